@@ -24,7 +24,7 @@
  * \library       seq64rtcli application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2017-04-07
- * \updates       2020-02-09
+ * \updates       2023-03-08
  * \license       GNU GPLv2 or above
  *
  *  This application is seq64 without a GUI, control must be done via MIDI.
@@ -49,6 +49,8 @@
 #endif
 
 #include "midifile.hpp"                 /* seq64::midifile to open the file */
+#include "offline_render.hpp"           /* seq64::offline_render            */
+#include "perf_stats.hpp"               /* seq64::statistics()              */
 #include "perform.hpp"                  /* seq64::perform, the main object  */
 #include "settings.hpp"                 /* seq64::usr() and seq64::rc()     */
 
@@ -82,6 +84,41 @@ save_file (seq64::perform & p)
     return result;
 }
 
+/**
+ *  Handles the "-o render=filename" option.  Renders the loaded song, as
+ *  heard in Song mode, into a MIDI file, and reports the throughput.
+ *
+ * \param p
+ *      The performance object, with the song already loaded.
+ *
+ * \param filename
+ *      The destination MIDI file.
+ *
+ * \return
+ *      Returns true if the song was rendered and written.
+ */
+
+static bool
+render_file (seq64::perform & p, const std::string & filename)
+{
+    seq64::offline_render renderer(p);
+    bool result = renderer.render();
+    if (result)
+        result = renderer.write_midi_file(filename);
+
+    if (result)
+    {
+        printf
+        (
+            "Rendered %ld ticks, %ld events in %.3f ms (%.0f events/s) to %s\n",
+            long(renderer.ticks()), renderer.capture().count(),
+            renderer.elapsed_us() / 1000.0, renderer.events_per_second(),
+            filename.c_str()
+        );
+    }
+    return result;
+}
+
 /**
  *  The standard C/C++ entry point to this application.  This first thing
  *  this function does is scan the argument vector and strip off all
@@ -216,7 +253,12 @@ main (int argc, char * argv [])
                 if (! ok)
                     extant_msg_active = true;
             }
-            if (ok)
+            if (ok && ! seq64::usr().option_render_file().empty())
+            {
+                ok = render_file(p, seq64::usr().option_render_file());
+                p.finish();                         /* tear down performer  */
+            }
+            else if (ok)
             {
 #if defined PLATFORM_LINUX
                 if (seq64::rc().lash_support())
@@ -224,11 +266,17 @@ main (int argc, char * argv [])
 
                 seq64::session_setup();
 #endif
+                const std::string & statsfile =
+                    seq64::usr().option_stats_file();
+
                 while (! seq64::session_close())
                 {
                     if (seq64::session_save())
                         save_file(p);
 
+                    if (! statsfile.empty())
+                        (void) seq64::statistics().write_report(statsfile);
+
                     usleep(1000000);
                 }
                 p.finish();                         /* tear down performer  */
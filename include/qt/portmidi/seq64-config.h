@@ -29,7 +29,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2018-04-08
- * \updates       2021-05-07
+ * \updates       2023-03-08
  * \license       GNU GPLv2 or above
  *
  *  Qt Portmidi Linux version.
@@ -378,9 +378,6 @@
 #endif
  */
 
-/* Define to enable statistics gathering */
-/* #undef STATISTICS_SUPPORT */
-
 /*
  * Define to 1 if you have the ANSI C header files.
  */
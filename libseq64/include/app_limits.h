@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2015-11-08
- * \updates       2018-10-31
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This collection of macros describes some facets of the
@@ -179,6 +179,27 @@
 
 #define SEQ64_ALSA_OUTPUT_BUSS_MAX        16
 
+/**
+ *  The maximum number of threads that evaluate the patterns in each output
+ *  cycle ("-o play-threads=n").  See the play_pool class.
+ */
+
+#define SEQ64_PLAY_THREADS_MAX            64
+
+/**
+ *  The maximum time, in milliseconds, by which the events are scheduled
+ *  ahead ("-o lookahead=ms").  See perform::schedule_ahead().
+ */
+
+#define SEQ64_LOOKAHEAD_MAX_MS            500
+
+/**
+ *  The longest period, in minutes, between automatic saves of the song
+ *  ("-o autosave=m").  See the autosaver class.
+ */
+
+#define SEQ64_AUTOSAVE_MAX_MINUTES        120
+
 /**
  *  Flags an unspecified buss number.  Two spellings are provided, one for
  *  youngsters and one for old men.  :-D
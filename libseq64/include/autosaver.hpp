@@ -0,0 +1,162 @@
+#ifndef SEQ64_AUTOSAVER_HPP
+#define SEQ64_AUTOSAVER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          autosaver.hpp
+ *
+ *  This module declares the thread that saves the song in the background.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-28
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  The autosaver thread wakes every few minutes (see the "-o autosave=m"
+ *  option) and, if the song was modified since it last saved it, writes
+ *  a song_snapshot to "autosave.midi" in the configuration directory.  It
+ *  can also be asked, by perform::save_in_background(), to save the song
+ *  to a given file at once.  Taking the snapshot is the only part of a save
+ *  that locks the patterns; the conversion to MIDI bytes and the file
+ *  writing happen on this thread, at its own pace.
+ */
+
+#include <string>                       /* std::string                      */
+#include <pthread.h>                    /* pthread_t                        */
+
+#include "mutex.hpp"                    /* seq64::condition_var             */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+    class song_snapshot;
+
+/**
+ *  Saves the song periodically, or on request, on a thread of its own.
+ */
+
+class autosaver
+{
+
+private:
+
+    /**
+     *  The performance to save.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  The full path of the autosave file.
+     */
+
+    std::string m_filename;
+
+    /**
+     *  The period of the autosave, in minutes.  If 0, the song is saved
+     *  only when requested.
+     */
+
+    int m_minutes;
+
+    /**
+     *  Wakes the thread, and guards m_running and the request.
+     */
+
+    condition_var m_wake;
+
+    /**
+     *  Cleared to stop the thread, which first finishes a requested save.
+     */
+
+    bool m_running;
+
+    /**
+     *  Indicates that a save was requested.
+     */
+
+    bool m_requested;
+
+    /**
+     *  The file to save to, for a request.  If empty, the autosave file.
+     */
+
+    std::string m_request_name;
+
+    /**
+     *  The perform::modify_count() value of the last save.
+     */
+
+    unsigned m_saved_count;
+
+    /**
+     *  The thread.
+     */
+
+    pthread_t m_thread;
+
+    /**
+     *  Indicates that m_thread was launched, and must be joined.
+     */
+
+    bool m_launched;
+
+public:
+
+    autosaver (perform & p, int minutes);
+    ~autosaver ();
+
+    bool request (const std::string & filename);
+
+    /**
+     * \getter m_filename
+     */
+
+    const std::string & filename () const
+    {
+        return m_filename;
+    }
+
+private:
+
+    void run ();
+    bool save (const std::string & filename, bool clear_modified);
+    static void * autosave_func (void * as);
+
+    autosaver (const autosaver &);                      /* not copyable     */
+    autosaver & operator = (const autosaver &);
+
+};          // class autosaver
+
+}           // namespace seq64
+
+#endif      // SEQ64_AUTOSAVER_HPP
+
+/*
+ * autosaver.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
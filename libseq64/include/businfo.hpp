@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-12-31
- * \updates       2017-05-31
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The businfo module defines the businfo and busarray classes so that we can
@@ -279,6 +279,11 @@ private:
         bus()->sysex(ev);
     }
 
+    void flush ()
+    {
+        bus()->flush();
+    }
+
 private:
 
     void print () const;
@@ -330,19 +335,27 @@ public:
     void init_clock (midipulse tick);
     void clock (midipulse tick);
     void sysex (event * ev);
+    void flush ();
     void play (bussbyte bus, event * e24, midibyte channel);
+    void play_at
+    (
+        bussbyte bus, event * e24, midibyte channel, long delayus, int tag
+    );
     bool set_clock (bussbyte bus, clock_e clocktype);
+    bool preset_clock (bussbyte bus, clock_e clocktype);
     void set_all_clocks ();
     clock_e get_clock (bussbyte bus);
     std::string get_midi_bus_name (int bus);        // full version
     void print () const;
     void port_exit (int client, int port);
+    int port_index (int client, int port);
     bool set_input (bussbyte bus, bool inputing);
+    bool preset_input (bussbyte bus, bool inputing);
     void set_all_inputs ();
     bool get_input (bussbyte bus);
     bool is_system_port (bussbyte bus);
     int poll_for_midi ();
-    bool get_midi_event (event * inev);
+    bool get_midi_event (event * inev, int * inbus = nullptr);
     int replacement_port (int bus, int port);
 
 };          // class busarray
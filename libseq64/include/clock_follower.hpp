@@ -0,0 +1,164 @@
+#ifndef SEQ64_CLOCK_FOLLOWER_HPP
+#define SEQ64_CLOCK_FOLLOWER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          clock_follower.hpp
+ *
+ *  This module declares a class that recovers the tempo and phase of an
+ *  external MIDI clock.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-13
+ * \updates       2023-03-13
+ * \license       GNU GPLv2 or above
+ *
+ *  When Sequencer64 is slaved to an external MIDI clock, the position used
+ *  to advance only when a MIDI Clock (0xF8) arrived, by 1/24 of a quarter
+ *  note at a time, with all the jitter of the incoming clock.  The
+ *  clock_follower runs the arrival times of the clocks through a
+ *  second-order delay-locked loop (DLL), as described by Fons Adriaensen in
+ *  "Using a DLL to filter time" (and as used by JACK).  The loop yields a
+ *  filtered time for each clock, and a running estimate of the clock
+ *  period, so that the output thread can interpolate the position between
+ *  clocks.  The interpolation never goes past the position of the next
+ *  clock, so the position never runs ahead of the master by more than a
+ *  clock, and it never goes backward.
+ *
+ *  See tests/clockfollow.cpp for a harness that measures the tracking
+ *  error for jittered clocks.
+ */
+
+#include "midibyte.hpp"                 /* seq64::midipulse, midibpm        */
+#include "mutex.hpp"                    /* seq64::mutex, automutex          */
+
+/**
+ *  The default bandwidth of the loop, in Hz.  Lower values filter more
+ *  jitter, but follow tempo changes more slowly.
+ */
+
+#define SEQ64_CLOCK_FOLLOWER_BANDWIDTH  1.0
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Recovers a continuous position from the MIDI Clock pulses.  pulse() is
+ *  called by the input thread, advance() by the output thread.
+ */
+
+class clock_follower
+{
+
+private:
+
+    /**
+     *  Protects the state of the loop.
+     */
+
+    mutable mutex m_mutex;
+
+    /**
+     *  The bandwidth of the loop, in Hz.
+     */
+
+    double m_bandwidth;
+
+    /**
+     *  The number of ticks per MIDI Clock, as given by
+     *  clock_ticks_from_ppqn().
+     */
+
+    int m_increment;
+
+    /**
+     *  The number of MIDI Clocks received since start().
+     */
+
+    long m_pulses;
+
+    /**
+     *  The filtered time of the latest MIDI Clock, in nanoseconds.
+     */
+
+    double m_t0;
+
+    /**
+     *  The predicted time of the next MIDI Clock, in nanoseconds.
+     */
+
+    double m_t1;
+
+    /**
+     *  The estimated period of the MIDI Clock, in nanoseconds.  Zero until
+     *  two clocks have been received.
+     */
+
+    double m_period;
+
+    /**
+     *  The whole ticks already handed out by advance().
+     */
+
+    midipulse m_reported;
+
+public:
+
+    clock_follower (double bandwidth = SEQ64_CLOCK_FOLLOWER_BANDWIDTH);
+
+    void start (int increment);
+    void pulse (long long ns);
+    midipulse advance (long long ns);
+    double position (long long ns) const;
+    midibpm bpm () const;
+
+    /**
+     *  Indicates if the loop has an estimate of the clock period, and so can
+     *  interpolate.
+     */
+
+    bool locked () const
+    {
+        automutex locker(m_mutex);
+        return m_pulses >= 2;
+    }
+
+private:
+
+    double interpolate (long long ns) const;
+    void resync (double t);
+
+};          // class clock_follower
+
+}           // namespace seq64
+
+#endif      // SEQ64_CLOCK_FOLLOWER_HPP
+
+/*
+ * clock_follower.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-11-28
- * \updates       2018-08-18
+ * \updates       2023-03-18
  * \license       GNU GPLv2 or above
  *
  *  This module extends the event class to support conversions between events
@@ -352,6 +352,29 @@ private:
 
     std::string m_name_data;
 
+    /**
+     *  Indicates that the category and the name strings have been made by
+     *  analyze().  An event editor holds an editable_event for every event of
+     *  the sequence, but shows only a screenful of them, so the strings are
+     *  made when first asked for, not when the event is loaded.  Changing
+     *  the event through the setters here clears this flag or re-analyzes.
+     */
+
+    bool m_analyzed;
+
+private:
+
+    /**
+     *  Makes the strings if not yet done.  The strings are a cache of the
+     *  event data, so this is allowed for a const event.
+     */
+
+    void check_analysis () const
+    {
+        if (! m_analyzed)
+            const_cast<editable_event *>(this)->analyze();
+    }
+
 public:
 
     /*
@@ -393,6 +416,7 @@ public:
 
     category_t category () const
     {
+        check_analysis();
         return m_category;
     }
 
@@ -404,6 +428,7 @@ public:
 
     const std::string & category_string () const
     {
+        check_analysis();
         return m_name_category;
     }
 
@@ -415,6 +440,7 @@ public:
 
     const std::string & timestamp_string () const
     {
+        check_analysis();
         return m_name_timestamp;
     }
 
@@ -461,6 +487,7 @@ public:
 
     std::string status_string () const
     {
+        check_analysis();
         return m_name_status;
     }
 
@@ -470,6 +497,7 @@ public:
 
     std::string meta_string () const
     {
+        check_analysis();
         return m_name_meta;
     }
 
@@ -479,6 +507,7 @@ public:
 
     std::string seqspec_string () const
     {
+        check_analysis();
         return m_name_seqspec;
     }
 
@@ -488,6 +517,7 @@ public:
 
     std::string channel_string () const
     {
+        check_analysis();
         return m_name_channel;
     }
 
@@ -499,6 +529,7 @@ public:
 
     std::string data_string () const
     {
+        check_analysis();
         return m_name_data;
     }
 
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2020-06-03
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This module also declares/defines the various constants, status-byte
@@ -42,6 +42,7 @@
  *  this data.
  */
 
+#include <memory>                       /* std::unique_ptr<>            */
 #include <string>                       /* used in to_string()          */
 #include <vector>                       /* SYSEX data stored in vector  */
 
@@ -331,24 +332,10 @@ private:
 
     midibyte m_data[SEQ64_MIDI_DATA_BYTE_COUNT];
 
-    /**
-     *  The data buffer for SYSEX messages.  Adapted from Stazed's Seq32
-     *  project on GitHub.  This object will also hold the generally small
-     *  amounts of data needed for Meta events.  Compare is_sysex() to
-     *  is_meta() and is_ex_data() [which tests for both].
-     */
-
-    SysexContainer m_sysex;
-
-    /**
-     *  This event is used to link Note Ons and Offs together.
-     */
-
-    event * m_linked;
-
     /**
      *  Indicates that a link has been made.  This item is used [via
-     *  the get_link() and link() accessors] in the sequence class.
+     *  the get_link() and link() accessors] in the sequence class.  This
+     *  flag and the three below fill the padding after m_data.
      */
 
     bool m_has_link;
@@ -371,6 +358,24 @@ private:
 
     bool m_painted;
 
+    /**
+     *  This event is used to link Note Ons and Offs together.
+     */
+
+    event * m_linked;
+
+    /**
+     *  The data buffer for SYSEX messages.  Adapted from Stazed's Seq32
+     *  project on GitHub.  This object will also hold the generally small
+     *  amounts of data needed for Meta events.  Compare is_sysex() to
+     *  is_meta() and is_ex_data() [which tests for both].  Only those
+     *  events have data, so the buffer is allocated only when data is
+     *  added (see sysex()); the other events carry just the null pointer.
+     *  This keeps an event at 40 bytes instead of 64 on 64-bit systems.
+     */
+
+    std::unique_ptr<SysexContainer> m_sysex;
+
 public:
 
     event ();
@@ -885,27 +890,21 @@ public:
 
     bool set_sysex (midibyte * data, int len)
     {
-        m_sysex.clear();
+        restart_sysex();
         return append_sysex(data, len);
     }
 
     /**
      * \getter m_sysex from stazed, non-const version for use by midibus.
+     *      Allocates the buffer if the event has none.
      */
 
     SysexContainer & get_sysex ()
     {
-        return m_sysex;
+        return sysex();
     }
 
-    /**
-     * \getter m_sysex from stazed
-     */
-
-    const SysexContainer & get_sysex () const
-    {
-        return m_sysex;
-    }
+    const SysexContainer & get_sysex () const;
 
     /**
      * \setter m_sysex from stazed
@@ -914,9 +913,9 @@ public:
     void set_sysex_size (int len)
     {
         if (len == 0)
-            m_sysex.clear();
+            restart_sysex();
         else
-            m_sysex.resize(len);
+            sysex().resize(len);
     }
 
     /**
@@ -925,7 +924,7 @@ public:
 
     int get_sysex_size () const
     {
-        return int(m_sysex.size());
+        return m_sysex ? int(m_sysex->size()) : 0 ;
     }
 
     /**
@@ -1286,6 +1285,11 @@ public:
      */
 
     int get_rank () const;
+    static int rank (midibyte status, midibyte note);
+
+private:
+
+    SysexContainer & sysex ();
 
 };          // class event
 
@@ -0,0 +1,216 @@
+#ifndef SEQ64_EVENT_COLUMNS_HPP
+#define SEQ64_EVENT_COLUMNS_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_columns.hpp
+ *
+ *  This module declares a column-wise copy of the events of a sequence, on
+ *  which the batch edits of the pattern editor are done.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-24
+ * \updates       2023-03-24
+ * \license       GNU GPLv2 or above
+ *
+ *  The edits of the pattern editor that move events (quantize, transpose,
+ *  stretch) used to walk the event_list node by node, adding each moved copy
+ *  with event_list::add(), which sorts the whole list, or to a second list
+ *  that was then merged.  A quantize of a long recorded pattern was
+ *  quadratic.
+ *
+ *  The event_columns class gathers, in one pass, the timestamp, status,
+ *  data, and flags of each event into a set of std::vectors, one per field,
+ *  in the order of the list.  The edit itself is then a loop over plain
+ *  arrays, which the compiler can unroll or vectorize, and which writes its
+ *  results to output columns.  Finally, apply() writes back only the events
+ *  that changed, removes the ones to be removed, and, if any event moved,
+ *  puts the list in order once, with event_list::arrange().  Moved events
+ *  sort after the unmoved events of the same time and rank, and in the order
+ *  they were moved, as they did when each was re-added to the list, so the
+ *  results, including the note links remade afterward, are unchanged.
+ *
+ *  The edits that only change data or selection in place (the LFO, the
+ *  data ramp, selection by box) still walk the list once.  Gathering the
+ *  columns is itself a walk of the list, so they would only get slower.
+ */
+
+#include <vector>                       /* std::vector<>                    */
+
+#include "event_list.hpp"               /* seq64::event_list, event         */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The column-wise copy of an event_list, and the edits done on it.
+ */
+
+class event_columns
+{
+
+public:
+
+    /**
+     *  Bits of the flags column.  The first three are gathered from the
+     *  events; the rest are set by the edits, and acted on by apply().  A
+     *  moved event is also unmarked, as the copies that used to be added
+     *  were.
+     */
+
+    enum flags_t
+    {
+        ec_selected = 0x01,             /**< The event is selected.         */
+        ec_marked   = 0x02,             /**< The event is marked.           */
+        ec_linked   = 0x04,             /**< The event has a linked event.  */
+        ec_changed  = 0x08,             /**< Write back the new columns.    */
+        ec_moved    = 0x10,             /**< Sort as if re-added.           */
+        ec_erase    = 0x20,             /**< Remove the event.              */
+        ec_select   = 0x40,             /**< Select the event.              */
+        ec_unmark   = 0x80              /**< Unmark the event.              */
+    };
+
+    typedef std::vector<event_list::iterator> Nodes;
+
+private:
+
+    /**
+     *  A copy of an event to be added, with a new timestamp.  Needed only
+     *  when an edit produces two results from one event (see quantize()).
+     */
+
+    struct copy
+    {
+        int c_row;                      /**< The event copied.              */
+        midipulse c_timestamp;          /**< The timestamp of the copy.     */
+        int c_order;                    /**< The order it was made in.      */
+    };
+
+    /**
+     *  The events, in the order of the list, for writing back.
+     */
+
+    Nodes m_nodes;
+
+    /**
+     *  The input columns, as gathered.
+     */
+
+    std::vector<midipulse> m_timestamps;
+    std::vector<midibyte> m_status;
+    std::vector<midibyte> m_d0;
+    std::vector<midibyte> m_d1;
+    std::vector<midibyte> m_flags;
+
+    /**
+     *  The output columns, sized only by the edits that write them, and
+     *  valid only for the events flagged ec_changed.
+     */
+
+    std::vector<midipulse> m_new_timestamps;
+    std::vector<midibyte> m_new_d0;
+    std::vector<midibyte> m_new_d1;
+
+    /**
+     *  The order in which the events flagged ec_moved were moved.
+     */
+
+    std::vector<int> m_order;
+
+    /**
+     *  The copies to be added, in the order they were made.
+     */
+
+    std::vector<copy> m_copies;
+
+    /**
+     *  The count of moves and copies made so far.
+     */
+
+    int m_moves;
+
+public:
+
+    event_columns ();
+
+    void gather (event_list & evl);
+    bool apply (event_list & evl);
+
+    /**
+     * \getter m_nodes.size()
+     */
+
+    int count () const
+    {
+        return int(m_nodes.size());
+    }
+
+    void quantize
+    (
+        midibyte status, midibyte cc, midipulse snap_tick, int divide,
+        bool linked, midipulse length, midipulse margin
+    );
+    void transpose (const int * table, int steps);
+    bool stretch (midipulse delta_tick);
+
+private:
+
+    /**
+     *  Gets the event of a row.
+     */
+
+    event & at (int row)
+    {
+        return event_list::dref(m_nodes[std::size_t(row)]);
+    }
+
+    /**
+     *  Indicates if an event is to be edited by the edits that work on the
+     *  selection: it is selected or already marked, as after
+     *  sequence::mark_selected().
+     */
+
+    bool edited (std::size_t row) const
+    {
+        return (m_flags[row] & (ec_selected | ec_marked)) != 0;
+    }
+
+    void prepare ();
+    void change (std::size_t r);
+    void move (int row, midipulse timestamp);
+    int link_row (int row) const;
+
+};          // class event_columns
+
+}           // namespace seq64
+
+#endif      // SEQ64_EVENT_COLUMNS_HPP
+
+/*
+ * event_columns.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,245 @@
+#ifndef SEQ64_EVENT_INDEX_HPP
+#define SEQ64_EVENT_INDEX_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_index.hpp
+ *
+ *  This module declares an index of the events of a sequence by time and
+ *  note, for the hit-tests and box selection of the pattern editors.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-25
+ * \updates       2023-03-26
+ * \license       GNU GPLv2 or above
+ *
+ *  sequence::select_note_events(), intersect_notes(), and
+ *  intersect_events() walked the whole event_list on every call, and the
+ *  pattern editors call them on every mouse move, to set the mouse pointer
+ *  over a note, or to erase-paint notes.  On a long pattern the pointer
+ *  lagged behind the mouse.
+ *
+ *  The event_index class holds, for each note value (the first data byte of
+ *  the events), the tick span of each event, sorted by start, with the
+ *  greatest end of each part of the sorted array kept in an implicit binary
+ *  tree, as in an interval tree.  A box query visits only the spans that
+ *  can overlap the box, and a point query is logarithmic.  A linked pair of
+ *  Note On and Note Off is one span, standing for both events.  The spans
+ *  that do not fit the tree (notes that wrap around the end of the pattern,
+ *  and links that are not mutual) are few, and are checked one by one.
+ *  The timestamps are also held by status, for intersect_events().
+ *
+ *  Like play_events, the index is rebuilt, in one pass and without sorting
+ *  when the event_list is in order, whenever the generation of the
+ *  sequence differs from the one it was built from.  Dragging a box or
+ *  hovering does not change the events, so those queries never rebuild it.
+ *  The spans point to the events themselves, which must not be removed
+ *  without a change of generation.  Since the container of the events may
+ *  be shared and copied (see event_list), the index is also rebuilt when
+ *  the serial number of the container changes.
+ */
+
+#include <vector>                       /* std::vector<>                    */
+
+#include "midibyte.hpp"                 /* seq64::midipulse, midibyte       */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class event;
+    class event_list;
+
+/**
+ *  The tick span of an event, as sequence::select_note_events() sees it.
+ *  For a linked note, the span runs from the Note On to the Note Off.  If
+ *  the Note On is later, the note wraps around the end of the pattern, and
+ *  es_start is greater than es_finish.  For an unlinked event, the span
+ *  runs from the timestamp to a little later (see event_index::slack()).
+ */
+
+struct event_span
+{
+    midipulse es_start;                 /**< The start of the span.         */
+    midipulse es_finish;                /**< The end of the span.           */
+    event * es_event;                   /**< The event, or the Note On.     */
+    int es_order;                       /**< Its position in the list.      */
+    midibyte es_note;                   /**< The note, i.e. the first byte. */
+    bool es_pair;                       /**< Stands for its Note Off too.   */
+};
+
+/**
+ *  The time-by-note index of an event_list.
+ */
+
+class event_index
+{
+
+public:
+
+    typedef std::vector<const event_span *> Hits;
+
+private:
+
+    /**
+     *  The number of note values, i.e. of values of a data byte.
+     */
+
+    static const int c_note_count = 256;
+
+    /**
+     *  The number of status values.
+     */
+
+    static const int c_status_count = 256;
+
+    /**
+     *  The spans that fit the tree, sorted by note, then by start.
+     */
+
+    std::vector<event_span> m_spans;
+
+    /**
+     *  For each span, the greatest es_finish of the part of the spans of
+     *  its note of which it is the middle.  This is the implicit tree.
+     */
+
+    std::vector<midipulse> m_max_finish;
+
+    /**
+     *  The index of the first span of each note, plus one for the end.
+     */
+
+    std::vector<int> m_note_first;
+
+    /**
+     *  The spans that wrap around, or have links that are not mutual, in
+     *  the order of the list.
+     */
+
+    std::vector<event_span> m_loose;
+
+    /**
+     *  The timestamps of all events, sorted by status, then by time.
+     */
+
+    std::vector<midipulse> m_stamps;
+
+    /**
+     *  The index of the first timestamp of each status, plus one for the
+     *  end.
+     */
+
+    std::vector<int> m_status_first;
+
+    /**
+     *  The spans, statuses, and timestamps as gathered, in the order of the
+     *  list, before they are sorted by note and by status.  Kept only for
+     *  their capacity.
+     */
+
+    std::vector<event_span> m_gathered;
+    std::vector<midibyte> m_gathered_status;
+    std::vector<midipulse> m_gathered_stamps;
+
+    /**
+     *  The sequence generation the index was built from.
+     */
+
+    unsigned m_generation;
+
+    /**
+     *  The serial number of the event container the index points into.
+     */
+
+    unsigned m_serial;
+
+    /**
+     *  Indicates that the index has been built at least once.
+     */
+
+    bool m_built;
+
+public:
+
+    event_index ();
+
+    void build (event_list & evl, unsigned generation);
+
+    /**
+     *  Indicates if the index matches the given sequence generation and
+     *  event container.
+     */
+
+    bool current (unsigned generation, unsigned serial) const
+    {
+        return m_built && m_generation == generation && m_serial == serial;
+    }
+
+    /**
+     *  The ticks that an unlinked event is extended by, to make it easier to
+     *  click.  It stretches the start of a selection box back, as
+     *  select_note_events() always did.
+     */
+
+    static midipulse slack ()
+    {
+        return 16;
+    }
+
+    void find_notes
+    (
+        midipulse tick_s, int note_h, midipulse tick_f, int note_l,
+        Hits & hits
+    ) const;
+    bool find_note
+    (
+        midipulse tick, int note, midipulse & start, midipulse & finish
+    ) const;
+    bool find_event
+    (
+        midibyte status, midipulse tick_s, midipulse tick_f,
+        midipulse & timestamp
+    ) const;
+
+private:
+
+    midipulse build_tree (int lo, int hi);
+    void find_spans
+    (
+        int lo, int hi, midipulse tick_s, midipulse tick_f, Hits & hits
+    ) const;
+    const event_span * find_pair (int lo, int hi, midipulse tick) const;
+
+};          // class event_index
+
+}           // namespace seq64
+
+#endif      // SEQ64_EVENT_INDEX_HPP
+
+/*
+ * event_index.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-19
- * \updates       2021-05-06
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This module extracts the event-list functionality from the sequencer
@@ -45,10 +45,25 @@
  *  release mode, and a lot faster in debug mode.  Why?  Probably because
  *  the std::list implementation calls std::list::sort() a lot, and the
  *  std::multimap implementation is a lot faster at sorting.
+ *
+ *  Copies of an event_list share the container of events, which is
+ *  reference-counted, until one of them changes it.  The undo and redo
+ *  stacks, the clipboard, and copies of whole patterns are cheap, and
+ *  share_duplicates() lets identical patterns, as found in imported songs,
+ *  share one container.  Any non-const access to the events, including
+ *  the non-const begin() and end(), first gives the list a container of
+ *  its own, copying the events and their links if the container is shared.
+ *  Read-only code should use the const accessors, such as cbegin(), so as
+ *  not to copy.  A copy invalidates the iterators and event pointers
+ *  obtained before it; serial() changes whenever that happens.
  */
 
+#include <algorithm>                    /* std::is_sorted()             */
+#include <atomic>                       /* std::atomic_thread_fence()   */
+#include <memory>                       /* std::shared_ptr<>            */
 #include <string>
 #include <stack>
+#include <vector>                       /* std::vector<>                */
 
 #include "seq64_features.h"             /* SEQ64_USE_EVENT_MAP          */
 
@@ -88,6 +103,7 @@ namespace seq64
 class event_list
 {
     friend class editable_events;       // access to event_key class
+    friend class event_index;           // owned(), for selection only
     friend class midifile;              // access to print()
     friend class sequence;              // any_selected_notes()
 
@@ -151,11 +167,42 @@ public:
 
 private:
 
+    /**
+     *  The container of the events, shared by copies of the list until one
+     *  of them changes it.
+     */
+
+    struct storage
+    {
+        /**
+         *  Holds the current pattern/sequence events.
+         */
+
+        Events st_events;
+
+        /**
+         *  Identifies this container, and so the validity of iterators and
+         *  event pointers into it.  Never reused.
+         */
+
+        unsigned st_serial;
+
+        /**
+         *  The length last given to verify_and_link(), if the events have
+         *  not been changed since, or -1.  It lets a shared copy skip a
+         *  verify_and_link() that would change nothing.
+         */
+
+        midipulse st_verified;
+
+        storage ();
+    };
+
     /**
      *  This list holds the current pattern/sequence events.
      */
 
-    Events m_events;
+    std::shared_ptr<storage> m_storage;
 
     /**
      *  Holds the length of the sequence holding this event-list,
@@ -200,63 +247,114 @@ public:
     ~event_list ();
 
     /**
-     * \getter m_events.begin(), non-constant version.
+     * \getter st_events.begin(), non-constant version.  Copies the events if
+     *      they are shared.
      */
 
     iterator begin ()
     {
-        return m_events.begin();
+        return owned().begin();
     }
 
     /**
-     * \getter m_events.begin(), constant version.
+     * \getter st_events.begin(), constant version.
      */
 
     const_iterator begin () const
     {
-        return m_events.begin();
+        return events().begin();
     }
 
     /**
-     * \getter m_events.end(), non-constant version.
+     * \getter st_events.end(), non-constant version.  Copies the events if
+     *      they are shared.
      */
 
     iterator end ()
     {
-        return m_events.end();
+        return owned().end();
     }
 
     /**
-     * \getter m_events.end(), constant version.
+     * \getter st_events.end(), constant version.
      */
 
     const_iterator end () const
     {
-        return m_events.end();
+        return events().end();
     }
 
     /**
-     *  Returns the number of events stored in m_events.  We like returning
+     * \getter st_events.begin(), constant version, for non-constant lists.
+     */
+
+    const_iterator cbegin () const
+    {
+        return events().begin();
+    }
+
+    /**
+     * \getter st_events.end(), constant version, for non-constant lists.
+     */
+
+    const_iterator cend () const
+    {
+        return events().end();
+    }
+
+    /**
+     *  Returns the number of events stored in the list.  We like returning
      *  an integer instead of size_t, and rename the function so nobody is
      *  fooled.
      */
 
     int count () const
     {
-        return int(m_events.size());
+        return int(events().size());
+    }
+
+    /**
+     * \getter m_storage->st_serial
+     *      It changes whenever the list gets another container, after which
+     *      the iterators and event pointers obtained before are not valid.
+     */
+
+    unsigned serial () const
+    {
+        return m_storage->st_serial;
+    }
+
+    /**
+     *  Indicates that the container is shared with another event_list.
+     *  use_count() is only a relaxed load.  If it finds the container ours
+     *  alone, the acquire fence orders our coming writes after the reads
+     *  made by the last other holder, such as a song_snapshot on the
+     *  autosave thread, before it let go of its reference.
+     */
+
+    bool shared () const
+    {
+        bool result = m_storage.use_count() > 1;
+        if (! result)
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+        return result;
     }
 
+    void unshare ();
+    static int share_duplicates (const std::vector<event_list *> & lists);
+
     midipulse max_length () const;
 
     /**
      *  Returns true if there are no events.
      *
-     *  return m_events.size() == 0;
+     *  return events().size() == 0;
      */
 
     bool empty () const
     {
-        return m_events.empty();
+        return events().empty();
     }
 
     /**
@@ -279,7 +377,7 @@ public:
         return append(e);
 #else
         bool result = append(e);
-        sort();                         /* by time-stamp and "rank" */
+        m_storage->st_events.sort();    /* by time-stamp and "rank" */
         return result;
 #endif
     }
@@ -308,7 +406,7 @@ public:
 
     void push_back (const event & e)
     {
-        m_events.push_back(e);
+        owned().push_back(e);
     }
 
 #endif
@@ -359,7 +457,8 @@ public:
     /**
      *  Provides a wrapper for the iterator form of erase(), which is the
      *  only one that sequence uses.  Currently, no check on removal is
-     *  performed.  Sets the modified-flag.
+     *  performed.  Sets the modified-flag.  The iterator comes from a
+     *  non-const access, so the container is already our own.
      *
      * \param ie
      *      Provides the iterator to the event to be removed.
@@ -367,24 +466,29 @@ public:
 
     void remove (iterator ie)
     {
-        m_events.erase(ie);
+        m_storage->st_events.erase(ie);
+        m_storage->st_verified = -1;
         m_is_modified = true;
     }
 
     /**
-     *  Provides a wrapper for clear().  Sets the modified-flag.
+     *  Provides a wrapper for clear().  Sets the modified-flag.  A shared
+     *  container is not copied, just left to the other lists.
      */
 
     void clear ()
     {
-        m_events.clear();
+        m_storage = std::make_shared<storage>();
         m_is_modified = true;
     }
 
     void merge (event_list & el, bool presort = true);
+    void arrange (const std::vector<iterator> & nodes);
 
     /**
      *  Sorts the event list; active only for the std::list implementation.
+     *  A list already in order is left alone, so that shared events are not
+     *  copied; the sort is stable, so it would not change anything.
      */
 
     void sort ()
@@ -392,7 +496,8 @@ public:
 #ifdef SEQ64_USE_EVENT_MAP
         // we need nothin' for sorting a multimap
 #else
-        m_events.sort();
+        if (! std::is_sorted(events().begin(), events().end()))
+            owned().sort();
 #endif
     }
 
@@ -459,14 +564,40 @@ private:                                // functions for friend sequence
     void print_notes (const std::string & tag = "") const;
 
     /**
-     * \getter m_events
+     * \getter st_events
      */
 
     const Events & events () const
     {
-        return m_events;
+        return m_storage->st_events;
     }
 
+    /**
+     * \getter st_events, for changing them.  Gives the list a container of
+     *      its own first, and forgets that it was verified, unless only the
+     *      selection is to be changed.
+     *
+     * \param selection_only
+     *      If true, the caller changes only the selection (or painting) of
+     *      the events, which verify_and_link() does not depend on.
+     */
+
+    Events & owned (bool selection_only = false)
+    {
+        if (shared())
+            unshare();
+
+        if (! selection_only)
+            m_storage->st_verified = -1;
+
+        return m_storage->st_events;
+    }
+
+    static void relink (const Events & source, Events & destination);
+    static bool same_events (const event_list & a, const event_list & b);
+    void link_indices (std::vector<int> & indices) const;
+    std::size_t content_hash (const std::vector<int> & indices) const;
+
     void set_length (midipulse len)
     {
         m_length = len;
@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-11-23
- * \updates       2018-06-02
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The mastermidibase module is the base-class version of the mastermidibus
@@ -36,11 +36,13 @@
  *  PortMidi.
  */
 
+#include <atomic>                       /* std::atomic<bool>                */
 #include <vector>                       /* for channel-filtered recording   */
 
 #include "businfo.hpp"                  /* seq64::businfo & busarray        */
 #include "midibus_common.hpp"
 #include "mutex.hpp"
+#include "thru_router.hpp"              /* seq64::thru_router               */
 #include "user_midi_bus.hpp"
 
 /*
@@ -50,7 +52,9 @@
 namespace seq64
 {
     class event;
+    class midi_capture;
     class midibus;
+    class play_buffer;
     class sequence;
 
 /**
@@ -107,6 +111,23 @@ protected:
 
     std::vector<bool> m_master_inputs;
 
+    /**
+     *  Holds the port names ("client:port") that went with the clock
+     *  settings the last time the "rc" file was written.  It is the
+     *  last-known port map; remap_ports() uses it to give each output port
+     *  its own clock setting, even if the system now numbers the ports
+     *  differently.  It is empty for an older "rc" file, and then the buss
+     *  numbers are used as is.
+     */
+
+    std::vector<std::string> m_master_clock_ports;
+
+    /**
+     *  Holds the port names that went with the input settings, as above.
+     */
+
+    std::vector<std::string> m_master_input_ports;
+
     /**
      *  The ID of the MIDI queue.
      */
@@ -155,6 +176,55 @@ protected:
 
     sequence * m_seq;
 
+    /**
+     *  If not null, receives a copy of everything played, sent as SysEx, or
+     *  set as the tempo.  See the offline_render class.  Not owned.
+     */
+
+    midi_capture * m_capture;
+
+    /**
+     *  Routes MIDI thru from the input ports straight to the output busses,
+     *  bypassing the sequences.  Its dispatching method is set by the
+     *  backend in api_init(), and its routes by update_thru().
+     */
+
+    thru_router m_thru_router;
+
+    /**
+     *  The input buss of the event most recently read by get_midi_event(),
+     *  or -1 if unknown.  Set by the backends that use
+     *  thru_router::dispatch_input.  Used only by the input thread.
+     */
+
+    int m_input_bus;
+
+    /**
+     *  A bit mask of the channels that carry the MIDI controls handled
+     *  while recording (start, stop, record).  These events must not be
+     *  echoed, so the channels are never routed.  See
+     *  perform::reserve_thru_channels().
+     */
+
+    unsigned m_thru_reserved;
+
+    /**
+     *  True while the events of the sequences are scheduled ahead on the
+     *  API queue ("-o lookahead=ms"), from schedule_start() to stop().  Read
+     *  by the threads that mute patterns.
+     */
+
+    std::atomic<bool> m_scheduling;
+
+    /**
+     *  The tick of the current output cycle, and the length of a tick in
+     *  microseconds.  The delay of an event played by play_ahead() is
+     *  figured from them.  See schedule_cycle().
+     */
+
+    double m_schedule_tick;
+    double m_schedule_pulse_us;
+
     /**
      *  The locking mutex.  This object is passed to an automutex object that
      *  lends exception-safety to the mutex locking.
@@ -173,7 +243,9 @@ public:
 
     /**
      *  Initialize the mastermidibus using the implementation-specific API
-     *  function. A return value would be nice.
+     *  function. A return value would be nice.  Then the clock and input
+     *  settings from the "rc" file are matched to the ports by name, before
+     *  activate() opens the output ports.
      *
      * \param ppqn
      *      The PPQN value to which to initialize the master MIDI buss.
@@ -188,6 +260,7 @@ public:
         m_ppqn = ppqn;
         m_beats_per_minute = bpm;
         api_init(ppqn, bpm);
+        remap_ports();
     }
 
     /*
@@ -240,6 +313,7 @@ public:
     void filter_by_channel (bool flag)
     {
         m_filter_by_channel = flag;
+        update_thru();
     }
 
     /**
@@ -290,11 +364,59 @@ public:
         return m_seq;
     }
 
+    /**
+     * \getter m_capture
+     */
+
+    midi_capture * capture () const
+    {
+        return m_capture;
+    }
+
+    void capture (midi_capture * mc);
+
+    static void redirect (play_buffer * pb);
+    static bool redirected ();
+
+    /**
+     * \getter m_scheduling
+     */
+
+    bool scheduling () const
+    {
+        return m_scheduling;
+    }
+
+    bool schedule_start ();
+    int schedule_lead_ms ();
+    void schedule_cycle (double tick, double pulseus);
+    void schedule_end ();
+    bool in_cycle () const;
+    void purge (int tag = 0);
+
+    /**
+     *  Indicates if incoming events of the given channel are forwarded by
+     *  the thru router, so that the sequences must not echo them.
+     *
+     * \param channel
+     *      The channel of the incoming event.
+     */
+
+    bool thru_routed (midibyte channel) const
+    {
+        return m_thru_router.routed(channel);
+    }
+
+    void update_thru ();
+    void reserve_thru_channel (int channel);
+    bool forward_thru (const event & ev);
+
     void start ();
     void stop ();
     void port_start (int client, int port);
     void port_exit (int client, int port);
     void play (bussbyte bus, event * e24, midibyte channel);
+    void play_ahead (bussbyte bus, event * e24, midibyte channel, int tag);
     void continue_from (midipulse tick);
     void init_clock (midipulse tick);
     void emit_clock (midipulse tick);
@@ -307,6 +429,8 @@ public:
 
     std::string get_midi_out_bus_name (bussbyte bus);
     std::string get_midi_in_bus_name (bussbyte bus);
+    std::string get_midi_out_port (bussbyte bus);
+    std::string get_midi_in_port (bussbyte bus);
 
     int poll_for_midi ();
     bool is_more_input ();
@@ -339,6 +463,22 @@ protected:
         m_master_inputs = inputs;
     }
 
+    /**
+     * \setter m_master_clock_ports, m_master_input_ports.
+     *      Used in the perform class to pass the port names read from the
+     *      "rc" file to here, along with the port statuses.
+     */
+
+    void set_port_names
+    (
+        const std::vector<std::string> & clockports,
+        const std::vector<std::string> & inputports
+    )
+    {
+        m_master_clock_ports = clockports;
+        m_master_input_ports = inputports;
+    }
+
     /**
      * \getter m_master_clocks, m_master_inputs.
      *      Used in the perform class to pass the settings read from the "rc"
@@ -366,6 +506,16 @@ protected:
         return bus < int(m_master_inputs.size()) ? m_master_inputs[bus] : false ;
     }
 
+    /**
+     * \setter m_input_bus
+     *      Called by api_get_midi_event() for each event read.
+     */
+
+    void input_bus (int bus)
+    {
+        m_input_bus = bus;
+    }
+
     /**
      *  Initializes and ctivates the busses, in a partly API-dependent manner.
      *  Currently re-implemented only in the rtmidi JACK API.
@@ -462,6 +612,33 @@ protected:
         // no code for portmidi
     }
 
+    /**
+     *  Gets the API ready to take events scheduled ahead of time (see
+     *  midibase::api_play_at()), for the schedule_start() function.
+     *
+     * \return
+     *      Returns false if the API cannot schedule events, which is the
+     *      case except for ALSA and PortMidi.
+     */
+
+    virtual bool api_schedule_start ()
+    {
+        return false;
+    }
+
+    virtual int api_schedule_lead_ms ();
+
+    /**
+     *  Removes the events still waiting in the API queue, for the purge()
+     *  function.  Note Offs are kept.  The \a tag parameter selects the
+     *  events of one pattern; 0 selects them all.
+     */
+
+    virtual void api_purge (int /* tag */)
+    {
+        // no code for base, rtmidi, or portmidi
+    }
+
     virtual bool api_get_midi_event (event * inev) = 0;
     virtual int api_poll_for_midi ();
 
@@ -480,6 +657,8 @@ private:
 
     bool save_clock (bussbyte bus, clock_e clock);
     bool save_input (bussbyte bus, bool inputing);
+    void remap_ports ();
+    int thru_target (int channel, int & outchannel) const;
 
 };          // class mastermidibase
 
@@ -28,14 +28,16 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-11-28
- * \updates       2017-09-02
+ * \updates       2023-03-06
  * \license       GNU GPLv2 or above
  *
  */
 
 #include "seq64-config.h"
 
-#if defined SEQ64_ALSAMIDI_SUPPORT
+#if defined SEQ64_NULLMIDI_SUPPORT
+#include "mastermidibus_nm.hpp"         /* seq64::mastermidibus, null MIDI  */
+#elif defined SEQ64_ALSAMIDI_SUPPORT
 #include "mastermidibus_am.hpp"         /* seq64::mastermidibus for ALSA    */
 #elif defined SEQ64_RTMIDI_SUPPORT
 #include "mastermidibus_rm.hpp"         /* seq64::mastermidibus for RtMidi  */
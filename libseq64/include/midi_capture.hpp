@@ -0,0 +1,202 @@
+#ifndef SEQ64_MIDI_CAPTURE_HPP
+#define SEQ64_MIDI_CAPTURE_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          midi_capture.hpp
+ *
+ *  This module declares a sink that records what the master MIDI buss is
+ *  asked to send.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-05
+ * \updates       2023-03-05
+ * \license       GNU GPLv2 or above
+ *
+ *  A midi_capture object can be attached to the mastermidibase with
+ *  mastermidibase::capture().  Every event played on an output buss, every
+ *  SysEx message, and every tempo change is then recorded along with the
+ *  current tick, which is set by the code driving playback (see the
+ *  offline_render class).  The result can be examined in memory (e.g. by a
+ *  regression test) or written as a type 1 Standard MIDI File, one track
+ *  per buss.
+ */
+
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "event.hpp"                    /* seq64::event                     */
+#include "midibyte.hpp"                 /* seq64::midipulse, bussbyte, etc. */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Records the output stream of the master buss.
+ */
+
+class midi_capture
+{
+
+public:
+
+    /**
+     *  One captured event.  The channel given to mastermidibase::play() has
+     *  already been applied to the event.  Tempo changes are stored as tempo
+     *  Meta events; they do not belong to any buss.
+     */
+
+    class record
+    {
+        friend class midi_capture;
+
+    private:
+
+        midipulse m_tick;
+        bussbyte m_bus;
+        event m_event;
+
+    public:
+
+        record (midipulse tick, bussbyte bus, const event & ev);
+
+        midipulse tick () const
+        {
+            return m_tick;
+        }
+
+        bussbyte bus () const
+        {
+            return m_bus;
+        }
+
+        const event & get_event () const
+        {
+            return m_event;
+        }
+    };
+
+    typedef std::vector<record> Records;
+
+private:
+
+    /**
+     *  The captured events, in the order they were played.
+     */
+
+    Records m_records;
+
+    /**
+     *  The tick stamped on events captured from now on.
+     */
+
+    midipulse m_tick;
+
+    /**
+     *  If true, captured events are also sent to the real MIDI ports.  If
+     *  false (the default), the ports stay silent, which is what one wants
+     *  when rendering a song faster than real time.
+     */
+
+    bool m_passthrough;
+
+public:
+
+    midi_capture (bool passthrough = false);
+
+    void capture (bussbyte bus, const event & ev, midibyte channel);
+    void capture_sysex (const event & ev);
+    void capture_tempo (midibpm bpm);
+    bool write_midi_file
+    (
+        const std::string & filename, int ppqn, midibpm bpm
+    ) const;
+
+    /**
+     *  Sets the tick to use for the next events.
+     */
+
+    void tick (midipulse t)
+    {
+        m_tick = t;
+    }
+
+    /**
+     * \getter m_tick
+     */
+
+    midipulse tick () const
+    {
+        return m_tick;
+    }
+
+    /**
+     * \getter m_passthrough
+     */
+
+    bool passthrough () const
+    {
+        return m_passthrough;
+    }
+
+    /**
+     * \getter m_records
+     */
+
+    const Records & records () const
+    {
+        return m_records;
+    }
+
+    /**
+     *  Returns the number of captured events.
+     */
+
+    long count () const
+    {
+        return long(m_records.size());
+    }
+
+    /**
+     *  Empties the capture, and rewinds the tick.
+     */
+
+    void clear ()
+    {
+        m_records.clear();
+        m_tick = 0;
+    }
+
+};          // class midi_capture
+
+}           // namespace seq64
+
+#endif      // SEQ64_MIDI_CAPTURE_HPP
+
+/*
+ * midi_capture.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
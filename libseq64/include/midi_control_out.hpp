@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Igor Angst
  * \date          2018-03-28
- * \updates       2019-06-10
+ * \updates       2023-03-19
  * \license       GNU GPLv2 or above
  *
  * The class contained in this file encapsulates most of the
@@ -36,13 +36,41 @@
  * order to reflect the state of sequencer64. This includes updates on
  * the playing and queueing status of the sequences.
  *
+ *  The feedback is sent by a thread of its own.  send_seq_event() is called
+ *  by sequence::set_playing() and sequence::toggle_queued(), which run on
+ *  the output thread, and by perform::announce_playscreen() for every slot
+ *  of a new screen-set.  They now only record the state wanted for the slot,
+ *  with no lock.  Every SEQ64_CTRL_OUT_FRAME_MS, the thread compares the
+ *  wanted state of each slot with the one it last sent, and sends only the
+ *  differences, at most SEQ64_CTRL_OUT_MAX_BURST of them, then flushes once.
+ *  Changes within a frame are coalesced, a screen-set change sends only the
+ *  LEDs that differ, and a surface on a DIN port is not flooded.
  */
 
+#include <atomic>                       /* std::atomic<>                    */
 #include <vector>                       /* std::vector<>                    */
+#include <pthread.h>                    /* pthread_t                        */
 
 #include "globals.h"
 #include "mastermidibus.hpp"
 #include "event.hpp"
+#include "mutex.hpp"                    /* seq64::condition_var             */
+
+/**
+ *  The period of the feedback thread, in milliseconds.  Changes arriving
+ *  within one period are sent together, and only the last state of a slot
+ *  is sent.
+ */
+
+#define SEQ64_CTRL_OUT_FRAME_MS         10
+
+/**
+ *  The most messages sent to the control surface per period.  Ten per 10 ms
+ *  is about the most that a DIN MIDI port can carry.  The rest wait for the
+ *  next period.
+ */
+
+#define SEQ64_CTRL_OUT_MAX_BURST        10
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -209,16 +237,67 @@ private:
 
     int m_screenset_offset;
 
+    /**
+     *  The state wanted for each slot of the screen-set, as a seq_action
+     *  value, or -1 if none has been asked for.  Written by any thread,
+     *  read by the feedback thread.
+     */
+
+    std::vector<std::atomic<int>> m_desired;
+
+    /**
+     *  The state last sent for each slot, or -1 if none has been sent.  Used
+     *  only by the feedback thread.
+     */
+
+    std::vector<int> m_sent;
+
+    /**
+     *  The non-sequence actions waiting to be sent, one bit per action.
+     *  Setting one action clears the others of its group; for example,
+     *  action_stop clears action_play.
+     */
+
+    std::atomic<unsigned> m_pending_actions;
+
+    /**
+     *  Indicates that the feedback thread has work.
+     */
+
+    std::atomic<bool> m_pending;
+
+    /**
+     *  Wakes the feedback thread, and guards m_running.
+     */
+
+    condition_var m_wake;
+
+    /**
+     *  Cleared to stop the feedback thread, which first sends anything still
+     *  pending.
+     */
+
+    bool m_running;
+
+    /**
+     *  The feedback thread.
+     */
+
+    pthread_t m_feedback_thread;
+
+    /**
+     *  Indicates that m_feedback_thread was launched, and must be joined.
+     */
+
+    bool m_feedback_launched;
+
 public:
 
     midi_control_out ();
+    ~midi_control_out ();
 
     void initialize (int count, int buss = SEQ64_MIDI_CONTROL_OUT_BUSS);
-
-    void set_master_bus (mastermidibus * mmbus)
-    {
-        m_master_bus = mmbus;
-    }
+    void set_master_bus (mastermidibus * mmbus);
 
     bussbyte buss () const
     {
@@ -248,19 +327,18 @@ public:
     }
 
     /**
-     * Send out notification about playing status of a sequence.
+     * Send out notification about playing status of a sequence.  The
+     * notification is sent by the feedback thread, if the state differs
+     * from the one last sent for the slot.
      *
      * \param seq
      *      The index of the sequence.
      *
      * \param what
      *      The status action of the sequence.
-     *
-     * \param flush
-     *      Flush MIDI buffer after sending (default true).
      */
 
-    void send_seq_event (int seq, seq_action what, bool flush = true);
+    void send_seq_event (int seq, seq_action what);
 
     /**
      *  Clears all visible sequences by sending "delete" messages for all
@@ -330,7 +408,8 @@ public:
     bool seq_event_is_active (int seq, seq_action what) const;
 
     /**
-     * Send out notification about non-sequence actions.
+     * Send out notification about non-sequence actions.  The notification
+     * is sent by the feedback thread, in its next period.
      *
      * \param what
      *      The action to be notified.
@@ -398,6 +477,14 @@ public:
 
     bool event_is_active (action what) const;
 
+private:
+
+    void wake ();
+    void play (const event & ev);
+    bool send_frame (int budget);
+    void run ();
+    static void * feedback_func (void * mco);
+
 };          // class midi_control_out
 
 /*
@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-11-24
- * \updates       2020-05-26
+ * \updates       2023-03-23
  * \license       GNU GPLv2 or above
  *
  *  The midibase module is the new base class for the various implementations
@@ -494,6 +494,7 @@ public:
     bool init_out_sub ();
     bool init_in_sub ();
     void play (event * e24, midibyte channel);
+    void play_at (event * e24, midibyte channel, long delayus, int tag);
     void sysex (event * e24);
     void flush ();
     void start ();
@@ -593,6 +594,21 @@ protected:
 
     virtual void api_play (event * e24, midibyte channel) = 0;
 
+    /**
+     *  Queues an event to be sent after the given delay, for the play_at()
+     *  function.  Only the ALSA and PortMidi implementations can do that;
+     *  the others play it now.  The \a delayus and \a tag parameters are
+     *  then unused.
+     */
+
+    virtual void api_play_at
+    (
+        event * e24, midibyte channel, long /* delayus */, int /* tag */
+    )
+    {
+        api_play(e24, channel);
+    }
+
     /**
      *  Handles implementation details for SysEx messages.
      *
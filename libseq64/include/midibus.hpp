@@ -28,14 +28,16 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-11-28
- * \updates       2017-12-26
+ * \updates       2023-03-06
  * \license       GNU GPLv2 or above
  *
  */
 
 #include "seq64-config.h"               /* generated by configure           */
 
-#if defined SEQ64_ALSAMIDI_SUPPORT
+#if defined SEQ64_NULLMIDI_SUPPORT
+#include "midibus_nm.hpp"               /* seq64::midibus for null MIDI     */
+#elif defined SEQ64_ALSAMIDI_SUPPORT
 #include "midibus_am.hpp"               /* seq64::midibus for ALSA          */
 #elif defined SEQ64_RTMIDI_SUPPORT
 #include "midibus_rm.hpp"               /* seq64::midibus for RtMidi        */
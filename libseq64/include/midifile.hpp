@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2021-05-09
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The Seq24 MIDI file is a standard, Format 1 MIDI file, with some extra
@@ -133,6 +133,7 @@ namespace seq64
     class midi_splitter;
     class perform;
     class midi_vector;
+    class song_snapshot;
 
 /**
  *  This class handles the parsing and writing of MIDI files.  In addition to
@@ -302,6 +303,7 @@ public:
 
     virtual bool parse (perform & p, int screenset = 0, bool importing = false);
     virtual bool write (perform & p, bool doseqspec = true);
+    bool write (const song_snapshot & snap, bool doseqspec = true);
 
     bool write_song (perform & p);
 
@@ -467,7 +469,7 @@ protected:
     void write_time_sig (int beatsperbar, int beatwidth);
 #endif
     void write_prop_header (midilong tag, long len);
-    bool write_proprietary_track (perform & a_perf);
+    bool write_proprietary_track (const song_snapshot & snap);
     long varinum_size (long len) const;
     long prop_item_size (long datalen) const;
     long track_name_size (const std::string & trackname) const;
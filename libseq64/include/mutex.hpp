@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2016-05-06
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This module defines the following classes:
@@ -160,7 +160,9 @@ public:
 
     condition_var ();
     void wait ();
+    bool timed_wait (int ms);
     void signal ();
+    void broadcast ();
 
 };
 
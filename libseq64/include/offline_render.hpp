@@ -0,0 +1,149 @@
+#ifndef SEQ64_OFFLINE_RENDER_HPP
+#define SEQ64_OFFLINE_RENDER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          offline_render.hpp
+ *
+ *  This module declares a class to play a song faster than real time,
+ *  capturing its output.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-05
+ * \updates       2023-03-05
+ * \license       GNU GPLv2 or above
+ *
+ *  The offline_render class drives perform::play() with a virtual clock,
+ *  instead of the output thread's real-time clock, with a midi_capture
+ *  attached to the master buss.  Since the same playback code is exercised
+ *  (trigger transitions, transposition, pattern wrap-around, tempo events,
+ *  song mutes, and the compiled song_timeline if it is enabled), the capture
+ *  is exactly what Sequencer64 would send to the ports, only much faster.
+ *
+ *  Uses:
+ *
+ *      -   Exporting the song as heard, one track per buss.
+ *      -   A deterministic basis for regression tests.
+ *      -   A throughput measurement, in events per second.
+ */
+
+#include <string>                       /* std::string                      */
+
+#include "midi_capture.hpp"             /* seq64::midi_capture              */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+
+/**
+ *  Renders a song offline.
+ */
+
+class offline_render
+{
+
+private:
+
+    /**
+     *  The performance to be rendered.  It must not be running.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  Receives the output of the render.
+     */
+
+    midi_capture m_capture;
+
+    /**
+     *  The tempo in force when the render started, for writing the file.
+     */
+
+    midibpm m_start_bpm;
+
+    /**
+     *  The number of ticks played.
+     */
+
+    midipulse m_ticks;
+
+    /**
+     *  The wall-clock duration of the last render, in microseconds.
+     */
+
+    double m_elapsed_us;
+
+public:
+
+    offline_render (perform & p, bool passthrough = false);
+
+    bool render
+    (
+        midipulse starttick = 0,
+        midipulse endtick = SEQ64_NULL_MIDIPULSE,
+        midipulse step = 1
+    );
+    bool write_midi_file (const std::string & filename) const;
+    double events_per_second () const;
+
+    /**
+     * \getter m_capture
+     */
+
+    const midi_capture & capture () const
+    {
+        return m_capture;
+    }
+
+    /**
+     * \getter m_ticks
+     */
+
+    midipulse ticks () const
+    {
+        return m_ticks;
+    }
+
+    /**
+     * \getter m_elapsed_us
+     */
+
+    double elapsed_us () const
+    {
+        return m_elapsed_us;
+    }
+
+};          // class offline_render
+
+}           // namespace seq64
+
+#endif      // SEQ64_OFFLINE_RENDER_HPP
+
+/*
+ * offline_render.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
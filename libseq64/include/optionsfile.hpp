@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2019-06-10
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The ~/.seq24rc or ~/.config/sequencer64/sequencer64.rc files are
@@ -112,6 +112,7 @@ private:
         const std::string & sectionname,
         const std::string & additional = ""
     );
+    std::string port_name () const;
 
 };          // class optionsfile
 
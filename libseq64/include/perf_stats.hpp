@@ -0,0 +1,388 @@
+#ifndef SEQ64_PERF_STATS_HPP
+#define SEQ64_PERF_STATS_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          perf_stats.hpp
+ *
+ *  This module declares the real-time latency and jitter statistics of the
+ *  application.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-08
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  These statistics replace the old SEQ64_STATISTICS_SUPPORT code of
+ *  perform::output_func(), which had to be compiled in and printed its
+ *  tables only when playback stopped.  The statistics are always compiled,
+ *  and cost a few relaxed atomic increments per output cycle, so they can be
+ *  read at any time, from any thread, without disturbing playback:
+ *
+ *      -   The duration of each output cycle (the play() and clock work).
+ *      -   The lateness of each wake-up of the output thread.
+ *      -   The number of events sent per output cycle.
+ *      -   The latency from the arrival of an input event at its port to
+ *          its forwarding to the output buss and handing to a pattern.
+ *      -   The fill level of the output buffer of each buss, and the
+ *          number of messages each buss had to drop ("xruns").
+ *
+ *  Optionally, a timeline trace of every measurement can be kept in a
+ *  fixed-size ring and dumped to a CSV file for offline analysis.
+ *
+ *  The single global object is accessed via the statistics() function, in
+ *  the same way the settings are accessed via rc() and usr(), so that the
+ *  MIDI backends can feed it without a pointer to the perform object.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "app_limits.h"                 /* SEQ64_DEFAULT_BUSS_MAX           */
+
+/**
+ *  The number of records in the timeline trace enabled by the "-o
+ *  trace=filename" option.  At 24 bytes per record, this is 6 MB, and holds
+ *  at least a minute or two of busy playback.
+ */
+
+#define SEQ64_STATS_TRACE_SIZE      (256 * 1024)
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  A lock-free histogram with power-of-two buckets.  Bucket 0 counts values
+ *  of 0 (or less), and bucket n counts values from 2^(n-1) to 2^n - 1.  The
+ *  last bucket also counts everything larger.  This is coarse, but it is
+ *  cheap, and it has the right shape for latencies, where the tail matters
+ *  more than the resolution.
+ */
+
+class histogram
+{
+
+public:
+
+    /**
+     *  The number of buckets.  The last one starts at 2^22, which is about
+     *  4 seconds when the units are microseconds.
+     */
+
+    static const int c_buckets = 24;
+
+private:
+
+    /**
+     *  The name and units of the measurement, for the reports.
+     */
+
+    const char * m_name;
+    const char * m_units;
+
+    std::atomic<long> m_buckets[c_buckets];
+    std::atomic<long> m_count;
+    std::atomic<long long> m_sum;
+    std::atomic<long> m_min;
+    std::atomic<long> m_max;
+
+public:
+
+    histogram (const char * name = "", const char * units = "");
+
+    void label (const char * name, const char * units);
+    void add (long value);
+    void reset ();
+
+    static int bucket_index (long value);
+    static long bucket_floor (int index);
+
+    /**
+     * \getter m_name
+     */
+
+    const char * name () const
+    {
+        return m_name;
+    }
+
+    /**
+     * \getter m_units
+     */
+
+    const char * units () const
+    {
+        return m_units;
+    }
+
+    /**
+     * \getter m_count
+     */
+
+    long count () const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \getter m_buckets[index]
+     *      The index is not checked.
+     */
+
+    long bucket (int index) const
+    {
+        return m_buckets[index].load(std::memory_order_relaxed);
+    }
+
+    long minimum () const;
+    long maximum () const;
+    double mean () const;
+    long percentile (double pct) const;
+    std::string to_string () const;
+
+private:
+
+    histogram (const histogram &);              /* atomics do not copy  */
+    histogram & operator = (const histogram &);
+
+};          // class histogram
+
+/**
+ *  Holds all of the real-time statistics.
+ */
+
+class perf_stats
+{
+
+public:
+
+    /**
+     *  The kinds of records in the timeline trace.
+     */
+
+    enum trace_kind
+    {
+        trace_cycle,            /**< Output cycle duration, microseconds.   */
+        trace_lateness,         /**< Wake-up lateness, microseconds.        */
+        trace_events,           /**< Events sent in an output cycle.        */
+        trace_input,            /**< Input-to-output latency, microseconds. */
+        trace_fill,             /**< Output buffer fill, percent.           */
+        trace_xrun,             /**< A message dropped by a buss.           */
+        trace_underrun          /**< The output cycle overran its period.   */
+    };
+
+    /**
+     *  One record of the timeline trace.
+     */
+
+    struct trace_record
+    {
+        long long tr_nanoseconds;
+        int tr_kind;
+        int tr_bus;
+        long tr_value;
+    };
+
+private:
+
+    histogram m_cycle;
+    histogram m_lateness;
+    histogram m_events;
+    histogram m_input;
+
+    /**
+     *  The output-buffer fill level of each buss, in percent.  Only the
+     *  backends with a buffer of their own (the JACK ring-buffer, the ALSA
+     *  output buffer) fill these in.
+     */
+
+    histogram m_fill[SEQ64_DEFAULT_BUSS_MAX];
+
+    /**
+     *  The number of messages each output buss could not send because its
+     *  buffer was full or the backend refused them.
+     */
+
+    std::atomic<long> m_xruns[SEQ64_DEFAULT_BUSS_MAX];
+
+    /**
+     *  The number of xruns reported by the JACK server itself.
+     */
+
+    std::atomic<long> m_server_xruns;
+
+    /**
+     *  The number of output cycles that took longer than their period, so
+     *  that the output thread did not sleep at all.
+     */
+
+    std::atomic<long> m_underruns;
+
+    /**
+     *  The number of events sent so far in the current output cycle.
+     */
+
+    std::atomic<long> m_cycle_events;
+
+    /**
+     *  The steady-clock time of the construction or the last reset.
+     */
+
+    std::atomic<long long> m_start_ns;
+
+    /**
+     *  The timeline trace, a ring of records.  It is empty (and the trace
+     *  disabled) unless enable_trace() is called before the threads start.
+     */
+
+    std::vector<trace_record> m_trace;
+
+    /**
+     *  The total number of records written to the trace.  The next record
+     *  goes to this number modulo the size of the trace.
+     */
+
+    std::atomic<unsigned long> m_trace_next;
+
+public:
+
+    perf_stats ();
+
+    static long long now_ns ();
+
+    void reset ();
+    void enable_trace (std::size_t capacity);
+
+    /**
+     *  Counts one event sent to an output buss.  Called by
+     *  mastermidibase::play().
+     */
+
+    void count_event ()
+    {
+        m_cycle_events.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void end_cycle (long long startns, long long endns);
+    void wake_up (long sleepus, long long sleepns, long long wakens);
+    void underrun ();
+    void input (long long arrivalns);
+    void buffer_fill (int bus, int percent);
+    void xrun (int bus);
+    void server_xrun ();
+
+    /**
+     * \getter m_cycle
+     */
+
+    const histogram & cycle () const
+    {
+        return m_cycle;
+    }
+
+    /**
+     * \getter m_lateness
+     */
+
+    const histogram & lateness () const
+    {
+        return m_lateness;
+    }
+
+    /**
+     * \getter m_events
+     */
+
+    const histogram & events () const
+    {
+        return m_events;
+    }
+
+    /**
+     * \getter m_input
+     */
+
+    const histogram & input_latency () const
+    {
+        return m_input;
+    }
+
+    const histogram & fill (int bus) const;
+    long xruns (int bus) const;
+
+    /**
+     * \getter m_server_xruns
+     */
+
+    long server_xruns () const
+    {
+        return m_server_xruns.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \getter m_underruns
+     */
+
+    long underruns () const
+    {
+        return m_underruns.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \getter m_trace.empty()
+     */
+
+    bool tracing () const
+    {
+        return ! m_trace.empty();
+    }
+
+    std::string report () const;
+    bool write_report (const std::string & filename) const;
+    bool dump_trace (const std::string & filename) const;
+
+private:
+
+    void trace (trace_kind kind, int bus, long value, long long ns = 0);
+
+};          // class perf_stats
+
+/*
+ *  The global statistics object.
+ */
+
+extern perf_stats & statistics ();
+
+}           // namespace seq64
+
+#endif      // SEQ64_PERF_STATS_HPP
+
+/*
+ * perf_stats.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
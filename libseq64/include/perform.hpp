@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2020-05-25
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This class still has way too many members, even with the JACK and
@@ -58,6 +58,7 @@
  */
 
 #include "globals.h"                    /* globals, nullptr, & more         */
+#include "clock_follower.hpp"           /* seq64::clock_follower            */
 #include "jack_assistant.hpp"           /* optional seq64::jack_assistant   */
 #include "gui_assistant.hpp"            /* seq64::gui_assistant             */
 #include "keys_perform.hpp"             /* seq64::keys_perform              */
@@ -66,12 +67,14 @@
 #include "midi_control_out.hpp"         /* seq64::midi_control_out          */
 #include "playlist.hpp"                 /* seq64::playlist, 0.96 and above  */
 #include "sequence.hpp"                 /* seq64::sequence                  */
+#include "song_timeline.hpp"            /* seq64::song_timeline             */
 
 #ifdef SEQ64_SONG_BOX_SELECT
 #include <functional>                   /* std::function, function objects  */
 #include <set>                          /* std::set, arbitary selection     */
 #endif
 
+#include <atomic>                       /* std::atomic<>                    */
 #include <memory>                       /* std::unique_ptr<>                */
 #include <vector>                       /* std::vector<>                    */
 #include <pthread.h>                    /* pthread_t C structure            */
@@ -135,7 +138,9 @@
 
 namespace seq64
 {
+    class autosaver;
     class keystroke;
+    class play_pool;
 
 /**
  *  These were purely internal constants used with the functions that
@@ -253,10 +258,12 @@ struct performcallback
 
 class perform
 {
+    friend class autosaver;             // clears the modified flag
     friend class jack_assistant;
     friend class keybindentry;
     friend class mainwnd;
     friend class midifile;
+    friend class offline_render;        // drives play() with a fake clock
     friend class options;
     friend class optionsfile;           // needs cleanup
     friend class perfedit;
@@ -266,6 +273,9 @@ class perform
     friend class qsliveframe;
     friend class qsmainwnd;
     friend class sequence;              // for setting tempo from events
+    friend class play_pool;             // parallel pattern evaluation
+    friend class song_snapshot;         // copies the song for saving
+    friend class song_timeline;         // ditto, compiled song playback
     friend class wrkfile;
     friend void * input_thread_func (void * myperf);
     friend void * output_thread_func (void * myperf);
@@ -861,6 +871,22 @@ private:
 
     std::vector<bool> m_master_inputs;
 
+    /**
+     *  Saves the port names obtained from the "rc" file for the clock
+     *  settings, the last-known port map.  The mastermidibus uses it to
+     *  match the settings to the ports, which might now be numbered
+     *  differently.
+     */
+
+    std::vector<std::string> m_master_clock_ports;
+
+    /**
+     *  Saves the port names obtained from the "rc" file for the input
+     *  settings.
+     */
+
+    std::vector<std::string> m_master_input_ports;
+
     /**
      *  Holds the "one measure's worth" of pulses (ticks), which is normally
      *  m_ppqn * 4.  We can save some multiplications, and, more importantly,
@@ -922,10 +948,13 @@ private:
     bool m_midiclockrunning;            // stopped or started
 
     /**
-     *  More MIDI clock support.
+     *  Recovers the tempo and phase of the external MIDI clock from the
+     *  arrival times of the MIDI Clock messages, so that the output thread
+     *  can advance smoothly between them.  Replaces the count of clock
+     *  ticks received.
      */
 
-    int m_midiclocktick;
+    clock_follower m_clock_follower;
 
     /**
      *  We need to adjust the clock increment for the PPQN that is in force.
@@ -1068,6 +1097,40 @@ private:
 
     int m_sequence_high;
 
+    /**
+     *  Holds the compiled form of the song, used in Song mode instead of
+     *  sequence::play() if the "-o song-timeline" option is in force.  See
+     *  song_timeline_active().
+     */
+
+    song_timeline m_song_timeline;
+
+    /**
+     *  The threads that evaluate the patterns in Live mode, and in Song mode
+     *  without the song timeline.  Created by launch() only if the "-o
+     *  play-threads=n" option asks for more than one thread; otherwise
+     *  perform::play() evaluates the patterns itself.
+     */
+
+    play_pool * m_play_pool;
+
+    /**
+     *  The thread that saves the song in the background, periodically if
+     *  the "-o autosave=m" option is given, and on request.  Created by
+     *  launch() for the option, or by the first save_in_background().
+     */
+
+    autosaver * m_autosaver;
+
+    /**
+     *  The tick up to which the patterns have been played when the events
+     *  are scheduled ahead ("-o lookahead=ms").  It never goes backward
+     *  until the position is reset, so that no event is played twice when
+     *  the look-ahead shrinks.  See schedule_ahead().
+     */
+
+    midipulse m_lookahead_tick;
+
 #ifdef SEQ64_EDIT_SEQUENCE_HIGHLIGHT
 
     /**
@@ -1082,9 +1145,24 @@ private:
     /**
      *  It may be a good idea to eventually centralize all of the dirtiness of
      *  a performance here.  All the GUIs seem to use a perform object.
+     *
+     *  Bit 0 is the modified flag.  The other bits count the modifications,
+     *  so that a save made in the background can tell if the song changed
+     *  while it was being written.  Both live in one atomic word, so that
+     *  is_modified_at() can test the count and clear the flag in a single
+     *  compare-and-swap, without losing a modification made meanwhile by
+     *  the GUI thread.
      */
 
-    bool m_is_modified;
+    std::atomic<unsigned> m_modify_state;
+
+    /**
+     *  Held while patterns are installed or deleted, or the screen-set notes
+     *  change, and while a song_snapshot copies them, since a snapshot can
+     *  be taken by the autosave thread.
+     */
+
+    mutable mutex m_snapshot_lock;
 
 #ifdef SEQ64_SONG_BOX_SELECT
 
@@ -1489,26 +1567,42 @@ public:
      */
 
     /**
-     * \getter m_is_modfied
+     * \getter m_modify_state
+     *      Returns the modified flag.
      */
 
     bool is_modified () const
     {
-        return m_is_modified;
+        return (m_modify_state.load() & 1) != 0;
     }
 
     /**
-     * \setter m_is_modified
-     *      This setter only sets the modified-flag to true.
+     * \setter m_modify_state
+     *      This setter only sets the modified-flag to true, and bumps the
+     *      modification count in the same atomic operation.
      *      The setter that can falsify it, is_modified(), is private.  No one
      *      but perform and its friends should falsify this flag.
      */
 
     void modify ()
     {
-        m_is_modified = true;
+        unsigned state = m_modify_state.load();
+        while (! m_modify_state.compare_exchange_weak(state, (state | 1) + 2))
+            ;                               /* state reloaded on failure    */
+    }
+
+    /**
+     * \getter m_modify_state
+     *      Returns the modification count.
+     */
+
+    unsigned modify_count () const
+    {
+        return m_modify_state.load() >> 1;
     }
 
+    bool save_in_background (const std::string & filename = "");
+
     /**
      * \getter m_ppqn
      */
@@ -2298,6 +2392,7 @@ public:
     bool is_mseq_available (int seq) const;
     bool screenset_is_active (int screenset);
     void apply_song_transpose ();
+    int share_duplicate_patterns ();
 
     /**
      * \setter m_transpose
@@ -3113,6 +3208,7 @@ private:
     bool handle_playlist_control (int ctl, midi_control::action a, int v);
     const std::string & get_screenset_notepad (int screenset) const;
     bool any_group_unmutes () const;
+    bool group_mute_state (int group, int gtrack) const;
     void print_group_unmutes () const;
     void mute_group_tracks ();
     void select_and_mute_group (int g_group);
@@ -3175,7 +3271,12 @@ private:
      */
 
     void play (midipulse tick);
+    midipulse schedule_ahead (midipulse tick);
+    void merge_recordings ();
+    midipulse input_tick (long delayus);
+    void reserve_thru_channels ();
     void set_orig_ticks (midipulse tick);
+    bool song_timeline_active () const;
     int max_active_set () const;
 
     /*
@@ -3189,15 +3290,33 @@ private:
     bool seq_in_playing_screen (int seq);
 
     /**
-     * \setter m_is_modified
+     * \setter m_modify_state
      *
      * \param flag
-     *      The value of the modified flag to be set.
+     *      The value of the modified flag to be set.  If true, the
+     *      modification count is also bumped.
      */
 
     void is_modified (bool flag)
     {
-        m_is_modified = flag;
+        if (flag)
+            modify();
+        else
+            m_modify_state.fetch_and(~1u);
+    }
+
+    /**
+     *  Falsifies the modified flag after a save made in the background,
+     *  unless the song was modified after the snapshot was taken.
+     *
+     * \param count
+     *      The modify_count() value of the snapshot that was saved.
+     */
+
+    void is_modified_at (unsigned count)
+    {
+        unsigned state = (count << 1) | 1;
+        (void) m_modify_state.compare_exchange_strong(state, count << 1);
     }
 
     bool valid_midi_control_seq (int seq) const;
@@ -3350,6 +3469,24 @@ private:
             m_master_clocks[bus] = clocktype;
     }
 
+    /**
+     *  Saves the port name read from the "rc" file with a clock setting.
+     *
+     * \param bus
+     *      The buss number read from the "rc" file.
+     *
+     * \param portname
+     *      The "client:port" name of the port, empty if not recorded.
+     */
+
+    void set_clock_port (bussbyte bus, const std::string & portname)
+    {
+        if (bus >= bussbyte(m_master_clock_ports.size()))
+            m_master_clock_ports.resize(bus + 1);
+
+        m_master_clock_ports[bus] = portname;
+    }
+
     /**
      *  Gets a single clock item, if in the currently existing range.
      *  Meant for use by the optionsfile::write() function.
@@ -3384,6 +3521,19 @@ private:
         m_master_inputs.push_back(flag);
     }
 
+    /**
+     *  Saves the port name read from the "rc" file with an input setting.
+     *  Called right after add_input(), so that the names line up.
+     *
+     * \param portname
+     *      The "client:port" name of the port, empty if not recorded.
+     */
+
+    void add_input_port (const std::string & portname)
+    {
+        m_master_input_ports.push_back(portname);
+    }
+
     /**
      *  Sets a single input item, if in the currently existing range.
      *  Mostly meant for use by the Options / MIDI Input tab.
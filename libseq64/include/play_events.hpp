@@ -0,0 +1,160 @@
+#ifndef SEQ64_PLAY_EVENTS_HPP
+#define SEQ64_PLAY_EVENTS_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          play_events.hpp
+ *
+ *  This module declares a compact, contiguous copy of the events of a
+ *  sequence, holding only what playback needs.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-14
+ * \updates       2023-03-14
+ * \license       GNU GPLv2 or above
+ *
+ *  The event class carries, besides the timestamp and the MIDI bytes, a
+ *  vector for SysEx and Meta data, a link pointer, the link, selection,
+ *  mark, and paint flags used by the editors, and a vtable pointer.  Each
+ *  event is also a separate node of the event_list.  sequence::play(),
+ *  which walks the events of every playing pattern on every output cycle,
+ *  touched at least a cache line per event, most of it editor state.
+ *
+ *  The event_list remains the one that is edited, saved, and drawn.  The
+ *  play_events class holds a packed, trivially-copyable record of each
+ *  event that can be played, in one std::vector, in the same order.  It is
+ *  rebuilt by sequence::play() whenever the generation of the sequence (see
+ *  sequence::generation()) differs from the one it was built from, so that
+ *  editing is unchanged, and playback reads 16 bytes per event.  SysEx and
+ *  Meta events other than Set Tempo are never played, and are left out.
+ */
+
+#include <vector>                       /* std::vector<>                    */
+
+#include "midibyte.hpp"                 /* seq64::midipulse, midibyte       */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class event;
+    class event_list;
+
+/**
+ *  The playback record of one event.  The status has no channel, as in the
+ *  event class; the channel kept by the event (see event::get_channel()) is
+ *  in the high nybble of pe_flags.  For a Set Tempo event, the status is
+ *  EVENT_MIDI_META, and the three tempo bytes are held in pe_tempo, as
+ *  microseconds per quarter note; for all others, pe_tempo is 0.
+ */
+
+struct play_event
+{
+    midipulse pe_timestamp;             /**< The time of the event.         */
+    midibyte pe_status;                 /**< Status, without the channel.   */
+    midibyte pe_data[2];                /**< The data bytes.                */
+    midibyte pe_flags;                  /**< See play_events::flags_t.      */
+    unsigned pe_tempo;                  /**< Tempo, in us per quarter note. */
+};
+
+/**
+ *  The contiguous playback copy of an event_list.
+ */
+
+class play_events
+{
+
+public:
+
+    /**
+     *  Bits for play_event::pe_flags, answering the questions
+     *  sequence::play() asks of each event in the frame.
+     */
+
+    enum flags_t
+    {
+        pe_note     = 0x01,             /**< Note On, Note Off, Aftertouch. */
+        pe_tempo    = 0x02,             /**< A Set Tempo Meta event.        */
+        pe_nochan   = 0x04,             /**< The event has no channel.      */
+        pe_chanmask = 0xF0              /**< The channel, shifted left 4.   */
+    };
+
+    typedef std::vector<play_event> Records;
+
+private:
+
+    /**
+     *  The records, in the order of the event_list.
+     */
+
+    Records m_records;
+
+    /**
+     *  The sequence generation the records were built from.
+     */
+
+    unsigned m_generation;
+
+    /**
+     *  Indicates that the records have been built at least once.
+     */
+
+    bool m_built;
+
+public:
+
+    play_events ();
+
+    void build (const event_list & evl, unsigned generation);
+    static void to_event (const play_event & pe, event & ev);
+
+    /**
+     *  Indicates if the records match the given sequence generation.
+     */
+
+    bool current (unsigned generation) const
+    {
+        return m_built && m_generation == generation;
+    }
+
+    /**
+     * \getter m_records
+     */
+
+    const Records & records () const
+    {
+        return m_records;
+    }
+
+};          // class play_events
+
+}           // namespace seq64
+
+#endif      // SEQ64_PLAY_EVENTS_HPP
+
+/*
+ * play_events.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,287 @@
+#ifndef SEQ64_PLAY_POOL_HPP
+#define SEQ64_PLAY_POOL_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          play_pool.hpp
+ *
+ *  This module declares a pool of threads that evaluates the patterns in
+ *  each output cycle.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-09
+ * \updates       2023-03-22
+ * \license       GNU GPLv2 or above
+ *
+ *  perform::play() normally has each sequence evaluate its triggers, select
+ *  the events in the current frame, transpose them, and play them, one
+ *  sequence after the other, all on the output thread.  With hundreds of
+ *  busy patterns, that can take longer than the output period.
+ *
+ *  The play_pool spreads that work over several threads.  The sequences are
+ *  handed out in small chunks, claimed by each thread (the output thread
+ *  included) from an atomic counter.  While a thread evaluates, the events
+ *  its sequences play go to a play_buffer of its own (see
+ *  mastermidibase::redirect()) instead of to the busses, so that the threads
+ *  do not contend for the buss mutex.  When all of the chunks are done, the
+ *  output thread merges the buffers, chunk by chunk, in sequence order.
+ *  Events within one output cycle are all sent "now", so sequence order,
+ *  then the order in which each sequence played them, is the order that
+ *  the serial loop would have used.  The output is therefore identical to
+ *  that of the serial loop, whatever the number of threads, and whichever
+ *  thread evaluated which chunk.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <vector>                       /* std::vector<>                    */
+#include <pthread.h>                    /* pthread_t                        */
+
+#include "event.hpp"                    /* seq64::event                     */
+#include "midibyte.hpp"                 /* seq64::midipulse, bussbyte       */
+#include "mutex.hpp"                    /* seq64::condition_var             */
+
+/**
+ *  The number of sequences in each chunk handed to a thread.  Small enough
+ *  to balance the load when a few patterns are much busier than the rest,
+ *  large enough to keep the atomic counter quiet.
+ */
+
+#define SEQ64_PLAY_POOL_CHUNK       4
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+
+/**
+ *  Holds the events played by one thread of the play_pool during one output
+ *  cycle.  The buffer keeps its capacity from cycle to cycle, so that it
+ *  stops allocating once the busiest cycle has been seen.
+ */
+
+class play_buffer
+{
+
+public:
+
+    /**
+     *  One event, with the arguments that mastermidibase::play() was given.
+     *  The tag is 0, unless mastermidibase::play_ahead() was called.
+     */
+
+    struct record
+    {
+        bussbyte pr_bus;
+        midibyte pr_channel;
+        int pr_tag;
+        event pr_event;
+    };
+
+    typedef std::vector<record> Records;
+
+private:
+
+    Records m_records;
+
+public:
+
+    play_buffer ();
+
+    void add (bussbyte bus, const event & ev, midibyte channel, int tag = 0);
+
+    /**
+     *  Empties the buffer, keeping its capacity.
+     */
+
+    void clear ()
+    {
+        m_records.clear();
+    }
+
+    /**
+     * \getter m_records.size()
+     */
+
+    std::size_t size () const
+    {
+        return m_records.size();
+    }
+
+    /**
+     * \getter m_records[index]
+     *      The index is not checked.
+     */
+
+    record & at (std::size_t index)
+    {
+        return m_records[index];
+    }
+
+};          // class play_buffer
+
+/**
+ *  The pool of threads.  The caller of play(), normally the output thread,
+ *  is the first thread of the pool; the others wait for work.
+ */
+
+class play_pool
+{
+
+private:
+
+    /**
+     *  The part of one thread's buffer filled by one chunk of sequences.
+     */
+
+    struct span
+    {
+        int sp_worker;
+        std::size_t sp_begin;
+        std::size_t sp_end;
+    };
+
+    /**
+     *  One thread of the pool.  Worker 0 is the caller of play(), and has
+     *  no thread of its own.
+     */
+
+    struct worker
+    {
+        play_pool * wk_pool;
+        int wk_index;
+        pthread_t wk_thread;
+        bool wk_launched;
+        play_buffer wk_buffer;
+    };
+
+    /**
+     *  The performance whose sequences are played.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  The threads.  The size of this vector is fixed by the constructor,
+     *  because each thread holds a pointer to its element.
+     */
+
+    std::vector<worker> m_workers;
+
+    /**
+     *  Where each chunk of the current cycle went, indexed by chunk number.
+     */
+
+    std::vector<span> m_spans;
+
+    /**
+     *  Wakes up the workers at the start of a cycle, and protects
+     *  m_cycle and m_quit.
+     */
+
+    condition_var m_start;
+
+    /**
+     *  Wakes up the caller of play() when the last worker is done, and
+     *  protects m_running.
+     */
+
+    condition_var m_done;
+
+    /**
+     *  Incremented at the start of each cycle.  A worker compares it with
+     *  the last cycle it did to tell a new cycle from a spurious wake-up.
+     */
+
+    unsigned long m_cycle;
+
+    /**
+     *  Tells the workers to exit.
+     */
+
+    bool m_quit;
+
+    /**
+     *  The number of workers (not counting the caller) still evaluating
+     *  the current cycle.
+     */
+
+    int m_running;
+
+    /**
+     *  The next chunk to be claimed in the current cycle.
+     */
+
+    std::atomic<int> m_next_chunk;
+
+    /**
+     *  The parameters of the current cycle, set by play() before the
+     *  workers are woken.
+     */
+
+    int m_chunk_count;
+    int m_sequence_high;
+    midipulse m_tick;
+    bool m_playback_mode;
+    bool m_resume_note_ons;
+
+public:
+
+    play_pool (perform & p, int threads);
+    ~play_pool ();
+
+    /**
+     * \getter m_workers.size()
+     *      The number of threads, including the caller of play().
+     */
+
+    int threads () const
+    {
+        return int(m_workers.size());
+    }
+
+    void play (midipulse tick, bool playbackmode, bool resumenoteons);
+
+private:
+
+    static void * worker_func (void * myworker);
+
+    void run (int index);
+    void evaluate (int index);
+    void merge ();
+
+    play_pool (const play_pool &);              /* no copies of threads */
+    play_pool & operator = (const play_pool &);
+
+};          // class play_pool
+
+}           // namespace seq64
+
+#endif      // SEQ64_PLAY_POOL_HPP
+
+/*
+ * play_pool.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -28,16 +28,15 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-22
- * \updates       2021-05-05
+ * \updates       2023-03-11
  * \license       GNU GPLv2 or above
  *
  *  This collection of variables describes the options of the application,
  *  accessible from the command-line or from the "rc" file.
  *
- * \warning
- *      We're making the "statistics" support a configure-time option.  The
- *      run-time option will be left here, but the actual usage of it will be
- *      disabled unless configured with the --enable-statistics option.
+ *  The "statistics" option (-S, --stats) prints the report of the latency
+ *  and jitter statistics (see the perf_stats module) when playback stops.
+ *  The statistics themselves are always gathered.
  *
  * \todo
  *      Consolidate the usr and rc settings classes, or at least have a base
@@ -45,6 +44,7 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "seq64_features.h"             /* SEQ64_USE_ZOOM_POWER_OF_2    */
 #include "app_limits.h"                 /* SEQ64_ALSA_OUTPUT_BUSS_MAX   */
@@ -266,6 +266,17 @@ private:
 
     int m_tempo_track_number;
 
+    /**
+     *  The latency of each input buss, in microseconds, from the
+     *  "[midi-input-latency]" section.  It is the time from playing a note
+     *  to the moment the backend timestamps it (the cable, the interface,
+     *  the driver), and is subtracted from the recorded time of each event
+     *  that arrives on the buss.  Busses past the end of the vector have no
+     *  latency.
+     */
+
+    std::vector<int> m_input_latency;
+
     /**
      *  Holds a few MIDI file-names most recently used.  Although this is a
      *  vector, we do not let it grow past SEQ64_RECENT_FILES_MAX.
@@ -746,6 +757,26 @@ public:
         return m_tempo_track_number;
     }
 
+    /**
+     * \getter m_input_latency[bus]
+     *      Returns 0 for a buss with no latency set.
+     */
+
+    int input_latency (int bus) const
+    {
+        return bus >= 0 && bus < int(m_input_latency.size()) ?
+            m_input_latency[bus] : 0 ;
+    }
+
+    /**
+     * \getter m_input_latency.size()
+     */
+
+    int input_latency_count () const
+    {
+        return int(m_input_latency.size());
+    }
+
     std::string recent_file (int index, bool shorten = true) const;
 
     /**
@@ -949,6 +980,7 @@ protected:
      */
 
     void tempo_track_number (int track);
+    void input_latency (int bus, int us);
     void device_ignore_num (int value);
     bool interaction_method (interaction_method_t value);
     bool mute_group_saving (mute_group_handling_t mgh);
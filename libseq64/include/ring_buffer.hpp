@@ -0,0 +1,194 @@
+#ifndef SEQ64_RING_BUFFER_HPP
+#define SEQ64_RING_BUFFER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          ring_buffer.hpp
+ *
+ *  This module declares/defines a lock-free, single-producer,
+ *  single-consumer queue.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-10
+ * \updates       2023-03-10
+ * \license       GNU GPLv2 or above
+ *
+ *  The queue lets one thread hand items to another without either of them
+ *  taking a mutex, so that neither can stall the other.  Exactly one thread
+ *  may call push(), and exactly one (other) thread may call pop().  The
+ *  storage is allocated once, by allocate(), which may be called while the
+ *  other threads are running; until then, push() simply fails.
+ *
+ *  The head and tail indices grow without bound, and are reduced modulo
+ *  the capacity only to index the storage, so that a full queue and an
+ *  empty one are easy to tell apart.
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+#include <vector>                       /* std::vector<>                    */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  A fixed-capacity, lock-free queue for one producer and one consumer.
+ *  The item type must be default-constructible and assignable.
+ */
+
+template <typename T>
+class ring_buffer
+{
+
+private:
+
+    /**
+     *  The storage.  Its size never changes once allocate() has set it.
+     */
+
+    std::vector<T> m_items;
+
+    /**
+     *  The number of items the storage holds, published by allocate()
+     *  after the storage exists.  Zero means no storage yet.
+     */
+
+    std::atomic<std::size_t> m_capacity;
+
+    /**
+     *  The number of items ever pushed.  Written only by the producer.
+     */
+
+    std::atomic<std::size_t> m_head;
+
+    /**
+     *  The number of items ever popped.  Written only by the consumer.
+     */
+
+    std::atomic<std::size_t> m_tail;
+
+public:
+
+    ring_buffer ()
+     :
+        m_items     (),
+        m_capacity  (0),
+        m_head      (0),
+        m_tail      (0)
+    {
+        // Empty body
+    }
+
+    /**
+     *  Allocates the storage, if not already done.  Must not be called by
+     *  two threads at once; the producer and consumer may be running.
+     *
+     * \param capacity
+     *      The number of items the queue can hold.
+     */
+
+    void allocate (std::size_t capacity)
+    {
+        if (m_capacity.load(std::memory_order_acquire) == 0 && capacity > 0)
+        {
+            m_items.resize(capacity);
+            m_capacity.store(capacity, std::memory_order_release);
+        }
+    }
+
+    /**
+     *  Adds an item.  Called only by the producer.
+     *
+     * \param item
+     *      The item to copy into the queue.
+     *
+     * \return
+     *      Returns false if the queue is full or not allocated.
+     */
+
+    bool push (const T & item)
+    {
+        std::size_t capacity = m_capacity.load(std::memory_order_acquire);
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        std::size_t tail = m_tail.load(std::memory_order_acquire);
+        bool result = capacity > 0 && head - tail < capacity;
+        if (result)
+        {
+            m_items[head % capacity] = item;
+            m_head.store(head + 1, std::memory_order_release);
+        }
+        return result;
+    }
+
+    /**
+     *  Removes the oldest item.  Called only by the consumer.
+     *
+     * \param [out] item
+     *      Receives the item.
+     *
+     * \return
+     *      Returns false if the queue is empty.
+     */
+
+    bool pop (T & item)
+    {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        std::size_t head = m_head.load(std::memory_order_acquire);
+        bool result = head != tail;
+        if (result)
+        {
+            std::size_t capacity = m_capacity.load(std::memory_order_relaxed);
+            item = m_items[tail % capacity];
+            m_tail.store(tail + 1, std::memory_order_release);
+        }
+        return result;
+    }
+
+    /**
+     *  Indicates if there is nothing to pop.  Exact only for the consumer.
+     */
+
+    bool empty () const
+    {
+        return m_head.load(std::memory_order_acquire) ==
+            m_tail.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    ring_buffer (const ring_buffer &);          /* atomics do not copy  */
+    ring_buffer & operator = (const ring_buffer &);
+
+};          // class ring_buffer
+
+}           // namespace seq64
+
+#endif      // SEQ64_RING_BUFFER_HPP
+
+/*
+ * ring_buffer.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
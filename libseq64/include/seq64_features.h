@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2016-08-19
- * \updates       2020-02-13
+ * \updates       2023-03-08
  * \license       GNU GPLv2 or above
  *
  *    Some options (the "USE_xxx" options) specify experimental and
@@ -324,13 +324,6 @@
  * #define SEQ64_FOLLOW_PROGRESS_BAR
  */
 
-/**
- *  An option we've preserved from Seq24, but have disabled until we find a
- *  need for it, is to tally some "statistics" about recording and playback.
- */
-
-#undef  SEQ64_STATISTICS_SUPPORT
-
 /**
  *  A color option.
  */
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-30
- * \updates       2021-05-09
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The functions add_list_var() and add_long_list() have been replaced by
@@ -48,6 +48,10 @@
 #include "midi_container.hpp"           /* seq64::midi_container        */
 #include "midibus.hpp"                  /* seq64::midibus               */
 #include "mutex.hpp"                    /* seq64::mutex, automutex      */
+#include "event_columns.hpp"            /* seq64::event_columns         */
+#include "event_index.hpp"              /* seq64::event_index           */
+#include "play_events.hpp"              /* seq64::play_events           */
+#include "ring_buffer.hpp"              /* seq64::ring_buffer<>         */
 #include "scales.h"                     /* key and scale constants      */
 #include "triggers.hpp"                 /* seq64::triggers, etc.        */
 
@@ -57,6 +61,14 @@
 
 #define SEQ64_COLOR_NONE                (-1)
 
+/**
+ *  The number of incoming events a recording sequence can hold between two
+ *  output cycles before stream_event() falls back to adding them directly.
+ *  See sequence::m_record_queue.
+ */
+
+#define SEQ64_RECORD_QUEUE_SIZE         512
+
 /*
  *  Do not document a namespace; it breaks Doxygen.
  */
@@ -145,6 +157,7 @@ class sequence
 {
     friend class perform;               /* access to set_parent()   */
     friend class triggers;              /* will unfriend later      */
+    friend class song_timeline;         /* compiled Song-mode play  */
 
 public:
 
@@ -203,6 +216,28 @@ private:
 
     event_list m_events;
 
+    /**
+     *  Holds the compact copy of m_events that play() walks, rebuilt from
+     *  m_events when m_generation changes.
+     */
+
+    play_events m_play_events;
+
+    /**
+     *  Holds the column-wise copy of m_events that the batch edits work on.
+     *  It is gathered anew by each edit, and kept only for its capacity.
+     */
+
+    event_columns m_columns;
+
+    /**
+     *  Holds the time-by-note index of m_events that the hit-tests and box
+     *  selections of the pattern editors query.  It is rebuilt by the first
+     *  query after m_generation changes.
+     */
+
+    event_index m_event_index;
+
     /**
      *  Holds the list of triggers associated with the sequence, used in the
      *  performance/song editor.
@@ -261,7 +296,22 @@ private:
      *  An iterator for drawing events.
      */
 
-    event_list::iterator m_iterator_draw;
+    event_list::const_iterator m_iterator_draw;
+
+    /**
+     *  The serial number of the event container m_iterator_draw points
+     *  into.  If m_events gets another container (see event_list::serial()),
+     *  the drawing stops, rather than following the old one.
+     */
+
+    unsigned m_draw_serial;
+
+    /**
+     *  The serial number of the event container at the last call to
+     *  reset_ex_iterator(), for the same purpose.
+     */
+
+    unsigned m_ex_serial;
 
     /**
      *  A new feature for recording, based on a "stazed" feature.  If true
@@ -341,6 +391,16 @@ private:
 
     bool m_recording;
 
+    /**
+     *  Holds the events recorded while the pattern plays.  The input thread
+     *  pushes them here in stream_event() without taking m_mutex, and the
+     *  output thread adds them to the pattern in merge_recording() at the
+     *  end of its cycle, so that heavy input does not hold up playback.
+     *  The storage is allocated when recording is first turned on.
+     */
+
+    ring_buffer<event> m_record_queue;
+
     /**
      *  Provides an option for expanding the number of measures while
      *  recording.  In essence, the "infinite" track we've wanted, thanks
@@ -447,6 +507,18 @@ private:
     bool m_dirty_perf;          /**< Provides performance dirty flagflag.   */
     bool m_dirty_names;         /**< Provides the names dirtiness flag.     */
 
+    /**
+     *  Incremented whenever the events or the playback-related settings of
+     *  the sequence change.  Unlike the dirty flags, it is never reset, so
+     *  that any number of consumers (e.g. the song_timeline) can compare it
+     *  with the value they last saw.  Changes to the playing status do not
+     *  count.  Every change to m_events must increment it, since play()
+     *  uses it to refresh m_play_events, and m_event_index points to the
+     *  events themselves.  A change of the note links counts, too.
+     */
+
+    unsigned m_generation;
+
     /**
      *  Indicates that the sequence is currently being edited.
      */
@@ -670,6 +742,7 @@ public:
     ~sequence ();
 
     void partial_assign (const sequence & rhs);
+    void snapshot_assign (const sequence & rhs);
 
     void set_editing (midibyte status, midibyte cc, midipulse snap, int scale)
     {
@@ -1408,6 +1481,26 @@ public:
     void set_dirty_mp ();
     void set_dirty ();
 
+    /**
+     * \getter m_generation
+     */
+
+    unsigned generation () const
+    {
+        return m_generation;
+    }
+
+    /**
+     * \getter m_triggers.generation()
+     *      Changes with every edit of the triggers of this sequence, so that
+     *      the song editors can tell when to draw them again.
+     */
+
+    unsigned trigger_generation () const
+    {
+        return m_triggers.generation();
+    }
+
     /**
      * \getter m_midi_channel
      */
@@ -1610,6 +1703,18 @@ public:
     midipulse clip_timestamp (midipulse ontime, midipulse offtime);
     void move_selected_notes (midipulse deltatick, int deltanote);
     bool stream_event (event & ev);
+    void merge_recording ();
+
+    /**
+     *  Indicates if merge_recording() has anything to do.  Called by the
+     *  output thread in each cycle, so it is inline and lock-free.
+     */
+
+    bool recording_pending () const
+    {
+        return ! m_record_queue.empty();
+    }
+
     bool change_event_data_range
     (
         midipulse tick_s, midipulse tick_f,
@@ -1841,13 +1946,31 @@ private:
         const event & e, midibyte status,
         midipulse tick_s, midipulse tick_f
     ) const;
+    const event_index & indexed_events ();
+    bool select_note_event (event & er, select_action_t action, int & result);
 
     void set_parent (perform * p);
-    void put_event_on_bus (event & ev);
+    void put_event_on_bus (event & ev, int tag = 0);
+    void echo_event (event & ev);
+    bool track_playing_note (const event & ev);
+    bool queue_recording (event & ev);
     void reset_loop ();
     void set_trigger_offset (midipulse trigger_offset);
     void adjust_trigger_offsets_to_length (midipulse newlen);
     midipulse adjust_offset (midipulse offset);
+
+    /**
+     *  The tag of the events of this sequence when they are scheduled ahead
+     *  (see mastermidibase::play_ahead()).  ALSA tags are one byte, and 0
+     *  is not used, so sequences 255 apart share a tag; a purge of one also
+     *  drops the pending events of the other, if it is playing.
+     */
+
+    int schedule_tag () const
+    {
+        return number() % 255 + 1;
+    }
+
     void remove (event_list::iterator i);
     void remove (event & e);
     void remove_all ();
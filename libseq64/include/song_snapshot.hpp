@@ -0,0 +1,267 @@
+#ifndef SEQ64_SONG_SNAPSHOT_HPP
+#define SEQ64_SONG_SNAPSHOT_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          song_snapshot.hpp
+ *
+ *  This module declares a copy of the song, as it is written to a MIDI
+ *  file, that can be written while the song plays on.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-28
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  midifile::write() used to walk the live patterns of the perform object
+ *  while it converted them to MIDI bytes, on whatever thread asked for the
+ *  save.  A song_snapshot copies, up front, everything that the write
+ *  needs:  each active pattern (see sequence::snapshot_assign()), the
+ *  screen-set notes, the mute groups, and the song settings.  The events
+ *  of a pattern are not copied, but shared with it (see event_list), so a
+ *  snapshot takes each pattern lock only for a moment, however long the
+ *  patterns are.  The snapshot never changes afterward, and can be written
+ *  on any thread, for example by the autosaver, while the patterns play
+ *  and are edited.
+ */
+
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "midibyte.hpp"                 /* seq64::midibpm                   */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+    class sequence;
+
+/**
+ *  An unchanging copy of the parts of a song that are saved.
+ */
+
+class song_snapshot
+{
+
+public:
+
+    /**
+     *  A copied pattern, and the number of its slot.
+     */
+
+    struct track
+    {
+        int tr_number;                  /**< The pattern number.            */
+        sequence * tr_sequence;         /**< The copy, owned here.          */
+    };
+
+    typedef std::vector<track> Tracks;
+
+private:
+
+    /**
+     *  The performance the snapshot was taken from.  It is passed to
+     *  midi_container::fill(), which reads nothing from it unless
+     *  USE_FILE_TIME_SIG_AND_TEMPO is defined.
+     */
+
+    const perform & m_perform;
+
+    /**
+     *  The active patterns, in order.
+     */
+
+    Tracks m_tracks;
+
+    /**
+     *  The screen-set notes, c_max_sets of them.
+     */
+
+    std::vector<std::string> m_notepads;
+
+    /**
+     *  The mute groups, c_seqs_in_set tracks for each of c_seqs_in_set
+     *  groups, as midifile::write_proprietary_track() saves them.
+     */
+
+    std::vector<bool> m_group_mutes;
+
+    /**
+     *  Indicates if any mute group unmutes a pattern.
+     */
+
+    bool m_any_group_unmutes;
+
+    /**
+     *  The song settings saved in the SeqSpec track.
+     */
+
+    int m_ppqn;
+    midibpm m_beats_per_minute;
+    int m_beats_per_bar;
+    int m_beat_width;
+    int m_tempo_track;
+    int m_musical_key;
+    int m_musical_scale;
+    int m_background_sequence;
+
+    /**
+     *  The value of perform::modify_count() when the snapshot was taken.
+     */
+
+    unsigned m_modify_count;
+
+public:
+
+    explicit song_snapshot (perform & p);
+    ~song_snapshot ();
+
+    /**
+     * \getter m_perform
+     */
+
+    const perform & performance () const
+    {
+        return m_perform;
+    }
+
+    /**
+     * \getter m_tracks
+     */
+
+    const Tracks & tracks () const
+    {
+        return m_tracks;
+    }
+
+    const std::string & notepad (int screenset) const;
+    bool group_mute_state (int group, int gtrack) const;
+
+    /**
+     * \getter m_any_group_unmutes
+     */
+
+    bool any_group_unmutes () const
+    {
+        return m_any_group_unmutes;
+    }
+
+    /**
+     * \getter m_ppqn
+     */
+
+    int ppqn () const
+    {
+        return m_ppqn;
+    }
+
+    /**
+     * \getter m_beats_per_minute
+     */
+
+    midibpm beats_per_minute () const
+    {
+        return m_beats_per_minute;
+    }
+
+    /**
+     * \getter m_beats_per_bar
+     */
+
+    int beats_per_bar () const
+    {
+        return m_beats_per_bar;
+    }
+
+    /**
+     * \getter m_beat_width
+     */
+
+    int beat_width () const
+    {
+        return m_beat_width;
+    }
+
+    /**
+     * \getter m_tempo_track
+     */
+
+    int tempo_track () const
+    {
+        return m_tempo_track;
+    }
+
+    /**
+     * \getter m_musical_key, from usr().seqedit_key()
+     */
+
+    int musical_key () const
+    {
+        return m_musical_key;
+    }
+
+    /**
+     * \getter m_musical_scale, from usr().seqedit_scale()
+     */
+
+    int musical_scale () const
+    {
+        return m_musical_scale;
+    }
+
+    /**
+     * \getter m_background_sequence, from usr().seqedit_bgsequence()
+     */
+
+    int background_sequence () const
+    {
+        return m_background_sequence;
+    }
+
+    /**
+     * \getter m_modify_count
+     */
+
+    unsigned modify_count () const
+    {
+        return m_modify_count;
+    }
+
+private:
+
+    song_snapshot (const song_snapshot &);              /* not copyable     */
+    song_snapshot & operator = (const song_snapshot &);
+
+};          // class song_snapshot
+
+}           // namespace seq64
+
+#endif      // SEQ64_SONG_SNAPSHOT_HPP
+
+/*
+ * song_snapshot.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
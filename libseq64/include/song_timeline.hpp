@@ -0,0 +1,303 @@
+#ifndef SEQ64_SONG_TIMELINE_HPP
+#define SEQ64_SONG_TIMELINE_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          song_timeline.hpp
+ *
+ *  This module declares a compiled, flattened form of the song (the
+ *  triggers of all patterns) for playback in Song mode.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-04
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  In Song mode, sequence::play() walks the trigger list of every pattern,
+ *  then walks the pattern's events (wrapping around the pattern length) to
+ *  find what falls inside the current frame, and transposes notes on the
+ *  fly.  That work is repeated for every pattern in every output cycle.
+ *
+ *  The song_timeline class does that work once.  Each trigger of each
+ *  pattern is "compiled" into a chunk of entries laid out at absolute song
+ *  ticks, already transposed, and bracketed by entries that arm and mute the
+ *  pattern at the trigger boundaries.  The chunks are merged into one
+ *  time-sorted lane per output buss, and playback then just advances a
+ *  cursor in each lane.
+ *
+ *  Edits made while playing are picked up by refresh(), which compares the
+ *  generation counters of each sequence and its triggers against the values
+ *  used for the last compile.  Only the chunks of the changed pattern are
+ *  rebuilt (chunks of unchanged triggers are reused), and only the lanes of
+ *  the affected busses are merged again.
+ *
+ *  Live-mode features (queueing, one-shots) and song recording are not
+ *  represented here; perform uses the normal sequence::play() path for them.
+ */
+
+#include <vector>                       /* std::vector<>                    */
+
+#include "event.hpp"                    /* seq64::event                     */
+#include "midibyte.hpp"                 /* seq64::midipulse, bussbyte       */
+#include "mutex.hpp"                    /* seq64::mutex, automutex          */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+    class sequence;
+    class trigger;
+
+/**
+ *  Holds the compiled Song-mode playback data and the cursors used to play
+ *  it back.
+ */
+
+class song_timeline
+{
+
+public:
+
+    /**
+     *  Indicates what an entry does when its tick is reached.  The values
+     *  also provide the sort order of entries that share a tick:  a pattern
+     *  is armed before its events play, and is muted after them.
+     */
+
+    enum phase_t
+    {
+        phase_on,               /**< Trigger start: arm the pattern.        */
+        phase_event,            /**< A MIDI (or tempo) event to play.       */
+        phase_off               /**< Trigger end: mute the pattern.         */
+    };
+
+    /**
+     *  One item of a lane.  The event is a copy of the pattern's event,
+     *  already transposed as required by the trigger or the song transpose.
+     */
+
+    class entry
+    {
+        friend class song_timeline;
+
+    private:
+
+        midipulse m_tick;       /**< Absolute song tick of the entry.       */
+        int m_seq;              /**< Number of the pattern owning the entry.*/
+        phase_t m_phase;        /**< Arm, event, or mute.                   */
+        midipulse m_offset;     /**< Trigger offset, for phase_on entries.  */
+        event m_event;          /**< The event, for phase_event entries.    */
+
+    public:
+
+        entry (midipulse tick, int seq, phase_t p, midipulse offset);
+        entry (midipulse tick, int seq, const event & ev);
+
+        /**
+         *  Orders entries by tick, then by phase.  Used with
+         *  std::stable_sort(), so that events at the same tick keep their
+         *  pattern order.
+         */
+
+        bool operator < (const entry & rhs) const
+        {
+            return m_tick < rhs.m_tick ||
+                (m_tick == rhs.m_tick && m_phase < rhs.m_phase);
+        }
+
+        midipulse tick () const
+        {
+            return m_tick;
+        }
+    };
+
+private:
+
+    /**
+     *  Holds everything a compiled chunk depends upon.  If any of these
+     *  values changes, the chunk must be compiled again.
+     */
+
+    class chunk_key
+    {
+        friend class song_timeline;
+
+    private:
+
+        midipulse m_tick_start;
+        midipulse m_tick_end;
+        midipulse m_offset;
+        midipulse m_length;
+        int m_transpose;
+
+    public:
+
+        chunk_key ();
+        bool operator == (const chunk_key & rhs) const;
+    };
+
+    /**
+     *  The entries generated by one trigger of one pattern, sorted by tick.
+     */
+
+    class chunk
+    {
+        friend class song_timeline;
+
+    private:
+
+        chunk_key m_key;
+        std::vector<entry> m_entries;
+    };
+
+    /**
+     *  The compiled state of one pattern slot.  The generation values and
+     *  the other cached items are compared against the live sequence in
+     *  refresh() to detect edits.
+     */
+
+    class slot
+    {
+        friend class song_timeline;
+
+    private:
+
+        sequence * m_seq;
+        unsigned m_events_serial;
+        unsigned m_seq_generation;
+        unsigned m_trigger_generation;
+        int m_song_transpose;
+        bussbyte m_bus;
+        bool m_compiled;
+        std::vector<chunk> m_chunks;
+
+    public:
+
+        slot ();
+    };
+
+    /**
+     *  The merged entries of all patterns that play on one buss, plus the
+     *  playback cursor into them.
+     */
+
+    class lane
+    {
+        friend class song_timeline;
+
+    private:
+
+        std::vector<entry> m_entries;
+        std::size_t m_cursor;
+        bool m_stale;
+
+    public:
+
+        lane ();
+    };
+
+    /**
+     *  Provides the source of the patterns and the destination of tempo
+     *  changes.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  One slot per pattern number, up to perform::sequence_high().
+     */
+
+    std::vector<slot> m_slots;
+
+    /**
+     *  One lane per output buss.
+     */
+
+    std::vector<lane> m_lanes;
+
+    /**
+     *  The next tick to be played.  Entries before this tick have already
+     *  been dispatched.
+     */
+
+    midipulse m_last_tick;
+
+    /**
+     *  Counts the chunks compiled since construction.  A small diagnostic
+     *  that lets one verify that an edit does not recompile the whole song.
+     */
+
+    long m_chunks_compiled;
+
+    /**
+     *  Serializes compiling (normally done by the GUI thread at start) and
+     *  playing (done by the output thread).
+     */
+
+    mutable mutex m_mutex;
+
+public:
+
+    song_timeline (perform & p);
+
+    void compile ();
+    void refresh ();
+    void seek (midipulse tick);
+    void play (midipulse tick);
+    void clear ();
+
+    /**
+     * \getter m_chunks_compiled
+     */
+
+    long chunks_compiled () const
+    {
+        return m_chunks_compiled;
+    }
+
+    std::size_t entry_count () const;
+
+private:
+
+    bool update_slot (int seqno, bool force);
+    void compile_chunk
+    (
+        sequence & s, const trigger & t, const chunk_key & key,
+        int seqno, chunk & c
+    );
+    void merge_lane (bussbyte bus);
+    void seek_lane (lane & ln, midipulse tick);
+    void dispatch (entry & e);
+
+};          // class song_timeline
+
+}           // namespace seq64
+
+#endif      // SEQ64_SONG_TIMELINE_HPP
+
+/*
+ * song_timeline.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -0,0 +1,184 @@
+#ifndef SEQ64_THRU_ROUTER_HPP
+#define SEQ64_THRU_ROUTER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          thru_router.hpp
+ *
+ *  This module declares the table that routes MIDI thru directly from the
+ *  input ports to the output busses.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-12
+ * \updates       2023-03-12
+ * \license       GNU GPLv2 or above
+ *
+ *  Normally, an incoming event that is to be echoed ("MIDI thru") travels
+ *  from the backend's input queue to the input thread, through
+ *  perform::poll_cycle() to the recording sequence, which then plays it on
+ *  its buss, whence the output thread or the next output callback sends it.
+ *  That is several thread hops and mutex locks.
+ *
+ *  The thru_router holds, for each input port and channel, the output buss
+ *  and channel to which an event is to be sent at once.  The table is
+ *  filled by mastermidibase::update_thru() from the thru settings of the
+ *  recording patterns, and read, without locking, by whoever dispatches the
+ *  events:
+ *
+ *      -   dispatch_callback:  The backend forwards each event from its
+ *          input callback straight to the output port, in the same period
+ *          (JACK).
+ *      -   dispatch_input:  mastermidibase forwards each event to the
+ *          output buss as soon as it is read, before the event goes to
+ *          perform::poll_cycle() (ALSA, null).
+ *      -   dispatch_none:  The backend cannot do either, and the sequences
+ *          echo the events as before.
+ *
+ *  When an event has been forwarded, the sequence that recorded it does not
+ *  echo it again; see sequence::echo_event().
+ */
+
+#include <atomic>                       /* std::atomic<>                    */
+
+#include "app_limits.h"                 /* SEQ64_DEFAULT_BUSS_MAX, etc.     */
+#include "midibyte.hpp"                 /* seq64::midibyte, bussbyte        */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  A lock-free table of thru routes.  Each entry is a single atomic integer,
+ *  so a reader sees either the old route or the new one, never a mixture.
+ */
+
+class thru_router
+{
+
+public:
+
+    /**
+     *  Who forwards the routed events.  Set once by the backend, before the
+     *  input thread starts.
+     */
+
+    enum dispatch_t
+    {
+        dispatch_none,          /**< No routing; the sequences echo.        */
+        dispatch_input,         /**< mastermidibase forwards as it reads.   */
+        dispatch_callback       /**< The backend's input callback forwards. */
+    };
+
+private:
+
+    /**
+     *  Indicates that an entry has no route.
+     */
+
+    static const int c_no_route = -1;
+
+    /**
+     *  The dispatching method of the backend.
+     */
+
+    dispatch_t m_dispatch;
+
+    /**
+     *  The route of each input buss and channel:  the output buss times 16
+     *  plus the output channel, or c_no_route.
+     */
+
+    std::atomic<int> m_routes[SEQ64_DEFAULT_BUSS_MAX][SEQ64_MIDI_CHANNEL_MAX];
+
+    /**
+     *  Indicates, for each channel, that the events of the channel are
+     *  routed from every input port that delivers them, so that the
+     *  sequences need not echo them.
+     */
+
+    std::atomic<bool> m_routed[SEQ64_MIDI_CHANNEL_MAX];
+
+public:
+
+    thru_router ();
+
+    void clear ();
+    void set_route (int inbus, int channel, int outbus, int outchannel);
+    void set_routed (int channel, bool flag);
+    bool route
+    (
+        int inbus, midibyte status, bussbyte & outbus, midibyte & outchannel
+    ) const;
+
+    /**
+     * \setter m_dispatch
+     */
+
+    void dispatch (dispatch_t d)
+    {
+        m_dispatch = d;
+    }
+
+    /**
+     * \getter m_dispatch
+     */
+
+    dispatch_t dispatch () const
+    {
+        return m_dispatch;
+    }
+
+    /**
+     *  Indicates if the events of the given channel are forwarded by the
+     *  router, rather than echoed by the sequences.
+     *
+     * \param channel
+     *      The channel of the event.  Events without a channel are never
+     *      routed.
+     */
+
+    bool routed (midibyte channel) const
+    {
+        return m_dispatch != dispatch_none &&
+            channel < SEQ64_MIDI_CHANNEL_MAX &&
+            m_routed[channel].load(std::memory_order_relaxed);
+    }
+
+private:
+
+    thru_router (const thru_router &);          /* atomics do not copy  */
+    thru_router & operator = (const thru_router &);
+
+};          // class thru_router
+
+}           // namespace seq64
+
+#endif      // SEQ64_THRU_ROUTER_HPP
+
+/*
+ * thru_router.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-10-30
- * \updates       2021-05-09
+ * \updates       2023-03-04
  * \license       GNU GPLv2 or above
  *
  *  By segregating trigger support into its own module, the sequence class is
@@ -350,6 +350,7 @@ class triggers
     friend class midi_container;
     friend class midifile;
     friend class sequence;
+    friend class song_timeline;         /* compiled Song-mode playback  */
     friend class Seq24PerfInput;        /* we need better encapsulation */
     friend class FruityPerfInput;       /* we need better encapsulation */
 
@@ -463,6 +464,15 @@ private:
 
     int m_length;
 
+    /**
+     *  Bumped by every operation that changes the trigger list, so that
+     *  consumers such as the compiled song timeline (see song_timeline) can
+     *  tell cheaply whether their copy of the triggers is stale.  Selection
+     *  changes do not count.
+     */
+
+    unsigned m_generation;
+
 public:
 
     triggers (sequence & parent);
@@ -592,6 +602,16 @@ public:
     {
         m_triggers.clear();
         m_number_selected = 0;
+        ++m_generation;
+    }
+
+    /**
+     * \getter m_generation
+     */
+
+    unsigned generation () const
+    {
+        return m_generation;
     }
 
     bool next
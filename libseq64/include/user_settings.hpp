@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-22
- * \updates       2020-06-21
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This module defines the following categories of "global" variables that
@@ -836,6 +836,40 @@ private:
 
     bool m_user_use_logfile;
 
+    /**
+     *  If true ("-o song-timeline"), Song-mode playback uses the compiled
+     *  song_timeline instead of having each sequence walk its triggers and
+     *  events in every output cycle.
+     */
+
+    bool m_user_option_song_timeline;
+
+    /**
+     *  The number of threads ("-o play-threads=n") that evaluate the
+     *  patterns in each output cycle.  The default, 1, evaluates them on the
+     *  output thread alone, as always; see the play_pool class.
+     */
+
+    int m_user_option_play_threads;
+
+    /**
+     *  The time, in milliseconds ("-o lookahead=ms"), by which the events of
+     *  the patterns are played ahead and queued, for the MIDI API to send
+     *  them at their time.  For PortMidi, it is instead the latency of the
+     *  output streams.  The default, 0, sends each event when its tick is
+     *  reached, as always; see perform::schedule_ahead().
+     */
+
+    int m_user_option_lookahead_ms;
+
+    /**
+     *  The period, in minutes ("-o autosave=m"), between automatic saves of
+     *  a modified song to a backup file.  The default, 0, turns them off; see
+     *  the autosaver class.
+     */
+
+    int m_user_option_autosave_minutes;
+
     /**
      *  If not empty, this file will be set up as the destination for all
      *  logging done by the errprint(), infoprint(), warnprint(), and printf()
@@ -850,6 +884,29 @@ private:
 
     std::string m_user_option_logfile;
 
+    /**
+     *  If not empty ("-o render=filename"), the CLI application renders the
+     *  song offline (see the offline_render class) into this MIDI file, and
+     *  exits instead of waiting for a session to end.
+     */
+
+    std::string m_user_option_render_file;
+
+    /**
+     *  If not empty ("-o stats=filename"), the CLI application rewrites the
+     *  statistics report (see the perf_stats class) to this file every
+     *  second, so that it can be watched while Sequencer64 plays.
+     */
+
+    std::string m_user_option_stats_file;
+
+    /**
+     *  If not empty ("-o trace=filename"), the timeline trace of the
+     *  statistics is enabled and written to this CSV file at exit.
+     */
+
+    std::string m_user_option_trace_file;
+
     /*
      *  [user-work-arounds]
      */
@@ -1834,6 +1891,42 @@ public:
         return m_user_use_logfile;
     }
 
+    /**
+     * \getter m_user_option_song_timeline
+     */
+
+    bool option_song_timeline () const
+    {
+        return m_user_option_song_timeline;
+    }
+
+    /**
+     * \getter m_user_option_play_threads
+     */
+
+    int option_play_threads () const
+    {
+        return m_user_option_play_threads;
+    }
+
+    /**
+     * \getter m_user_option_lookahead_ms
+     */
+
+    int option_lookahead_ms () const
+    {
+        return m_user_option_lookahead_ms;
+    }
+
+    /**
+     * \getter m_user_option_autosave_minutes
+     */
+
+    int option_autosave_minutes () const
+    {
+        return m_user_option_autosave_minutes;
+    }
+
     std::string option_logfile () const;
 
     /**
@@ -2006,6 +2099,19 @@ public:         // used in main application module and the userfile class
         m_user_use_logfile = flag;
     }
 
+    /**
+     * \setter m_user_option_song_timeline
+     */
+
+    void option_song_timeline (bool flag)
+    {
+        m_user_option_song_timeline = flag;
+    }
+
+    void option_play_threads (int count);
+    void option_lookahead_ms (int ms);
+    void option_autosave_minutes (int minutes);
+
     /**
      * \setter m_user_option_logfile
      */
@@ -2015,6 +2121,60 @@ public:         // used in main application module and the userfile class
         m_user_option_logfile = logfile;
     }
 
+    /**
+     * \getter m_user_option_render_file
+     */
+
+    const std::string & option_render_file () const
+    {
+        return m_user_option_render_file;
+    }
+
+    /**
+     * \setter m_user_option_render_file
+     */
+
+    void option_render_file (const std::string & fname)
+    {
+        m_user_option_render_file = fname;
+    }
+
+    /**
+     * \getter m_user_option_stats_file
+     */
+
+    const std::string & option_stats_file () const
+    {
+        return m_user_option_stats_file;
+    }
+
+    /**
+     * \setter m_user_option_stats_file
+     */
+
+    void option_stats_file (const std::string & fname)
+    {
+        m_user_option_stats_file = fname;
+    }
+
+    /**
+     * \getter m_user_option_trace_file
+     */
+
+    const std::string & option_trace_file () const
+    {
+        return m_user_option_trace_file;
+    }
+
+    /**
+     * \setter m_user_option_trace_file
+     */
+
+    void option_trace_file (const std::string & fname)
+    {
+        m_user_option_trace_file = fname;
+    }
+
     /**
      * \setter m_work_around_play_image
      */
@@ -35,9 +35,11 @@ CONFIG(debug, debug|release) {
 
 HEADERS += \
  include/app_limits.h \
+ include/autosaver.hpp \
  include/businfo.hpp \
  include/calculations.hpp \
  include/click.hpp \
+ include/clock_follower.hpp \
  include/cmdlineopts.hpp \
  include/configfile.hpp \
  include/controllers.hpp \
@@ -46,6 +48,8 @@ HEADERS += \
  include/editable_event.hpp \
  include/editable_events.hpp \
  include/event.hpp \
+ include/event_columns.hpp \
+ include/event_index.hpp \
  include/event_list.hpp \
  include/file_functions.hpp \
  include/gdk_basic_keys.h \
@@ -57,6 +61,7 @@ HEADERS += \
  include/lash.hpp \
  include/mastermidibase.hpp \
  include/mastermidibus.hpp \
+ include/midi_capture.hpp \
  include/midi_container.hpp \
  include/midi_control.hpp \
  include/midi_control_out.hpp \
@@ -69,18 +74,26 @@ HEADERS += \
  include/midibyte.hpp \
  include/midifile.hpp \
  include/mutex.hpp \
+ include/offline_render.hpp \
  include/optionsfile.hpp \
  include/palette.hpp \
+ include/perf_stats.hpp \
  include/perform.hpp \
  include/platform_macros.h \
+ include/play_events.hpp \
+ include/play_pool.hpp \
  include/playlist.hpp \
  include/rc_settings.hpp \
  include/recent.hpp \
  include/rect.hpp \
+ include/ring_buffer.hpp \
  include/scales.h \
  include/seq64_features.h \
  include/sequence.hpp \
  include/settings.hpp \
+ include/song_snapshot.hpp \
+ include/song_timeline.hpp \
+ include/thru_router.hpp \
  include/triggers.hpp \
  include/user_instrument.hpp \
  include/user_midi_bus.hpp \
@@ -89,9 +102,11 @@ HEADERS += \
  include/wrkfile.hpp
 
 SOURCES += \
+ src/autosaver.cpp \
  src/businfo.cpp \
  src/calculations.cpp \
  src/click.cpp \
+ src/clock_follower.cpp \
  src/cmdlineopts.cpp \
  src/configfile.cpp \
  src/controllers.cpp \
@@ -100,6 +115,8 @@ SOURCES += \
  src/editable_event.cpp \
  src/editable_events.cpp \
  src/event.cpp \
+ src/event_columns.cpp \
+ src/event_index.cpp \
  src/event_list.cpp \
  src/file_functions.cpp \
  src/gui_assistant.cpp \
@@ -108,6 +125,7 @@ SOURCES += \
  src/keystroke.cpp \
  src/lash.cpp \
  src/mastermidibase.cpp \
+ src/midi_capture.cpp \
  src/midi_container.cpp \
  src/midi_control.cpp \
  src/midi_control_out.cpp \
@@ -118,9 +136,13 @@ SOURCES += \
  src/midibyte.cpp \
  src/midifile.cpp \
  src/mutex.cpp \
+ src/offline_render.cpp \
  src/optionsfile.cpp \
  src/palette.cpp \
+ src/perf_stats.cpp \
  src/perform.cpp \
+ src/play_events.cpp \
+ src/play_pool.cpp \
  src/playlist.cpp \
  src/rc_settings.cpp \
  src/recent.cpp \
@@ -128,6 +150,9 @@ SOURCES += \
  src/seq64_features.cpp \
  src/sequence.cpp \
  src/settings.cpp \
+ src/song_snapshot.cpp \
+ src/song_timeline.cpp \
+ src/thru_router.cpp \
  src/triggers.cpp \
  src/user_instrument.cpp \
  src/user_midi_bus.cpp \
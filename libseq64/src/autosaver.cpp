@@ -0,0 +1,237 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          autosaver.cpp
+ *
+ *  This module defines the thread that saves the song in the background.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-28
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  The thread is the only user of its song_snapshot and midifile objects,
+ *  so the save itself needs no lock.  A periodic save is skipped if the
+ *  song is unmodified, or has not changed since the last autosave.
+ */
+
+#include "autosaver.hpp"                /* seq64::autosaver                 */
+#include "easy_macros.h"                /* errprint() macro                 */
+#include "midifile.hpp"                 /* seq64::midifile                  */
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "settings.hpp"                 /* seq64::rc() and usr()            */
+#include "song_snapshot.hpp"            /* seq64::song_snapshot             */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Starts the thread.
+ *
+ * \param p
+ *      The performance to save.
+ *
+ * \param minutes
+ *      The period of the autosave.  If 0, the song is saved only when
+ *      request() is called.
+ */
+
+autosaver::autosaver (perform & p, int minutes)
+ :
+    m_perform           (p),
+    m_filename          (rc().home_config_directory() + "autosave.midi"),
+    m_minutes           (minutes),
+    m_wake              (),
+    m_running           (true),
+    m_requested         (false),
+    m_request_name      (),
+    m_saved_count       (p.modify_count()),
+    m_thread            (),
+    m_launched          (false)
+{
+    int err = pthread_create(&m_thread, NULL, autosave_func, this);
+    if (err == 0)
+        m_launched = true;
+    else
+    {
+        m_running = false;
+        errprint("failed to launch autosave thread");
+    }
+}
+
+/**
+ *  Stops the thread, which first finishes a save that was requested.
+ */
+
+autosaver::~autosaver ()
+{
+    if (m_launched)
+    {
+        m_wake.lock();
+        m_running = false;
+        m_wake.signal();
+        m_wake.unlock();
+        pthread_join(m_thread, NULL);
+        m_launched = false;
+    }
+}
+
+/**
+ *  Asks the thread to save the song, and returns at once.  If a save is
+ *  already waiting, it is replaced by this one.
+ *
+ * \param filename
+ *      The file to save to.  If empty, the autosave file is written.
+ *      Otherwise, the modified flag of the song is falsified after the save,
+ *      as perform::is_modified_at() allows.
+ *
+ * \return
+ *      Returns false if the thread is not running.
+ */
+
+bool
+autosaver::request (const std::string & filename)
+{
+    bool result = m_launched;
+    if (result)
+    {
+        m_wake.lock();
+        m_requested = true;
+        m_request_name = filename;
+        m_wake.signal();
+        m_wake.unlock();
+    }
+    return result;
+}
+
+/**
+ *  The loop of the thread.  It sleeps until a save is requested, or the
+ *  autosave period runs out, and then saves without holding the lock.
+ *  When stopped, it makes a requested save before exiting.
+ */
+
+void
+autosaver::run ()
+{
+    for (;;)
+    {
+        bool timedout = false;
+        m_wake.lock();
+        if (m_running && ! m_requested)
+        {
+            if (m_minutes > 0)
+                timedout = ! m_wake.timed_wait(m_minutes * 60 * 1000);
+            else
+                m_wake.wait();
+        }
+
+        bool running = m_running;
+        bool requested = m_requested;
+        std::string name = m_request_name;
+        m_requested = false;
+        m_request_name.clear();
+        m_wake.unlock();
+        if (requested)
+        {
+            if (name.empty())
+                (void) save(m_filename, false);
+            else
+                (void) save(name, true);
+        }
+        else if (timedout && running)
+        {
+            bool changed = m_perform.modify_count() != m_saved_count;
+            if (m_perform.is_modified() && changed)
+                (void) save(m_filename, false);
+        }
+        if (! running)
+            break;
+    }
+}
+
+/**
+ *  Takes a snapshot of the song, and writes it to a MIDI file.
+ *
+ * \param filename
+ *      The file to write.
+ *
+ * \param clear_modified
+ *      If true, the file is the song itself, and the modified flag of the
+ *      song is falsified, unless the song changed after the snapshot.
+ *
+ * \return
+ *      Returns true if the file was written.
+ */
+
+bool
+autosaver::save (const std::string & filename, bool clear_modified)
+{
+    song_snapshot snap(m_perform);
+    midifile f
+    (
+        filename, snap.ppqn(), rc().legacy_format(),
+        usr().global_seq_feature()
+    );
+    bool result = f.write(snap);
+    if (result)
+    {
+        if (clear_modified)
+            m_perform.is_modified_at(snap.modify_count());
+        else
+            m_saved_count = snap.modify_count();
+    }
+    else
+    {
+        std::string msg = filename + ": " + f.error_message();
+        errprint(msg.c_str());
+    }
+    return result;
+}
+
+/**
+ *  The thread function of the autosave thread.
+ *
+ * \param as
+ *      The autosaver object.
+ *
+ * \return
+ *      Always returns the null pointer.
+ */
+
+void *
+autosaver::autosave_func (void * as)
+{
+    autosaver * self = (autosaver *) as;
+    self->run();
+    return nullptr;
+}
+
+}           // namespace seq64
+
+/*
+ * autosaver.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
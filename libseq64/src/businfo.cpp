@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-12-31
- * \updates       2018-05-31
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This file provides a base-class implementation for various master MIDI
@@ -475,6 +475,22 @@ busarray::sysex (event * ev)
         bi->sysex(ev);
 }
 
+/**
+ *  Sends out what the active busses are holding; used for output busses,
+ *  for APIs that batch their output (see midibase::api_flush()).
+ */
+
+void
+busarray::flush ()
+{
+    std::vector<businfo>::iterator bi;
+    for (bi = m_container.begin(); bi != m_container.end(); ++bi)
+    {
+        if (bi->active())
+            bi->flush();
+    }
+}
+
 /**
  *  Plays an event, if the bus is proper.
  *
@@ -498,6 +514,21 @@ busarray::play (bussbyte bus, event * e24, midibyte channel)
         m_container[bus].bus()->play(e24, channel);
 }
 
+/**
+ *  Plays an event on the given buss after a delay.  See
+ *  midibase::play_at().
+ */
+
+void
+busarray::play_at
+(
+    bussbyte bus, event * e24, midibyte channel, long delayus, int tag
+)
+{
+    if (bus < count() && m_container[bus].active())
+        m_container[bus].bus()->play_at(e24, channel, delayus, tag);
+}
+
 /**
  *  Sets the clock type for the given bus, usually the output buss.
  *  This code is a bit more restrictive than the original code in
@@ -541,6 +572,31 @@ busarray::set_clock (bussbyte bus, clock_e clocktype)
     return result;
 }
 
+/**
+ *  Sets the clock type for the given output buss before the busses are
+ *  initialized, when busarray::set_clock() cannot be used yet.  Like the
+ *  value given to add(), it decides whether initialize() opens the port.
+ *
+ * \param bus
+ *      The MIDI bus for which the clock is to be set.
+ *
+ * \param clocktype
+ *      Provides the type of clocking for the buss.
+ *
+ * \return
+ *      Returns true if the buss number is valid.
+ */
+
+bool
+busarray::preset_clock (bussbyte bus, clock_e clocktype)
+{
+    bool result = bus < count();
+    if (result)
+        m_container[bus].init_clock(clocktype);
+
+    return result;
+}
+
 /**
  *  Sets the clock type for all busses, usually the output buss.
  *  Note that the settings to apply are added when the add() call is made.
@@ -702,6 +758,38 @@ busarray::port_exit (int client, int port)
     }
 }
 
+/**
+ *  Finds the buss number of the given client and port.  Used by backends
+ *  that read all input events at the master level, to tell which input buss
+ *  an event came from.
+ *
+ * \param client
+ *      The client to be matched.  This value is actually an ALSA concept.
+ *
+ * \param port
+ *      The port to be matched.
+ *
+ * \return
+ *      Returns the index of the buss, or -1 if no buss matches.
+ */
+
+int
+busarray::port_index (int client, int port)
+{
+    int result = -1;
+    int counter = 0;
+    std::vector<businfo>::iterator bi;
+    for (bi = m_container.begin(); bi != m_container.end(); ++bi, ++counter)
+    {
+        if (bi->bus()->match(client, port))
+        {
+            result = counter;
+            break;
+        }
+    }
+    return result;
+}
+
 /**
  *  Set the status of the given input buss, if a legal buss number.  There's
  *  currently no implementation-specific API function called directly here.
@@ -744,6 +832,36 @@ busarray::set_input (bussbyte bus, bool inputing)
     return result;
 }
 
+/**
+ *  Sets the status of the given input buss before the busses are
+ *  initialized.  Unlike set_input(), it opens or closes the port even though
+ *  it is not active yet, to undo what add() did with the old setting.
+ *
+ * \param bus
+ *      Provides the buss number.
+ *
+ * \param inputing
+ *      True if the input bus will be inputting MIDI data.
+ *
+ * \return
+ *      Returns true if the buss number is valid.
+ */
+
+bool
+busarray::preset_input (bussbyte bus, bool inputing)
+{
+    bool result = bus < count();
+    if (result)
+    {
+        midibus * m = m_container[bus].bus();
+        if (not_nullptr(m) && m->get_input() != inputing)
+            (void) m->set_input(inputing);
+
+        m_container[bus].init_input(inputing);
+    }
+    return result;
+}
+
 /**
  *  Set the status of all input busses.  There's no implementation-specific
  *  API function here.  This function should be used only for the input
@@ -846,18 +964,27 @@ busarray::poll_for_midi ()
  * \param inev
  *      A pointer to the event to be modified by incoming data, if any.
  *
+ * \param [out] inbus
+ *      If not null, receives the index of the buss that provided the event.
+ *
  * \return
  *      Returns true if an event's data was copied into the event pointer.
  */
 
 bool
-busarray::get_midi_event (event * inev)
+busarray::get_midi_event (event * inev, int * inbus)
 {
+    int counter = 0;
     std::vector<businfo>::iterator bi;
-    for (bi = m_container.begin(); bi != m_container.end(); ++bi)
+    for (bi = m_container.begin(); bi != m_container.end(); ++bi, ++counter)
     {
         if (bi->bus()->get_midi_event(inev))
+        {
+            if (not_nullptr(inbus))
+                *inbus = counter;
+
             return true;
+        }
     }
     return false;
 }
@@ -0,0 +1,255 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          clock_follower.cpp
+ *
+ *  This module defines a class that recovers the tempo and phase of an
+ *  external MIDI clock.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-13
+ * \updates       2023-03-13
+ * \license       GNU GPLv2 or above
+ *
+ *  For each clock arriving at time t, with t1 the predicted time of the
+ *  clock, and T the estimated period, the loop does:
+ *
+\verbatim
+        e  = t - t1
+        t0 = t1
+        t1 = t1 + b * e + T
+        T  = T + c * e
+\endverbatim
+ *
+ *  where w = 2 pi B T (B being the bandwidth), b = sqrt(2) w, and c = w^2,
+ *  which makes the loop critically damped.
+ */
+
+#include <cmath>                        /* std::fabs(), std::sqrt()         */
+
+#include "clock_follower.hpp"           /* seq64::clock_follower            */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Two times pi, to avoid depending on M_PI.
+ */
+
+static const double s_two_pi = 6.283185307179586;
+
+/**
+ *  An arrival this many periods off the prediction is not jitter, but a
+ *  dropout or a jump in tempo, and restarts the loop from the arrival.
+ */
+
+static const double s_resync_periods = 4.0;
+
+/**
+ *  Constructs a follower that has not received any clock.
+ *
+ * \param bandwidth
+ *      The bandwidth of the loop, in Hz.
+ */
+
+clock_follower::clock_follower (double bandwidth)
+ :
+    m_mutex         (),
+    m_bandwidth     (bandwidth),
+    m_increment     (0),
+    m_pulses        (0),
+    m_t0            (0.0),
+    m_t1            (0.0),
+    m_period        (0.0),
+    m_reported      (0)
+{
+    // Empty body
+}
+
+/**
+ *  Starts following, at position 0.  Called on MIDI Start and Continue.
+ *
+ * \param increment
+ *      The number of ticks per MIDI Clock.
+ */
+
+void
+clock_follower::start (int increment)
+{
+    automutex locker(m_mutex);
+    m_increment = increment;
+    m_pulses = 0;
+    m_t0 = m_t1 = m_period = 0.0;
+    m_reported = 0;
+}
+
+/**
+ *  Runs the arrival of a MIDI Clock through the loop.
+ *
+ * \param ns
+ *      The arrival time of the clock, in nanoseconds, on the clock of
+ *      perf_stats::now_ns().
+ */
+
+void
+clock_follower::pulse (long long ns)
+{
+    automutex locker(m_mutex);
+    double t = double(ns);
+    if (m_pulses == 0)
+    {
+        m_t0 = m_t1 = t;
+    }
+    else if (m_pulses == 1)
+    {
+        m_period = t - m_t0;
+        resync(t);
+    }
+    else
+    {
+        double e = t - m_t1;
+        if (std::fabs(e) > s_resync_periods * m_period)
+            resync(t);
+        else
+        {
+            double w = s_two_pi * m_bandwidth * m_period * 1.0e-9;
+            m_t0 = m_t1;
+            m_t1 += std::sqrt(2.0) * w * e + m_period;
+            m_period += w * w * e;
+        }
+    }
+    ++m_pulses;
+}
+
+/**
+ *  Restarts the loop from an arrival time, keeping the period.  A period
+ *  that makes no sense disables the interpolation until the next clock.
+ *
+ * \param t
+ *      The arrival time, in nanoseconds.
+ */
+
+void
+clock_follower::resync (double t)
+{
+    if (m_period <= 0.0)
+        m_period = 0.0;
+
+    m_t0 = t;
+    m_t1 = t + m_period;
+}
+
+/**
+ *  Computes the position, in ticks since start(), with the lock held.  The
+ *  position of the latest clock is its count times the increment, as
+ *  before; between clocks, the position moves toward that of the next
+ *  clock, at the estimated tempo, but stops there.
+ *
+ * \param ns
+ *      The time at which the position is wanted, in nanoseconds.
+ */
+
+double
+clock_follower::interpolate (long long ns) const
+{
+    double result = double(m_pulses) * m_increment;
+    if (m_pulses >= 2 && m_period > 0.0)
+    {
+        double fraction = (double(ns) - m_t0) / m_period;
+        if (fraction > 1.0)
+            fraction = 1.0;
+        else if (fraction < 0.0)
+            fraction = 0.0;
+
+        result += fraction * m_increment;
+    }
+    return result;
+}
+
+/**
+ * \param ns
+ *      The time at which the position is wanted, in nanoseconds.
+ *
+ * \return
+ *      Returns the interpolated position, in ticks since start().
+ */
+
+double
+clock_follower::position (long long ns) const
+{
+    automutex locker(m_mutex);
+    return interpolate(ns);
+}
+
+/**
+ *  Gets the number of whole ticks the position has moved since the
+ *  previous call.  Used by perform::output_func() in place of the ticks
+ *  computed from its own tempo.
+ *
+ * \param ns
+ *      The current time, in nanoseconds.
+ *
+ * \return
+ *      Returns the number of ticks to advance.  Never negative.
+ */
+
+midipulse
+clock_follower::advance (long long ns)
+{
+    automutex locker(m_mutex);
+    midipulse result = 0;
+    midipulse pos = midipulse(interpolate(ns));
+    if (pos > m_reported)
+    {
+        result = pos - m_reported;
+        m_reported = pos;
+    }
+    return result;
+}
+
+/**
+ * \return
+ *      Returns the tempo of the external clock, in beats per minute, or 0
+ *      if it is not known yet.
+ */
+
+midibpm
+clock_follower::bpm () const
+{
+    automutex locker(m_mutex);
+    midibpm result = 0.0;
+    if (m_pulses >= 2 && m_period > 0.0)
+        result = 60.0e9 / (m_period * 24.0);    /* 24 clocks per beat   */
+
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * clock_follower.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-11-20
- * \updates       2020-09-08
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The "rc" command-line options override setting that are first read from
@@ -252,7 +252,7 @@ static const char * const s_help_1b =
 static const char * const s_help_2 =
 "   -k, --show-keys          Prints pressed key value.\n"
 "   -K, --inverse            Inverse (night) color scheme for seq/perf editors.\n"
-"   -S, --stats              Show global statistics.\n"
+"   -S, --stats              Show the latency and jitter statistics at stop.\n"
 #ifdef SEQ64_JACK_SUPPORT
 "   -j, --jack-transport     Synchronize to JACK transport.\n"
 "   -J, --jack-master        Try to be JACK Master. Also sets -j.\n"
@@ -319,12 +319,35 @@ static const char * const s_help_4 =
 "                            and C can range from 8 to 12. If not 4x8, seq64 is\n"
 "                            in 'variset' mode. Affects mute groups, too.\n"
 "\n"
+"              autosave=m    Every m minutes (1 to 120), save a modified song\n"
+"                            to 'autosave.midi' in the --home directory,\n"
+"                            without holding up playback.\n"
+"              lookahead=ms  Play the patterns up to ms milliseconds (0 to\n"
+"                            500) ahead, and let the ALSA queue send each\n"
+"                            event at its time.  With PortMidi, the output\n"
+"                            latency; events are stamped with their time.\n"
+"                            Other MIDI APIs ignore it.\n"
+"              play-threads=n\n"
+"                            Evaluate the patterns in each output cycle on n\n"
+"                            threads (1 to 64) instead of one.  This helps\n"
+"                            only with hundreds of busy patterns.\n"
 "              scale=x.y     Changes the size of the main window. Can range from\n"
 "                            0.5 to 3.0.\n"
+"              song-timeline Compile the song (all triggers) into a timeline\n"
+"                            before Song-mode playback, instead of scanning\n"
+"                            every pattern in every output cycle.\n"
+"              trace=file    Keep a timeline trace of the latency and jitter\n"
+"                            statistics, and write it to the given CSV file\n"
+"                            at exit.\n"
 "\n"
 " seq64cli:\n"
 "              daemonize     Makes this application fork to the background.\n"
 "              no-daemonize  Or not.  These options do not apply to Windows.\n"
+"              render=file   Plays the song in Song mode faster than real\n"
+"                            time, writes the output, one track per buss, to\n"
+"                            the given MIDI file, and exits.\n"
+"              stats=file    Rewrites the latency and jitter statistics to\n"
+"                            the given file every second while running.\n"
 "\n"
 "The 'daemonize' option works only in the CLI build. The 'sets' option works in\n"
 "the CLI build as well.  Specify the '--user-save' option to make these options\n"
@@ -516,6 +539,11 @@ parse_o_options (int argc, char * argv [])
                                 result = true;
                                 usr().option_use_logfile(true);
                             }
+                            else if (arg == "song-timeline")
+                            {
+                                result = true;
+                                usr().option_song_timeline(true);
+                            }
                         }
                         else
                         {
@@ -574,6 +602,57 @@ parse_o_options (int argc, char * argv [])
                                     }
                                 }
                             }
+                            else if (optionname == "render")
+                            {
+                                if (! arg.empty())
+                                {
+                                    usr().option_render_file(arg);
+                                    result = true;
+                                }
+                            }
+                            else if (optionname == "stats")
+                            {
+                                if (! arg.empty())
+                                {
+                                    usr().option_stats_file(arg);
+                                    result = true;
+                                }
+                            }
+                            else if (optionname == "trace")
+                            {
+                                if (! arg.empty())
+                                {
+                                    usr().option_trace_file(arg);
+                                    result = true;
+                                }
+                            }
+                            else if (optionname == "autosave")
+                            {
+                                int minutes = atoi(arg.c_str());
+                                if (minutes >= 0)
+                                {
+                                    usr().option_autosave_minutes(minutes);
+                                    result = true;
+                                }
+                            }
+                            else if (optionname == "lookahead")
+                            {
+                                int ms = atoi(arg.c_str());
+                                if (ms >= 0)
+                                {
+                                    usr().option_lookahead_ms(ms);
+                                    result = true;
+                                }
+                            }
+                            else if (optionname == "play-threads")
+                            {
+                                int count = atoi(arg.c_str());
+                                if (count > 0)
+                                {
+                                    usr().option_play_threads(count);
+                                    result = true;
+                                }
+                            }
                             else if (optionname == "scale")
                             {
                                 if (arg.length() >= 1)
@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-16
+ * \updates       2023-03-18
  * \license       GNU GPLv2 or above
  *
  *  A MIDI editable event is encapsulated by the seq64::editable_event
@@ -381,7 +381,8 @@ editable_event::editable_event (const editable_events & parent)
     m_name_meta         (),
     m_name_seqspec      (),
     m_name_channel      (),
-    m_name_data         ()
+    m_name_data         (),
+    m_analyzed          (false)
 {
     // Empty body
 }
@@ -407,9 +408,10 @@ editable_event::editable_event
     m_name_meta         (),
     m_name_seqspec      (),
     m_name_channel      (),
-    m_name_data         ()
+    m_name_data         (),
+    m_analyzed          (false)
 {
-    // analyze();               // DO IT NOW OR LATER?
+    // Empty body; analyzed when first shown, see check_analysis()
 }
 
 /**
@@ -440,7 +442,8 @@ editable_event::editable_event (const editable_event & rhs)
     m_name_meta         (rhs.m_name_meta),
     m_name_seqspec      (rhs.m_name_seqspec),
     m_name_channel      (rhs.m_name_channel),
-    m_name_data         (rhs.m_name_data)
+    m_name_data         (rhs.m_name_data),
+    m_analyzed          (rhs.m_analyzed)
 {
     // Empty body
 }
@@ -472,6 +475,7 @@ editable_event::operator = (const editable_event & rhs)
         m_name_seqspec      = rhs.m_name_seqspec;
         m_name_channel      = rhs.m_name_channel;
         m_name_data         = rhs.m_name_data;
+        m_analyzed          = rhs.m_analyzed;
     }
     return *this;
 }
@@ -772,7 +776,7 @@ void
 editable_event::set_channel (midibyte channel)
 {
     event::set_channel(channel);
-    analyze();                          /* (too much extra work, optimize!! */
+    m_analyzed = false;                 /* strings redone when next needed  */
 }
 
 /**
@@ -861,6 +865,7 @@ editable_event::analyze ()
 {
     midibyte status = get_status();
     char tmp[32];
+    m_analyzed = true;
     (void) format_timestamp();
     if (status >= EVENT_NOTE_OFF && status <= EVENT_PITCH_WHEEL)
     {
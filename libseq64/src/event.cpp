@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2021-05-06
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  A MIDI event (i.e. "track event") is encapsulated by the seq64::event
@@ -98,12 +98,12 @@ event::event ()
     m_status        (EVENT_NOTE_OFF),
     m_channel       (EVENT_NULL_CHANNEL),
     m_data          (),                     /* a two-element array  */
-    m_sysex         (),                     /* an std::vector       */
-    m_linked        (nullptr),
     m_has_link      (false),
     m_selected      (false),
     m_marked        (false),
-    m_painted       (false)
+    m_painted       (false),
+    m_linked        (nullptr),
+    m_sysex         ()                      /* allocated on demand  */
 {
     m_data[0] = m_data[1] = 0;
 }
@@ -136,21 +136,23 @@ event::event (const event & rhs)
     m_status        (rhs.m_status),
     m_channel       (rhs.m_channel),
     m_data          (),                     /* a two-element array      */
-    m_sysex         (rhs.m_sysex),          /* copies a vector of data  */
-    m_linked        (nullptr),              /* pointer, not yet handled */
     m_has_link      (false),                /* must indicate that fact  */
     m_selected      (rhs.m_selected),
     m_marked        (rhs.m_marked),
-    m_painted       (rhs.m_painted)
+    m_painted       (rhs.m_painted),
+    m_linked        (nullptr),              /* pointer, not yet handled */
+    m_sysex         ()                      /* copied below             */
 {
     m_data[0] = rhs.m_data[0];
     m_data[1] = rhs.m_data[1];
+    if (rhs.get_sysex_size() > 0)
+        m_sysex.reset(new SysexContainer(*rhs.m_sysex));
 }
 
 /**
  *  This destructor explicitly deletes m_sysex and sets it to null.
  *  The restart_sysex() function does what we need.  But now that m_sysex is a
- *  vector, no action is needed.
+ *  smart pointer, no action is needed.
  */
 
 event::~event ()
@@ -188,12 +190,15 @@ event::operator = (const event & rhs)
         m_channel       = rhs.m_channel;
         m_data[0]       = rhs.m_data[0];
         m_data[1]       = rhs.m_data[1];
-        m_sysex         = rhs.m_sysex;
-        m_linked        = nullptr;
         m_has_link      = false;                    /* rhs.m_has_link       */
         m_selected      = rhs.m_selected;           /* false instead?       */
         m_marked        = rhs.m_marked;             /* false instead?       */
         m_painted       = rhs.m_painted;            /* false instead?       */
+        m_linked        = nullptr;
+        if (rhs.get_sysex_size() > 0)
+            sysex() = *rhs.m_sysex;                 /* reuses our buffer    */
+        else
+            restart_sysex();
     }
     return *this;
 }
@@ -452,14 +457,45 @@ event::set_meta_status (midibyte metatype)
 }
 
 /**
- *  Deletes and clears out the SYSEX buffer.  (The m_sysex member used to be a
- *  pointer.)
+ *  Deletes and clears out the SYSEX buffer.  (The m_sysex member is a pointer
+ *  again, so that events without SysEx or Meta data carry no buffer.)
  */
 
 void
 event::restart_sysex ()
 {
-    m_sysex.clear();
+    m_sysex.reset();
+}
+
+/**
+ *  Gets the SYSEX buffer, allocating it if the event has none yet.
+ *
+ * \return
+ *      Returns a reference to the buffer.
+ */
+
+event::SysexContainer &
+event::sysex ()
+{
+    if (! m_sysex)
+        m_sysex.reset(new SysexContainer());
+
+    return *m_sysex;
+}
+
+/**
+ *  Gets the SYSEX buffer for reading.
+ *
+ * \return
+ *      Returns a reference to the buffer, or to an empty buffer if the event
+ *      has none.
+ */
+
+const event::SysexContainer &
+event::get_sysex () const
+{
+    static const SysexContainer s_empty;
+    return m_sysex ? *m_sysex : s_empty ;
 }
 
 /**
@@ -492,7 +528,7 @@ event::append_sysex (const midibyte * data, int dsize)
         result = true;
         for (int i = 0; i < dsize; ++i)
         {
-            m_sysex.push_back(data[i]);
+            sysex().push_back(data[i]);
             if (data[i] == EVENT_MIDI_SYSEX_END)
             {
                 result = false;
@@ -546,7 +582,7 @@ event::append_meta_data (midibyte metatype, const midibyte * data, int dsize)
     {
         set_meta_status(metatype);
         for (int i = 0; i < dsize; ++i)
-            m_sysex.push_back(data[i]);
+            sysex().push_back(data[i]);
     }
     else
     {
@@ -579,7 +615,7 @@ event::append_meta_data (midibyte metatype, const std::vector<midibyte> & data)
     {
         set_meta_status(metatype);
         for (int i = 0; i < dsize; ++i)
-             m_sysex.push_back(data[i]);
+             sysex().push_back(data[i]);
     }
     else
     {
@@ -599,7 +635,7 @@ event::append_meta_data (midibyte metatype, const std::vector<midibyte> & data)
 bool
 event::append_sysex (midibyte data)
 {
-    m_sysex.push_back(data);
+    sysex().push_back(data);
     return data != EVENT_MIDI_SYSEX_END;
 }
 
@@ -626,7 +662,7 @@ event::print () const
             if (use_linefeeds && (i % 16) == 0)
                 printf("\n         ");
 
-            printf("%02X ", m_sysex[i]);
+            printf("%02X ", (*m_sysex)[i]);
         }
         printf("\n");
     }
@@ -676,13 +712,34 @@ event::print_note (bool is_a_link) const
 int
 event::get_rank () const
 {
-    switch (m_status)
+    return rank(m_status, m_data[0]);
+}
+
+/**
+ *  The ranking of get_rank(), from the status and note alone, so that it can
+ *  be applied to events held elsewhere than in an event object (see the
+ *  event_columns class).
+ *
+ * \param status
+ *      The status byte, without the channel.
+ *
+ * \param note
+ *      The first data byte, the note of note events.
+ *
+ * \return
+ *      Returns the rank of the status byte.
+ */
+
+int
+event::rank (midibyte status, midibyte note)
+{
+    switch (status)
     {
     case EVENT_NOTE_OFF:
-        return 0x200 + get_note();
+        return 0x200 + note;
 
     case EVENT_NOTE_ON:
-        return 0x100 + get_note();
+        return 0x100 + note;
 
     case EVENT_AFTERTOUCH:
     case EVENT_CHANNEL_PRESSURE:
@@ -718,9 +775,9 @@ event::tempo () const
     if (is_tempo() && get_sysex_size() == 3)
     {
         midibyte b[3];
-        b[0] = m_sysex[0];                  /* convert vector to array type */
-        b[1] = m_sysex[1];
-        b[2] = m_sysex[2];
+        b[0] = (*m_sysex)[0];               /* convert vector to array type */
+        b[1] = (*m_sysex)[1];
+        b[2] = (*m_sysex)[2];
         result = bpm_from_bytes(b);
     }
     return result;
@@ -0,0 +1,617 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_columns.cpp
+ *
+ *  This module defines the column-wise copy of the events of a sequence,
+ *  and the batch edits done on it.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-24
+ * \updates       2023-03-24
+ * \license       GNU GPLv2 or above
+ *
+ *  Each edit is a transcription of the loop it replaces in the sequence
+ *  module, down to the integer and floating-point types of its arithmetic,
+ *  so that the results are the same.  The loops that only compute are kept
+ *  free of calls and early exits where the original allows it.
+ */
+
+#include <algorithm>                    /* std::sort(), std::equal_range()  */
+
+#include "app_limits.h"                 /* SEQ64_MIDI_COUNT_MAX             */
+#include "event_columns.hpp"            /* seq64::event_columns             */
+#include "scales.h"                     /* SEQ64_OCTAVE_SIZE                */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The sort key of an event to be put in place by apply().  Unmoved events
+ *  have an order of -1.
+ */
+
+struct event_place
+{
+    midipulse ep_timestamp;
+    int ep_rank;
+    int ep_order;
+    event_list::iterator ep_node;
+};
+
+/**
+ *  Orders moved events by time, rank, and the order in which they were
+ *  moved.
+ */
+
+static bool
+place_less (const event_place & a, const event_place & b)
+{
+    if (a.ep_timestamp != b.ep_timestamp)
+        return a.ep_timestamp < b.ep_timestamp;
+
+    if (a.ep_rank != b.ep_rank)
+        return a.ep_rank < b.ep_rank;
+
+    return a.ep_order < b.ep_order;
+}
+
+/**
+ *  Orders events by time and rank only, as event::operator < () does.
+ */
+
+static bool
+key_less (const event_place & a, const event_place & b)
+{
+    if (a.ep_timestamp != b.ep_timestamp)
+        return a.ep_timestamp < b.ep_timestamp;
+
+    return a.ep_rank < b.ep_rank;
+}
+
+/**
+ *  Constructs an empty set of columns.
+ */
+
+event_columns::event_columns ()
+ :
+    m_nodes             (),
+    m_timestamps        (),
+    m_status            (),
+    m_d0                (),
+    m_d1                (),
+    m_flags             (),
+    m_new_timestamps    (),
+    m_new_d0            (),
+    m_new_d1            (),
+    m_order             (),
+    m_copies            (),
+    m_moves             (0)
+{
+    // Empty body
+}
+
+/**
+ *  Gathers the events of a list into the columns, in one pass.  The output
+ *  columns are sized only when an edit needs them.  The columns keep their
+ *  capacity, so that repeated edits of a pattern, such as transposing with
+ *  the arrow keys, do not reallocate them.
+ *
+ * \param evl
+ *      The events of the sequence.  The caller holds the sequence mutex
+ *      until apply() is done.
+ */
+
+void
+event_columns::gather (event_list & evl)
+{
+    std::size_t n = std::size_t(evl.count());
+    m_nodes.resize(n);
+    m_timestamps.resize(n);
+    m_status.resize(n);
+    m_d0.resize(n);
+    m_d1.resize(n);
+    m_flags.resize(n);
+    m_copies.clear();
+    m_moves = 0;
+
+    std::size_t r = 0;
+    for (event_list::iterator i = evl.begin(); i != evl.end(); ++i, ++r)
+    {
+        const event & e = event_list::dref(i);
+        unsigned flags = 0;
+        m_nodes[r] = i;
+        m_timestamps[r] = e.get_timestamp();
+        m_status[r] = e.get_status();
+        m_d0[r] = e.data(0);
+        m_d1[r] = e.data(1);
+        if (e.is_selected())
+            flags |= ec_selected;
+
+        if (e.is_marked())
+            flags |= ec_marked;
+
+        if (e.is_linked())
+            flags |= ec_linked;
+
+        m_flags[r] = flags;
+    }
+}
+
+/**
+ *  Sizes the output columns, for an edit that writes them.  Their contents
+ *  are set by change().
+ */
+
+void
+event_columns::prepare ()
+{
+    std::size_t n = m_nodes.size();
+    m_new_timestamps.resize(n);
+    m_new_d0.resize(n);
+    m_new_d1.resize(n);
+    m_order.resize(n);
+}
+
+/**
+ *  Flags an event as changed, setting its output columns to its gathered
+ *  values the first time.
+ *
+ * \param r
+ *      The row of the event.
+ */
+
+void
+event_columns::change (std::size_t r)
+{
+    if ((m_flags[r] & ec_changed) == 0)
+    {
+        m_new_timestamps[r] = m_timestamps[r];
+        m_new_d0[r] = m_d0[r];
+        m_new_d1[r] = m_d1[r];
+        m_flags[r] |= ec_changed;
+    }
+}
+
+/**
+ *  Writes the results of the edits back to the event_list.  Copies are
+ *  added first, from the events as gathered; then selections, new times,
+ *  and new data are written; then the events to be removed are removed.
+ *  If any event moved or was copied, the list is put in order once: the
+ *  unmoved events keep their order, and each moved event goes after the
+ *  unmoved events of the same time and rank.  The caller must then relink
+ *  the events (see sequence::verify_and_link()).
+ *
+ * \param evl
+ *      The list the columns were gathered from, unchanged since.
+ *
+ * \return
+ *      Returns true if any event was changed, added, or removed.
+ */
+
+bool
+event_columns::apply (event_list & evl)
+{
+    bool result = ! m_copies.empty();
+    bool reorder = result;
+    std::vector<event_place> moved;
+    moved.reserve(std::size_t(m_moves));
+    for (std::size_t c = 0; c < m_copies.size(); ++c)
+    {
+        const copy & cp = m_copies[c];
+        event e = at(cp.c_row);
+        e.unmark();
+        e.set_timestamp(cp.c_timestamp);
+        (void) evl.append(e);
+#ifndef SEQ64_USE_EVENT_MAP
+        std::size_t r = std::size_t(cp.c_row);
+        event_place ep;
+        ep.ep_timestamp = cp.c_timestamp;
+        ep.ep_rank = event::rank(m_status[r], m_d0[r]);
+        ep.ep_order = cp.c_order;
+        ep.ep_node = evl.end();
+        --ep.ep_node;
+        moved.push_back(ep);
+#endif
+    }
+
+    std::size_t n = m_nodes.size();
+    for (std::size_t r = 0; r < n; ++r)
+    {
+        unsigned flags = m_flags[r];
+        if ((flags & (ec_changed | ec_select | ec_unmark | ec_moved)) == 0)
+            continue;
+
+        event & e = at(int(r));
+        result = true;
+        if ((flags & ec_select) != 0)
+            e.select();
+
+        if ((flags & (ec_moved | ec_unmark)) != 0)
+            e.unmark();
+
+        if ((flags & ec_changed) != 0)
+        {
+            if (m_new_timestamps[r] != m_timestamps[r])
+                e.set_timestamp(m_new_timestamps[r]);
+
+            if (m_new_d0[r] != m_d0[r] || m_new_d1[r] != m_d1[r])
+                e.set_data(m_new_d0[r], m_new_d1[r]);
+        }
+        if ((flags & ec_moved) != 0)
+        {
+            event_place ep;
+            ep.ep_timestamp = m_new_timestamps[r];
+            ep.ep_rank = event::rank(m_status[r], m_new_d0[r]);
+            ep.ep_order = m_order[r];
+            ep.ep_node = m_nodes[r];
+            moved.push_back(ep);
+            reorder = true;
+        }
+    }
+    if (reorder)
+    {
+        std::vector<event_place> kept;
+        kept.reserve(n);
+        for (std::size_t r = 0; r < n; ++r)
+        {
+            if ((m_flags[r] & (ec_moved | ec_erase)) == 0)
+            {
+                event_place ep;
+                ep.ep_timestamp = m_timestamps[r];
+                ep.ep_rank = event::rank(m_status[r], m_d0[r]);
+                ep.ep_order = -1;
+                ep.ep_node = m_nodes[r];
+                kept.push_back(ep);
+            }
+        }
+        if (! std::is_sorted(kept.begin(), kept.end(), key_less))
+            std::stable_sort(kept.begin(), kept.end(), key_less);
+
+        std::sort(moved.begin(), moved.end(), place_less);
+
+        /*
+         * Merge, taking the unmoved event first when the keys are equal.
+         */
+
+        Nodes order;
+        order.reserve(kept.size() + moved.size());
+        std::size_t k = 0;
+        std::size_t m = 0;
+        while (k < kept.size() || m < moved.size())
+        {
+            bool takekept = m == moved.size() ||
+                (k < kept.size() && ! key_less(moved[m], kept[k]));
+
+            if (takekept)
+                order.push_back(kept[k++].ep_node);
+            else
+                order.push_back(moved[m++].ep_node);
+        }
+        for (std::size_t r = 0; r < n; ++r)
+        {
+            if ((m_flags[r] & ec_erase) != 0)
+                evl.remove(m_nodes[r]);
+        }
+        evl.arrange(order);
+    }
+    else
+    {
+        for (std::size_t r = 0; r < n; ++r)
+        {
+            if ((m_flags[r] & ec_erase) != 0)
+            {
+                evl.remove(m_nodes[r]);
+                result = true;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Moves an edited event to a new time, or, if the event has already been
+ *  moved, or is not being edited, and so is kept as is, queues a copy of it
+ *  at the new time.
+ *
+ * \param row
+ *      The event to move or copy.
+ *
+ * \param timestamp
+ *      The new time.
+ */
+
+void
+event_columns::move (int row, midipulse timestamp)
+{
+    std::size_t r = std::size_t(row);
+    if (edited(r) && (m_flags[r] & ec_moved) == 0)
+    {
+        change(r);
+        m_new_timestamps[r] = timestamp;
+        m_flags[r] |= ec_moved;
+        m_order[r] = m_moves++;
+    }
+    else
+    {
+        copy cp;
+        cp.c_row = row;
+        cp.c_timestamp = timestamp;
+        cp.c_order = m_moves++;
+        m_copies.push_back(cp);
+    }
+}
+
+/**
+ *  Finds the row of the event linked to an event.  The events of equal time
+ *  are found by a binary search, the list being in time order; if it is not,
+ *  all rows are searched.
+ *
+ * \param row
+ *      The linked event.
+ *
+ * \return
+ *      Returns the row of its linked event, or -1 if not found.
+ */
+
+int
+event_columns::link_row (int row) const
+{
+    const event * target =
+        event_list::dref(m_nodes[std::size_t(row)]).get_linked();
+
+    midipulse t = target->get_timestamp();
+    std::pair
+    <
+        std::vector<midipulse>::const_iterator,
+        std::vector<midipulse>::const_iterator
+    > range = std::equal_range(m_timestamps.begin(), m_timestamps.end(), t);
+    std::size_t first = std::size_t(range.first - m_timestamps.begin());
+    std::size_t last = std::size_t(range.second - m_timestamps.begin());
+    for (std::size_t r = first; r < last; ++r)
+    {
+        if (&event_list::dref(m_nodes[r]) == target)
+            return int(r);
+    }
+    for (std::size_t r = 0; r < m_nodes.size(); ++r)
+    {
+        if (&event_list::dref(m_nodes[r]) == target)
+            return int(r);
+    }
+    return -1;
+}
+
+/**
+ *  Quantizes the marked events of the given kind, as
+ *  sequence::quantize_events() does.  Each such event is moved to its
+ *  quantized time; if linked is true, its linked event is moved by the
+ *  same amount, wrapped into the pattern.  Marked events not quantized are
+ *  removed.
+ *
+ * \param status
+ *      The kind of event to quantize.
+ *
+ * \param cc
+ *      The controller number, if the status is Control Change.
+ *
+ * \param snap_tick
+ *      The snap, in ticks.
+ *
+ * \param divide
+ *      The division of the move, 1 to quantize, 2 to tighten.  Not 0.
+ *
+ * \param linked
+ *      If true, move the linked events too.
+ *
+ * \param length
+ *      The length of the pattern.
+ *
+ * \param margin
+ *      The note-off margin of the pattern.
+ */
+
+void
+event_columns::quantize
+(
+    midibyte status, midibyte cc, midipulse snap_tick, int divide,
+    bool linked, midipulse length, midipulse margin
+)
+{
+    std::size_t n = m_nodes.size();
+    bool iscc = status == EVENT_CONTROL_CHANGE;
+    std::vector<midipulse> deltas(n);
+    prepare();
+    std::vector<midibyte> hits(n);
+    for (std::size_t r = 0; r < n; ++r)
+    {
+        midipulse t = m_timestamps[r];
+        midipulse t_remainder = 0;
+        midipulse t_delta;
+        if (snap_tick > 0)                              /* issue #190       */
+            t_remainder = t % snap_tick;
+
+        if (t_remainder < snap_tick / 2)
+            t_delta = -(t_remainder / divide);
+        else
+            t_delta = (snap_tick - t_remainder) / divide;
+
+        if ((t_delta + t) >= length)                    /* wrap-around      */
+            t_delta = -t;
+
+        deltas[r] = t_delta;
+        hits[r] = edited(r) && m_status[r] == status &&
+            (! iscc || m_d0[r] == cc);
+    }
+    for (std::size_t r = 0; r < n; ++r)
+    {
+        if (! hits[r])
+            continue;
+
+        midipulse t_delta = deltas[r];
+        move(int(r), m_timestamps[r] + t_delta);
+        if (linked && (m_flags[r] & ec_linked) != 0)
+        {
+            int link = link_row(int(r));
+            if (link >= 0)
+            {
+                std::size_t lr = std::size_t(link);
+                midipulse ft = m_timestamps[lr] + t_delta;
+                if (ft < 0)                             /* unwrap Note Off  */
+                    ft += length;
+
+                if (ft == length)                       /* trim it a little */
+                    ft -= margin;
+
+                if (ft > length)                        /* wrap it around   */
+                    ft -= length;
+
+                move(link, ft);
+                if (! edited(lr))
+                    m_flags[lr] |= ec_select;           /* the original     */
+            }
+        }
+    }
+    for (std::size_t r = 0; r < n; ++r)
+    {
+        if (edited(r) && (m_flags[r] & ec_moved) == 0)
+            m_flags[r] |= ec_erase;
+    }
+}
+
+/**
+ *  Transposes the marked notes, as sequence::transpose_notes() does, by
+ *  way of a table of the result for each note.  Marked events that are not
+ *  notes are unmarked.
+ *
+ * \param table
+ *      The up or down transposition table of the scale.
+ *
+ * \param steps
+ *      The number of steps, not negative.
+ */
+
+void
+event_columns::transpose (const int * table, int steps)
+{
+    midibyte result[SEQ64_MIDI_COUNT_MAX];
+    for (int n = 0; n < SEQ64_MIDI_COUNT_MAX; ++n)
+    {
+        int note = n;
+        bool off_scale = false;
+        if (table[note % SEQ64_OCTAVE_SIZE] == 0)
+        {
+            off_scale = true;
+            note -= 1;
+        }
+        for (int x = 0; x < steps; ++x)
+            note += table[note % SEQ64_OCTAVE_SIZE];
+
+        if (off_scale)
+            note += 1;
+
+        result[n] = midibyte(note) & 0x7F;          /* as event::set_note() */
+    }
+
+    std::size_t n = m_nodes.size();
+    prepare();
+    for (std::size_t r = 0; r < n; ++r)
+    {
+        if (edited(r))
+        {
+            if (event::is_note_msg(m_status[r]))
+            {
+                change(r);
+                m_new_d0[r] = result[m_d0[r] & 0x7F];
+                m_flags[r] |= ec_moved;
+                m_order[r] = m_moves++;
+            }
+            else
+                m_flags[r] |= ec_unmark;
+        }
+    }
+}
+
+/**
+ *  Stretches the marked events, as sequence::stretch_selected() does,
+ *  about the earliest selected event.
+ *
+ * \param delta_tick
+ *      The change in the span of the selected events.
+ *
+ * \return
+ *      Returns false if the new span would be too short, in which case
+ *      nothing is moved.
+ */
+
+bool
+event_columns::stretch (midipulse delta_tick)
+{
+    unsigned first_ev = 0x7fffffff;                 /* lower limit          */
+    unsigned last_ev = 0x00000000;                  /* upper limit          */
+    std::size_t n = m_nodes.size();
+    for (std::size_t r = 0; r < n; ++r)
+    {
+        if ((m_flags[r] & ec_selected) != 0)
+        {
+            midipulse t = m_timestamps[r];
+            if (t < midipulse(first_ev))
+                first_ev = unsigned(t);
+
+            if (t > midipulse(last_ev))
+                last_ev = unsigned(t);
+        }
+    }
+
+    unsigned old_len = last_ev - first_ev;
+    unsigned new_len = old_len + delta_tick;
+    bool result = new_len > 1;
+    if (result)
+    {
+        float ratio = float(new_len) / float(old_len);
+        prepare();
+        for (std::size_t r = 0; r < n; ++r)
+        {
+            if (edited(r))
+            {
+                midipulse t = m_timestamps[r];
+                change(r);
+                m_new_timestamps[r] =
+                    midipulse(ratio * (t - first_ev)) + first_ev;
+
+                m_flags[r] |= ec_moved;
+                m_order[r] = m_moves++;
+            }
+        }
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * event_columns.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
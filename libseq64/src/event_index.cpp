@@ -0,0 +1,503 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_index.cpp
+ *
+ *  This module defines the time-by-note index of the events of a sequence.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-25
+ * \updates       2023-03-26
+ * \license       GNU GPLv2 or above
+ *
+ *  The spans are gathered in the order of the list, then spread out by note
+ *  with a counting sort, which keeps them in the order of the list, and so
+ *  sorted by start: a pair is gathered at its Note On, and an unlinked event
+ *  starts at its own timestamp.  The spans of a note are sorted again only
+ *  if the list was not in order.  The tree is then built over the sorted
+ *  spans of each note, in linear time.
+ */
+
+#include <algorithm>                    /* std::sort(), std::lower_bound()  */
+#include <limits>                       /* std::numeric_limits<>            */
+
+#include "easy_macros.h"                /* not_nullptr()                    */
+#include "event_index.hpp"              /* seq64::event_index               */
+#include "event_list.hpp"               /* seq64::event_list, event         */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Orders spans by start, for the note arrays, which must then be sorted
+ *  stably to keep the order of the list.
+ */
+
+static bool
+start_less (const event_span & a, const event_span & b)
+{
+    return a.es_start < b.es_start;
+}
+
+/**
+ *  Orders hits by their position in the list.
+ */
+
+static bool
+order_less (const event_span * a, const event_span * b)
+{
+    return a->es_order < b->es_order;
+}
+
+/**
+ *  Constructs an empty index, which is not current for any generation.
+ */
+
+event_index::event_index ()
+ :
+    m_spans             (),
+    m_max_finish        (),
+    m_note_first        (c_note_count + 1, 0),
+    m_loose             (),
+    m_stamps            (),
+    m_status_first      (c_status_count + 1, 0),
+    m_gathered          (),
+    m_gathered_status   (),
+    m_gathered_stamps   (),
+    m_generation        (0),
+    m_serial            (0),
+    m_built             (false)
+{
+    // Empty body
+}
+
+/**
+ *  Rebuilds the index from an event_list.
+ *
+ *  A Note Off is left out if its Note On is linked back to it, has the
+ *  same note, and is not later; the span of the Note On stands for both.
+ *  A note that wraps around, or a link that is not mutual, or a linked
+ *  event that is not a note, makes a loose span.
+ *
+ * \param evl
+ *      The events of the sequence.  The caller holds the sequence mutex.
+ *      The spans point into its container, which is made its own, and
+ *      through which only the selection of the events is changed, so
+ *      that a verify_and_link() is not needed afterward.
+ *
+ * \param generation
+ *      The current generation of the sequence.
+ */
+
+void
+event_index::build (event_list & evl, unsigned generation)
+{
+    m_gathered.clear();
+    m_gathered_status.clear();
+    m_gathered_stamps.clear();
+    m_loose.clear();
+    m_note_first.assign(c_note_count + 1, 0);
+    m_status_first.assign(c_status_count + 1, 0);
+
+    int order = 0;
+    event_list::Events & evs = evl.owned(true);     /* selection only   */
+    for (event_list::iterator i = evs.begin(); i != evs.end(); ++i, ++order)
+    {
+        event & er = DREF(i);
+        midipulse ts = er.get_timestamp();
+        midibyte status = er.get_status();
+        m_gathered_status.push_back(status);
+        m_gathered_stamps.push_back(ts);
+        ++m_status_first[status + 1];
+
+        event_span es;
+        es.es_event = &er;
+        es.es_order = order;
+        es.es_note = er.get_note();
+        es.es_pair = false;
+        bool loose = false;
+        if (er.is_linked())
+        {
+            event * ev = er.get_linked();
+            es.es_start = es.es_finish = 0;
+            if (er.is_note_off())
+            {
+                es.es_start = ev->get_timestamp();
+                es.es_finish = ts;
+            }
+            else if (er.is_note_on())
+            {
+                es.es_start = ts;
+                es.es_finish = ev->get_timestamp();
+            }
+
+            bool mutual = ev->get_linked() == &er &&
+                ev->get_note() == er.get_note();
+
+            if (! mutual || es.es_start > es.es_finish)
+                loose = true;
+            else if (er.is_note_off() && ev->is_note_on())
+                continue;                       /* the Note On stands for it */
+            else if (er.is_note_on() && ev->is_note_off())
+                es.es_pair = true;
+            else
+                loose = true;
+        }
+        else
+        {
+            es.es_start = ts;
+            es.es_finish = ts + slack();
+        }
+        if (loose)
+        {
+            m_loose.push_back(es);
+        }
+        else
+        {
+            m_gathered.push_back(es);
+            ++m_note_first[es.es_note + 1];
+        }
+    }
+
+    int fill[c_note_count];
+    for (int n = 0; n < c_note_count; ++n)
+    {
+        m_note_first[n + 1] += m_note_first[n];
+        fill[n] = m_note_first[n];
+    }
+    m_spans.resize(m_gathered.size());
+    m_max_finish.resize(m_gathered.size());
+    for (std::size_t g = 0; g < m_gathered.size(); ++g)
+        m_spans[std::size_t(fill[m_gathered[g].es_note]++)] = m_gathered[g];
+
+    for (int n = 0; n < c_note_count; ++n)
+    {
+        std::vector<event_span>::iterator lo =
+            m_spans.begin() + m_note_first[n];
+
+        std::vector<event_span>::iterator hi =
+            m_spans.begin() + m_note_first[n + 1];
+
+        if (! std::is_sorted(lo, hi, start_less))
+            std::stable_sort(lo, hi, start_less);
+
+        (void) build_tree(m_note_first[n], m_note_first[n + 1]);
+    }
+
+    int sfill[c_status_count];
+    for (int s = 0; s < c_status_count; ++s)
+    {
+        m_status_first[s + 1] += m_status_first[s];
+        sfill[s] = m_status_first[s];
+    }
+    m_stamps.resize(m_gathered_stamps.size());
+    for (std::size_t g = 0; g < m_gathered_stamps.size(); ++g)
+    {
+        std::size_t s = std::size_t(sfill[m_gathered_status[g]]++);
+        m_stamps[s] = m_gathered_stamps[g];
+    }
+
+    for (int s = 0; s < c_status_count; ++s)
+    {
+        std::vector<midipulse>::iterator lo =
+            m_stamps.begin() + m_status_first[s];
+
+        std::vector<midipulse>::iterator hi =
+            m_stamps.begin() + m_status_first[s + 1];
+
+        if (! std::is_sorted(lo, hi))
+            std::sort(lo, hi);
+    }
+    m_generation = generation;
+    m_serial = evl.serial();
+    m_built = true;
+}
+
+/**
+ *  Builds the implicit tree over part of the spans: the middle span of the
+ *  part holds the greatest end of the whole part, and each half is built
+ *  the same way.
+ *
+ * \param lo
+ *      The index of the first span of the part.
+ *
+ * \param hi
+ *      The index after the last span of the part.
+ *
+ * \return
+ *      Returns the greatest end of the part, or the least midipulse if the
+ *      part is empty.
+ */
+
+midipulse
+event_index::build_tree (int lo, int hi)
+{
+    if (lo >= hi)
+        return std::numeric_limits<midipulse>::min();
+
+    int mid = lo + (hi - lo) / 2;
+    midipulse result = m_spans[std::size_t(mid)].es_finish;
+    midipulse left = build_tree(lo, mid);
+    midipulse right = build_tree(mid + 1, hi);
+    if (left > result)
+        result = left;
+
+    if (right > result)
+        result = right;
+
+    m_max_finish[std::size_t(mid)] = result;
+    return result;
+}
+
+/**
+ *  Adds the spans of part of the tree that overlap a range of ticks, in
+ *  the order of their start.  A part is skipped if no span in it ends late
+ *  enough, and the search stops at the first span that starts too late.
+ *
+ * \param lo
+ *      The index of the first span of the part.
+ *
+ * \param hi
+ *      The index after the last span of the part.
+ *
+ * \param tick_s
+ *      The start of the range.
+ *
+ * \param tick_f
+ *      The end of the range.
+ *
+ * \param [out] hits
+ *      The spans found are added to this vector.
+ */
+
+void
+event_index::find_spans
+(
+    int lo, int hi, midipulse tick_s, midipulse tick_f, Hits & hits
+) const
+{
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (m_max_finish[std::size_t(mid)] < tick_s)
+            return;
+
+        find_spans(lo, mid, tick_s, tick_f, hits);
+
+        const event_span & es = m_spans[std::size_t(mid)];
+        if (es.es_start > tick_f)
+            return;
+
+        if (es.es_finish >= tick_s)
+            hits.push_back(&es);
+
+        lo = mid + 1;                           /* the right half, in turn  */
+    }
+}
+
+/**
+ *  Finds the first pair in part of the tree whose span holds a tick.
+ *
+ * \param lo
+ *      The index of the first span of the part.
+ *
+ * \param hi
+ *      The index after the last span of the part.
+ *
+ * \param tick
+ *      The tick to look for.
+ *
+ * \return
+ *      Returns the span of the pair that starts first, or a null pointer if
+ *      there is none.
+ */
+
+const event_span *
+event_index::find_pair (int lo, int hi, midipulse tick) const
+{
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (m_max_finish[std::size_t(mid)] < tick)
+            return nullptr;
+
+        const event_span * result = find_pair(lo, mid, tick);
+        if (not_nullptr(result))
+            return result;
+
+        const event_span & es = m_spans[std::size_t(mid)];
+        if (es.es_start > tick)
+            return nullptr;
+
+        if (es.es_pair && es.es_finish >= tick)
+            return &es;
+
+        lo = mid + 1;
+    }
+    return nullptr;
+}
+
+/**
+ *  Finds the spans that overlap a box of ticks and notes, as
+ *  sequence::select_note_events() selects them.  A span that wraps around
+ *  overlaps if it starts before the end of the box, or ends after its
+ *  start.
+ *
+ * \param tick_s
+ *      The start of the box.
+ *
+ * \param note_h
+ *      The highest note of the box.
+ *
+ * \param tick_f
+ *      The end of the box.
+ *
+ * \param note_l
+ *      The lowest note of the box.
+ *
+ * \param [out] hits
+ *      Set to the spans found, in the order of their events in the list.
+ */
+
+void
+event_index::find_notes
+(
+    midipulse tick_s, int note_h, midipulse tick_f, int note_l,
+    Hits & hits
+) const
+{
+    hits.clear();
+    int low = note_l < 0 ? 0 : note_l ;
+    int high = note_h < c_note_count ? note_h : c_note_count - 1 ;
+    for (int n = low; n <= high; ++n)
+        find_spans(m_note_first[n], m_note_first[n + 1], tick_s, tick_f, hits);
+
+    for (std::size_t i = 0; i < m_loose.size(); ++i)
+    {
+        const event_span & es = m_loose[i];
+        if (es.es_note >= low && es.es_note <= high)
+        {
+            bool overlap = es.es_start <= es.es_finish ?
+                (es.es_start <= tick_f && es.es_finish >= tick_s) :
+                (es.es_start <= tick_f || es.es_finish >= tick_s) ;
+
+            if (overlap)
+                hits.push_back(&es);
+        }
+    }
+    if (hits.size() > 1)
+        std::sort(hits.begin(), hits.end(), order_less);
+}
+
+/**
+ *  Finds the first linked note, of a given note value, that holds a tick,
+ *  for sequence::intersect_notes().
+ *
+ * \param tick
+ *      The tick to look for.
+ *
+ * \param note
+ *      The note to look for.
+ *
+ * \param [out] start
+ *      Set to the time of the Note On, if found.
+ *
+ * \param [out] finish
+ *      Set to the time of the Note Off, if found.
+ *
+ * \return
+ *      Returns true if a note was found.
+ */
+
+bool
+event_index::find_note
+(
+    midipulse tick, int note, midipulse & start, midipulse & finish
+) const
+{
+    if (note < 0 || note >= c_note_count)
+        return false;
+
+    const event_span * es = find_pair
+    (
+        m_note_first[note], m_note_first[note + 1], tick
+    );
+    bool result = not_nullptr(es);
+    if (result)
+    {
+        start = es->es_start;
+        finish = es->es_finish;
+    }
+    return result;
+}
+
+/**
+ *  Finds the earliest event of a given status in a range of ticks, for
+ *  sequence::intersect_events().
+ *
+ * \param status
+ *      The status, without the channel, to look for.
+ *
+ * \param tick_s
+ *      The start of the range.
+ *
+ * \param tick_f
+ *      The end of the range.
+ *
+ * \param [out] timestamp
+ *      Set to the timestamp of the event, if found.
+ *
+ * \return
+ *      Returns true if an event was found.
+ */
+
+bool
+event_index::find_event
+(
+    midibyte status, midipulse tick_s, midipulse tick_f,
+    midipulse & timestamp
+) const
+{
+    std::vector<midipulse>::const_iterator hi =
+        m_stamps.begin() + m_status_first[status + 1];
+
+    std::vector<midipulse>::const_iterator t = std::lower_bound
+    (
+        m_stamps.begin() + m_status_first[status], hi, tick_s
+    );
+    bool result = t != hi && *t <= tick_f;
+    if (result)
+        timestamp = *t;
+
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * event_index.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-19
- * \updates       2021-05-06
+ * \updates       2023-03-26
  * \license       GNU GPLv2 or above
  *
  *  This container now can indicate if certain Meta events (time-signaure or
@@ -39,6 +39,9 @@
  */
 
 #include <stdio.h>                      /* C::printf()                  */
+#include <atomic>                       /* std::atomic<>                */
+#include <cstdint>                      /* std::uint64_t                */
+#include <unordered_map>                /* std::unordered_multimap<>    */
 
 #include "easy_macros.h"
 #include "event_list.hpp"
@@ -108,17 +111,123 @@ event_list::event_key::operator < (const event_key & rhs) const
         return (m_timestamp < rhs.m_timestamp);
 }
 
+/*
+ * Section: event_positions
+ */
+
+/**
+ *  A hash table from the addresses of the events of a container to their
+ *  positions in it, used to copy or compare the links between events.  It
+ *  uses open addressing in two flat arrays, since an std::unordered_map
+ *  allocates a node for every event.
+ */
+
+class event_positions
+{
+
+private:
+
+    std::vector<const event *> m_keys;  /**< The addresses, or null.    */
+    std::vector<int> m_values;          /**< The positions.             */
+    std::size_t m_mask;                 /**< The table size, minus one. */
+
+public:
+
+    /**
+     *  Makes a table at most half full for the given number of events.
+     */
+
+    explicit event_positions (std::size_t count)
+     :
+        m_keys      (),
+        m_values    (),
+        m_mask      (0)
+    {
+        std::size_t size = 16;
+        while (size < 2 * count)
+            size *= 2;
+
+        m_keys.assign(size, nullptr);
+        m_values.assign(size, -1);
+        m_mask = size - 1;
+    }
+
+    /**
+     *  Adds an event.  Each event is added once.
+     */
+
+    void insert (const event * e, int position)
+    {
+        std::size_t k = slot(e);
+        while (not_nullptr(m_keys[k]))
+            k = (k + 1) & m_mask;
+
+        m_keys[k] = e;
+        m_values[k] = position;
+    }
+
+    /**
+     *  Finds an event, returning its position, or -1.
+     */
+
+    int find (const event * e) const
+    {
+        std::size_t k = slot(e);
+        while (not_nullptr(m_keys[k]))
+        {
+            if (m_keys[k] == e)
+                return m_values[k];
+
+            k = (k + 1) & m_mask;
+        }
+        return -1;
+    }
+
+private:
+
+    /**
+     *  The first slot to try for an event.  The low bits of an address are
+     *  mostly the same, so a multiplicative hash spreads them.
+     */
+
+    std::size_t slot (const event * e) const
+    {
+        std::uint64_t a = std::uint64_t(reinterpret_cast<std::uintptr_t>(e));
+        return std::size_t((a * 11400714819323198485ULL) >> 32) & m_mask;
+    }
+
+};          // class event_positions
+
 /*
  * Section: event_list
  */
 
+/**
+ *  Provides the serial numbers of the event containers.
+ */
+
+static std::atomic<unsigned> s_next_serial(0);
+
+/**
+ *  Creates an empty container, with a new serial number.
+ */
+
+event_list::storage::storage ()
+ :
+    st_events   (),
+    st_serial   (++s_next_serial),
+    st_verified (-1)
+{
+    // Empty body
+}
+
 /**
  *  Principal constructor.
  */
 
 event_list::event_list ()
  :
-    m_events                (),
+    m_storage               (std::make_shared<storage>()),
     m_length                (0),
     m_is_modified           (false),
     m_has_tempo             (false),
@@ -128,7 +237,8 @@ event_list::event_list ()
 }
 
 /**
- *  Copy constructor.
+ *  Copy constructor.  The events are shared, not copied, until one of the
+ *  lists changes them.
  *
  * \param rhs
  *      Provides the event list to be copied.
@@ -136,7 +246,7 @@ event_list::event_list ()
 
 event_list::event_list (const event_list & rhs)
  :
-    m_events                (rhs.m_events),
+    m_storage               (rhs.m_storage),
     m_length                (rhs.m_length),
     m_is_modified           (rhs.m_is_modified),
     m_has_tempo             (rhs.m_has_tempo),
@@ -147,7 +257,8 @@ event_list::event_list (const event_list & rhs)
 
 /**
  *  Principal assignment operator.  Follows the stock rules for such an
- *  operator, just assigning member values.
+ *  operator, just assigning member values.  As with the copy constructor,
+ *  the events are shared.
  *
  * \param rhs
  *      Provides the event list to be assigned.
@@ -158,7 +269,7 @@ event_list::operator = (const event_list & rhs)
 {
     if (this != &rhs)
     {
-        m_events                = rhs.m_events;
+        m_storage               = rhs.m_storage;
         m_length                = rhs.m_length;
         m_is_modified           = rhs.m_is_modified;
         m_has_tempo             = rhs.m_has_tempo;
@@ -176,6 +287,227 @@ event_list::~event_list ()
     // No code needed
 }
 
+/**
+ *  Gives the list a container of its own, by copying the events of a shared
+ *  container.  The links of the copies are made to point to the copies.
+ *  The serial number changes, so that the holders of iterators into the old
+ *  container can tell.  Called by any non-const access to the events; also
+ *  called by sequence before handing out pointers to its events.
+ */
+
+void
+event_list::unshare ()
+{
+    if (shared())
+    {
+        std::shared_ptr<storage> own = std::make_shared<storage>();
+        own->st_events = m_storage->st_events;
+        own->st_verified = m_storage->st_verified;
+        relink(m_storage->st_events, own->st_events);
+        m_storage = own;
+    }
+}
+
+/**
+ *  Makes the links of a copy of a container point into the copy.  A link
+ *  to an event not in the source container is left as is, as a plain copy
+ *  would leave it.
+ *
+ * \param source
+ *      The container that was copied.
+ *
+ * \param destination
+ *      The copy, in the same order.
+ */
+
+void
+event_list::relink (const Events & source, Events & destination)
+{
+    event_positions positions(source.size());
+    int position = 0;
+    for (Events::const_iterator s = source.begin(); s != source.end(); ++s)
+        positions.insert(&dref(s), position++);
+
+    std::vector<event *> copies;
+    copies.reserve(destination.size());
+    for (Events::iterator d = destination.begin(); d != destination.end(); ++d)
+        copies.push_back(&dref(d));
+
+    for (std::size_t k = 0; k < copies.size(); ++k)
+    {
+        event * linked = copies[k]->get_linked();
+        if (not_nullptr(linked))
+        {
+            int p = positions.find(linked);
+            if (p >= 0)
+                copies[k]->link(copies[std::size_t(p)]);
+        }
+    }
+}
+
+/**
+ *  Makes identical event lists share one container, to save memory when a
+ *  song has many copies of the same pattern, as songs split from an SMF 0
+ *  file or built by copy and paste often do.  Each list is hashed by
+ *  content; the lists of the same hash are compared in full, including the
+ *  flags and the links of the events, and the later ones take the container
+ *  of the first.  The callers must make sure that no other thread uses the
+ *  lists meanwhile.
+ *
+ * \param lists
+ *      The event lists to look through.  Empty lists are left alone.
+ *
+ * \return
+ *      Returns the number of lists that now share the container of another.
+ */
+
+int
+event_list::share_duplicates (const std::vector<event_list *> & lists)
+{
+    int result = 0;
+    std::vector<std::vector<int>> indices(lists.size());
+    std::unordered_multimap<std::size_t, std::size_t> firsts;
+    for (std::size_t k = 0; k < lists.size(); ++k)
+    {
+        event_list & evl = *lists[k];
+        if (evl.empty())
+            continue;
+
+        evl.link_indices(indices[k]);
+        std::size_t hash = evl.content_hash(indices[k]);
+        bool found = false;
+        typedef std::unordered_multimap<std::size_t, std::size_t>::iterator
+            first_iterator;
+
+        std::pair<first_iterator, first_iterator> range =
+            firsts.equal_range(hash);
+
+        for (first_iterator f = range.first; f != range.second; ++f)
+        {
+            event_list & first = *lists[f->second];
+            if (indices[k] == indices[f->second] && same_events(evl, first))
+            {
+                if (evl.m_storage != first.m_storage)
+                {
+                    evl.m_storage = first.m_storage;
+                    ++result;
+                }
+                found = true;
+                break;
+            }
+        }
+        if (! found)
+            firsts.insert(std::make_pair(hash, k));
+        else
+            indices[k].clear();
+    }
+    return result;
+}
+
+/**
+ *  Gets, for each event, the position in the list of the event it is linked
+ *  to, or -1, so that the links of two lists can be compared.
+ *
+ * \param [out] indices
+ *      The positions, one per event.
+ */
+
+void
+event_list::link_indices (std::vector<int> & indices) const
+{
+    event_positions positions(events().size());
+    int position = 0;
+    for (const_iterator i = events().begin(); i != events().end(); ++i)
+        positions.insert(&dref(i), position++);
+
+    indices.clear();
+    indices.reserve(events().size());
+    for (const_iterator i = events().begin(); i != events().end(); ++i)
+    {
+        const event * linked = dref(i).get_linked();
+        indices.push_back(not_nullptr(linked) ? positions.find(linked) : -1);
+    }
+}
+
+/**
+ *  Hashes the content of the events, as compared by same_events(), with
+ *  the FNV-1a hash.
+ *
+ * \param indices
+ *      The positions of the linked events, from link_indices().
+ *
+ * \return
+ *      Returns the hash value.
+ */
+
+std::size_t
+event_list::content_hash (const std::vector<int> & indices) const
+{
+    std::uint64_t result = 14695981039346656037ULL;
+    std::size_t k = 0;
+    for (const_iterator i = events().begin(); i != events().end(); ++i, ++k)
+    {
+        const event & e = dref(i);
+        midibyte d0, d1;
+        e.get_data(d0, d1);
+        std::uint64_t values[] =
+        {
+            std::uint64_t(e.get_timestamp()),
+            std::uint64_t(e.get_status()) << 8 | e.get_channel(),
+            std::uint64_t(d0) << 8 | d1,
+            std::uint64_t(e.get_sysex_size()),
+            std::uint64_t(std::int64_t(indices[k]))
+        };
+        for (std::size_t v = 0; v < sizeof values / sizeof values[0]; ++v)
+        {
+            result ^= values[v];
+            result *= 1099511628211ULL;
+        }
+    }
+    return std::size_t(result);
+}
+
+/**
+ *  Compares the events of two lists, except for their links, which the
+ *  caller compares with link_indices().
+ *
+ * \return
+ *      Returns true if the events are the same, in the same order.
+ */
+
+bool
+event_list::same_events (const event_list & a, const event_list & b)
+{
+    if (a.count() != b.count())
+        return false;
+
+    const_iterator j = b.events().begin();
+    for (const_iterator i = a.events().begin(); i != a.events().end(); ++i)
+    {
+        const event & ea = dref(i);
+        const event & eb = dref(j);
+        midibyte a0, a1, b0, b1;
+        ea.get_data(a0, a1);
+        eb.get_data(b0, b1);
+        bool same =
+            ea.get_timestamp() == eb.get_timestamp() &&
+            ea.get_status() == eb.get_status() &&
+            ea.get_channel() == eb.get_channel() &&
+            a0 == b0 && a1 == b1 &&
+            ea.get_sysex() == eb.get_sysex() &&
+            ea.is_linked() == eb.is_linked() &&
+            ea.is_selected() == eb.is_selected() &&
+            ea.is_marked() == eb.is_marked() &&
+            ea.is_painted() == eb.is_painted();
+
+        if (! same)
+            return false;
+
+        ++j;
+    }
+    return true;
+}
+
 /**
  *  Provides the length of the events in MIDI pulses.  This function gets the
  *  iterator for the last element and returns its length value.
@@ -190,7 +522,7 @@ event_list::max_length () const
     midipulse result = 0;
     if (count() > 0)
     {
-        const_reverse_iterator lci = m_events.rbegin(); /* get last element */
+        const_reverse_iterator lci = events().rbegin(); /* get last element */
 #ifdef SEQ64_USE_EVENT_MAP
         result = lci->second.get_timestamp();           /* get length value */
 #else
@@ -247,7 +579,7 @@ event_list::append (const event & e)
     EventsPair p = std::make_pair<event_key, event>(key, e);
 #endif
 
-    m_events.insert(p);                 /* std::multimap operation  */
+    owned().insert(p);                  /* std::multimap operation  */
 
 #else   // SEQ64_USE_EVENT_MAP
 
@@ -320,7 +652,7 @@ event_list::merge (event_list & el, bool /*presort*/ )
 {
     int initialsize = count();
     int addedsize = el.count();
-    m_events.insert(el.events().begin(), el.events().end());
+    owned().insert(el.events().begin(), el.events().end());
     if (count() != (initialsize + addedsize))
     {
         char tmp[64];
@@ -341,75 +673,100 @@ event_list::merge (event_list & el, bool presort)
     if (presort)
         el.sort();                          // el.m_events.sort();
 
-    m_events.merge(el.m_events);
+    owned().merge(el.owned());
 }
 
 #endif  // SEQ64_USE_EVENT_MAP
 
+/**
+ *  Puts the events in the given order.  For the std::list implementation,
+ *  each node is spliced to the end of the list in turn; no event is copied,
+ *  and links and iterators remain valid.  For the std::multimap
+ *  implementation, the order is that of the keys, so each event is
+ *  re-inserted under a key made from its current timestamp and rank, and
+ *  the caller must relink the events afterward (see verify_and_link()).
+ *
+ * \param nodes
+ *      Provides every event of the container, exactly once, in the desired
+ *      order.
+ */
+
+void
+event_list::arrange (const std::vector<iterator> & nodes)
+{
+    Events & evs = m_storage->st_events;    /* our own, as nodes shows  */
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+#ifdef SEQ64_USE_EVENT_MAP
+        event e = dref(nodes[i]);
+        evs.erase(nodes[i]);
+        (void) append(e);
+#else
+        evs.splice(evs.end(), evs, nodes[i]);
+#endif
+    }
+    m_storage->st_verified = -1;
+    m_is_modified = true;
+}
+
 /**
  *  Links a new event.  This function checks for a note on, then looks for
  *  its note off.  This function is provided in the event_list because it
  *  does not depend on any external data.  Also note that any desired
  *  thread-safety must be provided by the caller.
+ *
+ *  Each unlinked Note On is linked to the first unlinked Note Off of the
+ *  same note that follows it.  Rather than searching forward from each Note
+ *  On, which is quadratic in the number of events, one pass queues the
+ *  unlinked Note Ons of each note in order, and hands each unlinked Note Off
+ *  to the oldest Note On waiting in its queue.  The pairs are the same.
+ *  The Stazed extension that also searched before the Note On, to link a
+ *  note wrapping around the end of the pattern, was never completed, and is
+ *  gone.
  */
 
 void
 event_list::link_new ()
 {
-    for (Events::iterator on = m_events.begin(); on != m_events.end(); ++on)
+    std::vector<event *> ons;                   /* unlinked Note Ons        */
+    std::vector<int> next;                      /* next in the same queue   */
+    int head[256];                              /* any byte as note number  */
+    int tail[256];
+    for (int n = 0; n < 256; ++n)
+        head[n] = tail[n] = -1;
+
+    Events & evs = owned();
+    ons.reserve(evs.size() / 2);
+    next.reserve(evs.size() / 2);
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
     {
-        event & eon = dref(on);
-        if (eon.is_note_on() && ! eon.is_linked())  /* note on, unlinked?   */
-        {
-            Events::iterator off = on;              /* point to note on     */
-            ++off;                                  /* get next element     */
-            while (off != m_events.end())
-            {
-                event & eoff = dref(off);
-                if                          /* Off, == notes, not linked    */
-                (
-                    eoff.is_note_off() &&
-                    (eoff.get_note() == eon.get_note()) &&
-                    ! eoff.is_linked()
-                )
-                {
-                    eon.link(&eoff);                /* link backward        */
-                    eoff.link(&eon);                /* link forward         */
-                    break;
-                }
-                ++off;
-            }
-
-#ifdef SEQ64_USE_STAZED_NEW_LINK_EXTENSION
-
-            /*
-             * This code, meant to allow wraparound of notes in a pattern, is
-             * problematic.  Commenting it out for now.  A possible
-             * alternative is to generated a Note Off event timestamped at the
-             * end of the pattern.
-             */
+        event & e = dref(i);
+        if (e.is_linked())
+            continue;
 
-            if (! endfound)
-            {
-                off = m_events.begin();
-                while (off != on)
-                {
-                    event & eoff = dref(off);
-                    if              /* off event, == notes, and not linked  */
-                    (
-                        eoff.is_note_off() &&
-                        eoff.get_note() == eon.get_note() && ! eoff.is_linked()
-                    )
-                    {
-                        eon.link(&eoff);            /* link backward        */
-                        eoff.link(&eon);            /* link forward         */
-                        endfound = true;            /* note on fulfilled    */
-                        break;
-                    }
-                    ++off;
-                }
-            }
-#endif
+        midibyte note = e.get_note();
+        if (e.is_note_on())
+        {
+            int k = int(ons.size());
+            ons.push_back(&e);
+            next.push_back(-1);
+            if (tail[note] >= 0)
+                next[tail[note]] = k;
+            else
+                head[note] = k;
+
+            tail[note] = k;
+        }
+        else if (e.is_note_off() && head[note] >= 0)
+        {
+            int k = head[note];
+            event * eon = ons[k];
+            head[note] = next[k];
+            if (head[note] < 0)
+                tail[note] = -1;
+
+            eon->link(&e);                          /* link backward        */
+            e.link(eon);                            /* link forward         */
         }
     }
 }
@@ -448,6 +805,9 @@ event_list::link_new ()
 void
 event_list::verify_and_link (midipulse slength)
 {
+    if (m_storage->st_verified == slength)
+        return;                         /* done, and unchanged since    */
+
     clear_links();
     link_new();
     if (slength > 0)
@@ -462,6 +822,7 @@ event_list::verify_and_link (midipulse slength)
      */
 
     link_tempos();
+    m_storage->st_verified = slength;
 }
 
 /**
@@ -471,7 +832,8 @@ event_list::verify_and_link (midipulse slength)
 void
 event_list::clear_links ()
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned();
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
     {
         event & e = dref(i);
         e.clear_link();
@@ -493,7 +855,8 @@ event_list::scan_meta_events ()
 {
     m_has_tempo = false;
     m_has_time_signature = false;
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned();
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
     {
         event & e = dref(i);
         if (e.is_tempo())
@@ -522,14 +885,15 @@ void
 event_list::link_tempos ()
 {
     clear_tempo_links();
-    for (event_list::iterator t = m_events.begin(); t != m_events.end(); ++t)
+    Events & evs = owned();
+    for (event_list::iterator t = evs.begin(); t != evs.end(); ++t)
     {
         event & e = dref(t);
         if (e.is_tempo())
         {
             event_list::iterator t2 = t;    /* next possible Set Tempo...   */
             ++t2;                           /* ...starting here             */
-            while (t2 != m_events.end())
+            while (t2 != evs.end())
             {
                 event & et2 = dref(t2);
                 if (et2.is_tempo())
@@ -550,7 +914,8 @@ event_list::link_tempos ()
 void
 event_list::clear_tempo_links ()
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned();
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
     {
         event & e = dref(i);
         if (e.is_tempo())
@@ -569,7 +934,8 @@ bool
 event_list::mark_selected ()
 {
     bool result = false;
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned();
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
     {
         event & e = dref(i);
         if (e.is_selected())
@@ -589,7 +955,8 @@ event_list::mark_selected ()
 void
 event_list::mark_all ()
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned();
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
         dref(i).mark();
 }
 
@@ -600,7 +967,8 @@ event_list::mark_all ()
 void
 event_list::unmark_all ()
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned();
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
         dref(i).unmark();
 }
 
@@ -625,7 +993,8 @@ event_list::unmark_all ()
 void
 event_list::mark_out_of_range (midipulse slength)
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned();
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
     {
         event & e = dref(i);
         bool prune = e.get_timestamp() > slength;   /* WAS ">=", SEE BANNER */
@@ -655,8 +1024,9 @@ bool
 event_list::remove_marked ()
 {
     bool result = false;
-    Events::iterator i = m_events.begin();
-    while (i != m_events.end())
+    Events & evs = owned();
+    Events::iterator i = evs.begin();
+    while (i != evs.end())
     {
         if (DREF(i).is_marked())
         {
@@ -679,7 +1049,8 @@ event_list::remove_marked ()
 void
 event_list::unpaint_all ()
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned(true);             /* selection only   */
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
         dref(i).unpaint();
 }
 
@@ -691,7 +1062,8 @@ int
 event_list::count_selected_notes () const
 {
     int result = 0;
-    for (Events::const_iterator i = m_events.begin(); i != m_events.end(); ++i)
+    const Events & evs = events();
+    for (Events::const_iterator i = evs.begin(); i != evs.end(); ++i)
     {
         if (dref(i).is_note_on() && dref(i).is_selected())
             ++result;
@@ -712,7 +1084,8 @@ bool
 event_list::any_selected_notes () const
 {
     bool result = false;
-    for (Events::const_iterator i = m_events.begin(); i != m_events.end(); ++i)
+    const Events & evs = events();
+    for (Events::const_iterator i = evs.begin(); i != evs.end(); ++i)
     {
         if (dref(i).is_note_on() && dref(i).is_selected())
         {
@@ -744,7 +1117,8 @@ int
 event_list::count_selected_events (midibyte status, midibyte cc) const
 {
     int result = 0;
-    for (Events::const_iterator i = m_events.begin(); i != m_events.end(); ++i)
+    const Events & evs = events();
+    for (Events::const_iterator i = evs.begin(); i != evs.end(); ++i)
     {
         const event & e = dref(i);
         if (e.is_tempo())
@@ -779,7 +1153,8 @@ bool
 event_list::any_selected_events (midibyte status, midibyte cc) const
 {
     bool result = false;
-    for (Events::const_iterator i = m_events.begin(); i != m_events.end(); ++i)
+    const Events & evs = events();
+    for (Events::const_iterator i = evs.begin(); i != evs.end(); ++i)
     {
         const event & e = dref(i);
         if (e.is_tempo())
@@ -814,18 +1189,35 @@ event_list::any_selected_events (midibyte status, midibyte cc) const
 void
 event_list::select_all ()
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    Events & evs = owned(true);             /* selection only   */
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
         dref(i).select();
 }
 
 /**
- *  Deselects all events, unconditionally.
+ *  Deselects all events, unconditionally.  If none is selected, the events
+ *  are left alone, so that a shared container, as after an undo, is not
+ *  copied for nothing.
  */
 
 void
 event_list::unselect_all ()
 {
-    for (Events::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    bool any = false;
+    const Events & cevs = events();
+    for (Events::const_iterator i = cevs.begin(); i != cevs.end(); ++i)
+    {
+        if (dref(i).is_selected())
+        {
+            any = true;
+            break;
+        }
+    }
+    if (! any)
+        return;
+
+    Events & evs = owned(true);             /* selection only   */
+    for (Events::iterator i = evs.begin(); i != evs.end(); ++i)
         dref(i).unselect();
 }
 
@@ -841,8 +1233,8 @@ event_list::print (const std::string & tag) const
         printf("%d events %s:\n", count(), tag.c_str());
         for
         (
-            Events::const_iterator i = m_events.begin();
-            i != m_events.end(); ++i
+            Events::const_iterator i = events().begin();
+            i != events().end(); ++i
         )
         {
             dref(i).print();
@@ -862,8 +1254,8 @@ event_list::print_notes (const std::string & tag) const
         printf("Notes %s:\n", tag.c_str());
         for
         (
-            Events::const_iterator i = m_events.begin();
-            i != m_events.end(); ++i
+            Events::const_iterator i = events().begin();
+            i != events().end(); ++i
         )
         {
             dref(i).print_note();
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-11-23
- * \updates       2018-07-05
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This file provides a base-class implementation for various master MIDI
@@ -33,10 +33,15 @@
  *  buss classes.
  */
 
+#include <algorithm>                    /* std::count()                     */
+
 #include "calculations.hpp"             /* seq64::extract_port_names()      */
 #include "easy_macros.h"
 #include "event.hpp"                    /* seq64::event                     */
 #include "mastermidibase.hpp"           /* seq64::mastermidibase            */
+#include "midi_capture.hpp"             /* seq64::midi_capture              */
+#include "perf_stats.hpp"               /* seq64::statistics()              */
+#include "play_pool.hpp"                /* seq64::play_buffer               */
 #include "sequence.hpp"                 /* seq64::sequence                  */
 #include "settings.hpp"                 /* seq64::rc()                      */
 
@@ -47,6 +52,72 @@
 namespace seq64
 {
 
+/**
+ *  If not null, the events played by the current thread go to this buffer
+ *  instead of to the busses.  Set by the play_pool workers; see redirect().
+ */
+
+static thread_local play_buffer * s_play_buffer = nullptr;
+
+/**
+ *  True while the current thread plays the patterns for an output cycle in
+ *  which the events are scheduled ahead.  See schedule_cycle().
+ */
+
+static thread_local bool s_in_cycle = false;
+
+/**
+ *  Looks up a port in the last-known port map read from the "rc" file.  If
+ *  more than one port has the same name (two of the same device, say), the
+ *  first such port found gets the first entry with that name, and so on.
+ *
+ * \param saved
+ *      The port names read from the "rc" file, in the saved buss order.
+ *
+ * \param found
+ *      The names of the ports enumerated so far, before this one.
+ *
+ * \param name
+ *      The name of the port to look up.  If empty, the port cannot be
+ *      matched by name.
+ *
+ * \param bus
+ *      The buss number the port has now.
+ *
+ * \return
+ *      Returns the saved buss number whose setting goes with the port.  If
+ *      the port has no name, or the "rc" file recorded no name for this buss
+ *      number, the buss number itself is returned.  If the port is new, -1
+ *      is returned, so that it gets the default setting.
+ */
+
+static int
+last_known_port
+(
+    const std::vector<std::string> & saved,
+    const std::vector<std::string> & found,
+    const std::string & name,
+    int bus
+)
+{
+    int result = bus;
+    if (! name.empty())
+    {
+        int nth = int(std::count(found.begin(), found.end(), name));
+        int index = 0;
+        for ( ; index < int(saved.size()); ++index)
+        {
+            if (saved[index] == name && nth-- == 0)
+                break;
+        }
+        if (index < int(saved.size()))
+            result = index;
+        else if (bus < int(saved.size()) && ! saved[bus].empty())
+            result = -1;                        /* a new port in this slot  */
+    }
+    return result;
+}
+
 /**
  *  The mastermidibase default constructor fills the array with our busses.
  *
@@ -72,6 +143,8 @@ mastermidibase::mastermidibase
     m_outbus_array      (),
     m_master_clocks     (),
     m_master_inputs     (),
+    m_master_clock_ports(),
+    m_master_input_ports(),
     m_queue             (0),
     m_ppqn              (choose_ppqn(ppqn)),
     m_beats_per_minute  (bpm),          /* beats per minute                 */
@@ -79,6 +152,13 @@ mastermidibase::mastermidibase
     m_vector_sequence   (),             /* stazed feature                   */
     m_filter_by_channel (false),        /* set based on configuration       */
     m_seq               (nullptr),
+    m_capture           (nullptr),
+    m_thru_router       (),
+    m_input_bus         (-1),
+    m_thru_reserved     (0),
+    m_scheduling        (false),
+    m_schedule_tick     (0.0),
+    m_schedule_pulse_us (0.0),
     m_mutex             ()
 {
     // Empty body now
@@ -172,6 +252,11 @@ void
 mastermidibase::stop ()
 {
     automutex locker(m_mutex);
+    if (m_scheduling)
+    {
+        api_purge(0);                   /* drop what is still ahead of us   */
+        m_scheduling = false;
+    }
     m_outbus_array.stop();
     api_stop();
 }
@@ -234,6 +319,9 @@ mastermidibase::set_beats_per_minute (midibpm bpm)
 {
     automutex locker(m_mutex);
     m_beats_per_minute = bpm;
+    if (not_nullptr(m_capture))
+        m_capture->capture_tempo(bpm);
+
     api_set_beats_per_minute(bpm);
 }
 
@@ -248,6 +336,9 @@ mastermidibase::set_beats_per_minute (midibpm bpm)
 void
 mastermidibase::flush ()
 {
+    if (not_nullptr(s_play_buffer))
+        return;                 /* play_pool::merge() flushes afterward */
+
     automutex locker(m_mutex);
     api_flush();
 }
@@ -292,6 +383,12 @@ void
 mastermidibase::sysex (event * ev)
 {
     automutex locker(m_mutex);
+    if (not_nullptr(m_capture))
+    {
+        m_capture->capture_sysex(*ev);
+        if (! m_capture->passthrough())
+            return;
+    }
     m_outbus_array.sysex(ev);
     flush();                /* recursive locking! */
 }
@@ -300,7 +397,10 @@ mastermidibase::sysex (event * ev)
  *  Handle the playing of MIDI events on the MIDI buss given by the
  *  parameter, as long as it is a legal buss number.
  *
- *  There's currently no implementation-specific API function here.
+ *  There's currently no implementation-specific API function here.  Each
+ *  event is counted for the events-per-cycle statistic.  If the calling
+ *  thread is a play_pool worker, the event is only added to its buffer, and
+ *  is played (and counted) later, by play_pool::merge().
  *
  * \threadsafe
  *
@@ -319,15 +419,240 @@ mastermidibase::sysex (event * ev)
 void
 mastermidibase::play (bussbyte bus, event * e24, midibyte channel)
 {
+    if (not_nullptr(s_play_buffer))
+    {
+        s_play_buffer->add(bus, *e24, channel);
+        return;
+    }
+    statistics().count_event();
     automutex locker(m_mutex);
+    if (not_nullptr(m_capture))
+    {
+        m_capture->capture(bus, *e24, channel);
+        if (! m_capture->passthrough())
+            return;
+    }
     m_outbus_array.play(bus, e24, channel);
 }
 
+/**
+ *  Plays an event of a pattern at its own time, rather than now, if the
+ *  events are being scheduled ahead (see schedule_start()).  The timestamp
+ *  of the event is its tick in the song, and the delay is figured from the
+ *  tick of the current output cycle.  An event that is already due has a
+ *  delay of 0 or less; the API plays it directly, or, if it delays all of
+ *  its output by a fixed latency, as PortMidi does, stamps it with the time
+ *  it was due.  Otherwise the same as play().
+ *
+ * \threadsafe
+ *
+ * \param bus
+ *      The buss to play on.
+ *
+ * \param e24
+ *      The event, stamped with its tick in the song.
+ *
+ * \param channel
+ *      The channel on which to play the event.
+ *
+ * \param tag
+ *      Identifies the pattern, so that purge() can remove its events.  It
+ *      must not be 0.
+ */
+
+void
+mastermidibase::play_ahead
+(
+    bussbyte bus, event * e24, midibyte channel, int tag
+)
+{
+    if (not_nullptr(s_play_buffer))
+    {
+        s_play_buffer->add(bus, *e24, channel, tag);
+        return;
+    }
+    statistics().count_event();
+    automutex locker(m_mutex);
+    if (not_nullptr(m_capture))
+    {
+        m_capture->capture(bus, *e24, channel);
+        if (! m_capture->passthrough())
+            return;
+    }
+
+    if (m_scheduling)
+    {
+        double ticks = double(e24->get_timestamp()) - m_schedule_tick;
+        long delayus = long(ticks * m_schedule_pulse_us);
+        m_outbus_array.play_at(bus, e24, channel, delayus, tag);
+    }
+    else
+        m_outbus_array.play(bus, e24, channel);
+}
+
+/**
+ *  Starts scheduling the events of the patterns ahead of time, on the
+ *  queue of the API, which then sends each one at its time.  Called by the
+ *  output thread when playback starts; stop() ends it.
+ *
+ * \threadsafe
+ *
+ * \return
+ *      Returns true if the API supports it, and is ready.
+ */
+
+bool
+mastermidibase::schedule_start ()
+{
+    automutex locker(m_mutex);
+    m_scheduling = api_schedule_start();
+    return m_scheduling;
+}
+
+/**
+ *  Gets how far ahead of time the patterns are played, if the events are
+ *  being scheduled ahead.
+ *
+ * \return
+ *      Returns the look-ahead in milliseconds, or 0 if the events are not
+ *      scheduled ahead, or if the API needs none.
+ */
+
+int
+mastermidibase::schedule_lead_ms ()
+{
+    return m_scheduling ? api_schedule_lead_ms() : 0 ;
+}
+
+/**
+ *  Provides the look-ahead of the API, for the schedule_lead_ms() function.
+ *  An API that queues events for later sending is given events up to the
+ *  "-o lookahead=ms" option ahead of their time.
+ */
+
+int
+mastermidibase::api_schedule_lead_ms ()
+{
+    return usr().option_lookahead_ms();
+}
+
+/**
+ *  Marks the start of the playing of the patterns for an output cycle, on
+ *  the calling thread.
+ *
+ * \param tick
+ *      The tick, with its fraction, that is now being played.
+ *
+ * \param pulseus
+ *      The length of a tick, in microseconds, at the current tempo.
+ */
+
+void
+mastermidibase::schedule_cycle (double tick, double pulseus)
+{
+    m_schedule_tick = tick;
+    m_schedule_pulse_us = pulseus;
+    s_in_cycle = true;
+}
+
+/**
+ *  Marks the end of the playing of the patterns for an output cycle.
+ */
+
+void
+mastermidibase::schedule_end ()
+{
+    s_in_cycle = false;
+}
+
+/**
+ * \return
+ *      Returns true if events are being scheduled ahead, and the calling
+ *      thread is playing the patterns for the output cycle, either as the
+ *      output thread or as a play_pool worker.  A pattern muted in the
+ *      cycle has been played up to its own last tick, and ends its notes
+ *      there; a pattern muted from another thread purges its events.  See
+ *      sequence::off_playing_notes().
+ */
+
+bool
+mastermidibase::in_cycle () const
+{
+    return m_scheduling && (s_in_cycle || not_nullptr(s_play_buffer));
+}
+
+/**
+ *  Removes the events still waiting to be sent, if events are being
+ *  scheduled ahead.  Note Offs are kept, so that no note is left hanging.
+ *
+ * \threadsafe
+ *
+ * \param tag
+ *      The tag of the pattern whose events are to be removed (see
+ *      play_ahead()), or 0 to remove the events of all patterns.
+ */
+
+void
+mastermidibase::purge (int tag)
+{
+    if (m_scheduling)
+    {
+        automutex locker(m_mutex);
+        api_purge(tag);
+    }
+}
+
+/**
+ *  Attaches or detaches a capture sink.
+ *
+ * \threadsafe
+ *
+ * \param mc
+ *      The sink to attach, or the null pointer to detach the current one.
+ *      The caller keeps ownership, and must detach the sink before
+ *      destroying it.
+ */
+
+void
+mastermidibase::capture (midi_capture * mc)
+{
+    automutex locker(m_mutex);
+    m_capture = mc;
+}
+
+/**
+ *  Redirects the events played by the calling thread, and only that
+ *  thread, to a buffer.  Used by the play_pool workers, so that they can
+ *  evaluate patterns at the same time without contending for the busses.
+ *
+ * \param pb
+ *      The buffer to fill, or the null pointer to play directly again.
+ */
+
+void
+mastermidibase::redirect (play_buffer * pb)
+{
+    s_play_buffer = pb;
+}
+
+/**
+ * \return
+ *      Returns true if the events played by the calling thread currently go
+ *      to a play_pool buffer.
+ */
+
+bool
+mastermidibase::redirected ()
+{
+    return not_nullptr(s_play_buffer);
+}
+
 /**
  *  Set the clock for the given (legal) buss number.  The legality checks
  *  are a little loose, however.
  *
- *  There's currently no implementation-specific API function here.
+ *  There's currently no implementation-specific API function here.  Each
+ *  event is counted for the events-per-cycle statistic.
  *
  * \threadsafe
  *
@@ -422,6 +747,7 @@ mastermidibase::set_input (bussbyte bus, bool inputing)
     if (result)
         result = save_input(bus, inputing);     /* save into the vector */
 
+    update_thru();
     return result;
 }
 
@@ -482,6 +808,59 @@ mastermidibase::get_input (bussbyte bus)
     return m_inbus_array.get_input(bus);
 }
 
+/**
+ *  Matches the clock and input settings read from the "rc" file to the ports
+ *  that were just enumerated, using the port names saved with them.  The
+ *  system might number the ports differently than it did the last time
+ *  (a device was plugged in, or unplugged), and then a setting read by buss
+ *  number would go to the wrong device.  Worse, a port disabled in the "rc"
+ *  file could be opened.  This must be called after api_init() and before
+ *  activate(), so that the output ports are opened with the right settings.
+ *  An input port set in the "rc" file at a buss number now taken by another
+ *  device is opened by busarray::add(), and is closed again here.
+ *
+ *  The status vectors are then rebuilt in the current buss order, so that
+ *  the next "rc" file is written to match the ports as they are now.
+ *  Without port names (an older "rc" file), nothing changes.
+ */
+
+void
+mastermidibase::remap_ports ()
+{
+    if (! m_master_clock_ports.empty())
+    {
+        std::vector<clock_e> clocks;
+        std::vector<std::string> ports;
+        for (int bus = 0; bus < m_outbus_array.count(); ++bus)
+        {
+            std::string name = get_midi_out_port(bus);
+            int saved = last_known_port(m_master_clock_ports, ports, name, bus);
+            clock_e c = saved >= 0 ? clock(saved) : e_clock_off ;
+            m_outbus_array.preset_clock(bus, c);
+            clocks.push_back(c);
+            ports.push_back(name);
+        }
+        m_master_clocks = clocks;
+        m_master_clock_ports = ports;
+    }
+    if (! m_master_input_ports.empty())
+    {
+        std::vector<bool> inputs;
+        std::vector<std::string> ports;
+        for (int bus = 0; bus < m_inbus_array.count(); ++bus)
+        {
+            std::string name = get_midi_in_port(bus);
+            int saved = last_known_port(m_master_input_ports, ports, name, bus);
+            bool flag = saved >= 0 ? input(saved) : false ;
+            m_inbus_array.preset_input(bus, flag);
+            inputs.push_back(flag);
+            ports.push_back(name);
+        }
+        m_master_inputs = inputs;
+        m_master_input_ports = ports;
+    }
+}
+
 /**
  *  Get the system-buss status for the given (legal) buss number.
  *
@@ -548,6 +927,44 @@ mastermidibase::get_midi_in_bus_name (bussbyte bus)
     return m_inbus_array.get_midi_bus_name(bus);
 }
 
+/**
+ *  Gets the name of the given output port, without the client and port
+ *  numbers, which can change from one run to the next.  This name is saved
+ *  in the "rc" file as part of the last-known port map.
+ *
+ * \param bus
+ *      Provides the output buss number.
+ *
+ * \return
+ *      Returns the "client:port" name, or an empty string if the buss number
+ *      is illegal.
+ */
+
+std::string
+mastermidibase::get_midi_out_port (bussbyte bus)
+{
+    midibus * m = m_outbus_array.bus(bus);
+    return not_nullptr(m) ? m->connect_name() : std::string() ;
+}
+
+/**
+ *  Gets the name of the given input port, as above.
+ *
+ * \param bus
+ *      Provides the input buss number.
+ *
+ * \return
+ *      Returns the "client:port" name, or an empty string if the buss number
+ *      is illegal.
+ */
+
+std::string
+mastermidibase::get_midi_in_port (bussbyte bus)
+{
+    midibus * m = m_inbus_array.bus(bus);
+    return not_nullptr(m) ? m->connect_name() : std::string() ;
+}
+
 /**
  *  Print some information about the available MIDI input and output busses.
  */
@@ -774,6 +1191,7 @@ mastermidibase::set_sequence_input (bool state, sequence * seq)
         m_seq = seq;
         m_dumping_input = state;
     }
+    update_thru();
 }
 
 /**
@@ -824,6 +1242,150 @@ mastermidibase::dump_midi_input (event ev)
     }
 }
 
+/**
+ *  Recalculates the routes of the thru router from the thru, buss, and
+ *  channel settings of the recording sequences, and the input ports that
+ *  are enabled.  Called whenever one of them changes.  The routes of each
+ *  channel are stored before the channel is marked as routed, so that an
+ *  event is never dropped by both the router and the sequence.
+ *
+ * \threadsafe
+ */
+
+void
+mastermidibase::update_thru ()
+{
+    automutex locker(m_mutex);
+    if (m_thru_router.dispatch() == thru_router::dispatch_none)
+        return;
+
+    int inputs = m_inbus_array.count();
+    for (int channel = 0; channel < SEQ64_MIDI_CHANNEL_MAX; ++channel)
+    {
+        int outchannel = 0;
+        int outbus = thru_target(channel, outchannel);
+        if (outbus < 0)
+            m_thru_router.set_routed(channel, false);
+
+        for (int bus = 0; bus < SEQ64_DEFAULT_BUSS_MAX; ++bus)
+        {
+            bool enabled = bus < inputs &&
+                m_inbus_array.get_input(bussbyte(bus));
+
+            m_thru_router.set_route
+            (
+                bus, channel, enabled ? outbus : -1, outchannel
+            );
+        }
+        if (outbus >= 0)
+            m_thru_router.set_routed(channel, true);
+    }
+}
+
+/**
+ *  Finds where the events of a channel would be echoed by the recording
+ *  sequences, following the same rules as perform::poll_cycle() and
+ *  dump_midi_input().
+ *
+ * \param channel
+ *      The channel of the incoming events.
+ *
+ * \param [out] outchannel
+ *      Receives the channel of the sequence that would echo them.
+ *
+ * \return
+ *      Returns the buss of the sequence that would echo the events, or -1
+ *      if no sequence would, or if more than one would.  In the latter case,
+ *      the sequences keep echoing the events themselves.
+ */
+
+int
+mastermidibase::thru_target (int channel, int & outchannel) const
+{
+    int result = -1;
+    int targets = 0;
+    bool ok = m_dumping_input && (m_thru_reserved & (1u << channel)) == 0;
+    if (ok)
+    {
+        size_t sz = m_filter_by_channel ? m_vector_sequence.size() : 1 ;
+        for (size_t i = 0; i < sz; ++i)
+        {
+            const sequence * s = m_filter_by_channel ?
+                m_vector_sequence[i] : m_seq ;
+
+            if (is_nullptr(s))
+                continue;
+
+            if (! s->channel_match() || s->get_midi_channel() == channel)
+            {
+                if (s->get_thru())
+                {
+                    ++targets;
+                    result = int(s->get_midi_bus());
+                    outchannel = int(s->get_midi_channel());
+                }
+                if (s->channel_match())
+                    break;
+            }
+        }
+    }
+    return targets == 1 ? result : -1 ;
+}
+
+/**
+ *  Prevents a channel from ever being routed.  Used for the channels of the
+ *  MIDI controls that perform::poll_cycle() handles while recording, which
+ *  would otherwise be forwarded from the JACK input callback before
+ *  perform could swallow them.
+ *
+ * \param channel
+ *      The channel to reserve.
+ */
+
+void
+mastermidibase::reserve_thru_channel (int channel)
+{
+    automutex locker(m_mutex);
+    if (channel >= 0 && channel < SEQ64_MIDI_CHANNEL_MAX)
+        m_thru_reserved |= 1u << channel;
+
+    update_thru();
+}
+
+/**
+ *  Forwards an event just read by get_midi_event() to its thru route, if
+ *  any, and if the backend uses thru_router::dispatch_input.  Called by
+ *  perform::poll_cycle() on the input thread, before the event is
+ *  time-stamped and handed to the sequences, so that the echo does not wait
+ *  for them, nor for the output thread.
+ *
+ * \param ev
+ *      The event, with its channel still in the status byte.
+ *
+ * \return
+ *      Returns true if the event was forwarded.
+ */
+
+bool
+mastermidibase::forward_thru (const event & ev)
+{
+    bool result = false;
+    if (m_thru_router.dispatch() == thru_router::dispatch_input)
+    {
+        bussbyte bus = 0;
+        midibyte channel = 0;
+        if (m_thru_router.route(m_input_bus, ev.get_status(), bus, channel))
+        {
+            event e = ev;
+            e.set_status(e.get_status());       /* clear the channel nybble */
+            play(bus, &e, channel);
+            flush();
+            result = true;
+        }
+    }
+    return result;
+}
+
 }           // namespace seq64
 
 /*
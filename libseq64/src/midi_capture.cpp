@@ -0,0 +1,356 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          midi_capture.cpp
+ *
+ *  This module defines the sink that records the master buss output.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-05
+ * \updates       2023-03-05
+ * \license       GNU GPLv2 or above
+ *
+ *  The file writer is deliberately simple:  it writes exactly what was
+ *  captured, with no running status, one track per buss that was used, plus a
+ *  conductor track holding the tempo changes.  It does not need a perform or
+ *  sequence object, unlike the midifile class.
+ */
+
+#include <fstream>                      /* std::ofstream                    */
+
+#include "calculations.hpp"             /* seq64::tempo_us_from_bpm(), etc. */
+#include "midi_capture.hpp"             /* seq64::midi_capture              */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Appends a MIDI variable-length value to a byte vector.
+ *
+ * \param track
+ *      The destination.
+ *
+ * \param v
+ *      The value to encode.
+ */
+
+static void
+add_variable (std::vector<midibyte> & track, midipulse v)
+{
+    unsigned long value = (unsigned long)(v);
+    unsigned long buffer = value & 0x7F;
+    while ((value >>= 7) > 0)
+    {
+        buffer <<= 8;
+        buffer |= ((value & 0x7F) | 0x80);
+    }
+    for (;;)
+    {
+        track.push_back(midibyte(buffer & 0xFF));
+        if (buffer & 0x80)
+            buffer >>= 8;
+        else
+            break;
+    }
+}
+
+/**
+ *  Appends a 32-bit big-endian value to a byte vector.
+ */
+
+static void
+add_long (std::vector<midibyte> & track, unsigned long v)
+{
+    track.push_back(midibyte((v >> 24) & 0xFF));
+    track.push_back(midibyte((v >> 16) & 0xFF));
+    track.push_back(midibyte((v >> 8) & 0xFF));
+    track.push_back(midibyte(v & 0xFF));
+}
+
+/**
+ *  Appends the bytes of an event, preceded by its delta time.  Tempo events
+ *  are written as Meta events, with the tempo encoded in microseconds.
+ *
+ * \param track
+ *      The destination.
+ *
+ * \param ev
+ *      The event to encode.
+ *
+ * \param deltatime
+ *      The time since the previous event of the track.
+ */
+
+static void
+add_event (std::vector<midibyte> & track, const event & ev, midipulse deltatime)
+{
+    add_variable(track, deltatime);
+    midibyte st = ev.get_status();
+    if (ev.is_tempo())
+    {
+        midibyte t[3];
+        tempo_us_to_bytes(t, int(tempo_us_from_bpm(ev.tempo())));
+        track.push_back(EVENT_MIDI_META);
+        track.push_back(EVENT_META_SET_TEMPO);
+        track.push_back(3);
+        track.push_back(t[0]);
+        track.push_back(t[1]);
+        track.push_back(t[2]);
+    }
+    else if (ev.is_ex_data())
+    {
+        const event::SysexContainer & data = ev.get_sysex();
+        track.push_back(st);
+        if (ev.is_meta())
+            track.push_back(ev.get_channel());      /* indicates meta type  */
+
+        add_variable(track, midipulse(data.size()));
+        track.insert(track.end(), data.begin(), data.end());
+    }
+    else
+    {
+        track.push_back(st | ev.get_channel());
+        track.push_back(ev.data(0));
+        if (event::is_two_byte_msg(st))
+            track.push_back(ev.data(1));
+    }
+}
+
+/**
+ *  Appends a track chunk, adding the End of Track Meta event.
+ */
+
+static void
+add_track
+(
+    std::vector<midibyte> & file,
+    std::vector<midibyte> & track,
+    midipulse lasttick,
+    midipulse endtick
+)
+{
+    add_variable(track, endtick > lasttick ? endtick - lasttick : 0);
+    track.push_back(EVENT_MIDI_META);
+    track.push_back(0x2F);                          /* End of Track         */
+    track.push_back(0);
+    file.push_back('M');
+    file.push_back('T');
+    file.push_back('r');
+    file.push_back('k');
+    add_long(file, (unsigned long)(track.size()));
+    file.insert(file.end(), track.begin(), track.end());
+}
+
+/**
+ *  Constructs a record.
+ */
+
+midi_capture::record::record (midipulse tick, bussbyte bus, const event & ev)
+ :
+    m_tick  (tick),
+    m_bus   (bus),
+    m_event (ev)
+{
+    // Empty body
+}
+
+/**
+ *  Principal constructor.
+ *
+ * \param passthrough
+ *      If true, the events are still sent to the MIDI ports.
+ */
+
+midi_capture::midi_capture (bool passthrough)
+ :
+    m_records       (),
+    m_tick          (0),
+    m_passthrough   (passthrough)
+{
+    // Empty body
+}
+
+/**
+ *  Records an event played on a buss.  Called by mastermidibase::play(),
+ *  which has the master-buss mutex locked.
+ *
+ * \param bus
+ *      The output buss.
+ *
+ * \param ev
+ *      The event to be played.
+ *
+ * \param channel
+ *      The channel of the sequence playing the event.  If it is the "null"
+ *      channel, the channel stored in the event is used, as done in
+ *      midi_container::add_event().
+ */
+
+void
+midi_capture::capture (bussbyte bus, const event & ev, midibyte channel)
+{
+    m_records.push_back(record(m_tick, bus, ev));
+    if (channel != EVENT_NULL_CHANNEL)
+        m_records.back().m_event.set_channel(channel);
+}
+
+/**
+ *  Records a SysEx message.  SysEx goes to every output buss; it is recorded
+ *  once, on buss 0.
+ */
+
+void
+midi_capture::capture_sysex (const event & ev)
+{
+    m_records.push_back(record(m_tick, 0, ev));
+}
+
+/**
+ *  Records a tempo change.
+ */
+
+void
+midi_capture::capture_tempo (midibpm bpm)
+{
+    event tempo = create_tempo_event(m_tick, bpm);
+    m_records.push_back(record(m_tick, bussbyte(SEQ64_BAD_BUSS), tempo));
+}
+
+/**
+ *  Writes the capture as a type 1 MIDI file.  Track 0 holds the tempo
+ *  changes; each buss that was used gets its own track, in buss order.
+ *
+ * \param filename
+ *      The full path to the file to write.
+ *
+ * \param ppqn
+ *      The division (PPQN) of the file.  It should match the PPQN of the
+ *      performance that was captured.
+ *
+ * \param bpm
+ *      The starting tempo, written at tick 0 of track 0.
+ *
+ * \return
+ *      Returns true if the file was written.
+ */
+
+bool
+midi_capture::write_midi_file
+(
+    const std::string & filename, int ppqn, midibpm bpm
+) const
+{
+    std::vector<bool> used(SEQ64_DEFAULT_BUSS_MAX, false);
+    midipulse endtick = 0;
+    int trackcount = 1;
+    for
+    (
+        Records::const_iterator r = m_records.begin();
+        r != m_records.end(); ++r
+    )
+    {
+        if (r->m_tick > endtick)
+            endtick = r->m_tick;
+
+        if (r->m_bus < SEQ64_DEFAULT_BUSS_MAX && ! used[r->m_bus])
+        {
+            used[r->m_bus] = true;
+            ++trackcount;
+        }
+    }
+
+    std::vector<midibyte> file;
+    file.push_back('M');
+    file.push_back('T');
+    file.push_back('h');
+    file.push_back('d');
+    add_long(file, 6);
+    file.push_back(0);                              /* format 1             */
+    file.push_back(1);
+    file.push_back(midibyte((trackcount >> 8) & 0xFF));
+    file.push_back(midibyte(trackcount & 0xFF));
+    file.push_back(midibyte((ppqn >> 8) & 0x7F));
+    file.push_back(midibyte(ppqn & 0xFF));
+
+    std::vector<midibyte> track;
+    midipulse lasttick = 0;
+    add_event(track, create_tempo_event(0, bpm), 0);
+    for
+    (
+        Records::const_iterator r = m_records.begin();
+        r != m_records.end(); ++r
+    )
+    {
+        if (r->m_bus == bussbyte(SEQ64_BAD_BUSS))
+        {
+            add_event(track, r->m_event, r->m_tick - lasttick);
+            lasttick = r->m_tick;
+        }
+    }
+    add_track(file, track, lasttick, endtick);
+    for (int bus = 0; bus < SEQ64_DEFAULT_BUSS_MAX; ++bus)
+    {
+        if (! used[bus])
+            continue;
+
+        track.clear();
+        lasttick = 0;
+        for
+        (
+            Records::const_iterator r = m_records.begin();
+            r != m_records.end(); ++r
+        )
+        {
+            if (r->m_bus == bussbyte(bus))
+            {
+                add_event(track, r->m_event, r->m_tick - lasttick);
+                lasttick = r->m_tick;
+            }
+        }
+        add_track(file, track, lasttick, endtick);
+    }
+
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+    bool result = out.is_open();
+    if (result)
+    {
+        out.write((const char *)(&file[0]), std::streamsize(file.size()));
+        result = out.good();
+    }
+    else
+    {
+        std::string msg = "could not open for writing: " + filename;
+        errprint(msg.c_str());
+    }
+
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * midi_capture.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-10-10
- * \updates       2021-05-09
+ * \updates       2023-03-26
  * \license       GNU GPLv2 or above
  *
  *  This class is important when writing the MIDI and sequencer data out to a
@@ -543,8 +543,12 @@ midi_container::song_fill_seq_event
     for (int p = 0; p <= times_played; ++p)
     {
         midipulse delta_time = 0;
-        event_list::Events::iterator i;
-        for (i = m_sequence.events().begin(); i != m_sequence.events().end(); ++i)
+        event_list::const_iterator i;
+        for
+        (
+            i = m_sequence.events().cbegin();
+            i != m_sequence.events().cend(); ++i
+        )
         {
             event e = DREF(i);                      /* must use a copy      */
             midipulse timestamp = e.get_timestamp() + timestamp_adjust;
@@ -721,7 +725,7 @@ midi_container::song_fill_seq_trigger
 void
 midi_container::fill (int track, const perform & p, bool doseqspec)
 {
-    event_list evl = m_sequence.events();           /* used below */
+    event_list evl = m_sequence.events();           /* shared, not copied */
     evl.sort();
     if (doseqspec)
         fill_seq_number(track);
@@ -748,7 +752,7 @@ midi_container::fill (int track, const perform & p, bool doseqspec)
     midipulse timestamp = 0;
     midipulse deltatime = 0;
     midipulse prevtimestamp = 0;
-    for (event_list::iterator i = evl.begin(); i != evl.end(); ++i)
+    for (event_list::const_iterator i = evl.cbegin(); i != evl.cend(); ++i)
     {
         const event & er = DREF(i);
         timestamp = er.get_timestamp();
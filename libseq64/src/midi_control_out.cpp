@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Igor Angst
  * \date          2018-03-28
- * \updates       2019-06-09
+ * \updates       2023-03-19
  * \license       GNU GPLv2 or above
  *
  * The class contained in this file encapsulates most of the functionality to
@@ -36,6 +36,7 @@
 
 #include <sstream>                      /* std::ostringstream class         */
 
+#include "daemonize.hpp"                /* seq64::millisleep()              */
 #include "midi_control_out.hpp"         /* seq64::midi_control_out class    */
 
 /*
@@ -45,6 +46,29 @@
 namespace seq64
 {
 
+/**
+ *  The value of a slot in m_desired or m_sent that holds no state.
+ */
+
+static const int s_no_state = -1;
+
+/**
+ *  For each action, the bits of the actions it replaces if they are still
+ *  waiting to be sent, itself included.  Play, stop, and pause form one
+ *  group; each on/off or store/restore pair forms another.
+ */
+
+static const unsigned s_action_groups[midi_control_out::action_max] =
+{
+    0x0007, 0x0007, 0x0007,                 /* play, stop, pause            */
+    0x0018, 0x0018,                         /* queue on, off                */
+    0x0060, 0x0060,                         /* oneshot on, off              */
+    0x0180, 0x0180,                         /* replace on, off              */
+    0x0600, 0x0600,                         /* snap1 store, restore         */
+    0x1800, 0x1800,                         /* snap2 store, restore         */
+    0x6000, 0x6000                          /* learn on, off                */
+};
+
 midi_control_out::midi_control_out ()
  :
     m_master_bus        (nullptr),
@@ -53,11 +77,38 @@ midi_control_out::midi_control_out ()
     m_events            (),             /* [action_max] vector              */
     m_is_blank          (true),
     m_screenset_size    (0),
-    m_screenset_offset  (0)
+    m_screenset_offset  (0),
+    m_desired           (),
+    m_sent              (),
+    m_pending_actions   (0),
+    m_pending           (false),
+    m_wake              (),
+    m_running           (false),
+    m_feedback_thread   (),
+    m_feedback_launched (false)
 {
     initialize(SEQ64_DEFAULT_SET_SIZE);
 }
 
+/**
+ *  Stops the feedback thread, which first sends whatever is still pending,
+ *  such as the "delete" messages of perform::announce_exit().  The master
+ *  bus must still exist.
+ */
+
+midi_control_out::~midi_control_out ()
+{
+    if (m_feedback_launched)
+    {
+        m_wake.lock();
+        m_running = false;
+        m_wake.signal();
+        m_wake.unlock();
+        pthread_join(m_feedback_thread, NULL);
+        m_feedback_launched = false;
+    }
+}
+
 /**
  *  Reinitializes an empty set of MIDI-control-out values.  It first clears any
  *  existing values from the vectors.
@@ -105,7 +156,191 @@ midi_control_out::initialize (int count, int buss)
             m_events[a] = apt;
     }
     else
+    {
         m_screenset_size = 0;
+        count = 0;
+    }
+
+    std::vector<std::atomic<int>> desired(count);
+    for (int c = 0; c < count; ++c)
+        desired[c].store(s_no_state);
+
+    m_desired.swap(desired);
+    m_sent.assign(count, s_no_state);
+    m_pending_actions.store(0);
+}
+
+/**
+ *  Sets the master bus, and starts the feedback thread the first time a bus
+ *  is provided.  Both this function and initialize() are called while
+ *  setting up, before any feedback is sent.
+ *
+ * \param mmbus
+ *      The master bus that the feedback goes to.
+ */
+
+void
+midi_control_out::set_master_bus (mastermidibus * mmbus)
+{
+    m_master_bus = mmbus;
+    if (not_nullptr(mmbus) && ! m_feedback_launched)
+    {
+        m_running = true;
+        int err = pthread_create
+        (
+            &m_feedback_thread, NULL, feedback_func, this
+        );
+        if (err == 0)
+            m_feedback_launched = true;
+        else
+        {
+            m_running = false;
+            errprint("failed to launch MIDI control-out thread");
+        }
+    }
+}
+
+/**
+ *  Tells the feedback thread that there is something to send.  The lock is
+ *  taken only by the first change after the thread has picked up the
+ *  previous ones, so a burst of changes takes it once.
+ */
+
+void
+midi_control_out::wake ()
+{
+    if (! m_pending.exchange(true))
+    {
+        m_wake.lock();
+        m_wake.signal();
+        m_wake.unlock();
+    }
+}
+
+/**
+ *  Sends one event to the control-out buss, without flushing.  Called only
+ *  by the feedback thread.
+ *
+ * \param ev
+ *      The event to send.
+ */
+
+void
+midi_control_out::play (const event & ev)
+{
+    if (not_nullptr(m_master_bus))
+    {
+        event e = ev;
+        m_master_bus->play(m_buss, &e, e.get_channel());
+    }
+}
+
+/**
+ *  Sends one period's worth of feedback:  the pending non-sequence actions,
+ *  then each slot whose wanted state differs from the one last sent, up to
+ *  the budget.  The buss is flushed once, if anything was sent.
+ *
+ * \param budget
+ *      The most messages to send.
+ *
+ * \return
+ *      Returns true if the budget ran out before all of the slots were
+ *      handled.  m_pending is then left set, for the next period.
+ */
+
+bool
+midi_control_out::send_frame (int budget)
+{
+    m_pending.store(false);
+    int sent = 0;
+    unsigned actions = m_pending_actions.exchange(0);
+    for (int a = 0; a < action_max && actions != 0; ++a)
+    {
+        unsigned bit = 1U << a;
+        if ((actions & bit) != 0)
+        {
+            actions &= ~bit;
+            play(m_events[a].apt_action_event);
+            ++sent;
+        }
+    }
+
+    bool result = false;
+    int count = int(m_sent.size());
+    for (int seq = 0; seq < count; ++seq)
+    {
+        int want = m_desired[seq].load();
+        if (want != s_no_state && want != m_sent[seq])
+        {
+            if (sent >= budget)
+            {
+                result = true;
+                break;
+            }
+            if (m_seq_events[seq][want].apt_action_status)
+            {
+#ifdef PLATFORM_DEBUG_TMI
+                std::string act = seq_action_to_string(seq_action(want));
+                printf("send_seq_event(%s): slot %d\n", act.c_str(), seq);
+#endif
+                play(m_seq_events[seq][want].apt_action_event);
+                ++sent;
+            }
+            m_sent[seq] = want;
+        }
+    }
+    if (sent > 0 && not_nullptr(m_master_bus))
+        m_master_bus->flush();
+
+    if (result)
+        m_pending.store(true);
+
+    return result;
+}
+
+/**
+ *  The loop of the feedback thread.  It sleeps until there is something to
+ *  send, sends it, then waits out the rest of the period, so that the
+ *  first change is sent at once, and the changes that follow it within the
+ *  period are sent together.  When stopped, it sends what is pending
+ *  before exiting.
+ */
+
+void
+midi_control_out::run ()
+{
+    for (;;)
+    {
+        m_wake.lock();
+        while (m_running && ! m_pending.load())
+            m_wake.wait();
+
+        bool running = m_running;
+        m_wake.unlock();
+        if (! running && ! m_pending.load())
+            break;
+
+        (void) send_frame(SEQ64_CTRL_OUT_MAX_BURST);
+        (void) millisleep(SEQ64_CTRL_OUT_FRAME_MS);
+    }
+}
+
+/**
+ *  The thread function of the feedback thread.
+ *
+ * \param mco
+ *      The midi_control_out object.
+ *
+ * \return
+ *      Always returns the null pointer.
+ */
+
+void *
+midi_control_out::feedback_func (void * mco)
+{
+    midi_control_out * self = (midi_control_out *) mco;
+    self->run();
+    return nullptr;
 }
 
 /**
@@ -209,29 +444,13 @@ action_to_string (midi_control_out::action a)
  */
 
 void
-midi_control_out::send_seq_event (int seq, seq_action what, bool flush)
+midi_control_out::send_seq_event (int seq, seq_action what)
 {
     seq -= m_screenset_offset;      // adjust relative to current screen-set
-    if (seq >= 0 && seq < screenset_size())
+    if (seq >= 0 && seq < screenset_size() && what < seq_action_max)
     {
-        if (m_seq_events[seq][what].apt_action_status)
-        {
-            event ev = m_seq_events[seq][what].apt_action_event;
-            if (not_nullptr(m_master_bus))
-            {
-#ifdef PLATFORM_DEBUG_TMI
-                std::string act = seq_action_to_string(what);
-                std::string evstring = to_string(ev);
-                printf
-                (
-                    "send_seq_event(%s): %s\n", act.c_str(), evstring.c_str()
-                );
-#endif
-                m_master_bus->play(m_buss, &ev, ev.get_channel());
-                if (flush)
-                    m_master_bus->flush();
-            }
-        }
+        m_desired[seq].store(int(what));
+        wake();
     }
 }
 
@@ -244,10 +463,7 @@ void
 midi_control_out::clear_sequences ()
 {
     for (int seq = 0; seq < screenset_size(); ++seq)
-        send_seq_event(seq, midi_control_out::seq_action_delete, false);
-
-    if (not_nullptr(m_master_bus))
-        m_master_bus->flush();
+        send_seq_event(seq + m_screenset_offset, seq_action_delete);
 }
 
 /**
@@ -316,20 +532,17 @@ midi_control_out::send_event (action what)
 {
     if (event_is_active(what))
     {
-        event ev = m_events[what].apt_action_event;
-        if (not_nullptr(m_master_bus))
+        unsigned bit = 1U << what;
+        unsigned keep = ~s_action_groups[what];
+        unsigned old = m_pending_actions.load();
+        while
+        (
+            ! m_pending_actions.compare_exchange_weak(old, (old & keep) | bit)
+        )
         {
-#ifdef PLATFORM_DEBUG_TMI
-                std::string act = action_to_string(what);
-                std::string evstring = to_string(ev);
-                printf
-                (
-                    "send_event(%s): %s\n", act.c_str(), evstring.c_str()
-                );
-#endif
-            m_master_bus->play(m_buss, &ev, ev.get_channel());
-            m_master_bus->flush();
+            // Retry with the updated value of old
         }
+        wake();
     }
 }
 
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-11-24
- * \updates       2018-08-05
+ * \updates       2023-03-27
  * \license       GNU GPLv2 or above
  *
  *  We have recently updated this module to put Set Tempo events into the
@@ -153,6 +153,24 @@ midi_splitter::log_main_sequence (sequence & seq, int seqnum)
  *  one channel it contains.  In fact, we just want to keep it in pattern slot
  *  number 16, to keep it out of the way.
  *
+ *  The SMF 0 track is walked only once.  Each event is appended, unsorted,
+ *  to the sequence of its channel; an event with no channel, or a SysEx
+ *  event, to every sequence; and a Meta event to the channel 0 sequence
+ *  only.  Walking the track once per channel, and adding each event with
+ *  add_event(), which sorts the sequence every time, made loading a large
+ *  SMF 0 file very slow.  Since the track is already sorted (see
+ *  log_main_sequence()), sorting and linking each sequence once at the end
+ *  gives the same order of events.
+ *
+ *  Note that the events that are read from the MIDI file have delta times.
+ *  Sequencer64 converts these delta times to cumulative times.    We
+ *  need to preserve that here.  Conversion back to delta times is needed only
+ *  when saving the sequences to a file.  This is done in
+ *  midi_container::fill().
+ *
+ *  Luckily, we don't have to worry about copying triggers, since the imported
+ *  SMF 0 track won't have any Seq24/Sequencer24 triggers.
+ *
  * \param p
  *      Provides a reference to the perform object into which sequences/tracks
  *      are to be added.
@@ -173,90 +191,111 @@ bool
 midi_splitter::split (perform & p, int screenset, int ppqn)
 {
     bool result = not_nullptr(m_smf0_main_sequence);
-    if (result)
+    if (result && m_smf0_channels_count > 0)
     {
-        if (m_smf0_channels_count > 0)
+        const sequence & main_seq = *m_smf0_main_sequence;
+        sequence * seqs[SEQ64_MIDI_CHANNEL_MAX];
+        midipulse lengths[SEQ64_MIDI_CHANNEL_MAX];
+        bool added[SEQ64_MIDI_CHANNEL_MAX];
+        for (int chan = 0; chan < SEQ64_MIDI_CHANNEL_MAX; ++chan)
         {
-            int seqnum = screenset * usr().seqs_in_set();
-            for (int chan = 0; chan < SEQ64_MIDI_CHANNEL_MAX; ++chan, ++seqnum)
+            seqs[chan] = nullptr;
+            lengths[chan] = 0;
+            added[chan] = false;
+            if (m_smf0_channels[chan])
             {
-                if (m_smf0_channels[chan])
+                /*
+                 * The master MIDI buss must be set before the split,
+                 * otherwise the null pointer causes a segfault.
+                 */
+
+                seqs[chan] = new sequence(ppqn);
+                seqs[chan]->set_master_midi_bus(&p.master_bus());
+                setup_channel(main_seq, *seqs[chan], chan);
+            }
+        }
+
+        const event_list & evl = main_seq.events();
+        for (event_list::const_iterator i = evl.begin(); i != evl.end(); ++i)
+        {
+            const event & er = DREF(i);
+            midipulse ts = er.get_timestamp();
+            int first = 0;                      /* channels to append to    */
+            int last = SEQ64_MIDI_CHANNEL_MAX - 1;
+            if (er.is_ex_data())
+            {
+                if (! er.is_sysex())
+                    last = 0;                   /* Meta events: channel 0   */
+            }
+            else if (er.get_channel() != EVENT_NULL_CHANNEL)
+            {
+                first = last = er.get_channel();
+                if (last >= SEQ64_MIDI_CHANNEL_MAX)
+                    continue;
+            }
+            for (int chan = first; chan <= last; ++chan)
+            {
+                if (not_nullptr(seqs[chan]))
                 {
-                    /*
-                     * The master MIDI buss must be set before the split,
-                     * otherwise the null pointer causes a segfault.
-                     */
+                    lengths[chan] = ts;         /* the last logged event    */
+                    if (seqs[chan]->append_event(er))
+                        added[chan] = true;
+                }
+            }
+        }
+
+        int seqnum = screenset * usr().seqs_in_set();
+        for (int chan = 0; chan < SEQ64_MIDI_CHANNEL_MAX; ++chan, ++seqnum)
+        {
+            sequence * s = seqs[chan];
+            if (is_nullptr(s))
+                continue;
 
-                    sequence * s = new sequence(ppqn);
-                    s->set_master_midi_bus(&p.master_bus());
-                    if (split_channel(*m_smf0_main_sequence, s, chan))
-                    {
-                        p.add_sequence(s, seqnum);
+            if (added[chan])
+            {
+                s->sort_events();
+                s->set_length(lengths[chan]);   /* verify_and_link() too    */
+                s->set_dirty();
+                p.add_sequence(s, seqnum);
 #ifdef SEQ64_USE_DEBUG_OUTPUT
-                        s->show_events();
+                s->show_events();
 #endif
-                    }
-                    else
-                        delete s;   /* empty sequence, not even meta events */
-                }
             }
-            m_smf0_main_sequence->set_midi_channel(EVENT_NULL_CHANNEL);
-            p.add_sequence(m_smf0_main_sequence, seqnum);
+            else
+                delete s;       /* empty sequence, not even meta events */
         }
+        m_smf0_main_sequence->set_midi_channel(EVENT_NULL_CHANNEL);
+        p.add_sequence(m_smf0_main_sequence, seqnum);
     }
     return result;
 }
 
 /**
- *  This function splits the given sequence into a new sequence, for the given
- *  channel found in the SMF 0 track.  It is called for each possible channel,
- *  resulting in multiple passes over the SMF 0 track.
- *
- *  Note that the events that are read from the MIDI file have delta times.
- *  Sequencer64 converts these delta times to cumulative times.    We
- *  need to preserve that here.  Conversion back to delta times is needed only
- *  when saving the sequences to a file.  This is done in
- *  midi_container::fill().
- *
- *  We have to accumulate the delta times in order to be able to set the
- *  length of the sequence in pulses.
- *
- *  Luckily, we don't have to worry about copying triggers, since the imported
- *  SMF 0 track won't have any Seq24/Sequencer24 triggers.
+ *  Sets up a new sequence for the given channel found in the SMF 0 track:
+ *  its name, channel, and buss.  The events are added by split().
  *
  *  It doesn't set the sequence number of the sequence; that is set when the
  *  sequence is added to the perform object.
  *
  * \param main_seq
  *      This parameter is the whole SMF 0 track that was read from the MIDI
- *      file.  It contains all of the channel data that needs to be split into
- *      separate sequences.
+ *      file.
  *
  * \param s
- *      Provides the new sequence that needs to have its settings made, and
- *      all of the selected channel events added to it.
+ *      Provides the new sequence that needs to have its settings made.
  *
  * \param channel
- *      Provides the MIDI channel number (re 0) that marks the channel data
- *      the needs to be extracted and added to the new sequence.  If this
- *      channel is 0, then we need to add certain Meta events to this
- *      sequence, as well.  So far we support only Tempo Meta events.
- *
- * \return
- *      Returns true if at least one event got added.   If none were added,
- *      the caller should delete the sequence object represented by parameter
- *      \a s.
+ *      Provides the MIDI channel number (re 0) of the new sequence.
  */
 
-bool
-midi_splitter::split_channel
+void
+midi_splitter::setup_channel
 (
     const sequence & main_seq,
-    sequence * s,
+    sequence & s,
     int channel
 )
 {
-    bool result = false;
     char tmp[32];
     if (main_seq.name().empty())
     {
@@ -270,41 +309,10 @@ midi_splitter::split_channel
         );
     }
 
-    s->set_name(std::string(tmp));
-    s->set_midi_channel(channel);
-    s->set_midi_bus(main_seq.get_midi_bus());
-    s->zero_markers();
-
-    midipulse length_in_ticks = 0;      /* an accumulator of delta times    */
-    const event_list & evl = main_seq.events();
-    for (event_list::const_iterator i = evl.begin(); i != evl.end(); ++i)
-    {
-        const event & er = DREF(i);
-        if (er.is_ex_data())
-        {
-            if (channel == 0 || er.is_sysex())
-            {
-                length_in_ticks = er.get_timestamp();
-                if (s->add_event(er))
-                    result = true;      /* an event got added               */
-            }
-        }
-        else if (er.check_channel(channel))
-        {
-            length_in_ticks = er.get_timestamp();
-            if (s->add_event(er))
-                result = true;          /* an event got added               */
-        }
-    }
-
-    /*
-     * No triggers to add.  Whew!  And setting the length is now a no-brainer,
-     * since the tick value is that of the last logged event in the sequence.
-     */
-
-    s->set_length(length_in_ticks);
-    s->sort_events();
-    return result;
+    s.set_name(std::string(tmp));
+    s.set_midi_channel(channel);
+    s.set_midi_bus(main_seq.get_midi_bus());
+    s.zero_markers();
 }
 
 }           // namespace seq64
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-11-25
- * \updates       2018-09-12
+ * \updates       2023-03-23
  * \license       GNU GPLv2 or above
  *
  *  This file provides a cross-platform implementation of MIDI support.
@@ -462,7 +462,11 @@ midibase::poll_for_midi ()
 }
 
 /**
- *  Obtains a MIDI event.
+ *  Obtains a MIDI event.  Until perform::poll_cycle() replaces it with a
+ *  tick, the timestamp of an input event is its input delay:  the number of
+ *  microseconds since the event arrived, as measured by the backend (0 if
+ *  the backend cannot tell).  Here, the configured latency of this buss is
+ *  added to that delay.
  *
  * \param inev
  *      Points the event to be filled with the MIDI event data.
@@ -475,7 +479,14 @@ midibase::poll_for_midi ()
 bool
 midibase::get_midi_event (event * inev)
 {
-    return api_get_midi_event(inev);
+    bool result = api_get_midi_event(inev);
+    if (result)
+    {
+        int latency = rc().input_latency(get_bus_index());
+        if (latency > 0)
+            inev->set_timestamp(inev->get_timestamp() + latency);
+    }
+    return result;
 }
 
 /**
@@ -577,6 +588,34 @@ midibase::play (event * e24, midibyte channel)
     api_play(e24, channel);
 }
 
+/**
+ *  Like play(), but the event is queued by the API, to be sent after the
+ *  given delay.  See mastermidibase::play_ahead().
+ *
+ * \threadsafe
+ *
+ * \param e24
+ *      The event to be played on this bus.
+ *
+ * \param channel
+ *      The channel of the playback.
+ *
+ * \param delayus
+ *      The time from now at which the event is due, in microseconds.  It
+ *      is 0 or less for an event that is already due.
+ *
+ * \param tag
+ *      Marks the event, so that the events of one pattern can be removed
+ *      from the queue.
+ */
+
+void
+midibase::play_at (event * e24, midibyte channel, long delayus, int tag)
+{
+    automutex locker(m_mutex);
+    api_play_at(e24, channel, delayus, tag);
+}
+
 /**
  *  Takes a native SYSEX event, encodes it to an ALSA event, and then
  *  puts it in the queue.
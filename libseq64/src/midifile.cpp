@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2021-05-09
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  For a quick guide to the MIDI format, see, for example:
@@ -73,6 +73,7 @@
 #include "midi_vector.hpp"              /* seq64::midi_vector container     */
 #include "sequence.hpp"                 /* seq64::sequence                  */
 #include "settings.hpp"                 /* seq64::rc() and choose_ppqn()    */
+#include "song_snapshot.hpp"            /* seq64::song_snapshot             */
 #include "wrkfile.hpp"                  /* seq64::wrkfile class             */
 
 /*
@@ -561,6 +562,9 @@ midifile::parse (perform & p, int screenset, bool importing)
         }
         if (result && screenset != 0)
              p.modify();                            /* modification flag    */
+
+        if (result)
+            (void) p.share_duplicate_patterns();    /* identical patterns   */
     }
     return result;
 }
@@ -2162,9 +2166,8 @@ midifile::prop_item_size (long data_length) const
  *  Write the whole MIDI data and Seq24 information out to the file.
  *  Also see the write_song() function, for exporting to standard MIDI.
  *
- *  Sequencer64 sometimes reverses the order of some events, due to popping
- *  from its container.  Not an issue, but can make a file slightly different
- *  for no reason.
+ *  The song is first copied into a song_snapshot, which locks each pattern
+ *  only while it is copied, then the snapshot is written.
  *
  * \param p
  *      Provides the object that will contain and manage the entire
@@ -2183,6 +2186,37 @@ midifile::prop_item_size (long data_length) const
 
 bool
 midifile::write (perform & p, bool doseqspec)
+{
+    song_snapshot snap(p);
+    bool result = write(snap, doseqspec);
+    if (result)
+        p.is_modified(false);           /* it worked, tell perform about it */
+
+    return result;
+}
+
+/**
+ *  Write a snapshot of the song out to the file.  This function does not
+ *  touch the performance the snapshot was taken from, so it can be called
+ *  on any thread (see the autosaver class).
+ *
+ *  Sequencer64 sometimes reverses the order of some events, due to popping
+ *  from its container.  Not an issue, but can make a file slightly different
+ *  for no reason.
+ *
+ * \param snap
+ *      Provides the copy of the song to be written.
+ *
+ * \param doseqspec
+ *      If true (the default), the SeqSpec sections are written to the file.
+ *
+ * \return
+ *      Returns true if the write operations succeeded.  If false is returned,
+ *      then m_error_message will contain a description of the error.
+ */
+
+bool
+midifile::write (const song_snapshot & snap, bool doseqspec)
 {
     automutex locker(m_mutex);
     bool result = m_ppqn >= SEQ64_MINIMUM_PPQN && m_ppqn <= SEQ64_MAXIMUM_PPQN;
@@ -2190,14 +2224,10 @@ midifile::write (perform & p, bool doseqspec)
     if (! result)
         m_error_message = "Error, invalid PPQN for MIDI file to write";
 
+    const song_snapshot::Tracks & tracks = snap.tracks();
     if (result)
     {
-        int numtracks = 0;
-        for (int i = 0; i < p.sequence_high(); ++i)
-        {
-            if (p.is_active(i))
-                ++numtracks;             /* count number of active tracks   */
-        }
+        int numtracks = int(tracks.size());     /* the active tracks        */
         result = numtracks > 0;
         if (result)
         {
@@ -2217,39 +2247,30 @@ midifile::write (perform & p, bool doseqspec)
     }
 
     /*
-     * Write out the active tracks.  The value of c_max_sequence is 1024.
-     * Note that we don't need to check the sequence pointer.
+     * Write out the active tracks, in order of their pattern numbers.
      */
 
     if (result)
     {
-        for (int track = 0; track < p.sequence_high(); ++track)
+        song_snapshot::Tracks::const_iterator t;
+        for (t = tracks.begin(); t != tracks.end(); ++t)
         {
-            if (p.is_active(track))
-            {
-                sequence * s = p.get_sequence(track);
-                if (not_nullptr(s))
-                {
-                    sequence & seq = *s;
-                    midi_vector lst(seq);
+            midi_vector lst(*t->tr_sequence);
 
-                    /*
-                     * midi_container::fill() also handles the time-signature
-                     * and tempo meta events, if they are not part of the
-                     * file's MIDI data.  All the events are put into the
-                     * container, and then the container's bytes are written
-                     * out below.
-                     */
+            /*
+             * midi_container::fill() also handles the time-signature and
+             * tempo meta events, if they are not part of the file's MIDI
+             * data.  All the events are put into the container, and then
+             * the container's bytes are written out below.
+             */
 
-                    lst.fill(track, p, doseqspec);
-                    write_track(lst);
-                }
-            }
+            lst.fill(t->tr_number, snap.performance(), doseqspec);
+            write_track(lst);
         }
     }
     if (result && doseqspec)
     {
-        result = write_proprietary_track(p);
+        result = write_proprietary_track(snap);
         if (! result)
             m_error_message = "Error, could not write SeqSpec track";
     }
@@ -2277,9 +2298,6 @@ midifile::write (perform & p, bool doseqspec)
             result = false;
         }
     }
-    if (result)
-        p.is_modified(false);           /* it worked, tell perform about it */
-
     return result;
 }
 
@@ -2498,9 +2516,8 @@ midifile::write_song (perform & p)
  *  We need a way to make the group mute data optional.  Why write 4096 bytes
  *  of zeroes?
  *
- * \param p
- *      Provides the object that will contain and manage the entire
- *      performance.
+ * \param snap
+ *      Provides the copy of the song whose settings are written.
  *
  * \return
  *      Always returns true.  No efficient way to check all of the writes that
@@ -2508,13 +2525,13 @@ midifile::write_song (perform & p)
  */
 
 bool
-midifile::write_proprietary_track (perform & p)
+midifile::write_proprietary_track (const song_snapshot & snap)
 {
     long tracklength = 0;
     int cnotesz = 2;                            /* first value is short     */
     for (int s = 0; s < c_max_sets; ++s)
     {
-        const std::string & note = p.get_screenset_notepad(s);
+        const std::string & note = snap.notepad(s);
         cnotesz += 2 + note.length();           /* short + note length      */
     }
 
@@ -2523,7 +2540,7 @@ midifile::write_proprietary_track (perform & p)
     int gmutesz = 4 + groupcount * (4 + seqsinset * 4);
     if (! rc().legacy_format())
     {
-        if (! p.any_group_unmutes())
+        if (! snap.any_group_unmutes())
             gmutesz = 0;
     }
     if (m_new_format)                           /* calculate track size     */
@@ -2563,7 +2580,7 @@ midifile::write_proprietary_track (perform & p)
     write_short(c_max_sets);                    /* data, not a tag          */
     for (int s = 0; s < c_max_sets; ++s)        /* see "cnotesz" calc       */
     {
-        const std::string & note = p.get_screenset_notepad(s);
+        const std::string & note = snap.notepad(s);
         write_short(note.length());
         for (unsigned n = 0; n < unsigned(note.length()); ++n)
             write_byte(note[n]);
@@ -2576,7 +2593,7 @@ midifile::write_proprietary_track (perform & p)
      *  We should probably sanity-check the BPM at some point.
      */
 
-    long scaled_bpm = long(p.get_beats_per_minute() * SEQ64_BPM_SCALE_FACTOR);
+    long scaled_bpm = long(snap.beats_per_minute() * SEQ64_BPM_SCALE_FACTOR);
     write_long(scaled_bpm);                     /* 4 bytes                  */
     if (gmutesz > 0)
     {
@@ -2591,10 +2608,9 @@ midifile::write_proprietary_track (perform & p)
         write_long(c_max_sequence);                 /* data, not a tag      */
         for (int j = 0; j < seqsinset; ++j)         /* now is optional      */
         {
-            p.select_group_mute(j);
             write_long(j);
             for (int i = 0; i < seqsinset; ++i)
-                write_long(p.get_group_mute_state(i));
+                write_long(snap.group_mute_state(j, i));
         }
     }
     if (m_new_format)                           /* write beginning of track */
@@ -2602,18 +2618,18 @@ midifile::write_proprietary_track (perform & p)
         if (m_global_bgsequence)
         {
             write_prop_header(c_musickey, 1);               /* control tag+1 */
-            write_byte(midibyte(usr().seqedit_key()));      /* key change    */
+            write_byte(midibyte(snap.musical_key()));       /* key change    */
             write_prop_header(c_musicscale, 1);             /* control tag+1 */
-            write_byte(midibyte(usr().seqedit_scale()));    /* scale change  */
+            write_byte(midibyte(snap.musical_scale()));     /* scale change  */
             write_prop_header(c_backsequence, 4);           /* control tag+4 */
-            write_long(long(usr().seqedit_bgsequence()));   /* background    */
+            write_long(long(snap.background_sequence()));   /* background    */
         }
         write_prop_header(c_perf_bp_mes, 4);                /* control tag+4 */
-        write_long(long(p.get_beats_per_bar()));            /* perfedit BPM  */
+        write_long(long(snap.beats_per_bar()));             /* perfedit BPM  */
         write_prop_header(c_perf_bw, 4);                    /* control tag+4 */
-        write_long(long(p.get_beat_width()));               /* perfedit BW   */
+        write_long(long(snap.beat_width()));                /* perfedit BW   */
         write_prop_header(c_tempo_track, 4);                /* control tag+4 */
-        write_long(long(p.get_tempo_track_number()));       /* perfedit BW   */
+        write_long(long(snap.tempo_track()));               /* perfedit BW   */
         write_track_end();
     }
     return true;
@@ -24,12 +24,14 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-09-03
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  Sequencer64 needs a mutex for sequencer operations.
  */
 
+#include <time.h>                       /* clock_gettime()                  */
+
 #include "platform_macros.h"
 #include "mutex.hpp"
 
@@ -119,6 +121,16 @@ condition_var::signal ()
     pthread_cond_signal(&m_cond);
 }
 
+/**
+ *  Signals the condition variable to all of the threads waiting on it.
+ */
+
+void
+condition_var::broadcast ()
+{
+    pthread_cond_broadcast(&m_cond);
+}
+
 /**
  *  Waits for the condition variable.
  */
@@ -129,6 +141,32 @@ condition_var::wait ()
     pthread_cond_wait(&m_cond, &m_mutex_lock);
 }
 
+/**
+ *  Waits for the condition variable, but no longer than the given time.
+ *  Like wait(), it must be called with the mutex locked.
+ *
+ * \param ms
+ *      The longest time to wait, in milliseconds.
+ *
+ * \return
+ *      Returns false if the time ran out before a signal came.
+ */
+
+bool
+condition_var::timed_wait (int ms)
+{
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);      /* the clock of m_cond      */
+    until.tv_sec += ms / 1000;
+    until.tv_nsec += long(ms % 1000) * 1000000L;
+    if (until.tv_nsec >= 1000000000L)
+    {
+        until.tv_nsec -= 1000000000L;
+        ++until.tv_sec;
+    }
+    return pthread_cond_timedwait(&m_cond, &m_mutex_lock, &until) == 0;
+}
+
 }           // namespace seq64
 
 /*
@@ -0,0 +1,197 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          offline_render.cpp
+ *
+ *  This module defines the faster-than-real-time song renderer.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-05
+ * \updates       2023-03-05
+ * \license       GNU GPLv2 or above
+ *
+ *  See offline_render.hpp for an overview.
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+
+#include "offline_render.hpp"           /* seq64::offline_render            */
+#include "perform.hpp"                  /* seq64::perform                   */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Principal constructor.
+ *
+ * \param p
+ *      The performance to render.  The song must already be loaded.
+ *
+ * \param passthrough
+ *      If true, the events are also sent to the MIDI ports while rendering.
+ *      Normally false.
+ */
+
+offline_render::offline_render (perform & p, bool passthrough)
+ :
+    m_perform       (p),
+    m_capture       (passthrough),
+    m_start_bpm     (p.get_beats_per_minute()),
+    m_ticks         (0),
+    m_elapsed_us    (0.0)
+{
+    // Empty body
+}
+
+/**
+ *  Plays the song, in Song mode, from the start tick to the end tick, as
+ *  fast as possible.  The previous capture is discarded.
+ *
+ *  Each step calls perform::play() for the span of ticks since the previous
+ *  step, as the output thread does.  With a step of 1 (the default), every
+ *  captured event carries its exact tick; with larger steps, events are
+ *  stamped with the last tick of their step, just as they would be sent
+ *  together at the end of an output cycle.  At the end, all patterns are
+ *  turned off, so that the Note Offs of hanging notes are captured at the
+ *  end tick.
+ *
+ *  The tempo and playback mode of the performance are restored afterwards.
+ *
+ * \param starttick
+ *      The first tick to render.
+ *
+ * \param endtick
+ *      The last tick to render.  If SEQ64_NULL_MIDIPULSE (the default), the
+ *      end of the last trigger of the song is used.
+ *
+ * \param step
+ *      The number of ticks of each step.  Values below 1 are treated as 1.
+ *
+ * \return
+ *      Returns true if rendering was possible.  It is not possible if the
+ *      performance is playing, if there is no master buss, or if the song is
+ *      empty.
+ */
+
+bool
+offline_render::render (midipulse starttick, midipulse endtick, midipulse step)
+{
+    if (m_perform.is_running() || is_nullptr(m_perform.m_master_bus))
+    {
+        errprint("offline_render: performance busy or not launched");
+        return false;
+    }
+    if (endtick == SEQ64_NULL_MIDIPULSE)
+        endtick = m_perform.get_max_trigger();
+
+    if (endtick <= starttick)
+    {
+        errprint("offline_render: nothing to render");
+        return false;
+    }
+    if (step < 1)
+        step = 1;
+
+    mastermidibus & mmb = m_perform.master_bus();
+    midi_capture * oldcapture = mmb.capture();
+    bool oldmode = m_perform.playback_mode();
+    m_start_bpm = m_perform.get_beats_per_minute();
+    m_capture.clear();
+    m_ticks = 0;
+    mmb.capture(&m_capture);
+    m_perform.playback_mode(true);
+    m_perform.off_sequences();
+    m_perform.set_orig_ticks(starttick);
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    midipulse tick = starttick;
+    for (;;)
+    {
+        m_capture.tick(tick);
+        m_perform.play(tick);
+        if (tick >= endtick)
+            break;
+
+        tick += step;
+        if (tick > endtick)
+            tick = endtick;
+    }
+    m_capture.tick(endtick);
+    m_perform.off_sequences();                      /* final Note Offs      */
+    mmb.flush();
+
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    m_elapsed_us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    m_ticks = endtick - starttick + 1;
+    mmb.capture(oldcapture);
+    if (m_perform.get_beats_per_minute() != m_start_bpm)
+        m_perform.set_beats_per_minute(m_start_bpm);
+
+    m_perform.playback_mode(oldmode);
+    m_perform.set_tick(starttick);
+    return true;
+}
+
+/**
+ *  Writes the capture as a type 1 MIDI file, at the PPQN of the performance
+ *  and with the tempo in force when the render started.
+ *
+ * \param filename
+ *      The full path to the file.
+ *
+ * \return
+ *      Returns true if the file was written.
+ */
+
+bool
+offline_render::write_midi_file (const std::string & filename) const
+{
+    return m_capture.write_midi_file
+    (
+        filename, m_perform.get_ppqn(), m_start_bpm
+    );
+}
+
+/**
+ *  Calculates the throughput of the last render.
+ *
+ * \return
+ *      Returns the number of captured events per second of wall-clock time,
+ *      or 0 if nothing was rendered.
+ */
+
+double
+offline_render::events_per_second () const
+{
+    return m_elapsed_us > 0.0 ?
+        double(m_capture.count()) * 1000000.0 / m_elapsed_us : 0.0 ;
+}
+
+}           // namespace seq64
+
+/*
+ * offline_render.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
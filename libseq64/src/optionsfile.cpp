@@ -26,7 +26,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2021-05-05
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The <code> ~/.seq24rc </code> or <code> ~/.config/sequencer64/sequencer64.rc
@@ -159,6 +159,33 @@ optionsfile::make_error_message
     return false;
 }
 
+/**
+ *  Gets the port name from the current [midi-clock] or [midi-input] data
+ *  line, where it is written in double quotes after the buss number and the
+ *  status.  The port names form the last-known port map, which is used to
+ *  match the settings to the ports at startup.  Older "rc" files have no
+ *  names, and older versions of Sequencer64 ignore them.
+ *
+ * \return
+ *      Returns the text between the first two double quotes, or an empty
+ *      string if there is none.
+ */
+
+std::string
+optionsfile::port_name () const
+{
+    std::string result;
+    std::string line = m_line;
+    std::string::size_type fpos = line.find_first_of("\"");
+    if (fpos != std::string::npos)
+    {
+        std::string::size_type lpos = line.find_first_of("\"", fpos + 1);
+        if (lpos != std::string::npos)
+            result = line.substr(fpos + 1, lpos - fpos - 1);
+    }
+    return result;
+}
+
 /**
  *  Parse the ~/.seq24rc or ~/.config/sequencer64/sequencer64.rc file.
  *
@@ -247,6 +274,12 @@ optionsfile::make_error_message
  *  buss.  The first field is the port number, and the second number
  *  indicates whether it is disabled (0), or enabled (1).
  *
+ *  [midi-input-latency]
+ *
+ *  This optional section holds the latency of each input buss, in
+ *  microseconds.  Recorded events are stamped at the time they arrived, as
+ *  reported by the MIDI driver, less this latency.
+ *
  *  [midi-clock-mod-ticks]
  *
  *  This section covers....  One common value is 64.
@@ -404,6 +437,7 @@ optionsfile::parse (perform & p)
              */
 
             p.set_clock(bus, static_cast<clock_e>(bus_on));
+            p.set_clock_port(bus, port_name());
             ok = next_data_line(file);
             if (! ok)
             {
@@ -703,6 +737,7 @@ optionsfile::parse (perform & p)
                 if (count == 2)
                 {
                     p.add_input(bool(bus_on));
+                    p.add_input_port(port_name());
                     ++b;
                 }
                 else if (count == 1)
@@ -720,6 +755,27 @@ optionsfile::parse (perform & p)
     else
         return make_error_message("midi-input");
 
+    /*
+     *  The input latencies are optional, and default to 0.  Each line holds
+     *  a buss number and its latency in microseconds.
+     */
+
+    if (line_after(file, "[midi-input-latency]"))
+    {
+        int buses = 0;
+        int count = sscanf(m_line, "%d", &buses);
+        if (count > 0 && buses > 0)
+        {
+            while (next_data_line(file))
+            {
+                int bus, us;
+                count = sscanf(m_line, "%d %d", &bus, &us);
+                if (count == 2)
+                    rc().input_latency(bus, us);
+            }
+        }
+    }
+
 #ifdef USE_THIS_CODE
 
     /*
@@ -1309,6 +1365,8 @@ optionsfile::write (const perform & p)
            "# disabled.  One can set this value manually for devices that are\n"
            "# present, but not available, perhaps because another application\n"
            "# has exclusive access to the device (e.g. on Windows).\n"
+           "# The quoted port name follows; at startup, a setting goes to\n"
+           "# the port with that name, even if its buss number has changed.\n"
            "\n"
         ;
 
@@ -1327,10 +1385,11 @@ optionsfile::write (const perform & p)
          */
 
         int bus_on = static_cast<int>(ucperf.get_clock(bussbyte(bus)));
+        std::string port = ucperf.master_bus().get_midi_out_port(bus);
         snprintf
         (
-            outs, sizeof outs, "%d %d    # buss number, clock status",
-            bus, bus_on
+            outs, sizeof outs, "%d %d \"%s\"    # buss number, clock status",
+            bus, bus_on, port.c_str()
         );
         file << outs << "\n";
     }
@@ -1372,7 +1431,8 @@ optionsfile::write (const perform & p)
         << "\n[midi-input]\n\n"
         << buses << "   # number of input MIDI busses\n\n"
            "# The first number is the port number, and the second number\n"
-           "# indicates whether it is disabled (0), or enabled (1).\n"
+           "# indicates whether it is disabled (0), or enabled (1).  The\n"
+           "# quoted port name follows, as in [midi-clock].\n"
            "\n"
         ;
 
@@ -1383,10 +1443,11 @@ optionsfile::write (const perform & p)
             << ucperf.master_bus().get_midi_in_bus_name(i)
             << "\n"
             ;
+        std::string port = ucperf.master_bus().get_midi_in_port(i);
         snprintf
         (
-            outs, sizeof outs, "%d %d  # buss number, input status",
-            i, static_cast<int>(ucperf.get_input(i))
+            outs, sizeof outs, "%d %d \"%s\"  # buss number, input status",
+            i, static_cast<int>(ucperf.get_input(i)), port.c_str()
         );
         file << outs << "\n";
     }
@@ -1406,6 +1467,30 @@ optionsfile::write (const perform & p)
         << "   # flag to record incoming data by channel\n"
         ;
 
+    /*
+     * Input latency, new option as of 2023-03-11
+     */
+
+    file
+        << "\n[midi-input-latency]\n\n"
+        << buses << "   # number of input MIDI busses\n\n"
+           "# The first number is the port number, and the second number is\n"
+           "# the latency of the port in microseconds:  the time from playing\n"
+           "# a note to the moment the MIDI driver timestamps it.  Recorded\n"
+           "# events are moved earlier by this amount, at the current tempo.\n"
+           "\n"
+        ;
+
+    for (int i = 0; i < buses; ++i)
+    {
+        snprintf
+        (
+            outs, sizeof outs, "%d %d  # buss number, latency (us)",
+            i, rc().input_latency(i)
+        );
+        file << outs << "\n";
+    }
+
     /*
      * Manual ALSA ports
      */
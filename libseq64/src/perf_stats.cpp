@@ -0,0 +1,676 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          perf_stats.cpp
+ *
+ *  This module defines the real-time latency and jitter statistics of the
+ *  application.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-08
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  All of the recording functions are lock-free and never allocate, so they
+ *  can be called from the output thread, the input thread, and the JACK
+ *  process callback.  The reporting functions read the counters with relaxed
+ *  loads, so a report taken during playback is a consistent-enough snapshot,
+ *  not an exact one.
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <climits>                      /* LONG_MAX                         */
+#include <cstdio>                       /* std::FILE, std::rename()         */
+#include <sstream>                      /* std::ostringstream               */
+
+#include "easy_macros.h"                /* not_nullptr() macro              */
+#include "perf_stats.hpp"               /* seq64::perf_stats, histogram     */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Names of the trace kinds, for the CSV dump.  Keep them in the order of
+ *  perf_stats::trace_kind.
+ */
+
+static const char * const s_trace_names [] =
+{
+    "cycle", "lateness", "events", "input", "fill", "xrun", "underrun"
+};
+
+/**
+ *  Constructs an empty histogram.
+ *
+ * \param name
+ *      The name of the measurement.  Must be a string literal or otherwise
+ *      outlive the histogram.
+ *
+ * \param units
+ *      The units of the measurement, such as "us".
+ */
+
+histogram::histogram (const char * name, const char * units)
+ :
+    m_name      (name),
+    m_units     (units),
+    m_count     (0),
+    m_sum       (0),
+    m_min       (LONG_MAX),
+    m_max       (0)
+{
+    for (int i = 0; i < c_buckets; ++i)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+}
+
+/**
+ *  Sets the name and units, for histograms created in an array.
+ */
+
+void
+histogram::label (const char * name, const char * units)
+{
+    m_name = name;
+    m_units = units;
+}
+
+/**
+ *  Calculates the bucket for a value.
+ *
+ * \param value
+ *      The value to be counted.
+ *
+ * \return
+ *      Returns 0 for values of 0 or less, otherwise one more than the
+ *      position of the highest bit set, up to c_buckets - 1.
+ */
+
+int
+histogram::bucket_index (long value)
+{
+    int result = 0;
+    while (value > 0 && result < c_buckets - 1)
+    {
+        value >>= 1;
+        ++result;
+    }
+    return result;
+}
+
+/**
+ *  Gets the smallest value counted in a bucket.
+ */
+
+long
+histogram::bucket_floor (int index)
+{
+    return index > 0 ? (1L << (index - 1)) : 0 ;
+}
+
+/**
+ *  Counts a value.  This function is lock-free, and can be called from any
+ *  thread.
+ *
+ * \param value
+ *      The measured value.  Negative values are counted as 0.
+ */
+
+void
+histogram::add (long value)
+{
+    if (value < 0)
+        value = 0;
+
+    m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    long previous = m_min.load(std::memory_order_relaxed);
+    while
+    (
+        value < previous && ! m_min.compare_exchange_weak
+        (
+            previous, value, std::memory_order_relaxed
+        )
+    )
+    {
+        // Empty body
+    }
+    previous = m_max.load(std::memory_order_relaxed);
+    while
+    (
+        value > previous && ! m_max.compare_exchange_weak
+        (
+            previous, value, std::memory_order_relaxed
+        )
+    )
+    {
+        // Empty body
+    }
+}
+
+/**
+ *  Clears the histogram.  Values added while the reset is in progress may
+ *  be partly lost, which does not matter for statistics.
+ */
+
+void
+histogram::reset ()
+{
+    for (int i = 0; i < c_buckets; ++i)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(LONG_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * \return
+ *      Returns the smallest value counted, or 0 if there are none.
+ */
+
+long
+histogram::minimum () const
+{
+    long result = m_min.load(std::memory_order_relaxed);
+    return result == LONG_MAX ? 0 : result ;
+}
+
+/**
+ * \return
+ *      Returns the largest value counted.
+ */
+
+long
+histogram::maximum () const
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+/**
+ * \return
+ *      Returns the average of the values counted, or 0 if there are none.
+ */
+
+double
+histogram::mean () const
+{
+    long n = count();
+    return n > 0 ?
+        double(m_sum.load(std::memory_order_relaxed)) / double(n) : 0.0 ;
+}
+
+/**
+ *  Estimates a percentile.  Since the buckets are powers of two, the result
+ *  is the upper limit of the bucket holding the percentile, capped by the
+ *  maximum; it errs on the pessimistic side.
+ *
+ * \param pct
+ *      The percentile, from 0.0 to 100.0.
+ *
+ * \return
+ *      Returns the estimate, or 0 if there are no values.
+ */
+
+long
+histogram::percentile (double pct) const
+{
+    long n = count();
+    long result = 0;
+    if (n > 0)
+    {
+        long target = long(double(n) * pct / 100.0 + 0.5);
+        long total = 0;
+        if (target < 1)
+            target = 1;
+
+        for (int i = 0; i < c_buckets; ++i)
+        {
+            total += bucket(i);
+            if (total >= target)
+            {
+                result = i < c_buckets - 1 ?
+                    bucket_floor(i + 1) - 1 : LONG_MAX ;
+                break;
+            }
+        }
+        if (result > maximum())
+            result = maximum();
+    }
+    return result;
+}
+
+/**
+ *  Formats the summary of the histogram as one line of the report.
+ */
+
+std::string
+histogram::to_string () const
+{
+    char temp[128];
+    std::string label = std::string(m_name);
+    if (m_units[0] != 0)
+        label += std::string(" (") + m_units + ")";
+
+    snprintf
+    (
+        temp, sizeof temp, "%-18s %9ld %9.1f %8ld %8ld %8ld %8ld",
+        label.c_str(), count(), mean(), minimum(),
+        percentile(50.0), percentile(99.0), maximum()
+    );
+    return std::string(temp);
+}
+
+/**
+ *  Constructs the statistics, with the trace disabled.
+ */
+
+perf_stats::perf_stats ()
+ :
+    m_cycle         ("cycle", "us"),
+    m_lateness      ("lateness", "us"),
+    m_events        ("events/cycle", ""),
+    m_input         ("input", "us"),
+    m_server_xruns  (0),
+    m_underruns     (0),
+    m_cycle_events  (0),
+    m_start_ns      (now_ns()),
+    m_trace         (),
+    m_trace_next    (0)
+{
+    for (int bus = 0; bus < SEQ64_DEFAULT_BUSS_MAX; ++bus)
+    {
+        m_fill[bus].label("fill", "%");
+        m_xruns[bus].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ *  Gets the current time of the steady clock, which is used for all of the
+ *  measurements.
+ *
+ * \return
+ *      Returns the time in nanoseconds.
+ */
+
+long long
+perf_stats::now_ns ()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ *  Clears all of the statistics.  The trace is kept.
+ */
+
+void
+perf_stats::reset ()
+{
+    m_cycle.reset();
+    m_lateness.reset();
+    m_events.reset();
+    m_input.reset();
+    for (int bus = 0; bus < SEQ64_DEFAULT_BUSS_MAX; ++bus)
+    {
+        m_fill[bus].reset();
+        m_xruns[bus].store(0, std::memory_order_relaxed);
+    }
+    m_server_xruns.store(0, std::memory_order_relaxed);
+    m_underruns.store(0, std::memory_order_relaxed);
+    m_cycle_events.store(0, std::memory_order_relaxed);
+    m_start_ns.store(now_ns(), std::memory_order_relaxed);
+}
+
+/**
+ *  Allocates the timeline trace.  This must be done before the input and
+ *  output threads start, since the recording functions do not lock.
+ *
+ * \param capacity
+ *      The number of records kept.  Once the trace is full, the oldest
+ *      records are overwritten.  Zero disables the trace.
+ */
+
+void
+perf_stats::enable_trace (std::size_t capacity)
+{
+    m_trace.assign(capacity, trace_record());
+    m_trace_next.store(0, std::memory_order_relaxed);
+}
+
+/**
+ *  Adds a record to the trace, if enabled.  The slot is claimed atomically,
+ *  so several threads can trace at the same time.
+ */
+
+void
+perf_stats::trace (trace_kind kind, int bus, long value, long long ns)
+{
+    if (! m_trace.empty())
+    {
+        unsigned long n = m_trace_next.fetch_add(1, std::memory_order_relaxed);
+        trace_record & tr = m_trace[n % m_trace.size()];
+        tr.tr_nanoseconds = ns != 0 ? ns : now_ns() ;
+        tr.tr_kind = int(kind);
+        tr.tr_bus = bus;
+        tr.tr_value = value;
+    }
+}
+
+/**
+ *  Records the end of an output cycle of perform::output_func().  The events
+ *  counted by count_event() since the previous call are tallied as well.
+ *
+ * \param startns
+ *      The time at which the cycle's work began.
+ *
+ * \param endns
+ *      The time at which it ended, just before the thread goes to sleep.
+ */
+
+void
+perf_stats::end_cycle (long long startns, long long endns)
+{
+    long us = long((endns - startns) / 1000);
+    long events = m_cycle_events.exchange(0, std::memory_order_relaxed);
+    m_cycle.add(us);
+    m_events.add(events);
+    trace(trace_cycle, -1, us, endns);
+    trace(trace_events, -1, events, endns);
+}
+
+/**
+ *  Records the wake-up of the output thread.
+ *
+ * \param sleepus
+ *      The number of microseconds the thread asked to sleep.
+ *
+ * \param sleepns
+ *      The time at which it went to sleep.
+ *
+ * \param wakens
+ *      The time at which it woke up.
+ */
+
+void
+perf_stats::wake_up (long sleepus, long long sleepns, long long wakens)
+{
+    long late = long((wakens - sleepns) / 1000) - sleepus;
+    m_lateness.add(late);
+    trace(trace_lateness, -1, late, wakens);
+}
+
+/**
+ *  Counts an output cycle that overran its period.
+ */
+
+void
+perf_stats::underrun ()
+{
+    m_underruns.fetch_add(1, std::memory_order_relaxed);
+    trace(trace_underrun, -1, 1);
+}
+
+/**
+ *  Records the handling of an input event, from its arrival to now, when it
+ *  has been forwarded and recorded.
+ *
+ * \param arrivalns
+ *      The time at which the event arrived at the input port, that is, the
+ *      time it was read less its input delay (see
+ *      midibase::get_midi_event()).
+ */
+
+void
+perf_stats::input (long long arrivalns)
+{
+    long long ns = now_ns();
+    long us = long((ns - arrivalns) / 1000);
+    m_input.add(us);
+    trace(trace_input, -1, us, ns);
+}
+
+/**
+ *  Records the fill level of the output buffer of a buss.
+ *
+ * \param bus
+ *      The buss number.  Out-of-range numbers are ignored.
+ *
+ * \param percent
+ *      The fill level, from 0 to 100.
+ */
+
+void
+perf_stats::buffer_fill (int bus, int percent)
+{
+    if (bus >= 0 && bus < SEQ64_DEFAULT_BUSS_MAX)
+    {
+        m_fill[bus].add(percent);
+        trace(trace_fill, bus, percent);
+    }
+}
+
+/**
+ *  Counts a message dropped by a buss.
+ *
+ * \param bus
+ *      The buss number.  Out-of-range numbers are ignored.
+ */
+
+void
+perf_stats::xrun (int bus)
+{
+    if (bus >= 0 && bus < SEQ64_DEFAULT_BUSS_MAX)
+    {
+        m_xruns[bus].fetch_add(1, std::memory_order_relaxed);
+        trace(trace_xrun, bus, 1);
+    }
+}
+
+/**
+ *  Counts an xrun reported by the JACK server.
+ */
+
+void
+perf_stats::server_xrun ()
+{
+    m_server_xruns.fetch_add(1, std::memory_order_relaxed);
+    trace(trace_xrun, -1, 1);
+}
+
+/**
+ * \getter m_fill[bus]
+ *      The bus number is not checked.
+ */
+
+const histogram &
+perf_stats::fill (int bus) const
+{
+    return m_fill[bus];
+}
+
+/**
+ * \getter m_xruns[bus]
+ *
+ * \return
+ *      Returns the count, or 0 if the bus number is out of range.
+ */
+
+long
+perf_stats::xruns (int bus) const
+{
+    return (bus >= 0 && bus < SEQ64_DEFAULT_BUSS_MAX) ?
+        m_xruns[bus].load(std::memory_order_relaxed) : 0 ;
+}
+
+/**
+ *  Formats all of the statistics as a plain-text table.  This is the text
+ *  shown by the Qt diagnostics panel and written to the statistics file of
+ *  the CLI application.  Busses without any activity are not shown.
+ */
+
+std::string
+perf_stats::report () const
+{
+    std::ostringstream result;
+    double seconds = double(now_ns() - m_start_ns.load()) / 1.0e9;
+    char temp[128];
+    snprintf(temp, sizeof temp, "Sequencer64 statistics, %.1f s\n\n", seconds);
+    result << temp;
+    snprintf
+    (
+        temp, sizeof temp, "%-18s %9s %9s %8s %8s %8s %8s\n",
+        "measurement", "count", "mean", "min", "p50", "p99", "max"
+    );
+    result
+        << temp
+        << m_cycle.to_string() << "\n"
+        << m_lateness.to_string() << "\n"
+        << m_events.to_string() << "\n"
+        << m_input.to_string() << "\n\n"
+        << "underruns " << underruns()
+        << ", JACK xruns " << server_xruns() << "\n"
+        ;
+
+    bool header = false;
+    for (int bus = 0; bus < SEQ64_DEFAULT_BUSS_MAX; ++bus)
+    {
+        const histogram & h = m_fill[bus];
+        long x = xruns(bus);
+        if (h.count() > 0 || x > 0)
+        {
+            if (! header)
+            {
+                result << "\nbuss   fill% mean   p99   max   xruns\n";
+                header = true;
+            }
+            snprintf
+            (
+                temp, sizeof temp, "%4d  %11.1f %5ld %5ld %7ld\n",
+                bus, h.mean(), h.percentile(99.0), h.maximum(), x
+            );
+            result << temp;
+        }
+    }
+    return result.str();
+}
+
+/**
+ *  Writes the report to a file.  The report is written to a temporary file
+ *  that is then renamed, so that a program polling the file never sees a
+ *  partial report.
+ *
+ * \param filename
+ *      The full path to the file.
+ *
+ * \return
+ *      Returns true if the file was written.
+ */
+
+bool
+perf_stats::write_report (const std::string & filename) const
+{
+    std::string tempname = filename + ".tmp";
+    std::FILE * fp = std::fopen(tempname.c_str(), "w");
+    bool result = not_nullptr(fp);
+    if (result)
+    {
+        std::string text = report();
+        result = std::fputs(text.c_str(), fp) >= 0;
+        result = std::fclose(fp) == 0 && result;
+        if (result)
+            result = std::rename(tempname.c_str(), filename.c_str()) == 0;
+    }
+    return result;
+}
+
+/**
+ *  Writes the timeline trace to a CSV file, oldest record first.  Each line
+ *  holds the time in nanoseconds since the start (or the last reset), the
+ *  kind of record, the buss number (-1 if not applicable), and the value.
+ *  Call this function only after the threads have stopped.
+ *
+ * \param filename
+ *      The full path to the file.
+ *
+ * \return
+ *      Returns true if the trace is enabled and the file was written.
+ */
+
+bool
+perf_stats::dump_trace (const std::string & filename) const
+{
+    bool result = ! m_trace.empty();
+    if (result)
+    {
+        std::FILE * fp = std::fopen(filename.c_str(), "w");
+        result = not_nullptr(fp);
+        if (result)
+        {
+            unsigned long total = m_trace_next.load();
+            unsigned long size = m_trace.size();
+            unsigned long first = total > size ? total - size : 0 ;
+            long long start = m_start_ns.load();
+            std::fprintf(fp, "ns,kind,buss,value\n");
+            for (unsigned long n = first; n < total; ++n)
+            {
+                const trace_record & tr = m_trace[n % size];
+                std::fprintf
+                (
+                    fp, "%lld,%s,%d,%ld\n", tr.tr_nanoseconds - start,
+                    s_trace_names[tr.tr_kind], tr.tr_bus, tr.tr_value
+                );
+            }
+            result = std::fclose(fp) == 0;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Provides the single statistics object of the application.
+ *
+ * \return
+ *      Returns the global object s_perf_stats.
+ */
+
+perf_stats &
+statistics ()
+{
+    static perf_stats s_perf_stats;
+    return s_perf_stats;
+}
+
+}           // namespace seq64
+
+/*
+ * perf_stats.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
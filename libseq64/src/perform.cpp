@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom and others
  * \date          2015-07-24
- * \updates       2020-07-05
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  This class is probably the single most important class in Sequencer64, as
@@ -144,21 +144,24 @@
  *    -   It is set to false in pause_playing().
  *    -   It is set to the midiclock parameter of inner_stop().
  *    -   If m_usemidiclock is true:
- *        -   It affects m_midiclocktick in output.
+ *        -   The output advances by m_clock_follower, not by its tempo.
  *        -   The position in output cannot be repositioned.
  *        -   The tick location cannot be changed.
  *
  *    On input:
  *
  *    -   If MIDI Start is received, m_midiclockrunning and m_usemidiclock
- *        become true, and m_midiclocktick and m_midiclockpos become 0.
+ *        become true, m_midiclockpos becomes 0, and m_clock_follower
+ *        restarts.
  *    -   If MIDI Continue is received, m_midiclockrunning is set to true and
  *        we start according to song-mode.
  *    -   If MIDI Stop is received, m_midiclockrunning is set to false,
  *        m_midiclockpos is set to the current tick (!), all_notes_off(), and
  *        inner_stop(true) [sets m_usemidiclock = true].
  *    -   If MIDI Clock is received, and m_midiclockrunning is true, then
- *        m_midiclocktick += m_midiclockincrement.
+ *        its arrival time is passed to m_clock_follower, which advances the
+ *        position by m_midiclockincrement per clock, interpolated between
+ *        clocks.
  *    -   If MIDI Song Position is received, then m_midiclockpos is set as per
  *        in data in this event.
  *    -   MIDI Active Sense and MIDI Reset are currently filtered by the JACK
@@ -223,12 +226,15 @@
 #include <stdio.h>
 #include <string.h>                     /* memset()                         */
 
+#include "autosaver.hpp"                /* seq64::autosaver                 */
 #include "calculations.hpp"
 #include "cmdlineopts.hpp"              /* seq64::parse_mute_groups()       */
 #include "event.hpp"                    /* seq64::event class               */
 #include "keystroke.hpp"                /* seq64::keystroke class           */
 #include "midibus.hpp"                  /* seq64::midibus class             */
 #include "perform.hpp"                  /* seq64::perform, this class       */
+#include "perf_stats.hpp"               /* seq64::statistics()              */
+#include "play_pool.hpp"                /* seq64::play_pool                 */
 #include "playlist.hpp"                 /* seq64::playlist, 0.96 and above  */
 #include "settings.hpp"                 /* seq64::rc()                      */
 
@@ -369,6 +375,8 @@ perform::perform (gui_assistant & mygui, int ppqn)
     m_filter_by_channel         (false),                /* "rc" option      */
     m_master_clocks             (),                     /* vector<clock_e>  */
     m_master_inputs             (),                     /* vector<bool>     */
+    m_master_clock_ports        (),                     /* vector<string>   */
+    m_master_input_ports        (),                     /* vector<string>   */
     m_one_measure               (m_ppqn * 4),           /* may change later */
     m_left_tick                 (0),
     m_right_tick                (m_one_measure * 4),    /* m_ppqn * 16      */
@@ -377,7 +385,7 @@ perform::perform (gui_assistant & mygui, int ppqn)
     m_jack_tick                 (0),
     m_usemidiclock              (false),
     m_midiclockrunning          (false),
-    m_midiclocktick             (0),
+    m_clock_follower            (),
     m_midiclockincrement        (clock_ticks_from_ppqn(m_ppqn)),
     m_midiclockpos              (0),
     m_dont_reset_ticks          (false),
@@ -396,10 +404,15 @@ perform::perform (gui_assistant & mygui, int ppqn)
     m_sequence_count            (0),
     m_sequence_max              (c_max_sequence),
     m_sequence_high             (-1),
+    m_song_timeline             (*this),
+    m_play_pool                 (nullptr),
+    m_autosaver                 (nullptr),
+    m_lookahead_tick            (0),
 #ifdef SEQ64_EDIT_SEQUENCE_HIGHLIGHT
     m_edit_sequence             (-1),
 #endif
-    m_is_modified               (false),
+    m_modify_state              (0),
+    m_snapshot_lock             (),
 #ifdef SEQ64_SONG_BOX_SELECT
     m_selected_seqs             (),                     // Selection, std::set
 #endif
@@ -464,6 +477,16 @@ perform::~perform ()
     if (m_in_thread_launched)
         pthread_join(m_in_thread, NULL);
 
+    if (not_nullptr(m_play_pool))
+    {
+        delete m_play_pool;                         /* joins its threads    */
+        m_play_pool = nullptr;
+    }
+    if (not_nullptr(m_autosaver))
+    {
+        delete m_autosaver;                         /* finishes a save      */
+        m_autosaver = nullptr;
+    }
     for (int seq = 0; seq < m_sequence_high; ++seq) /* m_sequence_max       */
     {
         if (not_nullptr(m_seqs[seq]))
@@ -482,6 +505,14 @@ perform::~perform ()
         delete m_master_bus;
         m_master_bus = nullptr;
     }
+
+    /*
+     * All of the threads that feed the statistics are gone now, so the trace
+     * can be read safely.
+     */
+
+    if (! usr().option_trace_file().empty())
+        (void) statistics().dump_trace(usr().option_trace_file());
 }
 
 /**
@@ -517,7 +548,8 @@ perform::set_ppqn (int p)
  *
  *  However, the devices actually on the system at start time might be
  *  different from what was saved in the "rc" file after the last run of
- *  Sequencer64.
+ *  Sequencer64.  So the port names saved with the settings are copied, too,
+ *  and the mastermidibus matches the settings to the ports by name.
  *
  *  For output, both apps have always connected to all ports automatically.
  *  But we want to support disabling some output ports, both in the "rc"
@@ -545,6 +577,10 @@ perform::create_master_bus ()
         {
             m_master_bus->filter_by_channel(m_filter_by_channel);
             m_master_bus->set_port_statuses(m_master_clocks, m_master_inputs);
+            m_master_bus->set_port_names
+            (
+                m_master_clock_ports, m_master_input_ports
+            );
             if (not_nullptr(m_midi_ctrl_out))
             {
                 m_midi_ctrl_out->set_master_bus(m_master_bus);
@@ -605,6 +641,17 @@ perform::launch (int ppqn)
             ppqn = SEQ64_DEFAULT_PPQN;
 
         m_master_bus->init(ppqn, m_bpm);    /* calls api_init() per API     */
+        reserve_thru_channels();
+        statistics().reset();
+        if (! usr().option_trace_file().empty())
+            statistics().enable_trace(SEQ64_STATS_TRACE_SIZE);
+
+        if (usr().option_play_threads() > 1 && is_nullptr(m_play_pool))
+            m_play_pool = new play_pool(*this, usr().option_play_threads());
+
+        int minutes = usr().option_autosave_minutes();
+        if (minutes > 0 && is_nullptr(m_autosaver))
+            m_autosaver = new autosaver(*this, minutes);
 
         /*
          * We may need to copy the actually input buss settings back to here,
@@ -622,6 +669,40 @@ perform::launch (int ppqn)
     }
 }
 
+/**
+ *  Tells the master buss which channels carry the MIDI controls that
+ *  poll_cycle() handles while recording, so that its thru router never
+ *  forwards them.
+ */
+
+void
+perform::reserve_thru_channels ()
+{
+    static const int s_controls[] =
+    {
+        c_midi_control_start, c_midi_control_stop, c_midi_control_record
+    };
+    for (int i = 0; i < int(sizeof s_controls / sizeof s_controls[0]); ++i)
+    {
+        int ctl = s_controls[i];
+        const midi_control * mcs[] =
+        {
+            &midi_control_toggle(ctl), &midi_control_on(ctl),
+            &midi_control_off(ctl)
+        };
+        for (int m = 0; m < 3; ++m)
+        {
+            int status = mcs[m]->status();
+            if (mcs[m]->active() && status >= EVENT_NOTE_OFF &&
+                status < EVENT_MIDI_SYSEX)
+            {
+                int channel = status & EVENT_GET_CHAN_MASK;
+                m_master_bus->reserve_thru_channel(channel);
+            }
+        }
+    }
+}
+
 /**
  *  The rough opposite of launch(); it doesn't stop the threads.  A minor
  *  simplification for the main() routine, hides the JACK support macro.
@@ -640,6 +721,31 @@ perform::finish ()
         m_master_bus->get_port_statuses(m_master_clocks, m_master_inputs);
 }
 
+/**
+ *  Asks the autosave thread to save the song now, and returns at once.  The
+ *  thread takes a song_snapshot and writes it, so the patterns are locked
+ *  only while they are copied, and playback goes on undisturbed.  The
+ *  thread is started, without a period, if the "-o autosave=m" option did
+ *  not start it.
+ *
+ * \param filename
+ *      The MIDI file to write.  If empty (the default), the autosave file
+ *      is written.  Otherwise, this is a save of the song itself, and the
+ *      modified flag is falsified if the song did not change meanwhile.
+ *
+ * \return
+ *      Returns false if the thread could not be started.
+ */
+
+bool
+perform::save_in_background (const std::string & filename)
+{
+    if (is_nullptr(m_autosaver))
+        m_autosaver = new autosaver(*this, 0);
+
+    return m_autosaver->request(filename);
+}
+
 #ifdef SEQ64_SONG_BOX_SELECT
 
 /**
@@ -976,6 +1082,36 @@ perform::any_group_unmutes () const
     return result;
 }
 
+/**
+ *  Gets a mute-group status as get_group_mute_state() does after
+ *  select_group_mute(), but without selecting the group, or storing the
+ *  playing statuses into it in group-learn mode.  Used for saving the mute
+ *  groups from a song_snapshot.
+ *
+ * \param group
+ *      The mute group, clamped as in select_group_mute().
+ *
+ * \param gtrack
+ *      The track in the group, re 0.
+ *
+ * \return
+ *      Returns the desired m_mute_group[] value, or false if the track is
+ *      out of range.
+ */
+
+bool
+perform::group_mute_state (int group, int gtrack) const
+{
+    bool result = false;
+    if (gtrack >= 0 && gtrack < m_seqs_in_set)
+    {
+        int grouptrack = clamp_group(group) * m_seqs_in_set + gtrack;
+        if (grouptrack < c_max_sequence)
+            result = m_mute_group[grouptrack];
+    }
+    return result;
+}
+
 /**
  *  This function is a way to dump the mute-group settings in a way
  *  independent of the code in the optionsfile module, for debugging.
@@ -1526,7 +1662,9 @@ perform::mute_all_tracks (bool flag)
 }
 
 /**
- * 3 colors?
+ *  Tells the control surface the state of each slot of the playing
+ *  screen-set.  The midi_control_out feedback thread sends only the slots
+ *  whose state differs from the one the surface already shows.
  */
 
 void
@@ -1546,14 +1684,14 @@ perform::announce_playscreen ()
                 {
                     m_midi_ctrl_out->send_seq_event
                     (
-                        s, midi_control_out::seq_action_arm, false
+                        s, midi_control_out::seq_action_arm
                     );
                 }
                 else
                 {
                     m_midi_ctrl_out->send_seq_event
                     (
-                        s, midi_control_out::seq_action_mute, false
+                        s, midi_control_out::seq_action_mute
                     );
                 }
             }
@@ -1561,10 +1699,9 @@ perform::announce_playscreen ()
             {
                 m_midi_ctrl_out->send_seq_event
                 (
-                    s, midi_control_out::seq_action_delete, false
+                    s, midi_control_out::seq_action_delete
                 );
             }
-            m_master_bus->flush();
         }
     }
 }
@@ -1584,9 +1721,8 @@ perform::announce_exit ()
         {
             m_midi_ctrl_out->send_seq_event
             (
-                i, midi_control_out::seq_action_delete, false
+                i, midi_control_out::seq_action_delete
             );
-            m_master_bus->flush();
         }
     }
 }
@@ -1869,6 +2005,7 @@ perform::set_right_tick (midipulse tick, bool setstart)
 bool
 perform::install_sequence (sequence * seq, int seqnum)
 {
+    automutex locker(m_snapshot_lock);
     bool result = false;
     if (not_nullptr(m_seqs[seqnum]))
     {
@@ -2040,6 +2177,7 @@ perform::new_sequence (int seq)
 void
 perform::delete_sequence (int seq)
 {
+    automutex locker(m_snapshot_lock);
     if (is_mseq_valid(seq))                         /* check for null, etc. */
     {
         set_active(seq, false);
@@ -2054,7 +2192,7 @@ perform::delete_sequence (int seq)
         {
             m_midi_ctrl_out->send_seq_event
             (
-                seq, midi_control_out::seq_action_delete    /* flushes  */
+                seq, midi_control_out::seq_action_delete
             );
         }
     }
@@ -2773,6 +2911,7 @@ perform::set_screenset_notepad
     {
         if (notepad != m_screenset_notepad[screenset])
         {
+            automutex locker(m_snapshot_lock);
             m_screenset_notepad[screenset] = notepad;
             if (! is_load_modification)
                 modify();
@@ -2890,6 +3029,14 @@ perform::set_playing_screenset ()
  *  Finally, we stop the looping at m_sequence_high rather than
  *  m_sequence_max, to save a little time.
  *
+ *  If the "-o play-threads=n" option is in force, the play_pool spreads the
+ *  sequences over n threads, with the same output as this serial loop.
+ *
+ *  If the "-o lookahead=ms" option is in force, and the MIDI API can do it,
+ *  the patterns are played up to that much time ahead of the tick, and
+ *  their events are queued to be sent at their own time.  See
+ *  schedule_ahead().
+ *
  * \param tick
  *      Provides the tick at which to start playing.  This value is also
  *      copied to m_tick.
@@ -2899,16 +3046,123 @@ void
 perform::play (midipulse tick)
 {
     set_tick(tick);
-    for (int seq = 0; seq < m_sequence_high; ++seq)
+    tick = schedule_ahead(tick);
+
+    bool ahead = not_nullptr(m_master_bus) && m_master_bus->in_cycle();
+    if (song_timeline_active())
     {
-        sequence * s = get_sequence(seq);
-        if (not_nullptr(s))
-            s->play_queue(tick, m_playback_mode, resume_note_ons());
+        m_song_timeline.play(tick);
+    }
+    else if (not_nullptr(m_play_pool))
+    {
+        m_play_pool->play(tick, m_playback_mode, resume_note_ons());
     }
+    else
+    {
+        for (int seq = 0; seq < m_sequence_high; ++seq)
+        {
+            sequence * s = get_sequence(seq);
+            if (not_nullptr(s))
+                s->play_queue(tick, m_playback_mode, resume_note_ons());
+        }
+    }
+    if (ahead)
+        m_master_bus->schedule_end();
+
     if (not_nullptr(m_master_bus))
         m_master_bus->flush();                      /* flush MIDI buss  */
 }
 
+/**
+ *  Figures out how far ahead perform::play() plays the patterns.  The
+ *  events are scheduled ahead only if the master buss has started to (see
+ *  mastermidibase::schedule_start()), and not while following JACK
+ *  transport or MIDI clock, or with the song timeline, whose positions or
+ *  events are not known ahead.  When looping in Song mode, the patterns are
+ *  never played past the right marker; the loop restarts at the left marker
+ *  only when it is reached.
+ *
+ *  The queue has the last word on timing, so that a tempo change found in
+ *  the look-ahead is applied up to the look-ahead early.  An API that
+ *  delays all of its output by a fixed latency, as PortMidi does, has no
+ *  look-ahead; its events are only stamped with their time.
+ *
+ * \param tick
+ *      The current tick.
+ *
+ * \return
+ *      Returns the tick up to which the patterns are to be played.  It is
+ *      the given tick if the events are not scheduled ahead.
+ */
+
+midipulse
+perform::schedule_ahead (midipulse tick)
+{
+    midipulse result = tick;
+    bool ok = not_nullptr(m_master_bus) && m_master_bus->scheduling();
+    if (ok)
+    {
+        ok = ! song_timeline_active() && ! m_usemidiclock &&
+            ! is_jack_running();
+    }
+
+    if (ok)
+    {
+        midibpm bpm = m_master_bus->get_beats_per_minute();
+        double pulseus = pulse_length_us(bpm, m_ppqn);
+        int leadms = m_master_bus->schedule_lead_ms();
+        if (pulseus > 0.0)
+            result += midipulse(leadms * 1000.0 / pulseus);
+
+        bool perfloop = m_looping &&
+            (m_playback_mode || start_from_perfedit() || song_start_mode());
+
+        midipulse rtick = get_right_tick();
+        if (perfloop && result >= rtick)
+            result = rtick - 1 > tick ? rtick - 1 : tick ;
+
+        if (result < m_lookahead_tick)
+            result = m_lookahead_tick;              /* never play it twice  */
+
+        m_lookahead_tick = result;
+        m_master_bus->schedule_cycle(m_current_tick, pulseus);
+    }
+    return result;
+}
+
+/**
+ *  Adds the events recorded during the cycle to their patterns.  Called by
+ *  the output thread at the end of each cycle, and once more when playback
+ *  stops, so that sequence::stream_event() never has to wait for the
+ *  pattern that the output thread is playing.  See
+ *  sequence::merge_recording().
+ */
+
+void
+perform::merge_recordings ()
+{
+    for (int seq = 0; seq < m_sequence_high; ++seq)
+    {
+        sequence * s = get_sequence(seq);
+        if (not_nullptr(s) && s->recording_pending())
+            s->merge_recording();
+    }
+}
+
+/**
+ *  Indicates if perform::play() uses the compiled song timeline.  It is
+ *  used only if the "-o song-timeline" option was given, only in Song mode,
+ *  and not while recording into the song, which changes the triggers on
+ *  every cycle.
+ */
+
+bool
+perform::song_timeline_active () const
+{
+    return m_playback_mode && ! m_song_recording &&
+        usr().option_song_timeline();
+}
+
 /**
  *  For every pattern/sequence that is active, sets the "original tick"
  *  value for the pattern.  This is really the "last tick" value, so we
@@ -2922,11 +3176,14 @@ perform::play (midipulse tick)
 void
 perform::set_orig_ticks (midipulse tick)
 {
+    m_lookahead_tick = 0;
     for (int s = 0; s < m_sequence_high; ++s)       /* m_sequence_max   */
     {
         if (is_active(s))
             m_seqs[s]->set_last_tick(tick);         /* set_orig_tick()  */
     }
+    if (song_timeline_active())
+        m_song_timeline.seek(tick);
 }
 
 /**
@@ -3408,7 +3665,11 @@ perform::inner_start (bool songmode)
     {
         playback_mode(songmode);
         if (songmode)
+        {
             off_sequences();
+            if (song_timeline_active())
+                m_song_timeline.compile();
+        }
 
         is_running(true);
         m_condition_var.signal();
@@ -3559,6 +3820,7 @@ void
 perform::reset_sequences (bool pause)
 {
     void (sequence::* f) (bool) = pause ? &sequence::pause : &sequence::stop ;
+    m_lookahead_tick = 0;
     for (int s = 0; s < m_sequence_high; ++s)           /* m_sequence_max   */
     {
         if (is_active(s))
@@ -3958,18 +4220,10 @@ perform::output_func ()
 #ifdef PLATFORM_WINDOWS
         long last;                          // beginning time
         long current;                       // current time
-#ifdef SEQ64_STATISTICS_SUPPORT
-        long stats_loop_start = 0;
-        long stats_loop_finish = 0;
-#endif
         long delta;                         // difference between last & current
 #else                                       // not Windows
         struct timespec last;               // beginning time
         struct timespec current;            // current time
-#ifdef SEQ64_STATISTICS_SUPPORT
-        struct timespec stats_loop_start;
-        struct timespec stats_loop_finish;
-#endif
         struct timespec delta;              // difference between last & current
 #endif
 
@@ -4003,32 +4257,6 @@ perform::output_func ()
         pad.js_ticks_delta = 0.0;
         pad.js_delta_tick_frac = 0L;        // from seq24 0.9.3, long value
 
-        /*
-         * Not sure that we really need this feature.  Will have to see if
-         * anyone wants it.  This is currently not a complete commenting out
-         * of the feature at this time.
-         */
-
-#ifdef SEQ64_STATISTICS_SUPPORT
-        midipulse stats_total_tick = 0;
-        long stats_loop_index = 0;
-        long stats_min = 0x7FFFFFFF;
-        long stats_max = 0;
-        long stats_avg = 0;
-        long stats_last_clock_us = 0;
-        long stats_clock_width_us = 0;
-        long stats_all[100];                // why 100?
-        long stats_clock[100];
-        if (rc().stats())                   // \change ca 2016-01-24
-        {
-            for (int i = 0; i < 100; ++i)
-            {
-                stats_all[i] = 0;
-                stats_clock[i] = 0;
-            }
-        }
-#endif  // SEQ64_STATISTICS_SUPPORT
-
         /*
          * If we are in the performance view (song editor), we care about
          * starting from the m_starting_tick offset.  However, if the pause
@@ -4054,20 +4282,9 @@ perform::output_func ()
         }
 
         int ppqn = m_master_bus->get_ppqn();
-
-#ifdef SEQ64_STATISTICS_SUPPORT
-
-#ifdef PLATFORM_WINDOWS
-        last = timeGetTime();                   // get start time position
-        if (rc().stats())
-            stats_last_clock_us = last * 1000;
-#else
-        clock_gettime(CLOCK_REALTIME, &last);   // get start time position
-        if (rc().stats())
-            stats_last_clock_us = (last.tv_sec*1000000) + (last.tv_nsec/1000);
-#endif
-
-#else   // SEQ64_STATISTICS_SUPPORT
+        m_lookahead_tick = 0;
+        if (usr().option_lookahead_ms() > 0 && ! is_jack_running())
+            (void) m_master_bus->schedule_start();
 
 #ifdef PLATFORM_WINDOWS
         last = timeGetTime();                   // get start time position
@@ -4075,8 +4292,6 @@ perform::output_func ()
         clock_gettime(CLOCK_REALTIME, &last);   // get start time position
 #endif
 
-#endif  // SEQ64_STATISTICS_SUPPORT
-
         while (is_running())
         {
             /**
@@ -4087,16 +4302,7 @@ perform::output_func ()
              * -# Play from current tick to prebuffer.
              */
 
-#ifdef SEQ64_STATISTICS_SUPPORT
-            if (rc().stats())
-            {
-#ifdef PLATFORM_WINDOWS
-                stats_loop_start = timeGetTime();
-#else
-                clock_gettime(CLOCK_REALTIME, &stats_loop_start);
-#endif
-            }
-#endif  // SEQ64_STATISTICS_SUPPORT
+            long long cycle_start_ns = perf_stats::now_ns();
 
             /*
              * Get the delta time.
@@ -4131,8 +4337,9 @@ perform::output_func ()
             pad.js_delta_tick_frac = long(delta_tick_num % delta_tick_denom);
             if (m_usemidiclock)
             {
-                delta_tick = m_midiclocktick;               /* int to double */
-                m_midiclocktick = 0;
+                delta_tick = long(m_clock_follower.advance(cycle_start_ns));
+                if (m_clock_follower.locked())
+                    bpm = m_clock_follower.bpm();           /* for sleeping */
             }
             if (m_midiclockpos >= 0)
             {
@@ -4203,6 +4410,7 @@ perform::output_func ()
 
             if (change_position)
             {
+                m_master_bus->purge();              /* drop events ahead    */
                 set_orig_ticks(m_starting_tick);
                 m_starting_tick = m_left_tick;      // restart at left marker
                 m_reposition = false;
@@ -4305,46 +4513,15 @@ perform::output_func ()
                  */
 
                 m_master_bus->emit_clock(midipulse(pad.js_clock_tick));
-
-#ifdef SEQ64_STATISTICS_SUPPORT
-                if (rc().stats())
-                {
-                    while (stats_total_tick <= pad.js_total_tick)
-                    {
-                        /*
-                         * Uses inline function for c_ppqn / 24.  Checks to see
-                         * if there was a tick.  What's up with the constants
-                         * 100 and 300?
-                         */
-
-                        int ct = clock_ticks_from_ppqn(m_ppqn);
-                        if ((stats_total_tick % ct) == 0)
-                        {
-#ifdef PLATFORM_WINDOWS
-                            long current_us = current * 1000;
-#else
-                            long current_us = (current.tv_sec * 1000000) +
-                                (current.tv_nsec / 1000);
-#endif
-                            stats_clock_width_us = current_us-stats_last_clock_us;
-                            stats_last_clock_us = current_us;
-
-                            int index = stats_clock_width_us / 300;
-                            if (index >= 100)
-                                index = 99;
-
-                            stats_clock[index]++;
-                        }
-                        stats_total_tick++;
-                    }
-                }
-#endif  // SEQ64_STATISTICS_SUPPORT
             }
+            merge_recordings();                 /* input recorded meanwhile */
 
             /**
-             *  Figure out how much time we need to sleep, and do it.
+             *  Figure out how much time we need to sleep, and do it.  The
+             *  cycle's work ends here, as far as the statistics go.
              */
 
+            statistics().end_cycle(cycle_start_ns, perf_stats::now_ns());
             last = current;
 
 #ifdef PLATFORM_WINDOWS
@@ -4381,84 +4558,20 @@ perform::output_func ()
                 delta_us = long(next_clock_delta_us);
 
             if (delta_us > 0)
-                (void) microsleep(delta_us);            /* daemonize.hpp    */
-
-#ifdef SEQ64_STATISTICS_SUPPORT
-            else
             {
-                if (rc().stats())
-                {
-                    errprint("Underrun");
-                }
-            }
-#endif  // SEQ64_STATISTICS_SUPPORT
-
-#ifdef SEQ64_STATISTICS_SUPPORT
-            if (rc().stats())
-            {
-#ifdef PLATFORM_WINDOWS
-                stats_loop_finish = timeGetTime();
-                delta = stats_loop_finish - stats_loop_start;
-                long delta_us = delta * 1000;
-#else
-                clock_gettime(CLOCK_REALTIME, &stats_loop_finish);
-                delta.tv_sec  = stats_loop_finish.tv_sec-stats_loop_start.tv_sec;
-                delta.tv_nsec = stats_loop_finish.tv_nsec-stats_loop_start.tv_nsec;
-                long delta_us = (delta.tv_sec*1000000) + (delta.tv_nsec/1000);
-#endif
-                int index = delta_us / 100;         // why the 100?
-                if (index >= 100)
-                    index = 99;
-
-                stats_all[index]++;
-                if (delta_us > stats_max)
-                    stats_max = delta_us;
-
-                if (delta_us < stats_min)
-                    stats_min = delta_us;
-
-                stats_avg += delta_us;
-                stats_loop_index++;
-                if (stats_loop_index > 200)         // what is 200?
-                {
-                    stats_loop_index = 0;
-                    stats_avg /= 200;
-                    printf
-                    (
-                        "stats_avg[%ld]us stats_min[%ld]us stats_max[%ld]us\n",
-                        stats_avg, stats_min, stats_max
-                    );
-                    stats_min = 0x7FFFFFFF;
-                    stats_max = 0;
-                    stats_avg = 0;
-                }
+                long long sleep_ns = perf_stats::now_ns();
+                (void) microsleep(delta_us);            /* daemonize.hpp    */
+                statistics().wake_up(delta_us, sleep_ns, perf_stats::now_ns());
             }
-#endif  // SEQ64_STATISTICS_SUPPORT
+            else
+                statistics().underrun();
 
             if (pad.js_jack_stopped)
                 inner_stop();
         }
-#ifdef SEQ64_STATISTICS_SUPPORT
+        merge_recordings();                     /* the last stragglers  */
         if (rc().stats())
-        {
-            printf("\n\n-- trigger width --\n");
-            for (int i = 0; i < 100; ++i)
-            {
-                printf("[%3d][%8ld]\n", i * 100, stats_all[i]);
-            }
-            printf("\n\n-- clock width --\n");
-
-            midibpm bpm  = m_master_bus->get_beats_per_minute();
-            printf
-            (
-                "optimal: [%d us]\n", int(clock_tick_duration_bogus(bpm, m_ppqn))
-            );
-            for (int i = 0; i < 100; ++i)
-            {
-                printf("[%3d][%8ld]\n", i * 300, stats_clock[i]);
-            }
-        }
-#endif  // SEQ64_STATISTICS_SUPPORT
+            printf("\n%s\n", statistics().report().c_str());
 
         /*
          * Disabling this setting allows all of the progress bars (seqroll,
@@ -5726,6 +5839,40 @@ perform::input_func ()
     pthread_exit(0);
 }
 
+/**
+ *  Converts the input delay of an event to the tick at which the event
+ *  arrived.  The backends set the timestamp of each input event to the
+ *  number of microseconds since it arrived, plus the configured latency of
+ *  its input buss (see midibase::get_midi_event()), so that the polling
+ *  delay and the scheduling of the input thread do not move the recorded
+ *  event.  Carrying a delay, rather than an absolute time, keeps the value
+ *  small enough for a midipulse everywhere, and leaves the conversion to
+ *  the one object that knows the transport position.
+ *
+ * \param delayus
+ *      The input delay in microseconds.
+ *
+ * \return
+ *      Returns the current tick less the delay at the current tempo, but
+ *      not less than 0.  If playback is not running, the tick does not
+ *      move, and the current tick is returned.
+ */
+
+midipulse
+perform::input_tick (long delayus)
+{
+    midipulse result = get_tick();
+    if (is_running() && delayus > 0)
+    {
+        midipulse ticks = midipulse
+        (
+            delta_time_us_to_ticks(delayus, get_beats_per_minute(), m_ppqn)
+        );
+        result = result > ticks ? result - ticks : 0 ;
+    }
+    return result;
+}
+
 /**
  *  A helper function for perform::input_func().
  */
@@ -5754,7 +5901,11 @@ perform::poll_cycle ()
                         }
                         else
                         {
-                            ev.set_timestamp(get_tick());
+                            long long arrivalns = perf_stats::now_ns() -
+                                1000LL * ev.get_timestamp();   /* delay */
+
+                            (void) m_master_bus->forward_thru(ev);
+                            ev.set_timestamp(input_tick(ev.get_timestamp()));
 #ifdef PLATFORM_DEBUG_TMI
                             ev.print_note();
 #endif
@@ -5765,6 +5916,8 @@ perform::poll_cycle ()
                                 m_master_bus->dump_midi_input(ev);
                             else
                                 m_master_bus->get_sequence()->stream_event(ev);
+
+                            statistics().input(arrivalns);
                         }
                     }
                     else
@@ -5779,7 +5932,8 @@ perform::poll_cycle ()
                 {
                     song_start_mode(false);                     /* Kepler34 */
                     m_midiclockrunning = m_usemidiclock = true;
-                    m_midiclocktick = m_midiclockpos = 0;
+                    m_midiclockpos = 0;
+                    m_clock_follower.start(m_midiclockincrement);
                     stop_playing();
                     start_playing(false);                       /* Live     */
                     if (rc().verbose_option())
@@ -5793,6 +5947,7 @@ perform::poll_cycle ()
                     m_midiclockpos = get_tick();
                     m_dont_reset_ticks = true;
                     m_midiclockrunning = m_usemidiclock = true;
+                    m_clock_follower.start(m_midiclockincrement);
 
                     /*
                      * Not sure why, but doing this twice works.
@@ -5826,7 +5981,12 @@ perform::poll_cycle ()
                      */
 
                     if (m_midiclockrunning)
-                        m_midiclocktick += m_midiclockincrement;
+                    {
+                        long long arrival = perf_stats::now_ns() -
+                            ev.get_timestamp() * 1000LL;    /* delay in us  */
+
+                        m_clock_follower.pulse(arrival);
+                    }
                 }
                 else if (ev.get_status() == EVENT_MIDI_SONG_POS)
                 {
@@ -7340,6 +7500,28 @@ perform::print_busses () const
         m_master_bus->print();
 }
 
+/**
+ *  Lets the patterns with identical events share one container of events
+ *  (see event_list::share_duplicates()).  Called after a song is read, while
+ *  no other thread edits or plays the patterns.
+ *
+ * \return
+ *      Returns the number of patterns that now share the events of another.
+ */
+
+int
+perform::share_duplicate_patterns ()
+{
+    std::vector<event_list *> lists;
+    for (int s = 0; s < m_sequence_high; ++s)       /* modest speed-up */
+    {
+        sequence * seq = get_sequence(s);
+        if (not_nullptr(seq))
+            lists.push_back(&seq->events());
+    }
+    return event_list::share_duplicates(lists);
+}
+
 /**
  *  Calls the apply_song_transpose() function for all active sequences.
  */
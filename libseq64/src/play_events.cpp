@@ -0,0 +1,171 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          play_events.cpp
+ *
+ *  This module defines the compact playback copy of the events of a
+ *  sequence.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-14
+ * \updates       2023-03-14
+ * \license       GNU GPLv2 or above
+ *
+ *  The records are built in one pass over the event_list.  The vector keeps
+ *  its capacity when rebuilt, so that a pattern being recorded into does
+ *  not reallocate on every note.
+ */
+
+#include "calculations.hpp"             /* seq64::tempo_us_from_bytes()     */
+#include "event_list.hpp"               /* seq64::event_list, event         */
+#include "play_events.hpp"              /* seq64::play_events               */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/*
+ *  The record must stay small and trivially copyable; that is its purpose.
+ */
+
+static_assert
+(
+    sizeof(play_event) <= 16, "play_event is larger than 16 bytes"
+);
+
+/**
+ *  Constructs an empty copy, which is not current for any generation.
+ */
+
+play_events::play_events ()
+ :
+    m_records       (),
+    m_generation    (0),
+    m_built         (false)
+{
+    // Empty body
+}
+
+/**
+ *  Rebuilds the records from an event_list.
+ *
+ * \param evl
+ *      The events of the sequence.  The caller holds the sequence mutex.
+ *
+ * \param generation
+ *      The current generation of the sequence.
+ */
+
+void
+play_events::build (const event_list & evl, unsigned generation)
+{
+    m_records.clear();
+    m_records.reserve(std::size_t(evl.count()));
+    for
+    (
+        event_list::const_iterator i = evl.begin(); i != evl.end(); ++i
+    )
+    {
+        const event & er = DREF(i);
+        play_event pe;
+        pe.pe_timestamp = er.get_timestamp();
+        pe.pe_status = er.get_status();
+        pe.pe_data[0] = er.data(0);
+        pe.pe_data[1] = er.data(1);
+        pe.pe_flags = 0;
+        pe.pe_tempo = 0;
+        if (er.is_tempo())
+        {
+            if (er.get_sysex_size() != 3)
+                continue;                       /* tempo() would be 0       */
+
+            const event::SysexContainer & data = er.get_sysex();
+            midibyte t[3];
+            t[0] = data[0];
+            t[1] = data[1];
+            t[2] = data[2];
+            pe.pe_flags = pe_tempo;
+            pe.pe_tempo = unsigned(tempo_us_from_bytes(t));
+        }
+        else if (er.is_ex_data())
+        {
+            continue;                           /* never played             */
+        }
+        else
+        {
+            midibyte channel = er.get_channel();
+            if (er.is_note())
+                pe.pe_flags |= pe_note;
+
+            if (channel == EVENT_NULL_CHANNEL)
+                pe.pe_flags |= pe_nochan;
+            else
+                pe.pe_flags |= midibyte((channel << 4) & pe_chanmask);
+        }
+        m_records.push_back(pe);
+    }
+    m_generation = generation;
+    m_built = true;
+}
+
+/**
+ *  Fills in an event from a record, for sending to the busses.  The
+ *  editor state of the event (links, selection, and the like) is left at
+ *  its defaults.
+ *
+ * \param pe
+ *      The record.
+ *
+ * \param [out] ev
+ *      The event to fill in; normally a default-constructed one.
+ */
+
+void
+play_events::to_event (const play_event & pe, event & ev)
+{
+    ev.set_timestamp(pe.pe_timestamp);
+    if ((pe.pe_flags & pe_tempo) != 0)
+    {
+        midibyte t[3];
+        tempo_us_to_bytes(t, int(pe.pe_tempo));
+        ev.set_status(EVENT_MIDI_META, EVENT_META_SET_TEMPO);
+        (void) ev.set_sysex(t, 3);
+    }
+    else
+    {
+        midibyte channel = (pe.pe_flags & pe_nochan) != 0 ?
+            EVENT_NULL_CHANNEL : midibyte((pe.pe_flags & pe_chanmask) >> 4) ;
+
+        ev.set_status(pe.pe_status, channel);
+        ev.set_data(pe.pe_data[0], pe.pe_data[1]);
+    }
+}
+
+}           // namespace seq64
+
+/*
+ * play_events.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,376 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          play_pool.cpp
+ *
+ *  This module defines a pool of threads that evaluates the patterns in
+ *  each output cycle.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-09
+ * \updates       2023-03-22
+ * \license       GNU GPLv2 or above
+ *
+ *  Each sequence is evaluated by exactly one thread per cycle, under its own
+ *  mutex, so the sequences need no further protection.  What a sequence
+ *  touches outside itself is either read-only during playback (the
+ *  transposition, the MIDI control-out settings) or goes through the
+ *  buffer.  That includes tempo events, which sequence::play() normally
+ *  applies at once; a worker buffers them instead, and merge() applies them
+ *  in order.
+ */
+
+#include <cstring>                      /* std::memset()                    */
+
+#include "app_limits.h"                 /* SEQ64_PLAY_THREADS_MAX           */
+#include "easy_macros.h"                /* not_nullptr() macro              */
+#include "mastermidibus.hpp"            /* seq64::mastermidibus             */
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "play_pool.hpp"                /* seq64::play_pool, play_buffer    */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "settings.hpp"                 /* seq64::rc()                      */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The number of records reserved by each buffer up front, so that a
+ *  moderately busy cycle does not allocate at all.
+ */
+
+static const std::size_t s_buffer_reserve = 1024;
+
+/**
+ *  Constructs an empty buffer.
+ */
+
+play_buffer::play_buffer ()
+ :
+    m_records   ()
+{
+    m_records.reserve(s_buffer_reserve);
+}
+
+/**
+ *  Adds an event to the buffer.
+ *
+ * \param bus
+ *      The buss on which the event is to be played.
+ *
+ * \param ev
+ *      The event, which is copied.
+ *
+ * \param channel
+ *      The channel on which the event is to be played.
+ *
+ * \param tag
+ *      The tag given to mastermidibase::play_ahead(), or 0 if the event
+ *      was given to mastermidibase::play().
+ */
+
+void
+play_buffer::add (bussbyte bus, const event & ev, midibyte channel, int tag)
+{
+    record r;
+    r.pr_bus = bus;
+    r.pr_channel = channel;
+    r.pr_tag = tag;
+    r.pr_event = ev;
+    m_records.push_back(r);
+}
+
+/**
+ *  Creates the pool and starts its threads.  If a thread cannot be created,
+ *  the pool just works with fewer threads.
+ *
+ * \param p
+ *      The performance object whose sequences are to be played.
+ *
+ * \param threads
+ *      The number of threads, including the caller of play().  Clamped to
+ *      the range 1 to SEQ64_PLAY_THREADS_MAX.
+ */
+
+play_pool::play_pool (perform & p, int threads)
+ :
+    m_perform           (p),
+    m_workers           (),
+    m_spans             (),
+    m_start             (),
+    m_done              (),
+    m_cycle             (0),
+    m_quit              (false),
+    m_running           (0),
+    m_next_chunk        (0),
+    m_chunk_count       (0),
+    m_sequence_high     (0),
+    m_tick              (0),
+    m_playback_mode     (false),
+    m_resume_note_ons   (false)
+{
+    if (threads < 1)
+        threads = 1;
+    else if (threads > SEQ64_PLAY_THREADS_MAX)
+        threads = SEQ64_PLAY_THREADS_MAX;
+
+    m_workers.resize(threads);
+    for (int w = 0; w < threads; ++w)
+    {
+        worker & wk = m_workers[w];
+        wk.wk_pool = this;
+        wk.wk_index = w;
+        wk.wk_launched = false;
+    }
+    for (int w = 1; w < threads; ++w)
+    {
+        worker & wk = m_workers[w];
+        int err = pthread_create(&wk.wk_thread, NULL, worker_func, &wk);
+        if (err != 0)
+        {
+            m_workers.resize(w);                /* nothing launched past w  */
+            break;
+        }
+        wk.wk_launched = true;
+    }
+}
+
+/**
+ *  Stops and joins the threads.  The caller must not be in play().
+ */
+
+play_pool::~play_pool ()
+{
+    m_start.lock();
+    m_quit = true;
+    m_start.broadcast();
+    m_start.unlock();
+    for (int w = 1; w < threads(); ++w)
+    {
+        if (m_workers[w].wk_launched)
+            pthread_join(m_workers[w].wk_thread, NULL);
+    }
+}
+
+/**
+ *  The thread function of each worker.  If the output thread runs with
+ *  real-time priority, so do the workers, but failing to get it is not an
+ *  error here; the output thread already reported it.
+ *
+ * \param myworker
+ *      The worker structure of the thread.
+ *
+ * \return
+ *      Always returns the null pointer.
+ */
+
+void *
+play_pool::worker_func (void * myworker)
+{
+    worker * wk = (worker *) myworker;
+
+#ifndef PLATFORM_WINDOWS
+    if (rc().priority())
+    {
+        struct sched_param schp;
+        std::memset(&schp, 0, sizeof(sched_param));
+        schp.sched_priority = 1;                /* same as output thread    */
+        (void) pthread_setschedparam(pthread_self(), SCHED_FIFO, &schp);
+    }
+#endif
+
+    wk->wk_pool->run(wk->wk_index);
+    return nullptr;
+}
+
+/**
+ *  The loop of each worker:  wait for a new cycle, evaluate chunks until
+ *  none are left, and report being done.
+ *
+ * \param index
+ *      The index of the worker.
+ */
+
+void
+play_pool::run (int index)
+{
+    unsigned long lastcycle = 0;
+    for (;;)
+    {
+        m_start.lock();
+        while (! m_quit && m_cycle == lastcycle)
+            m_start.wait();
+
+        bool quit = m_quit;
+        lastcycle = m_cycle;
+        m_start.unlock();
+        if (quit)
+            break;
+
+        evaluate(index);
+        m_done.lock();
+        if (--m_running == 0)
+            m_done.signal();
+
+        m_done.unlock();
+    }
+}
+
+/**
+ *  Evaluates all of the sequences for one output cycle, and plays what they
+ *  produce.  This function replaces the serial loop of perform::play(), and
+ *  has the same parameters as sequence::play_queue().  The master buss is
+ *  not flushed; perform::play() does that.
+ *
+ * \param tick
+ *      The tick up to which to play.
+ *
+ * \param playbackmode
+ *      True for Song mode, false for Live mode.
+ *
+ * \param resumenoteons
+ *      Indicates if notes are to be resumed.
+ */
+
+void
+play_pool::play (midipulse tick, bool playbackmode, bool resumenoteons)
+{
+    m_sequence_high = m_perform.sequence_high();
+    m_chunk_count = (m_sequence_high + SEQ64_PLAY_POOL_CHUNK - 1) /
+        SEQ64_PLAY_POOL_CHUNK;
+
+    if (m_chunk_count <= 0)
+        return;
+
+    if (int(m_spans.size()) < m_chunk_count)
+        m_spans.resize(m_chunk_count);
+
+    m_tick = tick;
+    m_playback_mode = playbackmode;
+    m_resume_note_ons = resumenoteons;
+    m_next_chunk.store(0, std::memory_order_relaxed);
+
+    int helpers = threads() - 1;
+    if (m_chunk_count == 1)
+        helpers = 0;                            /* nothing to share         */
+
+    if (helpers > 0)
+    {
+        m_done.lock();
+        m_running = helpers;
+        m_done.unlock();
+        m_start.lock();
+        ++m_cycle;                              /* publishes the parameters */
+        m_start.broadcast();
+        m_start.unlock();
+    }
+    evaluate(0);
+    if (helpers > 0)
+    {
+        m_done.lock();
+        while (m_running > 0)
+            m_done.wait();
+
+        m_done.unlock();
+    }
+    merge();
+}
+
+/**
+ *  Claims chunks of sequences and evaluates them, with the events going to
+ *  the buffer of the worker.
+ *
+ * \param index
+ *      The index of the worker.
+ */
+
+void
+play_pool::evaluate (int index)
+{
+    play_buffer & buffer = m_workers[index].wk_buffer;
+    buffer.clear();
+    mastermidibase::redirect(&buffer);
+    for (;;)
+    {
+        int chunk = m_next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= m_chunk_count)
+            break;
+
+        int seq = chunk * SEQ64_PLAY_POOL_CHUNK;
+        int last = seq + SEQ64_PLAY_POOL_CHUNK;
+        if (last > m_sequence_high)
+            last = m_sequence_high;
+
+        span & sp = m_spans[chunk];
+        sp.sp_worker = index;
+        sp.sp_begin = buffer.size();
+        for ( ; seq < last; ++seq)
+        {
+            sequence * s = m_perform.get_sequence(seq);
+            if (not_nullptr(s))
+                s->play_queue(m_tick, m_playback_mode, m_resume_note_ons);
+        }
+        sp.sp_end = buffer.size();
+    }
+    mastermidibase::redirect(nullptr);
+}
+
+/**
+ *  Plays the buffered events on the master buss, chunk by chunk, which is
+ *  the order of the serial loop, and applies the buffered tempo changes.
+ *  Called on the caller's thread once all of the workers are done.  Events
+ *  with a tag were played with mastermidibase::play_ahead().
+ */
+
+void
+play_pool::merge ()
+{
+    if (is_nullptr(m_perform.m_master_bus))
+        return;
+
+    mastermidibus & mmb = *m_perform.m_master_bus;
+    for (int chunk = 0; chunk < m_chunk_count; ++chunk)
+    {
+        const span & sp = m_spans[chunk];
+        play_buffer & buffer = m_workers[sp.sp_worker].wk_buffer;
+        for (std::size_t i = sp.sp_begin; i < sp.sp_end; ++i)
+        {
+            play_buffer::record & r = buffer.at(i);
+            if (r.pr_event.is_tempo())
+                m_perform.set_beats_per_minute(r.pr_event.tempo());
+            else if (r.pr_tag != 0)
+                mmb.play_ahead(r.pr_bus, &r.pr_event, r.pr_channel, r.pr_tag);
+            else
+                mmb.play(r.pr_bus, &r.pr_event, r.pr_channel);
+        }
+    }
+}
+
+}           // namespace seq64
+
+/*
+ * play_pool.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,16 +25,15 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-22
- * \updates       2021-05-05
+ * \updates       2023-03-11
  * \license       GNU GPLv2 or above
  *
  *  Note that this module also sets the legacy global variables, so that
  *  they can be used by modules that have not yet been cleaned up.
  *
- * \warning
- *      We're making the "statistics" support a configure-time option.  The
- *      run-time option will be left here, but the actual usage of it will be
- *      disabled unless configured with the --enable-statistics option.
+ *  The "statistics" option (-S, --stats) prints the report of the latency
+ *  and jitter statistics (see the perf_stats module) when playback stops.
+ *  The statistics themselves are always gathered.
  *
  * \todo
  *      Kepler34 has two more settings values: [midi-clock-mod-ticks],
@@ -128,6 +127,7 @@ rc_settings::rc_settings ()
     m_application_name          (seq_app_name()),
     m_app_client_name           (seq_client_name()),
     m_tempo_track_number        (0),
+    m_input_latency             (),
     m_recent_files              ()
 {
     // Empty body
@@ -181,6 +181,7 @@ rc_settings::rc_settings (const rc_settings & rhs)
     m_application_name          (rhs.m_application_name),
     m_app_client_name           (rhs.m_app_client_name),
     m_tempo_track_number        (rhs.m_tempo_track_number),
+    m_input_latency             (rhs.m_input_latency),
     m_recent_files              (rhs.m_recent_files)
 {
     // Empty body
@@ -244,6 +245,7 @@ rc_settings::operator = (const rc_settings & rhs)
 
         m_app_client_name           = rhs.m_app_client_name;
         m_tempo_track_number        = rhs.m_tempo_track_number;
+        m_input_latency             = rhs.m_input_latency;
         m_recent_files              = rhs.m_recent_files;
     }
     return *this;
@@ -307,6 +309,7 @@ rc_settings::set_defaults ()
     m_application_name          = seq_app_name();       // make it up-to-date
     m_app_client_name           = seq_client_name();    // ditto
     m_tempo_track_number        = 0;
+    m_input_latency.clear();
     m_recent_files.clear();
     set_config_files(SEQ64_CONFIG_NAME);
 }
@@ -563,6 +566,31 @@ rc_settings::tempo_track_number (int track)
     m_tempo_track_number = track;
 }
 
+/**
+ *  \setter m_input_latency[bus]
+ *
+ *  This setting is made only while reading the "rc" file, before the input
+ *  thread starts, so the vector can grow here without locking.
+ *
+ * \param bus
+ *      The input buss number, from 0 to SEQ64_DEFAULT_BUSS_MAX - 1.
+ *
+ * \param us
+ *      The latency in microseconds.  Negative values are treated as 0.
+ */
+
+void
+rc_settings::input_latency (int bus, int us)
+{
+    if (bus >= 0 && bus < SEQ64_DEFAULT_BUSS_MAX)
+    {
+        if (bus >= int(m_input_latency.size()))
+            m_input_latency.resize(bus + 1, 0);
+
+        m_input_latency[bus] = us > 0 ? us : 0 ;
+    }
+}
+
 /**
  * \getter m_recent_files
  *
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2017-03-12
- * \updates       2020-02-18
+ * \updates       2023-03-08
  * \license       GNU GPLv2 or above
  *
  *  The first part of this file defines a couple of global structure
@@ -275,9 +275,7 @@ seq_build_details ()
 #ifdef SEQ64_SONG_BOX_SELECT
         << "  Box song selection\n"
 #endif
-#ifdef SEQ64_STATISTICS_SUPPORT
-        << "  Statistics support\n"
-#endif
+        << "  Latency and jitter statistics\n"
 #ifdef PLATFORM_WINDOWS
         << "  Windows support\n"
 #endif
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2021-05-06
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  The functionality of this class also includes handling some of the
@@ -80,7 +80,9 @@ namespace seq64
 
 /**
  *  A static clipboard for holding pattern/sequence events.  Being static
- *  allows for copy/paste between patterns.
+ *  allows for copy/paste between patterns.  Like the undo and redo stacks,
+ *  it shares the events it is given (see event_list), so copying a large
+ *  selection does not copy it twice.
  */
 
 event_list sequence::m_events_clipboard;
@@ -103,13 +105,18 @@ sequence::sequence (int ppqn)
  :
     m_parent                    (nullptr),      // set when sequence installed
     m_events                    (),
+    m_play_events               (),
+    m_columns                   (),
+    m_event_index               (),
     m_triggers                  (*this),
     m_events_undo_hold          (),             // stazed
     m_have_undo                 (false),        // stazed
     m_have_redo                 (false),        // stazed
     m_events_undo               (),
     m_events_redo               (),
-    m_iterator_draw             (m_events.begin()),
+    m_iterator_draw             (m_events.cbegin()),
+    m_draw_serial               (m_events.serial()),
+    m_ex_serial                 (m_events.serial()),
     m_channel_match             (false),        // stazed
     m_midi_channel              (0),
     m_bus                       (0),
@@ -121,6 +128,7 @@ sequence::sequence (int ppqn)
     m_was_playing               (false),
     m_playing                   (false),
     m_recording                 (false),
+    m_record_queue              (),
     m_expanded_recording        (false),
     m_quantized_rec             (false),
     m_thru                      (false),
@@ -138,6 +146,7 @@ sequence::sequence (int ppqn)
     m_dirty_edit                (true),
     m_dirty_perf                (true),
     m_dirty_names               (true),
+    m_generation                (0),
     m_editing                   (false),
     m_raise                     (false),
     m_status                    (0),
@@ -197,6 +206,7 @@ sequence::~sequence ()
 void
 sequence::modify ()
 {
+    ++m_generation;
     if (not_nullptr(m_parent))
         m_parent->modify();
 }
@@ -208,6 +218,11 @@ sequence::modify ()
  *  so we created this partial_assign() function to do this work, and replaced
  *  operator =() with this function in client code.
  *
+ *  The events are shared with rhs, not copied (see event_list), and, if
+ *  they were verified and linked for the same length, verify_and_link()
+ *  finds nothing to do, so copying and pasting a pattern takes the same
+ *  short time however long the pattern is.
+ *
  * \threadsafe
  *
  * \param rhs
@@ -241,6 +256,46 @@ sequence::partial_assign (const sequence & rhs)
     }
 }
 
+/**
+ *  Copies, for a song_snapshot, what midi_container::fill() writes to a
+ *  MIDI file:  the events, shared as in partial_assign(), the trigger list,
+ *  and the settings saved with each track.  Unlike partial_assign(), it
+ *  takes the lock of rhs, since rhs is in use by other threads, and leaves
+ *  the parent, the master buss, and the trigger undo stacks alone, so that
+ *  the copy is never played or edited.
+ *
+ * \threadsafe
+ *
+ * \param rhs
+ *      Provides the source of the new member values.
+ */
+
+void
+sequence::snapshot_assign (const sequence & rhs)
+{
+    if (this != &rhs)
+    {
+        automutex locker(rhs.m_mutex);
+        m_events        = rhs.m_events;
+        if (rhs.m_recording)
+            m_events.unshare();         /* else merge_recording() copies    */
+
+        m_triggers.m_triggers = rhs.m_triggers.m_triggers;
+        m_midi_channel  = rhs.m_midi_channel;
+        m_transposable  = rhs.m_transposable;
+        m_bus           = rhs.m_bus;
+        m_name          = rhs.m_name;
+        m_ppqn          = rhs.m_ppqn;
+        m_length        = rhs.m_length;
+        m_time_beats_per_measure = rhs.m_time_beats_per_measure;
+        m_time_beat_width = rhs.m_time_beat_width;
+        m_musical_key   = rhs.m_musical_key;
+        m_musical_scale = rhs.m_musical_scale;
+        m_background_sequence = rhs.m_background_sequence;
+        m_seq_color     = rhs.m_seq_color;
+    }
+}
+
 /**
  *  Modifies the undo-hold container.
  *
@@ -310,8 +365,11 @@ sequence::push_undo (bool hold)
     if (hold)
         m_events_undo.push(m_events_undo_hold);     // stazed
     else
+    {
         m_events_undo.push(m_events);
-
+        if (m_recording)
+            m_events.unshare();                     /* see set_recording()  */
+    }
     set_have_undo();                                // stazed
 }
 
@@ -1142,6 +1200,10 @@ sequence::toggle_queued ()
  *  function.  Its return value and side-effects tell if there's a change in
  *  playing based on triggers, and provides the ticks that bracket it.
  *
+ *  The events are read from m_play_events, the compact copy of m_events,
+ *  which is rebuilt first if the events have changed since the last call.
+ *  Only the events in the frame are made into event objects.
+ *
  * \param tick
  *      Provides the current end-tick value.  The tick comes in as a global
  *      tick.
@@ -1209,45 +1271,59 @@ sequence::play
         if (transpose == 0)
             transpose = get_transposable() ? m_parent->get_transpose() : 0 ;
 
-        event_list::iterator e = m_events.begin();
-        while (e != m_events.end())
+        if (! m_play_events.current(m_generation))
+            m_play_events.build(m_events, m_generation);
+
+        int tag = m_master_bus->in_cycle() ? schedule_tag() : 0 ;
+        const play_events::Records & pr = m_play_events.records();
+        std::size_t count = pr.size();
+        std::size_t e = 0;
+        while (e < count)
         {
-            event & er = DREF(e);
-            midipulse stamp = er.get_timestamp() + offset_base;
+            const play_event & pe = pr[e];
+            midipulse stamp = pe.pe_timestamp + offset_base;
             if (stamp >= start_tick_offset && stamp <= end_tick_offset)
             {
-                if (transpose != 0 && er.is_note()) /* includes Aftertouch  */
+                event ev;
+                play_events::to_event(pe, ev);
+                if ((pe.pe_flags & play_events::pe_tempo) != 0)
                 {
-                    event transposed_event = er;    /* assign ALL members   */
-                    transposed_event.transpose_note(transpose);
-                    put_event_on_bus(transposed_event);
+                    /*
+                     * A play_pool worker defers the tempo change to the
+                     * merge, to keep it in order.
+                     */
+
+                    if (mastermidibase::redirected())
+                        m_master_bus->play(m_bus, &ev, m_midi_channel);
+                    else if (not_nullptr(m_parent))
+                        m_parent->set_beats_per_minute(ev.tempo());
                 }
                 else
                 {
-                    if (er.is_tempo())
-                    {
-                        if (not_nullptr(m_parent))
-                            m_parent->set_beats_per_minute(er.tempo());
-                    }
-                    else if (! er.is_ex_data())
-                        put_event_on_bus(er);       /* frame still going    */
+                    if (transpose != 0 && (pe.pe_flags & play_events::pe_note))
+                        ev.transpose_note(transpose);   /* incl. Aftertouch */
+
+                    if (tag != 0)
+                        ev.set_timestamp(stamp - offset);   /* song tick    */
+
+                    put_event_on_bus(ev, tag);          /* frame still going */
                 }
             }
             else if (stamp > end_tick_offset)
                 break;                              /* frame is done        */
 
             ++e;                                    /* go to next event     */
-            if (e == m_events.end())                /* did we hit the end ? */
+            if (e == count)                         /* did we hit the end ? */
             {
-                e = m_events.begin();               /* yes, start over      */
+                e = 0;                              /* yes, start over      */
                 offset_base += length;              /* for another go at it */
             }
         }
     }
+    m_last_tick = end_tick + 1;                     /* for next frame       */
     if (trigger_turning_off)                        /* triggers: "turn off" */
-        set_playing(false);
+        set_playing(false);                         /* notes end at frame   */
 
-    m_last_tick = end_tick + 1;                     /* for next frame       */
     m_was_playing = m_playing;
 }
 
@@ -1263,6 +1339,7 @@ sequence::verify_and_link ()
 {
     automutex locker(m_mutex);
     m_events.verify_and_link(m_length);
+    ++m_generation;
 }
 
 /**
@@ -1275,6 +1352,7 @@ void
 sequence::link_new ()
 {
     automutex locker(m_mutex);
+    ++m_generation;                     /* the spans of m_event_index       */
     m_events.link_new();
 }
 
@@ -1294,6 +1372,7 @@ sequence::link_new ()
 void
 sequence::remove (event_list::iterator i)
 {
+    ++m_generation;
     event & er = DREF(i);
     if (er.is_note_off() && m_playing_notes[er.get_note()] > 0)
     {
@@ -1324,6 +1403,7 @@ sequence::remove (event_list::iterator i)
 void
 sequence::remove (event & e)
 {
+    ++m_generation;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & er = DREF(i);
@@ -1349,6 +1429,7 @@ bool
 sequence::remove_marked ()
 {
     automutex locker(m_mutex);
+    ++m_generation;
 
 #ifdef LAYK_PULL_REQUEST_95
 
@@ -1408,6 +1489,7 @@ void
 sequence::remove_selected ()
 {
     automutex locker(m_mutex);
+    ++m_generation;
     if (m_events.mark_selected())
     {
         m_events_undo.push(m_events);           /* push_undo() without lock */
@@ -1460,9 +1542,13 @@ sequence::get_selected_box
     tick_f = 0;
     note_h = 0;
     note_l = SEQ64_MIDI_COUNT_MAX;
-    for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    for
+    (
+        event_list::const_iterator i = m_events.cbegin();
+        i != m_events.cend(); ++i
+    )
     {
-        event & e = DREF(i);
+        const event & e = DREF(i);
         if (e.is_selected())
         {
             midipulse time = e.get_timestamp();
@@ -1512,9 +1598,13 @@ sequence::get_onsets_selected_box
     tick_f = 0;
     note_h = 0;
     note_l = SEQ64_MIDI_COUNT_MAX;
-    for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    for
+    (
+        event_list::const_iterator i = m_events.cbegin();
+        i != m_events.cend(); ++i
+    )
     {
-        event & e = DREF(i);
+        const event & e = DREF(i);
         if (e.is_selected() && e.is_note_on())
         {
             /*
@@ -1576,8 +1666,12 @@ sequence::get_clipboard_box
     }
     else
     {
-        event_list::iterator i;
-        for (i = m_events_clipboard.begin(); i != m_events_clipboard.end(); ++i)
+        event_list::const_iterator i;
+        for
+        (
+            i = m_events_clipboard.cbegin();
+            i != m_events_clipboard.cend(); ++i
+        )
         {
             midipulse time = DREF(i).get_timestamp();
             if (time < tick_s)
@@ -1636,6 +1730,29 @@ sequence::get_num_selected_events (midibyte status, midibyte cc) const
     return m_events.count_selected_events(status, cc);
 }
 
+/**
+ *  Gets the time-by-note index of the events, rebuilding it first if the
+ *  events have changed, or have been copied, since it was built.  Since
+ *  select_note_events() changes the events it finds, the events must not be
+ *  shared with an undo snapshot or another pattern, so they are copied
+ *  first if they are.
+ *
+ * \threadunsafe
+ *
+ * \return
+ *      Returns a reference to m_event_index, current for m_generation.
+ */
+
+const event_index &
+sequence::indexed_events ()
+{
+    m_events.unshare();                 /* the spans point to our own events */
+    if (! m_event_index.current(m_generation, m_events.serial()))
+        m_event_index.build(m_events, m_generation);
+
+    return m_event_index;
+}
+
 #if ! defined USE_STAZED_SELECTION_EXTENSIONS
 
 /**
@@ -1645,6 +1762,11 @@ sequence::get_num_selected_events (midibyte status, midibyte cc) const
  *  Compare this function to the convenience function select_all_notes(),
  *  which doesn't use range information.
  *
+ *  The events in the box are found with m_event_index, and acted on in the
+ *  order of the list, as when the whole list was walked.  An event that is
+ *  linked is in the box if its note overlaps it; an unlinked event, if its
+ *  timestamp is in the box, or slightly before it.
+ *
  * \threadsafe
  *
  * \param tick_s
@@ -1677,132 +1799,146 @@ sequence::select_note_events
 {
     int result = 0;
     automutex locker(m_mutex);
-    for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    event_index::Hits hits;
+    indexed_events().find_notes(tick_s, note_h, tick_f, note_l, hits);
+    for (std::size_t h = 0; h < hits.size(); ++h)
     {
-        event & er = DREF(i);
-        if (er.get_note() <= note_h && er.get_note() >= note_l)
+        const event_span & es = *hits[h];
+        if (select_note_event(*es.es_event, action, result))
+            break;
+
+        if (es.es_pair)                     /* and its Note Off, as well    */
         {
-            midipulse stick = 0;                    // must be initialized
-            midipulse ftick = 0;                    // must be initialized
-            if (er.is_linked())
-            {
-                event * ev = er.get_linked();       // pointer
-                if (er.is_note_off())
-                {
-                    stick = ev->get_timestamp();
-                    ftick = er.get_timestamp();
-                }
-                else if (er.is_note_on())
-                {
-                    ftick = ev->get_timestamp();
-                    stick = er.get_timestamp();
-                }
+            if (select_note_event(*es.es_event->get_linked(), action, result))
+                break;
+        }
+    }
+    return result;
+}
 
-                bool tand = (stick <= tick_f) && (ftick >= tick_s);
-                bool tor = (stick <= tick_f) || (ftick >= tick_s);
-                if (((stick <= ftick) && tand) || ((stick > ftick) && tor))
-                {
-                    if (action == e_select || action == e_select_one)
-                    {
-                        er.select();
-                        ev->select();
-                        ++result;
-                        if (action == e_select_one)
-                            break;
-                    }
-                    if (action == e_is_selected)
-                    {
-                        if (er.is_selected())
-                        {
-                            result = 1;
-                            break;
-                        }
-                    }
-                    if (action == e_would_select)
-                    {
-                        result = 1;
-                        break;
-                    }
-                    if (action == e_deselect)
-                    {
-                        result = 0;
-                        er.unselect();
-                        ev->unselect();
-                    }
-                    if (action == e_toggle_selection && er.is_note_on())
-                    {
-                        ++result;
-                        if (er.is_selected())       // don't toggle twice
-                        {
-                            er.unselect();
-                            ev->unselect();
-                        }
-                        else
-                        {
-                            er.select();
-                            ev->select();
-                        }
-                    }
-                    if (action == e_remove_one)
-                    {
-                        remove(er);
-                        remove(*ev);
-                        reset_draw_marker();
-                        ++result;
-                        break;
-                    }
-                }
+/**
+ *  Performs the action of select_note_events() on one event found in the
+ *  box.  A linked event takes its linked event along.
+ *
+ * \threadunsafe
+ *
+ * \param er
+ *      The event to act on.
+ *
+ * \param action
+ *      The action to perform.
+ *
+ * \param [out] result
+ *      The number of events acted on so far, updated as the action requires.
+ *
+ * \return
+ *      Returns true if the action is done, and no other event is to be
+ *      acted on.
+ */
+
+bool
+sequence::select_note_event
+(
+    event & er, select_action_t action, int & result
+)
+{
+    if (er.is_linked())
+    {
+        event * ev = er.get_linked();       // pointer
+        if (action == e_select || action == e_select_one)
+        {
+            er.select();
+            ev->select();
+            ++result;
+            if (action == e_select_one)
+                return true;
+        }
+        if (action == e_is_selected)
+        {
+            if (er.is_selected())
+            {
+                result = 1;
+                return true;
+            }
+        }
+        if (action == e_would_select)
+        {
+            result = 1;
+            return true;
+        }
+        if (action == e_deselect)
+        {
+            result = 0;
+            er.unselect();
+            ev->unselect();
+        }
+        if (action == e_toggle_selection && er.is_note_on())
+        {
+            ++result;
+            if (er.is_selected())           // don't toggle twice
+            {
+                er.unselect();
+                ev->unselect();
             }
             else
             {
-                stick = ftick = er.get_timestamp();
-                if (stick >= tick_s - 16 && ftick <= tick_f)
-                {
-                    if (action == e_select || action == e_select_one)
-                    {
-                        er.select();
-                        ++result;
-                        if (action == e_select_one)
-                            break;
-                    }
-                    if (action == e_is_selected)
-                    {
-                        if (er.is_selected())
-                        {
-                            result = 1;
-                            break;
-                        }
-                    }
-                    if (action == e_would_select)
-                    {
-                        result = 1;
-                        break;
-                    }
-                    if (action == e_deselect)
-                    {
-                        result = 0;
-                        er.unselect();
-                    }
-                    if (action == e_toggle_selection)
-                    {
-                        ++result;
-                        if (er.is_selected())
-                            er.unselect();
-                        else
-                            er.select();
-                    }
-                    if (action == e_remove_one)
-                    {
-                        remove(er);
-                        reset_draw_marker();
-                        ++result;
-                        break;
-                    }
-                }
+                er.select();
+                ev->select();
             }
         }
+        if (action == e_remove_one)
+        {
+            remove(er);
+            remove(*ev);
+            reset_draw_marker();
+            ++result;
+            return true;
+        }
     }
-    return result;
+    else
+    {
+        if (action == e_select || action == e_select_one)
+        {
+            er.select();
+            ++result;
+            if (action == e_select_one)
+                return true;
+        }
+        if (action == e_is_selected)
+        {
+            if (er.is_selected())
+            {
+                result = 1;
+                return true;
+            }
+        }
+        if (action == e_would_select)
+        {
+            result = 1;
+            return true;
+        }
+        if (action == e_deselect)
+        {
+            result = 0;
+            er.unselect();
+        }
+        if (action == e_toggle_selection)
+        {
+            ++result;
+            if (er.is_selected())
+                er.unselect();
+            else
+                er.select();
+        }
+        if (action == e_remove_one)
+        {
+            remove(er);
+            reset_draw_marker();
+            ++result;
+            return true;
+        }
+    }
+    return false;
 }
 
 #endif  // ! definded USE_STAZED_SELECTION_EXTENSIONS
@@ -2164,46 +2300,15 @@ sequence::stretch_selected (midipulse delta_tick)
     if (mark_selected())
     {
         automutex locker(m_mutex);
-        unsigned first_ev = 0x7fffffff;             /* timestamp lower limit */
-        unsigned last_ev = 0x00000000;              /* timestamp upper limit */
         m_events_undo.push(m_events);               /* push_undo(), no lock  */
-        for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
+        m_columns.gather(m_events);
+        if (m_columns.stretch(delta_tick))          /* moves marked events  */
         {
-            event & er = DREF(i);
-            if (er.is_selected())
-            {
-                event * e = &er;
-                if (e->get_timestamp() < midipulse(first_ev))
-                    first_ev = e->get_timestamp();
-
-                if (e->get_timestamp() > midipulse(last_ev))
-                    last_ev = e->get_timestamp();
-            }
-        }
-        unsigned old_len = last_ev - first_ev;
-        unsigned new_len = old_len + delta_tick;
-        if (new_len > 1)
-        {
-            float ratio = float(new_len) / float(old_len);
-            mark_selected();                        /* locked recursively   */
-            for
-            (
-                event_list::iterator i = m_events.begin();
-                i != m_events.end(); ++i
-            )
-            {
-                event & er = DREF(i);
-                if (er.is_marked())
-                {
-                    event n = er;                   /* copy the event       */
-                    midipulse t = er.get_timestamp();
-                    n.set_timestamp(midipulse(ratio * (t - first_ev)) + first_ev);
-                    n.unmark();
-                    add_event(n);
-                }
-            }
-            if (remove_marked())
-                verify_and_link();
+            (void) m_columns.apply(m_events);       /* sorts once, at end   */
+            ++m_generation;
+            reset_draw_marker();
+            set_dirty();
+            verify_and_link();
         }
     }
 }
@@ -2303,6 +2408,7 @@ sequence::randomize_selected
     midibyte datitem;
     int datidx = 0;
     automutex locker(m_mutex);
+    ++m_generation;
     m_events_undo.push(m_events);               /* push_undo(), no lock  */
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
@@ -2347,6 +2453,7 @@ sequence::adjust_data_handle (midibyte status, int adata)
     midibyte datitem;
     int datidx = 0;
     automutex locker(m_mutex);
+    ++m_generation;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & e = DREF(i);
@@ -2403,6 +2510,7 @@ void
 sequence::increment_selected (midibyte astat, midibyte /*acontrol*/)
 {
     automutex locker(m_mutex);
+    ++m_generation;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & er = DREF(i);
@@ -2446,6 +2554,7 @@ void
 sequence::decrement_selected (midibyte astat, midibyte /*acontrol*/)
 {
     automutex locker(m_mutex);
+    ++m_generation;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & er = DREF(i);
@@ -2493,7 +2602,11 @@ sequence::copy_selected ()
 {
     automutex locker(m_mutex);
     event_list clipbd;
-    for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    for
+    (
+        event_list::const_iterator i = m_events.cbegin();
+        i != m_events.cend(); ++i
+    )
     {
         if (DREF(i).is_selected())
             clipbd.add(DREF(i));
@@ -2733,6 +2846,7 @@ sequence::change_event_data_range
 )
 {
     automutex locker(m_mutex);
+    ++m_generation;
     bool result = false;
     bool have_selection = m_events.any_selected_events(status, cc);
     if (useundo)
@@ -2863,6 +2977,7 @@ sequence::change_event_data_relative
 )
 {
     automutex locker(m_mutex);
+    ++m_generation;
     bool result = false;
     bool have_selection = m_events.any_selected_events(status, cc);
     if (useundo)
@@ -2995,6 +3110,7 @@ sequence::change_event_data_lfo
 )
 {
     automutex locker(m_mutex);
+    ++m_generation;
     double dlength = double(m_length);
     double dbw = double(m_time_beat_width);
     bool have_selection = m_events.any_selected_events(status, cc);
@@ -3316,6 +3432,7 @@ bool
 sequence::append_event (const event & er)
 {
     automutex locker(m_mutex);
+    ++m_generation;
     return m_events.append(er);     /* does *not* sort, too time-consuming */
 }
 
@@ -3422,6 +3539,11 @@ sequence::check_loop_reset ()
  *
  *  If MIDI Thru is enabled, the event is put on the buss.
  *
+ *  While the pattern plays, an event to be recorded is normally not added
+ *  here, but pushed to m_record_queue without taking the mutex, and added
+ *  later by merge_recording() on the output thread.  Only if that queue is
+ *  full (or not yet allocated) is the event added here, as before.
+ *
  *  We are adding a feature where events are rejected if their channel
  *  doesn't match that of the sequence.  This has been a complaint of some
  *  people.  Could modify the add_event() and add_note() functions, but
@@ -3453,6 +3575,9 @@ sequence::check_loop_reset ()
 bool
 sequence::stream_event (event & ev)
 {
+    if (queue_recording(ev))                    /* lock-free, the usual way */
+        return true;
+
     automutex locker(m_mutex);
     bool result = channels_match(ev);           /* set if channel matches   */
     if (result)
@@ -3522,7 +3647,7 @@ sequence::stream_event (event & ev)
             }
         }
         if (m_thru)
-            put_event_on_bus(ev);                       /* more locking     */
+            echo_event(ev);                             /* more locking     */
 
         if (ev.is_note_off())                           /* time to relink   */
             m_events.link_new();                        /* already locked   */
@@ -3541,6 +3666,102 @@ sequence::stream_event (event & ev)
     return result;
 }
 
+/**
+ *  The lock-free part of stream_event().  If the pattern is recording and
+ *  playing, and the event is for this pattern, the event is pushed to
+ *  m_record_queue, and, if MIDI Thru is enabled, also put on the buss.
+ *  Called only by the input thread, the only producer of the queue.
+ *
+ * \param ev
+ *      Provides the event to stream.  Its channel nybble is cleared if it
+ *      is queued and echoed.
+ *
+ * \return
+ *      Returns true if the event was queued.  Otherwise, stream_event()
+ *      handles the event in the usual way.
+ */
+
+bool
+sequence::queue_recording (event & ev)
+{
+    bool result = m_recording && m_parent->is_pattern_playing() &&
+        channels_match(ev) && m_record_queue.push(ev);
+
+    if (result && m_thru)
+    {
+        ev.set_status(ev.get_status());         /* clear the channel nybble */
+        echo_event(ev);                         /* locks only briefly       */
+    }
+    return result;
+}
+
+/**
+ *  Adds the events queued by stream_event() to the pattern.  Called by the
+ *  output thread at the end of each cycle (see perform::output_func()), the
+ *  only consumer of m_record_queue.  It does, once per batch, the work that
+ *  stream_event() does for each event:  the events are appended and sorted
+ *  once, the new notes are linked once, and, in quantized recording, only
+ *  the notes completed by this batch are selected and quantized.  At most
+ *  SEQ64_RECORD_QUEUE_SIZE events are taken per call, which bounds the work
+ *  done in one output cycle.
+ *
+ * \threadsafe
+ */
+
+void
+sequence::merge_recording ()
+{
+    automutex locker(m_mutex);
+    if (overwrite_recording() && loop_reset())
+    {
+        loop_reset(false);
+        remove_all();                           /* clear old items          */
+    }
+
+    midipulse offticks[SEQ64_RECORD_QUEUE_SIZE];
+    midibyte offnotes[SEQ64_RECORD_QUEUE_SIZE];
+    int offcount = 0;
+    int count = 0;
+    event ev;
+    while (count < SEQ64_RECORD_QUEUE_SIZE && m_record_queue.pop(ev))
+    {
+        ev.set_status(ev.get_status());         /* clear the channel nybble */
+        ev.mod_timestamp(m_length);             /* adjust tick re length    */
+        if (ev.is_note_on() && m_rec_vol > SEQ64_PRESERVE_VELOCITY)
+            ev.set_note_velocity(m_rec_vol);    /* modify incoming          */
+
+        (void) m_events.append(ev);             /* sorted after the batch   */
+        if (ev.is_note_off())
+        {
+            offticks[offcount] = ev.get_timestamp();
+            offnotes[offcount] = ev.get_note();
+            ++offcount;
+        }
+        ++count;
+    }
+    if (count > 0)
+    {
+        m_events.sort();
+        ++m_generation;                         /* before select_note_events */
+        reset_draw_marker();
+        if (offcount > 0)
+        {
+            m_events.link_new();                /* time to relink           */
+            if (m_quantized_rec)
+            {
+                for (int i = 0; i < offcount; ++i)
+                {
+                    midipulse t = offticks[i];
+                    midibyte n = offnotes[i];
+                    select_note_events(t, n, t, n, e_select);
+                }
+                quantize_events(EVENT_NOTE_ON, 0, get_snap_tick(), 1, true);
+            }
+        }
+        set_dirty();
+    }
+}
+
 /**
  *  Sets the dirty flags for names, main, and performance.  These flags are
  *  meant for causing user-interface refreshes, not for performance
@@ -3560,7 +3781,9 @@ sequence::set_dirty_mp ()
 }
 
 /**
- *  Call set_dirty_mp() and then sets the dirty flag for editing.
+ *  Call set_dirty_mp() and then sets the dirty flag for editing.  Also bumps
+ *  the generation counter, since callers use this function after changing
+ *  the content of the sequence.
  *
  * \threadsafe
  */
@@ -3570,6 +3793,7 @@ sequence::set_dirty ()
 {
     set_dirty_mp();
     m_dirty_edit = true;
+    ++m_generation;
 }
 
 /**
@@ -3783,10 +4007,14 @@ sequence::intersect_triggers (midipulse position)
 }
 
 /**
- *  This function examines each note in the event list.  If the given position
- *  is between the current note's on and off time values, the these
- *  values are copied to the start and end parameters, respectively, and the
- *  note value is copied to the note parameter, and then we exit.
+ *  This function looks for a note under the mouse.  If the given position
+ *  is between the on and off times of a linked note of the given note
+ *  value, then these values are copied to the start and end parameters,
+ *  respectively, and the note value is copied to the note parameter.  If
+ *  more than one note holds the position, the earliest one is used.
+ *
+ *  The notes are found with m_event_index.  The list used to be walked,
+ *  comparing each Note On with the event after it.
  *
  * \threadsafe
  *
@@ -3821,50 +4049,14 @@ sequence::intersect_notes
 )
 {
     automutex locker(m_mutex);
-    event_list::iterator on = m_events.begin();
-    event_list::iterator off = m_events.begin();
-    while (on != m_events.end())
-    {
-        event & eon = DREF(on);
-        if (position_note == eon.get_note() && eon.is_note_on())
-        {
-            off = on;                   /* find next "off" event for note   */
-            ++off;                      /* hopefully, this is it!           */
-            event & eoff = DREF(off);   /* access the event itself          */
-
-            /*
-             *  (eon.get_note() != eoff.get_note() || eoff.is_note_on())
-             *
-             *  Not quite De Morgan's Law below.  It sounds like we want to
-             *  find the next Note Off event for the current Note On that
-             *  matches the mouse position.
-             */
+    bool result = indexed_events().find_note
+    (
+        position, position_note, start, ender
+    );
+    if (result)
+        note = position_note;
 
-            bool notematch = false;
-            for ( ; off != m_events.end(); ++off)
-            {
-                if (eon.get_note() == eoff.get_note() && eoff.is_note_off())
-                {
-                    notematch = true;
-                    break;
-                }
-            }
-            if (notematch)
-            {
-                midipulse ontime = eon.get_timestamp();
-                midipulse offtime = eoff.get_timestamp();
-                if (ontime <= position && position <= offtime)
-                {
-                    start = eon.get_timestamp();
-                    ender = eoff.get_timestamp();
-                    note = eon.get_note();
-                    return true;
-                }
-            }
-        }
-        ++on;
-    }
-    return false;
+    return result;
 }
 
 /**
@@ -3872,7 +4064,8 @@ sequence::intersect_notes
  *
  *  If the given position is between the current notes's timestamp-start and
  *  timestamp-end values, the these values are copied to the posstart and posend
- *  parameters, respectively, and then we exit.
+ *  parameters, respectively, and then we exit.  The events are found with
+ *  m_event_index, which holds the timestamps of each status in order.
  *
  * \threadsafe
  *
@@ -3903,20 +4096,10 @@ sequence::intersect_events
 {
     automutex locker(m_mutex);
     midipulse poslength = posend - posstart;
-    for (event_list::iterator on = m_events.begin(); on != m_events.end(); ++on)
-    {
-        event & eon = DREF(on);
-        if (status == eon.get_status())
-        {
-            midipulse ts = eon.get_timestamp();
-            if (ts <= posstart && posstart <= (ts + poslength))
-            {
-                start = eon.get_timestamp();    /* side-effect return value */
-                return true;
-            }
-        }
-    }
-    return false;
+    return indexed_events().find_event
+    (
+        status, posstart - poslength, posstart, start
+    );
 }
 
 /**
@@ -4399,7 +4582,8 @@ void
 sequence::reset_draw_marker ()
 {
     automutex locker(m_mutex);
-    m_iterator_draw = m_events.begin();
+    m_iterator_draw = m_events.cbegin();
+    m_draw_serial = m_events.serial();
 }
 
 /**
@@ -4464,9 +4648,13 @@ sequence::get_minmax_note_events (int & lowest, int & highest)
     bool result = false;
     int low = SEQ64_MAX_DATA_VALUE;
     int high = -1;
-    for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
+    for
+    (
+        event_list::const_iterator i = m_events.cbegin();
+        i != m_events.cend(); ++i
+    )
     {
-        event & er = DREF(i);
+        const event & er = DREF(i);
         if (er.is_note_on() || er.is_note_off())
         {
             if (er.get_note() < low)
@@ -4537,9 +4725,12 @@ sequence::get_next_note_event
 )
 {
     tick_f = 0;
-    while (m_iterator_draw != m_events.end())   /* not threadsafe           */
+    while (m_iterator_draw != m_events.cend())  /* not threadsafe           */
     {
-        event & drawevent = DREF(m_iterator_draw);
+        if (m_draw_serial != m_events.serial())
+            break;                              /* events copied or swapped */
+
+        const event & drawevent = DREF(m_iterator_draw);
         bool isnoteon = drawevent.is_note_on();
         bool islinked = drawevent.is_linked();  /* not get_linked(), idiot! */
         tick_s   = drawevent.get_timestamp();
@@ -4602,10 +4793,13 @@ sequence::get_next_note_event
 bool
 sequence::get_next_event (midibyte & status, midibyte & cc)
 {
-    while (m_iterator_draw != m_events.end())       /* NOT THREADSAFE!!!    */
+    while (m_iterator_draw != m_events.cend())      /* NOT THREADSAFE!!!    */
     {
+        if (m_draw_serial != m_events.serial())
+            break;                                  /* events copied        */
+
         midibyte d1;
-        event & drawevent = DREF(m_iterator_draw);
+        const event & drawevent = DREF(m_iterator_draw);
         status = drawevent.get_status();
         drawevent.get_data(cc, d1);
         inc_draw_marker();
@@ -4626,7 +4820,8 @@ sequence::get_next_event (midibyte & status, midibyte & cc)
 void
 sequence::reset_ex_iterator (event_list::const_iterator & evi)
 {
-    evi = m_events.begin();
+    evi = m_events.cbegin();
+    m_ex_serial = m_events.serial();
 }
 
 /**
@@ -4660,7 +4855,10 @@ sequence::get_next_event_ex
     event_list::const_iterator & evi
 )
 {
-    if (evi != m_events.end())
+    if (m_ex_serial != m_events.serial())
+        return false;                           /* the events were copied   */
+
+    if (evi != m_events.cend())
     {
         midibyte d1;                            /* will be ignored          */
         const event & ev = DREF(evi);
@@ -4720,7 +4918,10 @@ sequence::get_next_event_match
     int evtype
 )
 {
-    while (evi != m_events.end())
+    if (m_ex_serial != m_events.serial())
+        return false;                           /* the events were copied   */
+
+    while (evi != m_events.cend())
     {
         const event & drawevent = DREF(evi);
         bool istempo = drawevent.is_tempo();
@@ -4790,6 +4991,7 @@ void
 sequence::remove_all ()
 {
     automutex locker(m_mutex);
+    ++m_generation;
     m_events.clear();
     m_events.unmodify();
 }
@@ -4854,6 +5056,9 @@ sequence::set_midi_bus (char mb, bool user_change)
         m_bus = mb;
         if (user_change)
             modify();                   /* no easy way to undo this, though */
+
+        if (m_thru && not_nullptr(m_master_bus))
+            m_master_bus->update_thru();
     }
     set_dirty();                        /* this is for display updating     */
 }
@@ -4932,6 +5137,7 @@ sequence::set_length (midipulse len, bool adjust_triggers, bool verify)
 
     m_events.set_length(len);
     m_triggers.set_length(len);         /* must precede adjust call         */
+    ++m_generation;                     /* compiled song data now stale     */
     if (adjust_triggers)
         m_triggers.adjust_offsets_to_length(len);
 
@@ -5028,7 +5234,13 @@ sequence::set_playing (bool p)
             printf("seq %d off\n", number());
 #endif
 
-        set_dirty();
+        /*
+         * Not set_dirty(); arming or muting the pattern is not a change of
+         * content, and must not bump m_generation (see song_timeline).
+         */
+
+        set_dirty_mp();
+        m_dirty_edit = true;
     }
     m_queued = false;
     m_one_shot = false;
@@ -5052,6 +5264,11 @@ sequence::set_playing (bool p)
  *  This function sets m_notes_on to 0, but this should be done only if the
  *  recording status has changed.
  *
+ *  Arming the recording also gives the pattern a container of events of its
+ *  own, if it shares one with an undo copy or the clipboard.  Otherwise the
+ *  first merge_recording() would copy the whole list on the output thread.
+ *  push_undo() and snapshot_assign() keep it so while recording.
+ *
  * \threadsafe
  */
 
@@ -5061,6 +5278,11 @@ sequence::set_recording (bool r)
     automutex locker(m_mutex);
     if (r != m_recording)
     {
+        if (r)
+        {
+            m_record_queue.allocate(SEQ64_RECORD_QUEUE_SIZE);
+            m_events.unshare();
+        }
         m_notes_on = 0;         // is there a more robust way to do this?
         m_recording = r;
         if (! r)
@@ -5087,7 +5309,11 @@ sequence::set_quantized_recording (bool qr)
         m_notes_on = 0;         // is there a more robust way to do this?
         m_quantized_rec = qr;
         if (qr)
+        {
+            m_record_queue.allocate(SEQ64_RECORD_QUEUE_SIZE);
+            m_events.unshare();
             m_recording = qr;   // also need recording
+        }
     }
 }
 
@@ -5172,6 +5398,8 @@ sequence::set_thru (bool r)
 {
     automutex locker(m_mutex);
     m_thru = r;
+    if (not_nullptr(m_master_bus))
+        m_master_bus->update_thru();
 }
 
 /**
@@ -5205,11 +5433,15 @@ sequence::set_input_thru (bool thru_active, bool toggle)
  *  We now try to include the length of the sequences in measures at the end
  *  of the name, and limit the length of the entire string.  As noted in the
  *  printing of sequence::get_name() in mainwid, this length is 13 characters.
+ *
+ * \threadsafe
+ *      The name can be copied by a song_snapshot on another thread.
  */
 
 void
 sequence::set_name (const std::string & name)
 {
+    automutex locker(m_mutex);
     if (name.empty())
         m_name = sm_default_name;
     else
@@ -5291,6 +5523,9 @@ sequence::set_midi_channel (midibyte ch, bool user_change)
         m_midi_channel = ch;
         if (user_change)
             modify();                   /* no easy way to undo this, though */
+
+        if (m_thru && not_nullptr(m_master_bus))
+            m_master_bus->update_thru();
     }
     set_dirty();                        /* this is for display updating     */
 }
@@ -5328,25 +5563,18 @@ sequence::print_triggers () const
  * \param ev
  *      The event to put on the buss.
  *
+ * \param tag
+ *      If not 0, the event is stamped with its tick in the song, and is
+ *      scheduled ahead with this tag (see schedule_tag()).
+ *
  * \threadsafe
  */
 
 void
-sequence::put_event_on_bus (event & ev)
+sequence::put_event_on_bus (event & ev, int tag)
 {
     automutex locker(m_mutex);
-    midibyte note = ev.get_note();
-    bool skip = false;
-    if (ev.is_note_on())
-        m_playing_notes[note]++;
-
-    if (ev.is_note_off())
-    {
-        if (m_playing_notes[note] <= 0)
-            skip = true;
-        else
-            m_playing_notes[note]--;
-    }
+    bool skip = ! track_playing_note(ev);
     if (! skip)
     {
         /*
@@ -5357,17 +5585,82 @@ sequence::put_event_on_bus (event & ev)
          *      usage.
          */
 
-        m_master_bus->play(m_bus, &ev, m_midi_channel);
+        if (tag != 0)
+            m_master_bus->play_ahead(m_bus, &ev, m_midi_channel, tag);
+        else
+            m_master_bus->play(m_bus, &ev, m_midi_channel);
 
         // m_master_bus->flush();
     }
     m_master_bus->flush();
 }
 
+/**
+ *  Echoes an incoming event (MIDI Thru).  If the master buss has already
+ *  forwarded the event through its thru router, the event is not played
+ *  again; only the playing notes are counted, so that off_playing_notes()
+ *  can still end the notes that are held.
+ *
+ * \param ev
+ *      The event to echo.  Its channel (see event::get_channel()) is the
+ *      channel on which it arrived.
+ *
+ * \threadsafe
+ */
+
+void
+sequence::echo_event (event & ev)
+{
+    if (m_master_bus->thru_routed(ev.get_channel()))
+    {
+        automutex locker(m_mutex);
+        (void) track_playing_note(ev);
+    }
+    else
+        put_event_on_bus(ev);
+}
+
+/**
+ *  Counts a note played by this sequence in m_playing_notes[].  The caller
+ *  holds the lock.
+ *
+ * \param ev
+ *      The event about to be played.
+ *
+ * \return
+ *      Returns false if the event is a Note Off for a note that is not
+ *      playing, and should be skipped.
+ */
+
+bool
+sequence::track_playing_note (const event & ev)
+{
+    bool result = true;
+    midibyte note = ev.get_note();
+    if (ev.is_note_on())
+        m_playing_notes[note]++;
+
+    if (ev.is_note_off())
+    {
+        if (m_playing_notes[note] <= 0)
+            result = false;
+        else
+            m_playing_notes[note]--;
+    }
+    return result;
+}
+
 /**
  *  Sends a note-off event for all active notes.  This function does not
  *  bother checking if m_master_bus is a null pointer.
  *
+ *  If the events are scheduled ahead ("-o lookahead=ms"), some of them may
+ *  still be waiting in the queue.  In the output cycle, this sequence has
+ *  been played up to its last tick, so the Note Offs are scheduled there,
+ *  after the rest.  Otherwise (a mute, stop, or change of buss from the
+ *  user interface) the pending events are purged, and the Note Offs are
+ *  sent now.
+ *
  * \threadsafe
  */
 
@@ -5375,14 +5668,27 @@ void
 sequence::off_playing_notes ()
 {
     automutex locker(m_mutex);
+    int tag = 0;
     event e;
+    if (m_master_bus->in_cycle())
+    {
+        tag = schedule_tag();
+        e.set_timestamp(m_last_tick);
+    }
+    else
+        m_master_bus->purge(schedule_tag());    /* no-op unless scheduling  */
+
     for (int x = 0; x < c_midi_notes; ++x)
     {
         while (m_playing_notes[x] > 0)
         {
             e.set_status(EVENT_NOTE_OFF);
             e.set_data(x, midibyte(0));               /* or is 127 better?  */
-            m_master_bus->play(m_bus, &e, m_midi_channel);
+            if (tag != 0)
+                m_master_bus->play_ahead(m_bus, &e, m_midi_channel, tag);
+            else
+                m_master_bus->play(m_bus, &e, m_midi_channel);
+
             if (m_playing_notes[x] > 0)
                 m_playing_notes[x]--;
         }
@@ -5478,7 +5784,6 @@ sequence::transpose_notes (int steps, int scale)
     if (mark_selected())                            /* mark original notes  */
     {
         automutex locker(m_mutex);
-        event_list transposed_events;
         const int * transpose_table;
         m_events_undo.push(m_events);               /* push_undo(), no lock  */
         if (steps < 0)
@@ -5489,34 +5794,11 @@ sequence::transpose_notes (int steps, int scale)
         else
             transpose_table = &c_scales_transpose_up[scale][0];     /* up   */
 
-        for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
-        {
-            event & er = DREF(i);
-            if (er.is_marked() && er.is_note())     /* transposable event?  */
-            {
-                event e = er;
-                e.unmark();
-                int note = e.get_note();
-                bool off_scale = false;
-                if (transpose_table[note % SEQ64_OCTAVE_SIZE] == 0)
-                {
-                    off_scale = true;
-                    note -= 1;
-                }
-                for (int x = 0; x < steps; ++x)
-                    note += transpose_table[note % SEQ64_OCTAVE_SIZE];
-
-                if (off_scale)
-                    note += 1;
-
-                e.set_note(note);
-                transposed_events.add(e);   // , false);    sort afterward
-            }
-            else
-                er.unmark();                        /* ignore, no transpose */
-        }
-        (void) remove_marked();                     /* remove original notes */
-        m_events.merge(transposed_events);          /* events get presorted  */
+        m_columns.gather(m_events);
+        m_columns.transpose(transpose_table, steps); /* marked notes only    */
+        (void) m_columns.apply(m_events);           /* notes sorted again   */
+        ++m_generation;
+        reset_draw_marker();
         verify_and_link();
     }
 }
@@ -5663,84 +5945,28 @@ sequence::quantize_events
          *      push_quantize() function!
          */
 
-        event_list quantized_events;
-        for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
-        {
-            event & er = DREF(i);
-            midibyte d0, d1;
-            er.get_data(d0, d1);
-            bool match = er.get_status() == status;
-            bool canselect;
-            if (status == EVENT_CONTROL_CHANGE)
-                canselect = match && d0 == cc;  /* right status, right cc   */
-            else
-                canselect = match;              /* correct status, any cc   */
-
-            if (! er.is_marked())
-                canselect = false;
-
-            if (canselect)
-            {
-                event e = er;                   /* copy the event           */
-                er.select();                    /* selected original event  */
-                e.unmark();                     /* unmark copy of the event */
-
-                midipulse t = e.get_timestamp();
-                midipulse t_remainder = 0;
-                midipulse t_delta = 0;
-                if (snap_tick > 0)              /* issue #190               */
-                    t_remainder = t % snap_tick;
-
-                if (t_remainder < snap_tick / 2)
-                    t_delta = -(t_remainder / divide);
-                else
-                    t_delta = (snap_tick - t_remainder) / divide;
-
-                if ((t_delta + t) >= m_length)      /* wrap-around Note On   */
-                    t_delta = -e.get_timestamp();
-
-                e.set_timestamp(e.get_timestamp() + t_delta);
-                quantized_events.add(e);
-
-                /*
-                 * The only events linked are notes; the status of all notes
-                 * in this function are On, so the link must be only Note Off.
-                 */
-
-                if (er.is_linked() && linked)
-                {
-                    event f = *er.get_linked();
-                    midipulse ft = f.get_timestamp() + t_delta; /* seq32 */
-                    f.unmark();
-                    er.get_linked()->select();
-
-                    /*
-                     * Seq32: If ft is negative, then we have a Note Off
-                     * previously wrapped before adjustment. Since the delta
-                     * is based on the Note On (not wrapped), we must add back
-                     * the m_length for the wrapping.  If the ft is then >=
-                     * m_length, it will be deleted by verify_and_link(),
-                     * which discards any notes (ON or OFF) that are >=
-                     * m_length. So we must wrap if > m_length and trim if ==
-                     * m_length.  Compare to trim_timestamp().
-                     */
-
-                    if (ft < 0)                     /* unwrap Note Off      */
-                        ft += m_length;
-
-                    if (ft == m_length)             /* trim it a little     */
-                        ft -= m_note_off_margin;
-
-                    if (ft > m_length)              /* wrap it around       */
-                        ft -= m_length;
+        /*
+         * The only events linked are notes; the status of all notes in this
+         * function are On, so the link must be only Note Off.  Seq32: If the
+         * moved Note Off time is negative, then we have a Note Off
+         * previously wrapped before adjustment. Since the delta is based on
+         * the Note On (not wrapped), we must add back the m_length for the
+         * wrapping.  If the time is then >= m_length, it will be deleted by
+         * verify_and_link(), which discards any notes (ON or OFF) that are
+         * >= m_length. So we must wrap if > m_length and trim if ==
+         * m_length.  Compare to trim_timestamp().  See
+         * event_columns::quantize().
+         */
 
-                    f.set_timestamp(ft);
-                    quantized_events.add(f);
-                }
-            }
-        }
-        (void) remove_marked();
-        m_events.merge(quantized_events);   /* presort quantized events */
+        m_columns.gather(m_events);
+        m_columns.quantize
+        (
+            status, cc, snap_tick, divide, linked,
+            m_length, m_note_off_margin
+        );
+        (void) m_columns.apply(m_events);   /* one sort, not one per event  */
+        ++m_generation;
+        reset_draw_marker();
         verify_and_link();
         set_dirty();                        /* tells perfedit to update     */
     }
@@ -5870,6 +6096,7 @@ sequence::copy_events (const event_list & newevents)
     automutex locker(m_mutex);
     m_events.clear();
     m_events = newevents;
+    ++m_generation;
     if (m_events.empty())
     {
         m_events.unmodify();
@@ -5880,7 +6107,8 @@ sequence::copy_events (const event_list & newevents)
         // WTF?
     }
 
-    m_iterator_draw = m_events.begin();     /* same as in reset_draw_marker */
+    m_iterator_draw = m_events.cbegin();    /* same as in reset_draw_marker */
+    m_draw_serial = m_events.serial();
     if (! m_events.empty())                 /* need at least 1 (2?) events  */
     {
         /*
@@ -6067,9 +6295,10 @@ sequence::song_recording_stop (midipulse tick)
 void
 sequence::resume_note_ons (midipulse tick)
 {
-    for         /* would like a const_iterator, but put_event_on_bus()...   */
+    for         /* const, so as not to copy events shared with the undo */
     (
-        event_list::iterator ei = m_events.begin(); ei != m_events.end(); ++ei
+        event_list::const_iterator ei = m_events.cbegin();
+        ei != m_events.cend(); ++ei
     )
     {
         if (ei->is_note_on())
@@ -6081,7 +6310,10 @@ sequence::resume_note_ons (midipulse tick)
                 midipulse off = link->get_timestamp();
                 midipulse remainder = tick % m_length;
                 if (on < remainder && off > remainder)
-                    put_event_on_bus(*ei);
+                {
+                    event ev = *ei;             /* put_event_on_bus() needs */
+                    put_event_on_bus(ev);       /* a non-const event        */
+                }
             }
         }
     }
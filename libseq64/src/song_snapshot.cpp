@@ -0,0 +1,166 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          song_snapshot.cpp
+ *
+ *  This module defines a copy of the song, as it is written to a MIDI file,
+ *  that can be written while the song plays on.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-28
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  The snapshot is taken under perform::m_snapshot_lock, so that no pattern
+ *  is installed or deleted while it is copied.  Each pattern is copied
+ *  under its own lock.  The output thread never takes the first lock, and
+ *  waits for the second only while a pattern is copied, which takes about
+ *  as long as copying its triggers.
+ */
+
+#include "easy_macros.h"                /* not_nullptr() macro              */
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "settings.hpp"                 /* seq64::usr()                     */
+#include "song_snapshot.hpp"            /* seq64::song_snapshot             */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Takes the snapshot.
+ *
+ * \param p
+ *      The performance to copy.  It is not changed.
+ */
+
+song_snapshot::song_snapshot (perform & p)
+ :
+    m_perform               (p),
+    m_tracks                (),
+    m_notepads              (),
+    m_group_mutes           (),
+    m_any_group_unmutes     (false),
+    m_ppqn                  (p.get_ppqn()),
+    m_beats_per_minute      (p.get_beats_per_minute()),
+    m_beats_per_bar         (p.get_beats_per_bar()),
+    m_beat_width            (p.get_beat_width()),
+    m_tempo_track           (p.get_tempo_track_number()),
+    m_musical_key           (usr().seqedit_key()),
+    m_musical_scale         (usr().seqedit_scale()),
+    m_background_sequence   (usr().seqedit_bgsequence()),
+    m_modify_count          (p.modify_count())
+{
+    automutex locker(p.m_snapshot_lock);
+    for (int s = 0; s < p.sequence_high(); ++s)
+    {
+        if (p.is_active(s))
+        {
+            const sequence * seq = p.m_seqs[s];
+            if (not_nullptr(seq))
+            {
+                track t;
+                t.tr_number = s;
+                t.tr_sequence = new sequence(seq->get_ppqn());
+                t.tr_sequence->snapshot_assign(*seq);
+                m_tracks.push_back(t);
+            }
+        }
+    }
+    m_notepads.reserve(c_max_sets);
+    for (int s = 0; s < c_max_sets; ++s)
+        m_notepads.push_back(p.get_screenset_notepad(s));
+
+    m_any_group_unmutes = p.any_group_unmutes();
+    m_group_mutes.reserve(c_seqs_in_set * c_seqs_in_set);
+    for (int g = 0; g < c_seqs_in_set; ++g)
+    {
+        for (int t = 0; t < c_seqs_in_set; ++t)
+            m_group_mutes.push_back(p.group_mute_state(g, t));
+    }
+}
+
+/**
+ *  Deletes the copies of the patterns.
+ */
+
+song_snapshot::~song_snapshot ()
+{
+    for (Tracks::iterator t = m_tracks.begin(); t != m_tracks.end(); ++t)
+        delete t->tr_sequence;
+}
+
+/**
+ *  Gets the notes of a screen-set.
+ *
+ * \param screenset
+ *      The screen-set number, which is validated.
+ *
+ * \return
+ *      Returns the notes, or an empty string if the number is invalid.
+ */
+
+const std::string &
+song_snapshot::notepad (int screenset) const
+{
+    static std::string s_empty;
+    if (screenset >= 0 && screenset < int(m_notepads.size()))
+        return m_notepads[std::size_t(screenset)];
+    else
+        return s_empty;
+}
+
+/**
+ *  Gets a mute-group status, as perform::group_mute_state() returned it.
+ *
+ * \param group
+ *      The mute group, from 0 to c_seqs_in_set - 1.
+ *
+ * \param gtrack
+ *      The track in the group, from 0 to c_seqs_in_set - 1.
+ *
+ * \return
+ *      Returns the status, or false if either number is out of range.
+ */
+
+bool
+song_snapshot::group_mute_state (int group, int gtrack) const
+{
+    bool result = false;
+    if (group >= 0 && group < c_seqs_in_set)
+    {
+        if (gtrack >= 0 && gtrack < c_seqs_in_set)
+            result = m_group_mutes[std::size_t(group * c_seqs_in_set + gtrack)];
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * song_snapshot.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
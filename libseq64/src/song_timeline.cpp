@@ -0,0 +1,656 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          song_timeline.cpp
+ *
+ *  This module defines the compiled Song-mode playback data.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-04
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  See song_timeline.hpp for an overview.  The placement of events follows
+ *  sequence::play() exactly:  with a trigger offset of "o" and a pattern
+ *  length of "L", an event stamped "t" plays at every song tick T such that
+ *  T = t + o + k * L, for integer k, as long as T lies inside the trigger
+ *  (both ends inclusive).
+ */
+
+#include <algorithm>                    /* std::stable_sort(), lower_bound  */
+
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "song_timeline.hpp"            /* seq64::song_timeline             */
+#include "triggers.hpp"                 /* seq64::trigger, triggers         */
+#include "user_midi_bus.hpp"            /* seq64::c_max_busses              */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Used with std::lower_bound() to find the first entry of a lane at or after
+ *  a given tick.
+ */
+
+static bool
+entry_before_tick (const song_timeline::entry & e, midipulse tick)
+{
+    return e.tick() < tick;
+}
+
+/**
+ *  Constructs an arming (phase_on) or muting (phase_off) entry.
+ *
+ * \param tick
+ *      The song tick of the trigger boundary.
+ *
+ * \param seq
+ *      The number of the pattern.
+ *
+ * \param p
+ *      The phase of the entry, either phase_on or phase_off.
+ *
+ * \param offset
+ *      The trigger offset, which is applied to the sequence when it is armed,
+ *      so that its progress bar is correct.
+ */
+
+song_timeline::entry::entry
+(
+    midipulse tick, int seq, phase_t p, midipulse offset
+)
+ :
+    m_tick      (tick),
+    m_seq       (seq),
+    m_phase     (p),
+    m_offset    (offset),
+    m_event     ()
+{
+    // Empty body
+}
+
+/**
+ *  Constructs a phase_event entry.
+ *
+ * \param tick
+ *      The song tick at which the event plays.
+ *
+ * \param seq
+ *      The number of the pattern.
+ *
+ * \param ev
+ *      The event to be copied.
+ */
+
+song_timeline::entry::entry (midipulse tick, int seq, const event & ev)
+ :
+    m_tick      (tick),
+    m_seq       (seq),
+    m_phase     (phase_event),
+    m_offset    (0),
+    m_event     (ev)
+{
+    // Empty body
+}
+
+/**
+ *  Default constructor for the chunk key.
+ */
+
+song_timeline::chunk_key::chunk_key ()
+ :
+    m_tick_start    (0),
+    m_tick_end      (0),
+    m_offset        (0),
+    m_length        (0),
+    m_transpose     (0)
+{
+    // Empty body
+}
+
+/**
+ *  Compares all members.
+ */
+
+bool
+song_timeline::chunk_key::operator == (const chunk_key & rhs) const
+{
+    return
+    (
+        m_tick_start == rhs.m_tick_start && m_tick_end == rhs.m_tick_end &&
+        m_offset == rhs.m_offset && m_length == rhs.m_length &&
+        m_transpose == rhs.m_transpose
+    );
+}
+
+/**
+ *  Default constructor for the slot.  A slot starts out uncompiled.
+ */
+
+song_timeline::slot::slot ()
+ :
+    m_seq                   (nullptr),
+    m_events_serial         (0),
+    m_seq_generation        (0),
+    m_trigger_generation    (0),
+    m_song_transpose        (0),
+    m_bus                   (0),
+    m_compiled              (false),
+    m_chunks                ()
+{
+    // Empty body
+}
+
+/**
+ *  Default constructor for the lane.
+ */
+
+song_timeline::lane::lane ()
+ :
+    m_entries   (),
+    m_cursor    (0),
+    m_stale     (false)
+{
+    // Empty body
+}
+
+/**
+ *  Principal constructor.  Nothing is compiled until compile() or refresh()
+ *  is called.
+ *
+ * \param p
+ *      The performance object that owns the patterns.
+ */
+
+song_timeline::song_timeline (perform & p)
+ :
+    m_perform           (p),
+    m_slots             (),
+    m_lanes             (c_max_busses),
+    m_last_tick         (0),
+    m_chunks_compiled   (0),
+    m_mutex             ()
+{
+    // Empty body
+}
+
+/**
+ *  Throws away all compiled data.
+ */
+
+void
+song_timeline::clear ()
+{
+    automutex locker(m_mutex);
+    m_slots.clear();
+    for (std::size_t bus = 0; bus < m_lanes.size(); ++bus)
+    {
+        m_lanes[bus].m_entries.clear();
+        m_lanes[bus].m_cursor = 0;
+        m_lanes[bus].m_stale = false;
+    }
+}
+
+/**
+ *  Compiles the whole song from scratch.  Meant to be called when Song-mode
+ *  playback starts, so that the first output cycle does not have to do it.
+ */
+
+void
+song_timeline::compile ()
+{
+    automutex locker(m_mutex);
+    clear();
+    refresh();
+}
+
+/**
+ *  Brings the compiled data up to date with the patterns.  Each pattern whose
+ *  events, settings, or triggers have changed since it was last compiled is
+ *  compiled again, and the lanes of the busses it used (before and after the
+ *  change) are merged again.  When nothing has changed, this function costs
+ *  just a few comparisons per pattern, so it can be called every output
+ *  cycle.
+ */
+
+void
+song_timeline::refresh ()
+{
+    automutex locker(m_mutex);
+    int high = m_perform.sequence_high();
+    if (high > int(m_slots.size()))
+        m_slots.resize(std::size_t(high));
+
+    for (int seqno = 0; seqno < int(m_slots.size()); ++seqno)
+        (void) update_slot(seqno, false);
+
+    for (std::size_t bus = 0; bus < m_lanes.size(); ++bus)
+    {
+        if (m_lanes[bus].m_stale)
+            merge_lane(bussbyte(bus));
+    }
+}
+
+/**
+ *  Checks one pattern slot, and recompiles it if needed.  Chunks whose
+ *  trigger did not change, and whose pattern content did not change, are
+ *  kept as is.  The serial number of the events container is compared too,
+ *  since a pattern loaded with a new song can get the address of an old
+ *  one, along with the same generation counts.
+ *
+ * \param seqno
+ *      The number of the pattern slot.
+ *
+ * \param force
+ *      If true, the slot is compiled even if it seems to be current.
+ *
+ * \return
+ *      Returns true if the slot was recompiled or dropped.
+ */
+
+bool
+song_timeline::update_slot (int seqno, bool force)
+{
+    slot & sl = m_slots[seqno];
+    sequence * s = m_perform.get_sequence(seqno);
+    if (is_nullptr(s))
+    {
+        bool result = sl.m_compiled;
+        if (result)
+        {
+            m_lanes[sl.m_bus].m_stale = true;
+            sl = slot();
+        }
+        return result;
+    }
+
+    int songtp = s->get_transposable() ? m_perform.get_transpose() : 0 ;
+    int busno = int(bussbyte(s->get_midi_bus()));
+    bussbyte bus = busno < int(m_lanes.size()) ? bussbyte(busno) : 0 ;
+    bool changed = force || ! sl.m_compiled || sl.m_seq != s;
+    if (! changed)
+    {
+        changed =
+            sl.m_events_serial != s->m_events.serial() ||
+            sl.m_seq_generation != s->generation() ||
+            sl.m_trigger_generation != s->m_triggers.generation() ||
+            sl.m_song_transpose != songtp || sl.m_bus != bus;
+    }
+    if (! changed)
+        return false;
+
+    automutex seqlocker(s->m_mutex);
+    bool samecontent = sl.m_compiled && sl.m_seq == s &&
+        sl.m_events_serial == s->m_events.serial() &&
+        sl.m_seq_generation == s->generation();
+
+    std::vector<chunk> oldchunks;
+    oldchunks.swap(sl.m_chunks);
+    if (sl.m_compiled)
+        m_lanes[sl.m_bus].m_stale = true;
+
+    const triggers::List & tl = s->m_triggers.triggerlist();
+    sl.m_chunks.reserve(tl.size());
+    for
+    (
+        triggers::List::const_iterator t = tl.begin(); t != tl.end(); ++t
+    )
+    {
+        chunk_key key;
+        key.m_tick_start = t->tick_start();
+        key.m_tick_end = t->tick_end();
+        key.m_offset = t->offset();
+        key.m_length = s->get_length();
+        key.m_transpose = t->transpose() != 0 ? t->transpose() : songtp ;
+
+        sl.m_chunks.push_back(chunk());
+        chunk & c = sl.m_chunks.back();
+        bool reused = false;
+        if (samecontent)
+        {
+            for
+            (
+                std::vector<chunk>::iterator oc = oldchunks.begin();
+                oc != oldchunks.end(); ++oc
+            )
+            {
+                if (oc->m_key == key)
+                {
+                    c.m_key = key;
+                    c.m_entries.swap(oc->m_entries);
+                    reused = true;
+                    break;
+                }
+            }
+        }
+        if (! reused)
+            compile_chunk(*s, *t, key, seqno, c);
+    }
+    sl.m_seq = s;
+    sl.m_events_serial = s->m_events.serial();
+    sl.m_seq_generation = s->generation();
+    sl.m_trigger_generation = s->m_triggers.generation();
+    sl.m_song_transpose = songtp;
+    sl.m_bus = bus;
+    sl.m_compiled = true;
+    m_lanes[bus].m_stale = true;
+    return true;
+}
+
+/**
+ *  Lays out the events of one trigger at absolute song ticks.  The caller
+ *  holds the sequence's mutex.
+ *
+ *  As in sequence::play(), tempo events are kept (they change the tempo of
+ *  the performance when reached), other SysEx and Meta events are dropped,
+ *  and note events are transposed.  Note Offs falling past the end of the
+ *  trigger are dropped too; the muting entry at the end of the trigger turns
+ *  off any notes still playing.  The muting entry is made even if the next
+ *  trigger starts right after this one, since sequence::play() also ends the
+ *  playing notes at every trigger end.
+ *
+ * \param s
+ *      The pattern.
+ *
+ * \param t
+ *      The trigger.
+ *
+ * \param key
+ *      The key values already computed for this trigger.
+ *
+ * \param seqno
+ *      The number of the pattern.
+ *
+ * \param [out] c
+ *      The chunk to fill.
+ */
+
+void
+song_timeline::compile_chunk
+(
+    sequence & s, const trigger & t, const chunk_key & key,
+    int seqno, chunk & c
+)
+{
+    midipulse length = key.m_length > 0 ? key.m_length : s.get_ppqn() ;
+    midipulse tickstart = key.m_tick_start;
+    midipulse tickend = key.m_tick_end;
+    midipulse phase = (tickstart - key.m_offset) % length;
+    if (phase < 0)
+        phase += length;
+
+    c.m_key = key;
+    c.m_entries.clear();
+    c.m_entries.push_back(entry(tickstart, seqno, phase_on, t.offset()));
+    for (midipulse base = tickstart - phase; base <= tickend; base += length)
+    {
+        for
+        (
+            event_list::const_iterator e = s.m_events.begin();
+            e != s.m_events.end(); ++e
+        )
+        {
+            const event & er = DREF(e);
+            midipulse stamp = base + er.get_timestamp();
+            if (stamp > tickend)
+                break;                          /* the events are sorted    */
+
+            if (stamp < tickstart)
+                continue;
+
+            if (er.is_tempo() || ! er.is_ex_data())
+            {
+                c.m_entries.push_back(entry(stamp, seqno, er));
+                if (key.m_transpose != 0 && er.is_note())
+                    c.m_entries.back().m_event.transpose_note(key.m_transpose);
+            }
+        }
+    }
+    c.m_entries.push_back(entry(tickend, seqno, phase_off, 0));
+
+    ++m_chunks_compiled;
+}
+
+/**
+ *  Rebuilds the lane of one buss from the chunks of all patterns playing on
+ *  that buss, then repositions the lane's cursor at the current tick.
+ *
+ * \param bus
+ *      The buss (lane) number.
+ */
+
+void
+song_timeline::merge_lane (bussbyte bus)
+{
+    lane & ln = m_lanes[bus];
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < m_slots.size(); ++i)
+    {
+        const slot & sl = m_slots[i];
+        if (sl.m_compiled && sl.m_bus == bus)
+        {
+            for (std::size_t c = 0; c < sl.m_chunks.size(); ++c)
+                count += sl.m_chunks[c].m_entries.size();
+        }
+    }
+    ln.m_entries.clear();
+    ln.m_entries.reserve(count);
+    for (std::size_t i = 0; i < m_slots.size(); ++i)
+    {
+        const slot & sl = m_slots[i];
+        if (sl.m_compiled && sl.m_bus == bus)
+        {
+            for (std::size_t c = 0; c < sl.m_chunks.size(); ++c)
+            {
+                const std::vector<entry> & ev = sl.m_chunks[c].m_entries;
+                ln.m_entries.insert(ln.m_entries.end(), ev.begin(), ev.end());
+            }
+        }
+    }
+    std::stable_sort(ln.m_entries.begin(), ln.m_entries.end());
+    seek_lane(ln, m_last_tick);
+    ln.m_stale = false;
+}
+
+/**
+ *  Positions a lane's cursor at the first entry at or after the given tick.
+ */
+
+void
+song_timeline::seek_lane (lane & ln, midipulse tick)
+{
+    ln.m_cursor = std::size_t
+    (
+        std::lower_bound
+        (
+            ln.m_entries.begin(), ln.m_entries.end(), tick, entry_before_tick
+        ) - ln.m_entries.begin()
+    );
+}
+
+/**
+ *  Moves the play position.  The cursors of all lanes are repositioned, and
+ *  each pattern is armed or muted according to whether a trigger covers the
+ *  new position, as sequence::play() would do on its next call.  If the
+ *  "resume note-ons" option is active, notes that should already be sounding
+ *  are started.
+ *
+ * \param tick
+ *      The next tick to be played.
+ */
+
+void
+song_timeline::seek (midipulse tick)
+{
+    automutex locker(m_mutex);
+    m_last_tick = tick;
+    refresh();
+    for (std::size_t bus = 0; bus < m_lanes.size(); ++bus)
+        seek_lane(m_lanes[bus], tick);
+
+    bool resume = m_perform.resume_note_ons();
+    for (int seqno = 0; seqno < int(m_slots.size()); ++seqno)
+    {
+        sequence * s = m_perform.get_sequence(seqno);
+        if (is_nullptr(s) || s->song_playback_block())
+            continue;
+
+        midipulse start, ender;
+        bool covered = ! s->get_song_mute() &&
+            s->m_triggers.intersect(tick, start, ender);
+
+        if (covered)
+        {
+            const triggers::List & tl = s->m_triggers.triggerlist();
+            for
+            (
+                triggers::List::const_iterator t = tl.begin();
+                t != tl.end(); ++t
+            )
+            {
+                if (t->tick_start() == start)
+                {
+                    s->set_trigger_offset(t->offset());
+                    break;
+                }
+            }
+            s->set_playing(true);
+            if (resume && start < tick)
+                s->resume_note_ons(tick);
+        }
+        else
+            s->set_playing(false);
+    }
+}
+
+/**
+ *  Plays all entries from the last tick played up to and including the given
+ *  tick, the same span that sequence::play() covers.  A backwards jump of
+ *  the tick is treated as a seek.
+ *
+ * \param tick
+ *      The last tick of the current frame.
+ */
+
+void
+song_timeline::play (midipulse tick)
+{
+    automutex locker(m_mutex);
+    if (tick + 1 < m_last_tick)
+    {
+        seek(tick + 1);
+        return;
+    }
+    refresh();
+    for (std::size_t bus = 0; bus < m_lanes.size(); ++bus)
+    {
+        lane & ln = m_lanes[bus];
+        std::size_t count = ln.m_entries.size();
+        while (ln.m_cursor < count && ln.m_entries[ln.m_cursor].m_tick <= tick)
+        {
+            dispatch(ln.m_entries[ln.m_cursor]);
+            ++ln.m_cursor;
+        }
+    }
+    m_last_tick = tick + 1;
+    for (int seqno = 0; seqno < int(m_slots.size()); ++seqno)
+    {
+        sequence * s = m_perform.get_sequence(seqno);
+        if (not_nullptr(s))
+            s->set_last_tick(m_last_tick);          /* for progress bars    */
+    }
+}
+
+/**
+ *  Acts on one entry.  Trigger boundaries clear any "song playback block"
+ *  (see triggers::play()), and song-muted patterns are never armed.
+ *
+ * \param e
+ *      The entry.  Not const, because sequence::put_event_on_bus() takes a
+ *      non-const event.
+ */
+
+void
+song_timeline::dispatch (entry & e)
+{
+    sequence * s = m_perform.get_sequence(e.m_seq);
+    if (is_nullptr(s))
+        return;
+
+    switch (e.m_phase)
+    {
+    case phase_on:
+
+        s->song_playback_block(false);
+        if (s->get_song_mute())
+            s->set_playing(false);
+        else
+        {
+            s->set_trigger_offset(e.m_offset);
+            s->set_playing(true);
+        }
+        break;
+
+    case phase_event:
+
+        if (s->get_playing() && ! s->get_song_mute())
+        {
+            if (e.m_event.is_tempo())
+                m_perform.set_beats_per_minute(e.m_event.tempo());
+            else
+                s->put_event_on_bus(e.m_event);
+        }
+        break;
+
+    case phase_off:
+
+        s->song_playback_block(false);
+        s->set_playing(false);
+        break;
+    }
+}
+
+/**
+ * \return
+ *      Returns the total number of entries in all lanes.
+ */
+
+std::size_t
+song_timeline::entry_count () const
+{
+    std::size_t result = 0;
+    for (std::size_t bus = 0; bus < m_lanes.size(); ++bus)
+        result += m_lanes[bus].m_entries.size();
+
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * song_timeline.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
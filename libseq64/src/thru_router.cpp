@@ -0,0 +1,169 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          thru_router.cpp
+ *
+ *  This module defines the table that routes MIDI thru directly from the
+ *  input ports to the output busses.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-12
+ * \updates       2023-03-12
+ * \license       GNU GPLv2 or above
+ *
+ *  Only channel messages are routed.  System messages are never echoed by
+ *  the sequences either.
+ */
+
+#include "event.hpp"                    /* EVENT_MIDI_SYSEX, masks          */
+#include "thru_router.hpp"              /* seq64::thru_router               */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Constructs an empty table, with no dispatching.
+ */
+
+thru_router::thru_router ()
+ :
+    m_dispatch  (dispatch_none)
+{
+    clear();
+}
+
+/**
+ *  Removes all of the routes.
+ */
+
+void
+thru_router::clear ()
+{
+    for (int b = 0; b < SEQ64_DEFAULT_BUSS_MAX; ++b)
+    {
+        for (int c = 0; c < SEQ64_MIDI_CHANNEL_MAX; ++c)
+            m_routes[b][c].store(c_no_route, std::memory_order_relaxed);
+    }
+    for (int c = 0; c < SEQ64_MIDI_CHANNEL_MAX; ++c)
+        m_routed[c].store(false, std::memory_order_relaxed);
+}
+
+/**
+ *  Sets or removes the route of one input buss and channel.  Out-of-range
+ *  values are ignored.
+ *
+ * \param inbus
+ *      The input buss.
+ *
+ * \param channel
+ *      The channel of the incoming events.
+ *
+ * \param outbus
+ *      The output buss, or -1 to remove the route.
+ *
+ * \param outchannel
+ *      The channel with which the events are sent.
+ */
+
+void
+thru_router::set_route (int inbus, int channel, int outbus, int outchannel)
+{
+    bool ok = inbus >= 0 && inbus < SEQ64_DEFAULT_BUSS_MAX &&
+        channel >= 0 && channel < SEQ64_MIDI_CHANNEL_MAX;
+
+    if (ok)
+    {
+        int value = c_no_route;
+        if (outbus >= 0 && outbus < SEQ64_DEFAULT_BUSS_MAX)
+            value = outbus * SEQ64_MIDI_CHANNEL_MAX +
+                (outchannel & EVENT_GET_CHAN_MASK);
+
+        m_routes[inbus][channel].store(value, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * \setter m_routed[channel]
+ */
+
+void
+thru_router::set_routed (int channel, bool flag)
+{
+    if (channel >= 0 && channel < SEQ64_MIDI_CHANNEL_MAX)
+        m_routed[channel].store(flag, std::memory_order_relaxed);
+}
+
+/**
+ *  Looks up the route of an incoming event.  Safe to call from a real-time
+ *  callback:  it neither locks nor allocates.
+ *
+ * \param inbus
+ *      The input buss on which the event arrived.
+ *
+ * \param status
+ *      The status byte of the event, including its channel.
+ *
+ * \param [out] outbus
+ *      Receives the output buss.
+ *
+ * \param [out] outchannel
+ *      Receives the channel with which to send the event.
+ *
+ * \return
+ *      Returns true if the event is to be forwarded.
+ */
+
+bool
+thru_router::route
+(
+    int inbus, midibyte status, bussbyte & outbus, midibyte & outchannel
+) const
+{
+    bool result = false;
+    bool ok = m_dispatch != dispatch_none &&
+        inbus >= 0 && inbus < SEQ64_DEFAULT_BUSS_MAX &&
+        status >= EVENT_NOTE_OFF && status < EVENT_MIDI_SYSEX;
+
+    if (ok)
+    {
+        int channel = status & EVENT_GET_CHAN_MASK;
+        int value = m_routes[inbus][channel].load(std::memory_order_relaxed);
+        if (value != c_no_route)
+        {
+            outbus = bussbyte(value / SEQ64_MIDI_CHANNEL_MAX);
+            outchannel = midibyte(value % SEQ64_MIDI_CHANNEL_MAX);
+            result = true;
+        }
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * thru_router.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-10-30
- * \updates       2021-05-09
+ * \updates       2023-03-04
  * \license       GNU GPLv2 or above
  *
  *  Man, we need to learn a lot more about triggers.  One important thing to
@@ -93,7 +93,8 @@ triggers::triggers (sequence & parent)
     m_trigger_copied            (false),
     m_paste_tick                (SEQ64_NO_PASTE_TRIGGER),   // stazed
     m_ppqn                      (0),
-    m_length                    (0)
+    m_length                    (0),
+    m_generation                (0)
 {
     // Empty body
 }
@@ -141,6 +142,7 @@ triggers::operator = (const triggers & rhs)
         m_trigger_copied = rhs.m_trigger_copied;
         m_ppqn = rhs.m_ppqn;
         m_length = rhs.m_length;
+        ++m_generation;
     }
     return *this;
 }
@@ -178,6 +180,7 @@ triggers::pop_undo ()
         m_redo_stack.push(m_triggers);
         m_triggers = m_undo_stack.top();
         m_undo_stack.pop();
+        ++m_generation;
     }
 }
 
@@ -195,6 +198,7 @@ triggers::pop_redo ()
         m_undo_stack.push(m_triggers);
         m_triggers = m_redo_stack.top();
         m_redo_stack.pop();
+        ++m_generation;
     }
 }
 
@@ -427,6 +431,7 @@ triggers::add
     }
     m_triggers.push_front(t);
     m_triggers.sort();                          /* hmmm, another sort       */
+    ++m_generation;
 }
 
 bool
@@ -439,7 +444,10 @@ triggers::transpose (midipulse tick, int transposition)
         {
             result = transposition != i->transpose();
             if (result)
+            {
                 i->transpose(transposition);
+                ++m_generation;
+            }
 
             break;
         }
@@ -580,6 +588,7 @@ triggers::remove (midipulse tick)
         {
             unselect(*i);                       /* adjust selection count    */
             m_triggers.erase(i);
+            ++m_generation;
             break;
         }
     }
@@ -606,6 +615,7 @@ triggers::split (trigger & trig, midipulse splittick)
     midipulse new_tick_end = trig.tick_end();
     midipulse new_tick_start = splittick;
     trig.tick_end(splittick - 1);
+    ++m_generation;
 
     midipulse len = new_tick_end - new_tick_start;
     if (len > 1)
@@ -709,6 +719,7 @@ triggers::adjust_offsets_to_length (midipulse newlength)
             i->offset(new_offset % newlength);
             i->offset(newlength - i->offset());
         }
+        ++m_generation;
     }
 }
 
@@ -813,6 +824,7 @@ triggers::copy (midipulse starttick, midipulse distance)
         }
     }
     m_triggers.sort();
+    ++m_generation;
 }
 
 /**
@@ -895,6 +907,7 @@ triggers::move (midipulse starttick, midipulse distance, bool direction)
         }
         i->offset(adjust_offset(i->offset()));
     }
+    ++m_generation;
 }
 
 /**
@@ -1042,6 +1055,7 @@ triggers::move_selected (midipulse tick, bool fixoffset, grow_edit_t which)
                 s->increment_offset(deltatick);
                 s->offset(adjust_offset(s->offset()));
             }
+            ++m_generation;
             break;
         }
         else
@@ -1070,6 +1084,8 @@ triggers::offset_selected (midipulse tick, grow_edit_t editmode)
 
             if (editmode == GROW_MOVE)
                 i->increment_offset(tick);
+
+            ++m_generation;
         }
         ++i;
     }
@@ -1202,6 +1218,7 @@ triggers::remove_selected ()
         {
             unselect(*i);               /* this adjusts the selection count */
             m_triggers.erase(i);
+            ++m_generation;
             break;
         }
     }
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-23
- * \updates       2020-06-21
+ * \updates       2023-03-28
  * \license       GNU GPLv2 or above
  *
  *  Note that this module also sets the remaining legacy global variables, so
@@ -228,7 +228,14 @@ user_settings::user_settings ()
 
     m_user_option_daemonize     (false),
     m_user_use_logfile          (false),
+    m_user_option_song_timeline (false),
+    m_user_option_play_threads  (1),
+    m_user_option_lookahead_ms  (0),
+    m_user_option_autosave_minutes (0),
     m_user_option_logfile       (),
+    m_user_option_render_file   (),
+    m_user_option_stats_file    (),
+    m_user_option_trace_file    (),
     m_work_around_play_image    (false),
     m_work_around_transpose_image (false),
 
@@ -344,7 +351,14 @@ user_settings::user_settings (const user_settings & rhs)
 
     m_user_option_daemonize     (rhs.m_user_option_daemonize),
     m_user_use_logfile          (rhs.m_user_use_logfile),
+    m_user_option_song_timeline (rhs.m_user_option_song_timeline),
+    m_user_option_play_threads  (rhs.m_user_option_play_threads),
+    m_user_option_lookahead_ms  (rhs.m_user_option_lookahead_ms),
+    m_user_option_autosave_minutes (rhs.m_user_option_autosave_minutes),
     m_user_option_logfile       (rhs.m_user_option_logfile),
+    m_user_option_render_file   (rhs.m_user_option_render_file),
+    m_user_option_stats_file    (rhs.m_user_option_stats_file),
+    m_user_option_trace_file    (rhs.m_user_option_trace_file),
     m_work_around_play_image    (rhs.m_work_around_play_image),
     m_work_around_transpose_image (rhs.m_work_around_transpose_image),
 
@@ -460,7 +474,14 @@ user_settings::operator = (const user_settings & rhs)
 
         m_user_option_daemonize = rhs.m_user_option_daemonize;
         m_user_use_logfile = rhs.m_user_use_logfile;
+        m_user_option_song_timeline = rhs.m_user_option_song_timeline;
+        m_user_option_play_threads = rhs.m_user_option_play_threads;
+        m_user_option_lookahead_ms = rhs.m_user_option_lookahead_ms;
+        m_user_option_autosave_minutes = rhs.m_user_option_autosave_minutes;
         m_user_option_logfile = rhs.m_user_option_logfile;
+        m_user_option_render_file = rhs.m_user_option_render_file;
+        m_user_option_stats_file = rhs.m_user_option_stats_file;
+        m_user_option_trace_file = rhs.m_user_option_trace_file;
         m_work_around_play_image = rhs.m_work_around_play_image;
         m_work_around_transpose_image = rhs.m_work_around_transpose_image;
 
@@ -549,7 +570,14 @@ user_settings::set_defaults ()
 
     m_user_option_daemonize = false;
     m_user_use_logfile = false;
+    m_user_option_song_timeline = false;
+    m_user_option_play_threads = 1;
+    m_user_option_lookahead_ms = 0;
+    m_user_option_autosave_minutes = 0;
     m_user_option_logfile.clear();
+    m_user_option_render_file.clear();
+    m_user_option_stats_file.clear();
+    m_user_option_trace_file.clear();
     m_work_around_play_image = false;
     m_work_around_transpose_image = false;
     m_user_ui_key_height = 10;
@@ -819,6 +847,64 @@ user_settings::max_sets (int value)
     normalize();
 }
 
+/**
+ * \setter m_user_option_play_threads
+ *      The value is clamped to the range 1 to SEQ64_PLAY_THREADS_MAX.
+ *
+ * \param count
+ *      The number of threads to use for evaluating the patterns, including
+ *      the output thread itself.
+ */
+
+void
+user_settings::option_play_threads (int count)
+{
+    if (count < 1)
+        count = 1;
+    else if (count > SEQ64_PLAY_THREADS_MAX)
+        count = SEQ64_PLAY_THREADS_MAX;
+
+    m_user_option_play_threads = count;
+}
+
+/**
+ * \setter m_user_option_lookahead_ms
+ *      The value is clamped to the range 0 to SEQ64_LOOKAHEAD_MAX_MS.
+ *
+ * \param ms
+ *      The look-ahead time in milliseconds; 0 turns it off.
+ */
+
+void
+user_settings::option_lookahead_ms (int ms)
+{
+    if (ms < 0)
+        ms = 0;
+    else if (ms > SEQ64_LOOKAHEAD_MAX_MS)
+        ms = SEQ64_LOOKAHEAD_MAX_MS;
+
+    m_user_option_lookahead_ms = ms;
+}
+
+/**
+ * \setter m_user_option_autosave_minutes
+ *      The value is clamped to the range 0 to SEQ64_AUTOSAVE_MAX_MINUTES.
+ *
+ * \param minutes
+ *      The period between automatic saves; 0 turns them off.
+ */
+
+void
+user_settings::option_autosave_minutes (int minutes)
+{
+    if (minutes < 0)
+        minutes = 0;
+    else if (minutes > SEQ64_AUTOSAVE_MAX_MINUTES)
+        minutes = SEQ64_AUTOSAVE_MAX_MINUTES;
+
+    m_user_option_autosave_minutes = minutes;
+}
+
 /**
  * \setter m_text_x
  *      This value is not modified unless the value parameter is between 6 and
@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-06-04
- * \updates       2018-11-05
+ * \updates       2023-03-26
  * \license       GNU GPLv2 or above
  *
  *  For a quick guide to the WRK format, see, for example:
@@ -437,6 +437,9 @@ wrkfile::parse (perform & p, int screenset, bool importing)
             result = set_error("Corrupted WRK file.");
         else
             End_chunk();
+
+        if (result)
+            (void) p.share_duplicate_patterns();    /* identical patterns   */
     }
     else
         result = set_error("Invalid WRK file format.");
@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-30
- * \updates       2017-03-21
+ * \updates       2023-03-22
  * \license       GNU GPLv2 or above
  *
  *  The mastermidibus module is the Linux version of the mastermidibus module.
@@ -103,6 +103,10 @@ private:
     virtual void api_stop ();
     virtual void api_continue_from (midipulse tick);
     virtual void api_port_start (int client, int port);
+    virtual bool api_schedule_start ();
+    virtual void api_purge (int tag);
+
+    long input_delay (const snd_seq_event_t * ev);
 
     /*
      * Not implemented:
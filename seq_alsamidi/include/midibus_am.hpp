@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-03-21
+ * \updates       2023-03-22
  * \license       GNU GPLv2 or above
  *
  *  The midibus module is the Linux version of the midibus module.
@@ -176,6 +176,10 @@ protected:
     virtual bool api_init_in_sub ();
     virtual bool api_deinit_in ();
     virtual void api_play (event * e24, midibyte channel);
+    virtual void api_play_at
+    (
+        event * e24, midibyte channel, long delayus, int tag
+    );
     virtual void api_sysex (event * e24);
     virtual void api_flush ();
     virtual void api_continue_from (midipulse tick, midipulse beats);
@@ -186,6 +190,8 @@ protected:
 private:
 
     bool set_virtual_name (int portid, const std::string & portname);
+    void encode_event (event * e24, midibyte channel, snd_seq_event_t & ev);
+    void output_event (snd_seq_event_t & ev);
 
 };          // class midibus (ALSA version)
 
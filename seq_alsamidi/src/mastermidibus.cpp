@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-30
- * \updates       2017-06-02
+ * \updates       2023-03-22
  * \license       GNU GPLv2 or above
  *
  *  This file provides a Linux-only implementation of ALSA MIDI support.
@@ -344,6 +344,7 @@ mastermidibus::api_init (int ppqn, midibpm bpm)
     }
     set_beats_per_minute(m_beats_per_minute);
     set_ppqn(ppqn);
+    m_thru_router.dispatch(thru_router::dispatch_input);  /* on input read  */
     set_sequence_input(false, nullptr);
 
     /*
@@ -426,6 +427,52 @@ mastermidibus::api_stop ()
     snd_seq_stop_queue(m_alsa_seq, m_queue, NULL);  /* start timer */
 }
 
+/**
+ *  Starts our queue, so that the events scheduled on it by
+ *  midibus::api_play_at() are sent at their time by the ALSA timer.  The
+ *  queue is stopped again by api_stop().
+ *
+ * \return
+ *      Returns true if the queue could be started.
+ */
+
+bool
+mastermidibus::api_schedule_start ()
+{
+    bool result = snd_seq_start_queue(m_alsa_seq, m_queue, NULL) >= 0;
+    if (result)
+        snd_seq_drain_output(m_alsa_seq);
+
+    return result;
+}
+
+/**
+ *  Removes the events still waiting in our queue, and in our output buffer,
+ *  except the Note Offs, which must still get out to end their notes.
+ *
+ * \param tag
+ *      The tag of the events to remove (see midibus::api_play_at()), or 0
+ *      to remove them all.
+ */
+
+void
+mastermidibus::api_purge (int tag)
+{
+    unsigned condition = SND_SEQ_REMOVE_OUTPUT | SND_SEQ_REMOVE_IGNORE_OFF;
+    snd_seq_drain_output(m_alsa_seq);               /* direct events first  */
+
+    snd_seq_remove_events_t * remove;
+    snd_seq_remove_events_alloca(&remove);
+    snd_seq_remove_events_set_queue(remove, m_queue);
+    if (tag != 0)
+    {
+        condition |= SND_SEQ_REMOVE_TAG_MATCH;
+        snd_seq_remove_events_set_tag(remove, tag);
+    }
+    snd_seq_remove_events_set_condition(remove, condition);
+    snd_seq_remove_events(m_alsa_seq, remove);
+}
+
 /**
  *  Set the PPQN value (parts per quarter note).  This is done by creating an
  *  ALSA tempo structure, adding tempo information to it, and then setting the
@@ -685,7 +732,18 @@ mastermidibus::api_get_midi_event (event * inev)
     if (bytes <= 0)                                 /* happens at startup    */
         return false;
 
-    inev->set_timestamp(ev->time.tick);
+    /*
+     * Note the input buss, for the input latency and for the thru router,
+     * which forwards MIDI thru as soon as perform::poll_cycle() reads the
+     * event.  In manual mode, the lone virtual input port is buss 0.
+     */
+
+    int bus = m_inbus_array.port_index(ev->source.client, ev->source.port);
+    if (bus < 0 && rc().manual_alsa_ports())
+        bus = 0;
+
+    input_bus(bus);
+    inev->set_timestamp(input_delay(ev) + rc().input_latency(bus));
     inev->set_status_keep_channel(buffer[0]);
 
     /**
@@ -736,6 +794,50 @@ mastermidibus::api_get_midi_event (event * inev)
     return true;
 }
 
+/**
+ *  Calculates the input delay of an event, for api_get_midi_event().  The
+ *  input ports are subscribed with tick time-stamps from our queue, whose
+ *  tempo and PPQN match ours, so the age of an event is the current tick of
+ *  the queue less the tick of the event.  While the queue is stopped, both
+ *  are frozen, and the age is 0.  The caller adds the latency configured
+ *  for the input buss.
+ *
+ * \param ev
+ *      The ALSA event just read.
+ *
+ * \return
+ *      Returns the age of the event in microseconds.
+ */
+
+long
+mastermidibus::input_delay (const snd_seq_event_t * ev)
+{
+    long result = 0;
+    bool ticked = (ev->flags & SND_SEQ_TIME_STAMP_MASK) ==
+        SND_SEQ_TIME_STAMP_TICK;
+
+    if (ticked && ev->queue == m_queue)
+    {
+        snd_seq_queue_status_t * status;
+        snd_seq_queue_status_alloca(&status);
+        if (snd_seq_get_queue_status(m_alsa_seq, m_queue, status) == 0)
+        {
+            snd_seq_tick_time_t now =
+                snd_seq_queue_status_get_tick_time(status);
+
+            if (now > ev->time.tick)
+            {
+                midipulse age = midipulse(now - ev->time.tick);
+                result = long
+                (
+                    ticks_to_delta_time_us(age, get_bpm(), get_ppqn())
+                );
+            }
+        }
+    }
+    return result;
+}
+
 }           // namespace seq64
 
 /*
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2019-04-27
+ * \updates       2023-03-23
  * \license       GNU GPLv2 or above
  *
  *  This file provides a Linux-only implementation of MIDI support.
@@ -35,6 +35,7 @@
 #include "calculations.hpp"             /* clock_ticks_from_ppqn()          */
 #include "event.hpp"                    /* seq64::event (MIDI event)        */
 #include "midibus.hpp"                  /* seq64::midibus for ALSA          */
+#include "perf_stats.hpp"               /* seq64::statistics()              */
 #include "settings.hpp"                 /* seq64::rc() and choose_ppqn()    */
 
 /*
@@ -453,7 +454,8 @@ midibus::api_deinit_in ()
  *  This play() function takes a native event, encodes it to an ALSA MIDI
  *  sequencer event, sets the broadcasting to the subscribers, sets the
  *  direct-passing mode to send the event without queueing, and puts it in the
- *  queue.
+ *  queue.  The fill level of the ALSA output buffer, or the loss of the
+ *  event, is tallied in the statistics of this buss.
  *
  * \threadsafe
  *
@@ -467,6 +469,69 @@ midibus::api_deinit_in ()
 
 void
 midibus::api_play (event * e24, midibyte channel)
+{
+    snd_seq_event_t ev;
+    encode_event(e24, channel, ev);
+    snd_seq_ev_set_direct(&ev);                     /* it is immediate      */
+    output_event(ev);
+}
+
+/**
+ *  Like api_play(), but the event is scheduled on our queue, relative to
+ *  its current real time, so that the kernel sends it when it is due.  The
+ *  queue is started by mastermidibus::api_schedule_start().  The tag lets
+ *  mastermidibus::api_purge() find the events of one pattern.
+ *
+ * \param e24
+ *      The event to be played on this bus.
+ *
+ * \param channel
+ *      The channel of the playback.
+ *
+ * \param delayus
+ *      The delay from now, in microseconds.  An event that is already due
+ *      is sent directly.
+ *
+ * \param tag
+ *      The tag of the pattern, 1 to 255.
+ */
+
+void
+midibus::api_play_at (event * e24, midibyte channel, long delayus, int tag)
+{
+    if (delayus <= 0)
+    {
+        api_play(e24, channel);                     /* already due          */
+        return;
+    }
+
+    snd_seq_event_t ev;
+    encode_event(e24, channel, ev);
+
+    snd_seq_real_time_t rt;
+    rt.tv_sec = unsigned(delayus / 1000000);
+    rt.tv_nsec = unsigned((delayus % 1000000) * 1000);
+    snd_seq_ev_schedule_real(&ev, queue_number(), 1, &rt);  /* relative */
+    ev.tag = (unsigned char)(tag);
+    output_event(ev);
+}
+
+/**
+ *  Encodes a native event to an ALSA MIDI sequencer event, from our port
+ *  to its subscribers.
+ *
+ * \param e24
+ *      The event to encode.
+ *
+ * \param channel
+ *      The channel of the playback.
+ *
+ * \param [out] ev
+ *      The ALSA event to fill.
+ */
+
+void
+midibus::encode_event (event * e24, midibyte channel, snd_seq_event_t & ev)
 {
     midibyte buffer[4];                             /* temp for MIDI data   */
     buffer[0] = e24->get_status();                  /* fill buffer          */
@@ -475,15 +540,39 @@ midibus::api_play (event * e24, midibyte channel)
 
     snd_midi_event_t * midi_ev;                     /* ALSA MIDI parser     */
     snd_midi_event_new(SEQ64_MIDI_EVENT_SIZE_MAX, &midi_ev);
-
-    snd_seq_event_t ev;
     snd_seq_ev_clear(&ev);                          /* clear event          */
     snd_midi_event_encode(midi_ev, buffer, 3, &ev); /* encode 3 raw bytes   */
     snd_midi_event_free(midi_ev);                   /* free the parser      */
     snd_seq_ev_set_source(&ev, m_local_addr_port);  /* set source           */
     snd_seq_ev_set_subs(&ev);
-    snd_seq_ev_set_direct(&ev);                     /* it is immediate      */
-    snd_seq_event_output(m_seq, &ev);               /* pump into the queue  */
+}
+
+/**
+ *  Puts an encoded event in the ALSA output buffer, and tallies the fill
+ *  level of the buffer, or the loss of the event.
+ *
+ * \param ev
+ *      The ALSA event to output.
+ */
+
+void
+midibus::output_event (snd_seq_event_t & ev)
+{
+    int remaining = snd_seq_event_output(m_seq, &ev);   /* pump into queue  */
+    int bus = get_bus_index();
+    if (remaining < 0)
+    {
+        statistics().xrun(bus);
+    }
+    else
+    {
+        size_t buffsize = snd_seq_get_output_buffer_size(m_seq);
+        if (buffsize > 0)
+        {
+            size_t used = size_t(remaining) * sizeof ev;
+            statistics().buffer_fill(bus, int(used * 100 / buffsize));
+        }
+    }
 }
 
 /**
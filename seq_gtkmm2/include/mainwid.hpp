@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-02-17
+ * \updates       2023-03-17
  * \license       GNU GPLv2 or above
  *
  *  Wonder where the name "wid" came from....
@@ -110,6 +110,31 @@ private:
 
     long m_last_tick_x[c_max_sequence];
 
+    /**
+     *  A copy of the inner box of a pattern slot, with its notes, and the
+     *  values it was drawn with.  See draw_sequence_on_pixmap().
+     */
+
+    struct slot_preview
+    {
+        Glib::RefPtr<Gdk::Pixmap> sp_pixmap;    /**< The copy of the box.   */
+        unsigned sp_generation;                 /**< sequence::generation() */
+        midipulse sp_length;                    /**< Length of the pattern. */
+        int sp_state;                           /**< Queued, one-shot, etc. */
+        Color sp_fg;                            /**< Outline and note color.*/
+        Color sp_bg;                            /**< Background color.      */
+    };
+
+    /**
+     *  The cached inner boxes of the pattern slots.  Walking the events of
+     *  a pattern to draw its notes is the costly part of drawing a slot, and
+     *  slots are drawn again on every arming, muting, queueing, and change
+     *  of the sequence in edit; now the notes are drawn only when the
+     *  pattern or the colors of the box have changed.
+     */
+
+    slot_preview m_slot_previews[c_max_sequence];
+
     /**
      *  These values are assigned to the values given by the constants of
      *  similar names in globals.h, and we will make them parameters or
@@ -231,6 +256,7 @@ private:
     void update_markers (int ticks);            /* ditto                    */
     bool valid_sequence (int seq);
     void draw_sequence_on_pixmap (int seq);
+    void draw_slot_box (sequence & seq, int rectangle_x, int rectangle_y);
     void draw_sequences_on_pixmap ();
     void draw_sequence_pixmap_on_window (int seq);
     int seq_from_xy (int x, int y);
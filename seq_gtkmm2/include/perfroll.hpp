@@ -28,13 +28,15 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-11
+ * \updates       2023-03-17
  * \license       GNU GPLv2 or above
  *
  *  This class represents the central piano-roll user-interface area of the
  *  performance/song editor.
  */
 
+#include <vector>                       /* std::vector<>                    */
+
 #include "globals.h"                    /* seq64::c_max_sequence            */
 #include "gui_drawingarea_gtk2.hpp"     /* seq64::gui_drawingarea_gtk2      */
 #include "rect.hpp"                     /* seq64::rect class                */
@@ -56,6 +58,7 @@ namespace seq64
 {
     class perform;
     class perfedit;
+    class sequence;
 
 /**
  *  This class implements the performance roll user interface.
@@ -282,6 +285,44 @@ protected:
 
     bool m_sequence_active[c_max_sequence];
 
+    /**
+     *  One note (or tempo) line of a pattern as drawn in its triggers, in
+     *  pixels, with x relative to the start of the pattern and y relative to
+     *  the top of the trigger box.
+     */
+
+    struct note_mark
+    {
+        int nm_x_start;             /**< Start of the line.                 */
+        int nm_x_finish;            /**< End of the line.                   */
+        int nm_y;                   /**< Vertical position of the line.     */
+        bool nm_tempo;              /**< A tempo event, drawn thicker.      */
+    };
+
+    /**
+     *  The note lines of a pattern, and the values they were computed with.
+     *  A pattern with many triggers, or a short pattern repeated across a
+     *  long trigger, used to walk all of its events once for each repeat
+     *  drawn; now they are walked only when the pattern changes.  See
+     *  note_marks().
+     */
+
+    struct track_marks
+    {
+        std::vector<note_mark> tm_marks;    /**< The lines to draw.         */
+        unsigned tm_generation;             /**< sequence::generation().    */
+        midipulse tm_length;                /**< The length of the pattern. */
+        int tm_scale;                       /**< The m_perf_scale_x value.  */
+        int tm_names_y;                     /**< The m_names_y value.       */
+        bool tm_valid;                      /**< Computed at least once.    */
+    };
+
+    /**
+     *  The cached note lines of each pattern.
+     */
+
+    track_marks m_track_marks[c_max_sequence];
+
 #ifdef SEQ64_SONG_BOX_SELECT
 
     /**
@@ -398,6 +439,7 @@ protected:
     void snap_y (int & y);
     void draw_sequence_on (int seqnum);         /* perform::SeqOperation    */
     void draw_background_on (int seqnum);
+    const std::vector<note_mark> & note_marks (int seqnum, sequence & seq);
     void draw_drawable_row (int y);
 
 #ifdef SEQ64_SONG_BOX_SELECT
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2019-02-05
+ * \updates       2023-03-17
  * \license       GNU GPLv2 or above
  *
  *  Note that this representation is, in a sense, inside the mainwnd
@@ -115,6 +115,7 @@ mainwid::mainwid (perform & p, int ss)
     m_old_seq               (0),
     m_screenset             ((ss > 0 && ss < SEQ64_DEFAULT_SET_MAX) ? ss : 0),
     m_last_tick_x           (),                 // array of size c_max_sequence
+    m_slot_previews         (),                 // array of size c_max_sequence
     m_mainwnd_rows          (usr().mainwnd_rows()),
     m_mainwnd_cols          (usr().mainwnd_cols()),
     m_seqarea_x             (usr().seqarea_x()),
@@ -409,132 +410,49 @@ mainwid::draw_sequence_on_pixmap (int seqnum)
             int ly = m_seqarea_seq_y + 3;
 
             /*
-             * Draw the inner rectangle containing the notes of a sequence.
-             * If queued, color the rectangle grey.  If one-shot queued, color
-             * it light grey.
+             * The inner rectangle and its notes are copied from the cached
+             * preview of the slot when nothing they depend on has changed.
              */
 
-            if (seq->get_queued())
-            {
-                draw_rectangle_on_pixmap(grey_paint(), x, y, lx, ly);
-                fg_color(black());
-            }
-            else if (seq->one_shot())
-            {
-                draw_rectangle_on_pixmap(light_grey_paint(), x, y, lx, ly);
-                fg_color(black());
-            }
-            else
-            {
-#ifdef SEQ64_SHOW_COLOR_PALETTE
-
-                /*
-                 * Draws a filled-in rectangle to hold the event marks.  We
-                 * might make this conditional to preserve the full coloring
-                 * of empty or in-edit sequences. TBD.
-                 *
-                 * Weird, somehow m_cyan comes out black, though m_dk_cyan
-                 * works!!!
-                 */
-
-                int c = seq->color();
-                Color color = get_color(PaletteColor(c));
-                if (c == SEQ64_COLOR_NONE)
-                    color = bg_color();     /* preserve normal coloring     */
+            slot_preview & sp = m_slot_previews[seqnum];
+            int state = seq->get_queued() ? 1 : (seq->one_shot() ? 2 : 0) ;
+            if (! seq->get_transposable())
+                state |= 4;
 
-                draw_rectangle_on_pixmap(color, x, y, lx, ly);
+#ifdef SEQ64_SHOW_COLOR_PALETTE
+            state |= (seq->color() + 1) << 4;
 #endif
-                /*
-                 * Draws a rectangular outline around the event marks.
-                 */
-
-                draw_rectangle_on_pixmap(fg_color(), x, y, lx, ly, false);
+            Color fg = fg_color();
+            Color bg = bg_color();
+            bool cached = sp.sp_pixmap &&
+                sp.sp_generation == seq->generation() &&
+                sp.sp_length == seq->get_length() &&
+                sp.sp_state == state && sp.sp_fg == fg && sp.sp_bg == bg;
+
+            if (cached)
+            {
+                m_pixmap->draw_drawable
+                (
+                    m_gc, sp.sp_pixmap, 0, 0, x, y, lx + 1, ly + 1
+                );
             }
-
-            int low_note;                                   // for side-effect
-            int high_note;                                  // ditto
-            bool have_notes = seq->get_minmax_note_events(low_note, high_note);
-            if (have_notes)
+            else
             {
-                int height = high_note - low_note + 2;      // 2-pixel border
-                int len = seq->get_length();
-                midipulse tick_s;
-                midipulse tick_f;
-                int note;
-                bool selected;
-                int velocity;
-                draw_type_t dt;
-                Color drawcolor = fg_color();
-                Color eventcolor = fg_color();
-                if (! seq->get_transposable())
+                draw_slot_box(*seq, rectangle_x, rectangle_y);
+                if (! sp.sp_pixmap)
                 {
-                    eventcolor = red();
-                    drawcolor = red();
+                    sp.sp_pixmap =
+                        Gdk::Pixmap::create(m_window, lx + 1, ly + 1, -1);
                 }
-
-                /*
-                 * Draw the note events in the sequence.
-                 */
-
-                seq->reset_draw_marker();       /* reset container iterator */
-                do
-                {
-                    dt = seq->get_next_note_event           /* side-effects */
-                    (
-                        tick_s, tick_f, note, selected, velocity
-                    );
-                    if (dt == DRAW_FIN)
-                        break;
-
-                    int tick_s_x = tick_s * m_seqarea_seq_x / len;
-                    int tick_f_x = tick_f * m_seqarea_seq_x / len;
-                    int note_y;
-                    if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
-                        tick_f_x = tick_s_x + 1;
-
-                    if (tick_f_x <= tick_s_x)
-                        tick_f_x = tick_s_x + 1;
-
-                    if (dt == DRAW_TEMPO)
-                    {
-                        /*
-                         * Do not scale by the note range here.
-                         */
-
-                        set_line(Gdk::LINE_SOLID, 2);
-                        drawcolor = tempo_paint();
-                        note_y = m_seqarea_seq_y -
-                             m_seqarea_seq_y * (note + 1) / SEQ64_MAX_DATA_VALUE;
-                    }
-                    else
-                    {
-                        note_y = m_seqarea_seq_y -
-                             m_seqarea_seq_y * (note + 1 - low_note) / height;
-                    }
-
-                    int sx = rectangle_x + tick_s_x;            /* start x  */
-                    int fx = rectangle_x + tick_f_x;            /* finish x */
-                    int sy = rectangle_y + note_y;              /* start y  */
-                    int fy = sy;                                /* finish y */
-                    draw_line_on_pixmap(drawcolor, sx, sy, fx, fy);
-
-                    if (dt == DRAW_TEMPO)
-                    {
-                        /*
-                         * We would like to also draw a line from the end of
-                         * the current tempo to the start of the next one.
-                         * But we currently have only the x value of the next
-                         * tempo.
-                         *
-                         * sx = fx;
-                         * fy = next tempo value scaled to 127;
-                         */
-
-                        set_line(Gdk::LINE_SOLID, 1);
-                        drawcolor = eventcolor;
-                    }
-
-                } while (dt != DRAW_FIN);
+                sp.sp_pixmap->draw_drawable
+                (
+                    m_gc, m_pixmap, x, y, 0, 0, lx + 1, ly + 1
+                );
+                sp.sp_generation = seq->generation();
+                sp.sp_length = seq->get_length();
+                sp.sp_state = state;
+                sp.sp_fg = fg;
+                sp.sp_bg = bg;
             }
         }
         else                                            /* sequence inactive */
@@ -603,6 +521,159 @@ mainwid::draw_sequence_on_pixmap (int seqnum)
     }
 }
 
+/**
+ *  Draws the inner box of a pattern slot, and the notes of the pattern in it.
+ *  Called by draw_sequence_on_pixmap() when the cached copy of the box is
+ *  out of date.
+ *
+ * \param seq
+ *      The pattern to draw.
+ *
+ * \param rectangle_x
+ *      The x coordinate of the area for the notes.
+ *
+ * \param rectangle_y
+ *      The y coordinate of the area for the notes.
+ */
+
+void
+mainwid::draw_slot_box (sequence & seq, int rectangle_x, int rectangle_y)
+{
+    int x = rectangle_x - 2;
+    int y = rectangle_y - 1;
+    int lx = m_seqarea_seq_x + 3;
+    int ly = m_seqarea_seq_y + 3;
+
+    /*
+     * Draw the inner rectangle containing the notes of a sequence.
+     * If queued, color the rectangle grey.  If one-shot queued, color
+     * it light grey.
+     */
+
+    if (seq.get_queued())
+    {
+        draw_rectangle_on_pixmap(grey_paint(), x, y, lx, ly);
+        fg_color(black());
+    }
+    else if (seq.one_shot())
+    {
+        draw_rectangle_on_pixmap(light_grey_paint(), x, y, lx, ly);
+        fg_color(black());
+    }
+    else
+    {
+#ifdef SEQ64_SHOW_COLOR_PALETTE
+
+        /*
+         * Draws a filled-in rectangle to hold the event marks.  We
+         * might make this conditional to preserve the full coloring
+         * of empty or in-edit sequences. TBD.
+         *
+         * Weird, somehow m_cyan comes out black, though m_dk_cyan
+         * works!!!
+         */
+
+        int c = seq.color();
+        Color color = get_color(PaletteColor(c));
+        if (c == SEQ64_COLOR_NONE)
+            color = bg_color();     /* preserve normal coloring     */
+
+        draw_rectangle_on_pixmap(color, x, y, lx, ly);
+#endif
+        /*
+         * Draws a rectangular outline around the event marks.
+         */
+
+        draw_rectangle_on_pixmap(fg_color(), x, y, lx, ly, false);
+    }
+
+    int low_note;                                   // for side-effect
+    int high_note;                                  // ditto
+    bool have_notes = seq.get_minmax_note_events(low_note, high_note);
+    if (have_notes)
+    {
+        int height = high_note - low_note + 2;      // 2-pixel border
+        int len = seq.get_length();
+        midipulse tick_s;
+        midipulse tick_f;
+        int note;
+        bool selected;
+        int velocity;
+        draw_type_t dt;
+        Color drawcolor = fg_color();
+        Color eventcolor = fg_color();
+        if (! seq.get_transposable())
+        {
+            eventcolor = red();
+            drawcolor = red();
+        }
+
+        /*
+         * Draw the note events in the sequence.
+         */
+
+        seq.reset_draw_marker();       /* reset container iterator */
+        do
+        {
+            dt = seq.get_next_note_event           /* side-effects */
+            (
+                tick_s, tick_f, note, selected, velocity
+            );
+            if (dt == DRAW_FIN)
+                break;
+
+            int tick_s_x = tick_s * m_seqarea_seq_x / len;
+            int tick_f_x = tick_f * m_seqarea_seq_x / len;
+            int note_y;
+            if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
+                tick_f_x = tick_s_x + 1;
+
+            if (tick_f_x <= tick_s_x)
+                tick_f_x = tick_s_x + 1;
+
+            if (dt == DRAW_TEMPO)
+            {
+                /*
+                 * Do not scale by the note range here.
+                 */
+
+                set_line(Gdk::LINE_SOLID, 2);
+                drawcolor = tempo_paint();
+                note_y = m_seqarea_seq_y -
+                     m_seqarea_seq_y * (note + 1) / SEQ64_MAX_DATA_VALUE;
+            }
+            else
+            {
+                note_y = m_seqarea_seq_y -
+                     m_seqarea_seq_y * (note + 1 - low_note) / height;
+            }
+
+            int sx = rectangle_x + tick_s_x;            /* start x  */
+            int fx = rectangle_x + tick_f_x;            /* finish x */
+            int sy = rectangle_y + note_y;              /* start y  */
+            int fy = sy;                                /* finish y */
+            draw_line_on_pixmap(drawcolor, sx, sy, fx, fy);
+
+            if (dt == DRAW_TEMPO)
+            {
+                /*
+                 * We would like to also draw a line from the end of
+                 * the current tempo to the start of the next one.
+                 * But we currently have only the x value of the next
+                 * tempo.
+                 *
+                 * sx = fx;
+                 * fy = next tempo value scaled to 127;
+                 */
+
+                set_line(Gdk::LINE_SOLID, 1);
+                drawcolor = eventcolor;
+            }
+
+        } while (dt != DRAW_FIN);
+    }
+}
+
 /**
  *  Common-code helper function.
  *
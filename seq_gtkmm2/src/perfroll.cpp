@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2021-05-07
+ * \updates       2023-03-17
  * \license       GNU GPLv2 or above
  *
  *  The performance window allows automatic control of when each
@@ -156,6 +156,7 @@ perfroll::perfroll
     m_drop_sequence         (0),
     m_sequence_max          (c_max_sequence),
     m_sequence_active       (),                             // [c_max_sequence]
+    m_track_marks           (),                             // [c_max_sequence]
 #ifdef SEQ64_SONG_BOX_SELECT
     m_old                   (),                             // seq64::rect
     m_selected              (),                             // seq64::rect
@@ -172,7 +173,10 @@ perfroll::perfroll
 {
     set_ppqn(ppqn);                                         // choose_ppqn(ppqn)
     for (int i = 0; i < m_sequence_max; ++i)
+    {
         m_sequence_active[i] = false;
+        m_track_marks[i].tm_valid = false;
+    }
 }
 
 /**
@@ -611,12 +615,12 @@ perfroll::draw_sequence_on (int seqnum)
     {
         midipulse tick_offset = m_4bar_offset;      //  * m_ticks_per_bar;
         midipulse x_offset = tick_offset / m_perf_scale_x;
+        const std::vector<note_mark> & marks = note_marks(seqnum, *seq);
         m_sequence_active[seqnum] = true;
         seq->reset_draw_trigger_marker();
         seqnum -= m_sequence_offset;
 
         midipulse sequence_length = seq->get_length();
-        int length_w = sequence_length / m_perf_scale_x;
         midipulse tick_on;
         midipulse tick_off;
         midipulse offset;
@@ -699,22 +703,8 @@ perfroll::draw_sequence_on (int seqnum)
                         );
                     }
 
-                    int low_note, high_note;            // for side-effects
-                    bool have_notes = seq->get_minmax_note_events
-                    (
-                        low_note, high_note             // side-effects
-                    );
-                    if (have_notes)
+                    if (! marks.empty())
                     {
-                        int height = high_note - low_note + 2;
-                        int length = seq->get_length();
-                        midipulse tick_s;
-                        midipulse tick_f;
-                        int note;
-                        bool selected;
-                        int velocity;
-                        draw_type_t dt;
-
                         /*
                          * If a pattern is not transposable, draw it in red
                          * instead of black.
@@ -726,48 +716,11 @@ perfroll::draw_sequence_on (int seqnum)
                         else
                             m_gc->set_foreground(red());
 
-                        seq->reset_draw_marker();       /* container iterator */
-                        do
+                        std::vector<note_mark>::const_iterator nm;
+                        for (nm = marks.begin(); nm != marks.end(); ++nm)
                         {
-                            dt = seq->get_next_note_event   /* side-effects */
-                            (
-                                tick_s, tick_f, note, selected, velocity
-                            );
-                            if (dt == DRAW_FIN)
-                                break;
-
-                            int mny = m_names_y - 6;
-                            int note_y;
-                            if (dt == DRAW_TEMPO)
-                            {
-                                /*
-                                 * Do not to scale by the note range here.
-                                 */
-
-                                note_y =
-                                (
-                                    mny - (mny * note) / SEQ64_MAX_DATA_VALUE
-                                ) + 1;
-                            }
-                            else
-                            {
-                                note_y =
-                                (
-                                    mny - (mny * (note - low_note)) / height
-                                ) + 1;
-                            }
-                            int tick_s_x =
-                                ((tick_s * length_w) / length) + tickmarker_x;
-
-                            int tick_f_x =
-                                ((tick_f * length_w) / length) + tickmarker_x;
-
-                            if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
-                                tick_f_x = tick_s_x + 1;
-
-                            if (tick_f_x <= tick_s_x)
-                                tick_f_x = tick_s_x + 1;
-
+                            int tick_s_x = nm->nm_x_start + tickmarker_x;
+                            int tick_f_x = nm->nm_x_finish + tickmarker_x;
                             if (tick_s_x < x)
                                 tick_s_x = x;
 
@@ -776,9 +729,9 @@ perfroll::draw_sequence_on (int seqnum)
 
                             if (tick_f_x >= x && tick_s_x <= x + w)
                             {
-                                int ny = y + note_y;
+                                int ny = y + nm->nm_y;
                                 Color paint = transposable ? black_paint() : red();
-                                if (dt == DRAW_TEMPO)
+                                if (nm->nm_tempo)
                                 {
                                     set_line(Gdk::LINE_SOLID, 2);
                                     paint = tempo_paint();
@@ -787,7 +740,7 @@ perfroll::draw_sequence_on (int seqnum)
                                 (
                                     paint, tick_s_x, ny, tick_f_x, ny
                                 );
-                                if (dt == DRAW_TEMPO)
+                                if (nm->nm_tempo)
                                 {
                                     /*
                                      * We would like to also draw a line from
@@ -800,7 +753,7 @@ perfroll::draw_sequence_on (int seqnum)
                                     set_line(Gdk::LINE_SOLID, 1);
                                 }
                             }
-                        } while (dt != DRAW_FIN);
+                        }
                     }
                     tickmarker += sequence_length;
 
@@ -824,6 +777,92 @@ perfroll::draw_sequence_on (int seqnum)
     }
 }
 
+/**
+ *  Gets the note lines of a pattern, as drawn in each repeat of the pattern
+ *  in a trigger.  They are computed again only when the pattern has changed
+ *  (see sequence::generation()), or when the zoom or the row height has
+ *  changed.
+ *
+ * \param seqnum
+ *      The number of the pattern.
+ *
+ * \param seq
+ *      The pattern.
+ *
+ * \return
+ *      Returns the lines, which are empty if the pattern has no notes.
+ */
+
+const std::vector<perfroll::note_mark> &
+perfroll::note_marks (int seqnum, sequence & seq)
+{
+    track_marks & tm = m_track_marks[seqnum];
+    midipulse length = seq.get_length();
+    bool current = tm.tm_valid && tm.tm_generation == seq.generation() &&
+        tm.tm_length == length && tm.tm_scale == m_perf_scale_x &&
+        tm.tm_names_y == m_names_y;
+
+    if (! current)
+    {
+        tm.tm_marks.clear();
+        tm.tm_generation = seq.generation();
+        tm.tm_length = length;
+        tm.tm_scale = m_perf_scale_x;
+        tm.tm_names_y = m_names_y;
+        tm.tm_valid = true;
+
+        int low_note, high_note;                        // for side-effects
+        bool have_notes = seq.get_minmax_note_events(low_note, high_note);
+        if (have_notes && length > 0)
+        {
+            int length_w = length / m_perf_scale_x;
+            int height = high_note - low_note + 2;
+            int mny = m_names_y - 6;
+            midipulse tick_s;
+            midipulse tick_f;
+            int note;
+            bool selected;
+            int velocity;
+            draw_type_t dt;
+            seq.reset_draw_marker();                    /* container iterator */
+            while
+            (
+                (
+                    dt = seq.get_next_note_event        /* side-effects     */
+                    (
+                        tick_s, tick_f, note, selected, velocity
+                    )
+                ) != DRAW_FIN
+            )
+            {
+                note_mark nm;
+                if (dt == DRAW_TEMPO)
+                {
+                    /*
+                     * Do not to scale by the note range here.
+                     */
+
+                    nm.nm_y = (mny - (mny * note) / SEQ64_MAX_DATA_VALUE) + 1;
+                }
+                else
+                    nm.nm_y = (mny - (mny * (note - low_note)) / height) + 1;
+
+                nm.nm_x_start = (tick_s * length_w) / length;
+                nm.nm_x_finish = (tick_f * length_w) / length;
+                if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
+                    nm.nm_x_finish = nm.nm_x_start + 1;
+
+                if (nm.nm_x_finish <= nm.nm_x_start)
+                    nm.nm_x_finish = nm.nm_x_start + 1;
+
+                nm.nm_tempo = dt == DRAW_TEMPO;
+                tm.tm_marks.push_back(nm);
+            }
+        }
+    }
+    return tm.tm_marks;
+}
+
 /**
  *  Draws the given pattern/sequence background on the given drawable area.
  */
@@ -853,7 +892,8 @@ perfroll::draw_background_on (int seqnum)
 }
 
 /**
- *  Redraws patterns/sequences that have been modified.
+ *  Redraws patterns/sequences that have been modified, and copies only
+ *  their rows to the window.
  *
  * \change ca 2016-05-30
  *      Lets try not drawing sequences greater than the maximum, at all.
@@ -862,7 +902,6 @@ perfroll::draw_background_on (int seqnum)
 void
 perfroll::redraw_dirty_sequences ()
 {
-    bool draw = false;
     int yf = m_window_y / m_names_y;
     for (int y = 0; y <= yf; ++y)
     {
@@ -870,11 +909,9 @@ perfroll::redraw_dirty_sequences ()
         if (seq < m_sequence_max && perf().is_dirty_perf(seq))  /* see note */
         {
             draw_sequence(seq);
-            draw = true;
+            draw_drawable_row(y * m_names_y);       /* blit only this row   */
         }
     }
-    if (draw)
-        draw_drawable(0, 0, 0, 0, m_window_x, m_window_y);
 }
 
 /**
@@ -0,0 +1,117 @@
+#ifndef SEQ64_MASTERMIDIBUS_NM_HPP
+#define SEQ64_MASTERMIDIBUS_NM_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          mastermidibus_nm.hpp
+ *
+ *  This module declares/defines the master buss of the null MIDI backend.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-06
+ * \updates       2023-03-06
+ * \license       GNU GPLv2 or above
+ *
+ *  The null backend is selected with "./configure --enable-nullmidi".  It
+ *  needs no sound server, so that Seq64cli, the benchmarks, and the tests can
+ *  run on a headless build machine.  The number of ports is configurable:
+ *  by default, the output count is the "[manual-alsa-ports]" count of the
+ *  "rc" file, and there is one input port.  See the midibus_nm.hpp module
+ *  for what the ports do.
+ */
+
+#include "mastermidibase.hpp"           /* seq64::mastermidibase ABC        */
+#include "midibus_nm.hpp"               /* seq64::midibus::Records          */
+
+/*
+ * Do not document the namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The class that "supervises" all of the null midibus objects.
+ */
+
+class mastermidibus : public mastermidibase
+{
+
+private:
+
+    /**
+     *  The number of output ports to create, or -1 to use the
+     *  "[manual-alsa-ports]" count.  Static, because perform creates the
+     *  master buss itself, well after the test program has started.
+     */
+
+    static int sm_output_ports;
+
+    /**
+     *  The number of input ports to create.
+     */
+
+    static int sm_input_ports;
+
+    /**
+     *  The number of records each output port keeps.
+     */
+
+    static std::size_t sm_capture_limit;
+
+public:
+
+    mastermidibus
+    (
+        int ppqn    = SEQ64_USE_DEFAULT_PPQN,
+        midibpm bpm = SEQ64_DEFAULT_BPM        /* c_beats_per_minute */
+    );
+    virtual ~mastermidibus ();
+
+    static void configure
+    (
+        int outputs, int inputs = 1,
+        std::size_t capturelimit = SEQ64_NULLMIDI_CAPTURE_LIMIT
+    );
+
+    midibus * output_port (bussbyte bus);
+    midibus * input_port (bussbyte bus);
+    bool inject (bussbyte bus, const event & ev, long long delayns = 0);
+    bool loopback (bussbyte outbus, bussbyte inbus);
+    midibus::Records records (bussbyte bus);
+
+protected:
+
+    virtual void api_init (int ppqn, midibpm bpm);
+    virtual bool api_get_midi_event (event * inev);
+
+};          // class mastermidibus
+
+}           // namespace seq64
+
+#endif      // SEQ64_MASTERMIDIBUS_NM_HPP
+
+/*
+ * mastermidibus_nm.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
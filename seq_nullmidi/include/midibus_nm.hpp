@@ -0,0 +1,253 @@
+#ifndef SEQ64_MIDIBUS_NM_HPP
+#define SEQ64_MIDIBUS_NM_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          midibus_nm.hpp
+ *
+ *  This module declares/defines the in-process "null" MIDI buss.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-06
+ * \updates       2023-03-06
+ * \license       GNU GPLv2 or above
+ *
+ *  The null midibus talks to no sound server at all.  An output port records
+ *  every message it is asked to send, along with a nanosecond time-stamp
+ *  from the steady clock, so that playback can be measured and verified on a
+ *  machine without ALSA or JACK.  An input port holds a queue of events
+ *  injected by a test or benchmark program; the events are handed to
+ *  perform::poll_cycle() exactly as if they had arrived from a device.  An
+ *  output port can also be looped back to an input port.
+ */
+
+#include <deque>                        /* std::deque<>                     */
+#include <vector>                       /* std::vector<>                    */
+
+#include "event.hpp"                    /* seq64::event                     */
+#include "midibase.hpp"                 /* seq64::midibase                  */
+#include "mutex.hpp"                    /* seq64::mutex, automutex          */
+
+/**
+ *  The default number of messages each null output port records.  At 16
+ *  bytes or so per record, this is a few megabytes per port.
+ */
+
+#define SEQ64_NULLMIDI_CAPTURE_LIMIT    (1024 * 1024)
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  This class implements the null version of the midibus object.
+ */
+
+class midibus : public midibase
+{
+    /**
+     *  The master MIDI bus sets up the buss, so it gets private access.
+     */
+
+    friend class mastermidibus;
+
+public:
+
+    /**
+     *  One message sent on an output port.  SysEx data is not kept, only
+     *  its length, so that a record is small and cheap to append.
+     */
+
+    class record
+    {
+        friend class midibus;
+
+    private:
+
+        long long m_nanoseconds;
+        midibyte m_status;
+        midibyte m_d0;
+        midibyte m_d1;
+        int m_size;
+
+    public:
+
+        record
+        (
+            long long ns, midibyte status,
+            midibyte d0 = 0, midibyte d1 = 0, int size = 1
+        );
+
+        /**
+         * \getter m_nanoseconds
+         *      The steady-clock time at which the message was sent.
+         */
+
+        long long nanoseconds () const
+        {
+            return m_nanoseconds;
+        }
+
+        midibyte status () const
+        {
+            return m_status;
+        }
+
+        midibyte d0 () const
+        {
+            return m_d0;
+        }
+
+        midibyte d1 () const
+        {
+            return m_d1;
+        }
+
+        /**
+         * \getter m_size
+         *      The number of bytes of the message.
+         */
+
+        int size () const
+        {
+            return m_size;
+        }
+    };
+
+    typedef std::vector<record> Records;
+
+private:
+
+    /**
+     *  An injected event, with the steady-clock time at which it becomes
+     *  available to poll_for_midi().
+     */
+
+    typedef std::pair<long long, event> Pending;
+    typedef std::deque<Pending> Queue;
+
+    /**
+     *  Protects the capture and the input queue, which are used by the
+     *  output or input thread and by the test program at the same time.
+     */
+
+    mutable mutex m_null_mutex;
+
+    /**
+     *  The messages sent on this (output) port.
+     */
+
+    Records m_records;
+
+    /**
+     *  The maximum number of records kept.  Once reached, messages are
+     *  still counted, but not recorded, so that a long soak test does not
+     *  exhaust memory.  Zero means no records are kept at all.
+     */
+
+    std::size_t m_capture_limit;
+
+    /**
+     *  The number of messages sent on this port, recorded or not.
+     */
+
+    long m_sent_count;
+
+    /**
+     *  The events waiting to be read from this (input) port, sorted by the
+     *  time at which they are due.
+     */
+
+    Queue m_input_queue;
+
+    /**
+     *  If not null, every message sent on this output port is also injected
+     *  into this input port.
+     */
+
+    midibus * m_loopback;
+
+public:
+
+    midibus (int index, bool isinput, std::size_t capturelimit);
+    virtual ~midibus ();
+
+    static long long timestamp_ns ();
+
+    void inject (const event & ev, long long delayns = 0);
+    Records records () const;
+    void clear_capture ();
+    int pending_count () const;
+
+    /**
+     * \getter m_sent_count
+     */
+
+    long sent_count () const
+    {
+        return m_sent_count;
+    }
+
+    /**
+     * \setter m_loopback
+     *      Use a null pointer to disable the loop-back.
+     */
+
+    void loopback (midibus * inbus)
+    {
+        m_loopback = inbus;
+    }
+
+protected:
+
+    virtual int api_poll_for_midi ();
+    virtual bool api_get_midi_event (event * inev);
+    virtual bool api_init_in ();
+    virtual bool api_init_out ();
+    virtual bool api_init_in_sub ();
+    virtual bool api_init_out_sub ();
+    virtual bool api_deinit_in ();
+    virtual void api_play (event * e24, midibyte channel);
+    virtual void api_sysex (event * e24);
+    virtual void api_continue_from (midipulse tick, midipulse beats);
+    virtual void api_start ();
+    virtual void api_stop ();
+    virtual void api_clock (midipulse tick);
+
+private:
+
+    void send (const record & r, const event * ev = nullptr);
+
+};          // class midibus (null)
+
+}           // namespace seq64
+
+#endif      // SEQ64_MIDIBUS_NM_HPP
+
+/*
+ * midibus_nm.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
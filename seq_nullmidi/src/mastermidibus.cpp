@@ -0,0 +1,295 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          mastermidibus.cpp
+ *
+ *  This module defines the master buss of the null MIDI backend.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-06
+ * \updates       2023-03-12
+ * \license       GNU GPLv2 or above
+ *
+ *  A typical hardware-free test:
+ *
+\verbatim
+        seq64::mastermidibus::configure(2, 1);      // before launch()
+        p.launch(ppqn);
+        p.master_bus().set_input(0, true);
+        p.master_bus().inject(0, noteon);           // scripted input
+        p.poll_cycle();                             // as the input thread
+        p.master_bus().records(0);                  // what was played
+\endverbatim
+ */
+
+#include "event.hpp"                    /* seq64::event                     */
+#include "mastermidibus_nm.hpp"         /* seq64::mastermidibus, null MIDI  */
+#include "midibus_nm.hpp"               /* seq64::midibus, null MIDI        */
+#include "settings.hpp"                 /* seq64::rc()                      */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Static members.
+ */
+
+int mastermidibus::sm_output_ports = (-1);
+int mastermidibus::sm_input_ports = 1;
+std::size_t mastermidibus::sm_capture_limit = SEQ64_NULLMIDI_CAPTURE_LIMIT;
+
+/**
+ *  The base-class constructor fills the array for our busses.
+ *
+ * \param ppqn
+ *      Provides the PPQN value for this object.
+ *
+ * \param bpm
+ *      Provides the beats per minute value.
+ */
+
+mastermidibus::mastermidibus (int ppqn, midibpm bpm)
+ :
+    mastermidibase      (ppqn, bpm)
+{
+    // Empty body
+}
+
+/**
+ *  A rote empty destructor.  The busses are deleted by the busarray
+ *  objects.
+ */
+
+mastermidibus::~mastermidibus ()
+{
+    // Empty body
+}
+
+/**
+ *  Sets the layout of the master busses created from now on.  Call it
+ *  before perform::launch().
+ *
+ * \param outputs
+ *      The number of output ports.  If negative, the "[manual-alsa-ports]"
+ *      count of the "rc" file is used.  At most SEQ64_DEFAULT_BUSS_MAX.
+ *
+ * \param inputs
+ *      The number of input ports, at most SEQ64_DEFAULT_BUSS_MAX.
+ *
+ * \param capturelimit
+ *      The number of messages each output port records.  Zero disables the
+ *      capture, leaving only the sent-message count, for benchmarks that
+ *      should not be disturbed by memory allocation.
+ */
+
+void
+mastermidibus::configure (int outputs, int inputs, std::size_t capturelimit)
+{
+    if (outputs > SEQ64_DEFAULT_BUSS_MAX)
+        outputs = SEQ64_DEFAULT_BUSS_MAX;
+
+    if (inputs < 0)
+        inputs = 0;
+    else if (inputs > SEQ64_DEFAULT_BUSS_MAX)
+        inputs = SEQ64_DEFAULT_BUSS_MAX;
+
+    sm_output_ports = outputs;
+    sm_input_ports = inputs;
+    sm_capture_limit = capturelimit;
+}
+
+/**
+ *  Creates the null ports.  There is no system to query, so the ports are
+ *  simply made up, numbered from 0.  MIDI thru is forwarded by the input
+ *  thread as soon as an event is read (thru_router::dispatch_input).
+ *
+ * \param ppqn
+ *      Provides the PPQN value to set.
+ *
+ * \param bpm
+ *      Provides the beats/minute value to set.
+ */
+
+void
+mastermidibus::api_init (int ppqn, midibpm bpm)
+{
+    int outputs = sm_output_ports >= 0 ?
+        sm_output_ports : rc().manual_port_count() ;
+
+    if (outputs > SEQ64_DEFAULT_BUSS_MAX)
+        outputs = SEQ64_DEFAULT_BUSS_MAX;
+
+    for (int i = 0; i < outputs; ++i)
+    {
+        midibus * m = new midibus(i, false, sm_capture_limit);
+        m_outbus_array.add(m, clock(i));
+    }
+    for (int i = 0; i < sm_input_ports; ++i)
+    {
+        midibus * m = new midibus(i, true, 0);
+        m_inbus_array.add(m, input(i));
+    }
+    m_thru_router.dispatch(thru_router::dispatch_input);
+    set_beats_per_minute(bpm);
+    set_ppqn(ppqn);
+}
+
+/**
+ *  Reads an injected event from the first input port that has one due, and
+ *  notes the port for the thru router.  The base-class api_poll_for_midi()
+ *  already polls each input port.
+ *
+ * \param inev
+ *      Receives the event.
+ *
+ * \return
+ *      Returns true if an event was read.
+ */
+
+bool
+mastermidibus::api_get_midi_event (event * inev)
+{
+    int bus = -1;
+    bool result = m_inbus_array.get_midi_event(inev, &bus);
+    input_bus(bus);
+    return result;
+}
+
+/**
+ *  Looks up an output port.
+ *
+ * \param bus
+ *      The output buss number.
+ *
+ * \return
+ *      Returns a pointer to the port, or a null pointer if there is no such
+ *      port.
+ */
+
+midibus *
+mastermidibus::output_port (bussbyte bus)
+{
+    return int(bus) < m_outbus_array.count() ?
+        m_outbus_array.bus(bus) : nullptr ;
+}
+
+/**
+ *  Looks up an input port.
+ *
+ * \param bus
+ *      The input buss number.
+ *
+ * \return
+ *      Returns a pointer to the port, or a null pointer if there is no such
+ *      port.
+ */
+
+midibus *
+mastermidibus::input_port (bussbyte bus)
+{
+    return int(bus) < m_inbus_array.count() ?
+        m_inbus_array.bus(bus) : nullptr ;
+}
+
+/**
+ *  Queues an event on an input port.  The event is read by
+ *  perform::poll_cycle() only if the port is enabled for input, as with a
+ *  real port; see mastermidibase::set_input().
+ *
+ * \param bus
+ *      The input buss number.
+ *
+ * \param ev
+ *      The event to inject.
+ *
+ * \param delayns
+ *      The delay, in nanoseconds from now, after which the event is due.
+ *
+ * \return
+ *      Returns true if the port exists.
+ */
+
+bool
+mastermidibus::inject (bussbyte bus, const event & ev, long long delayns)
+{
+    midibus * m = input_port(bus);
+    bool result = not_nullptr(m);
+    if (result)
+        m->inject(ev, delayns);
+
+    return result;
+}
+
+/**
+ *  Connects an output port to an input port, so that what Sequencer64 plays
+ *  comes back in, for testing MIDI thru and recording.
+ *
+ * \param outbus
+ *      The output buss number.
+ *
+ * \param inbus
+ *      The input buss number.  If there is no such port, the loop-back of
+ *      the output port is removed.
+ *
+ * \return
+ *      Returns true if both ports exist.
+ */
+
+bool
+mastermidibus::loopback (bussbyte outbus, bussbyte inbus)
+{
+    automutex locker(m_mutex);
+    midibus * out = output_port(outbus);
+    midibus * in = input_port(inbus);
+    if (not_nullptr(out))
+        out->loopback(in);
+
+    return not_nullptr(out) && not_nullptr(in);
+}
+
+/**
+ *  Gets a copy of the capture of an output port.
+ *
+ * \param bus
+ *      The output buss number.
+ *
+ * \return
+ *      Returns the records, which are empty if there is no such port.
+ */
+
+midibus::Records
+mastermidibus::records (bussbyte bus)
+{
+    midibus * m = output_port(bus);
+    return not_nullptr(m) ? m->records() : midibus::Records() ;
+}
+
+}           // namespace seq64
+
+/*
+ * mastermidibus.cpp for null MIDI
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,418 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          midibus.cpp
+ *
+ *  This module defines the in-process "null" MIDI buss.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-06
+ * \updates       2023-03-11
+ * \license       GNU GPLv2 or above
+ *
+ *  This file provides the null implementation of the midibus class.  Output
+ *  ports record what they send; input ports deliver what was injected.
+ *  Nothing is ever passed to an operating-system MIDI API.
+ */
+
+#include <algorithm>                    /* std::upper_bound()               */
+#include <chrono>                       /* std::chrono::steady_clock        */
+
+#include "midibus_nm.hpp"               /* seq64::midibus for null MIDI     */
+#include "settings.hpp"                 /* seq64::rc_settings               */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Orders pending input events by due time.
+ */
+
+static bool
+earlier (long long due, const std::pair<long long, event> & p)
+{
+    return due < p.first;
+}
+
+/**
+ *  Constructs an output record.
+ */
+
+midibus::record::record
+(
+    long long ns, midibyte status, midibyte d0, midibyte d1, int size
+) :
+    m_nanoseconds   (ns),
+    m_status        (status),
+    m_d0            (d0),
+    m_d1            (d1),
+    m_size          (size)
+{
+    // Empty body
+}
+
+/**
+ *  Principal constructor.  The index is also used as the buss and port
+ *  numbers, since there is no system to assign them.
+ *
+ * \param index
+ *      The index of the port in the input or output buss array.
+ *
+ * \param isinput
+ *      True if this is an input port.
+ *
+ * \param capturelimit
+ *      The maximum number of output records to keep.
+ */
+
+midibus::midibus (int index, bool isinput, std::size_t capturelimit)
+ :
+    midibase
+    (
+        rc().application_name(), "null",
+        std::string(isinput ? "in " : "out ") + std::to_string(index),
+        index, index, index, SEQ64_NO_QUEUE,
+        SEQ64_USE_DEFAULT_PPQN, SEQ64_DEFAULT_BPM,
+        false, isinput
+    ),
+    m_null_mutex    (),
+    m_records       (),
+    m_capture_limit (capturelimit),
+    m_sent_count    (0),
+    m_input_queue   (),
+    m_loopback      (nullptr)
+{
+    // Empty body
+}
+
+/**
+ *  A rote empty destructor.
+ */
+
+midibus::~midibus ()
+{
+    // Empty body
+}
+
+/**
+ *  Gets the current time of the steady clock.  All ports use the same clock,
+ *  so that time-stamps can be compared across ports.
+ *
+ * \return
+ *      Returns the time in nanoseconds since the epoch of the steady clock.
+ */
+
+long long
+midibus::timestamp_ns ()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ *  Queues an event on this input port.  A scripted input stream is a
+ *  sequence of calls to this function; the delays allow the stream to be
+ *  injected in advance and still be delivered at a realistic pace.
+ *
+ * \param ev
+ *      The event to deliver.  Only channel messages and SysEx are meaningful
+ *      to perform::poll_cycle().
+ *
+ * \param delayns
+ *      The number of nanoseconds from now after which the event is due.
+ *      Zero (the default) makes it available at once.
+ */
+
+void
+midibus::inject (const event & ev, long long delayns)
+{
+    long long due = timestamp_ns() + (delayns > 0 ? delayns : 0);
+    automutex locker(m_null_mutex);
+    Queue::iterator pos = std::upper_bound
+    (
+        m_input_queue.begin(), m_input_queue.end(), due, earlier
+    );
+    m_input_queue.insert(pos, Pending(due, ev));
+}
+
+/**
+ *  Gets a copy of the output capture, which is safe to use while the output
+ *  thread keeps playing.
+ */
+
+midibus::Records
+midibus::records () const
+{
+    automutex locker(m_null_mutex);
+    return m_records;
+}
+
+/**
+ *  Empties the output capture and resets the sent-message count.
+ */
+
+void
+midibus::clear_capture ()
+{
+    automutex locker(m_null_mutex);
+    m_records.clear();
+    m_sent_count = 0;
+}
+
+/**
+ *  Counts the injected events not yet read, whether they are due or not.
+ */
+
+int
+midibus::pending_count () const
+{
+    automutex locker(m_null_mutex);
+    return int(m_input_queue.size());
+}
+
+/**
+ *  Counts the input events that are due.
+ *
+ * \return
+ *      Returns the number of events that can be read now.
+ */
+
+int
+midibus::api_poll_for_midi ()
+{
+    long long now = timestamp_ns();
+    automutex locker(m_null_mutex);
+    Queue::const_iterator pos = std::upper_bound
+    (
+        m_input_queue.begin(), m_input_queue.end(), now, earlier
+    );
+    return int(pos - m_input_queue.begin());
+}
+
+/**
+ *  Reads the oldest due input event.  Like the other backends, a Note On
+ *  with zero velocity is converted to a Note Off, and the timestamp is set
+ *  to the input delay, here the microseconds since the event fell due.
+ *
+ * \param inev
+ *      Receives the event.
+ *
+ * \return
+ *      Returns true if an event was due.
+ */
+
+bool
+midibus::api_get_midi_event (event * inev)
+{
+    long long now = timestamp_ns();
+    automutex locker(m_null_mutex);
+    bool result = ! m_input_queue.empty() &&
+        m_input_queue.front().first <= now;
+
+    if (result)
+    {
+        long long due = m_input_queue.front().first;
+        *inev = m_input_queue.front().second;
+        inev->set_timestamp(midipulse((now - due) / 1000));
+        m_input_queue.pop_front();
+        if (inev->is_note_off_recorded())
+        {
+            midibyte channel = inev->get_channel();
+            inev->set_status_keep_channel(EVENT_NOTE_OFF | channel);
+        }
+    }
+    return result;
+}
+
+/**
+ *  There is nothing to open, so the port initialization functions always
+ *  succeed.
+ */
+
+bool
+midibus::api_init_in ()
+{
+    return true;
+}
+
+bool
+midibus::api_init_out ()
+{
+    return true;
+}
+
+bool
+midibus::api_init_in_sub ()
+{
+    return true;
+}
+
+bool
+midibus::api_init_out_sub ()
+{
+    return true;
+}
+
+/**
+ *  Closing an input port discards whatever was still queued on it.
+ */
+
+bool
+midibus::api_deinit_in ()
+{
+    automutex locker(m_null_mutex);
+    m_input_queue.clear();
+    return true;
+}
+
+/**
+ *  Records an outgoing message, and passes it to the loop-back port if
+ *  there is one.
+ *
+ * \param r
+ *      The message, already time-stamped.
+ *
+ * \param ev
+ *      The event to loop back, if applicable.  Real-time messages are not
+ *      looped back, since perform::poll_cycle() would ignore them anyway.
+ */
+
+void
+midibus::send (const record & r, const event * ev)
+{
+    {
+        automutex locker(m_null_mutex);
+        ++m_sent_count;
+        if (m_records.size() < m_capture_limit)
+            m_records.push_back(r);
+    }
+    if (not_nullptr(m_loopback) && not_nullptr(ev))
+        m_loopback->inject(*ev);
+}
+
+/**
+ *  Records a channel message.
+ *
+ * \param e24
+ *      The MIDI event to play.
+ *
+ * \param channel
+ *      The channel on which to play the event.
+ */
+
+void
+midibus::api_play (event * e24, midibyte channel)
+{
+    long long ns = timestamp_ns();
+    midibyte status = e24->get_status() | (channel & 0x0F);
+    midibyte d0, d1;
+    e24->get_data(d0, d1);
+    int size = event::is_two_byte_msg(e24->get_status()) ? 3 : 2;
+    if (not_nullptr(m_loopback))
+    {
+        event ev = *e24;
+        ev.set_status_keep_channel(status);
+        send(record(ns, status, d0, d1, size), &ev);
+    }
+    else
+        send(record(ns, status, d0, d1, size));
+}
+
+/**
+ *  Records a SysEx message, keeping only its length.
+ */
+
+void
+midibus::api_sysex (event * e24)
+{
+    send
+    (
+        record(timestamp_ns(), EVENT_MIDI_SYSEX, 0, 0, e24->get_sysex_size()),
+        e24
+    );
+}
+
+/**
+ *  Records the Continue and Song Position messages.
+ *
+ * \param beats
+ *      The calculated beats, as in the other implementations.
+ */
+
+void
+midibus::api_continue_from (midipulse /* tick */, midipulse beats)
+{
+    long long ns = timestamp_ns();
+    send(record(ns, EVENT_MIDI_CONTINUE));
+    send
+    (
+        record
+        (
+            ns, EVENT_MIDI_SONG_POS,
+            midibyte(beats & 0x7F), midibyte((beats >> 7) & 0x7F), 3
+        )
+    );
+}
+
+/**
+ *  Records the Start message.
+ */
+
+void
+midibus::api_start ()
+{
+    send(record(timestamp_ns(), EVENT_MIDI_START));
+}
+
+/**
+ *  Records the Stop message.
+ */
+
+void
+midibus::api_stop ()
+{
+    send(record(timestamp_ns(), EVENT_MIDI_STOP));
+}
+
+/**
+ *  Records a MIDI Clock message.  Comparing the time-stamps of these records
+ *  is a direct measure of the clock jitter of the output thread.
+ */
+
+void
+midibus::api_clock (midipulse /* tick */)
+{
+    send(record(timestamp_ns(), EVENT_MIDI_CLOCK));
+}
+
+}           // namespace seq64
+
+/*
+ * midibus.cpp for null MIDI
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
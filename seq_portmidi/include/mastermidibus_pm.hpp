@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-05-27
+ * \updates       2023-03-23
  * \license       GNU GPLv2 or above
  *
  *  This mastermidibus module is the Windows (and Linux now!) version of the
@@ -75,11 +75,13 @@ protected:
     virtual bool api_get_midi_event (event * in);
     virtual void api_set_ppqn (int ppqn);
     virtual void api_set_beats_per_minute (midibpm bpm);
+    virtual void api_flush ();
+    virtual bool api_schedule_start ();
+    virtual int api_schedule_lead_ms ();
 
     /*
      * TODO
      *
-    virtual void api_flush ();
     virtual void api_start ();
     virtual void api_stop ();
     virtual void api_continue_from (midipulse tick);
@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-08-30
+ * \updates       2023-03-23
  * \license       GNU GPLv2 or above
  *
  *  This midibus module is the Windows (PortMidi) version of the midibus
@@ -35,6 +35,8 @@
  *  class for all midibus classes.
  */
 
+#include <vector>                       /* std::vector<PmEvent>             */
+
 #include "midibase.hpp"
 #include "portmidi.h"                   /* PortMIDI API header file         */
 
@@ -66,6 +68,22 @@ private:
 
     PortMidiStream * m_pms;
 
+    /**
+     *  The latency with which the output stream is opened, in milliseconds.
+     *  If not 0, PortMidi sends each event at its timestamp plus this
+     *  latency, and events without a timestamp at the time they are written
+     *  plus this latency.  It is the "-o lookahead=ms" option.
+     */
+
+    int m_latency;
+
+    /**
+     *  The timestamped events of the current output cycle, written with one
+     *  call to Pm_Write() when the buss is flushed.  See api_play_at().
+     */
+
+    std::vector<PmEvent> m_batch;
+
 public:
 
     /*
@@ -89,6 +107,15 @@ protected:
     virtual void api_stop ();
     virtual void api_clock (midipulse tick);
     virtual void api_play (event * e24, midibyte channel);
+    virtual void api_play_at
+    (
+        event * e24, midibyte channel, long delayus, int tag
+    );
+    virtual void api_flush ();
+
+private:
+
+    void write_batch ();
 
     /*
      * Functions not implemented in PortMIDI.  For example, the "sub"
@@ -102,10 +129,6 @@ protected:
      * We should be able to implement this in a "sysex_fix" branch:
      *
      * virtual void api_sysex (event * e24);
-     *
-     * This function should be able to be implemented in Windows and ALSA:
-     *
-     * virtual void api_flush ();
      */
 
 };          // class midibus (portmidi)
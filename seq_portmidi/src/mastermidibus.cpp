@@ -25,19 +25,21 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-06-02
+ * \updates       2023-03-23
  * \license       GNU GPLv2 or above
  *
  *  This file provides a Windows-only implementation of the mastermidibus
  *  class.  There is a lot of common code between these two versions!
  */
 
+#include "easy_macros.h"                /* not_nullptr() macro              */
 #include "event.hpp"                    /* seq64::event                     */
 #include "mastermidibus_pm.hpp"         /* seq64::mastermidibus, PortMIDI   */
 #include "midibus_pm.hpp"               /* seq64::midibus, PortMIDI         */
 #include "portmidi.h"                   /* external PortMidi header file    */
 #include "porttime.h"                   /* Pt_Time_To_Pulses()              */
 #include "pmutil.h"                     /* Pm_Dequeue()                     */
+#include "settings.hpp"                 /* seq64::rc()                      */
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -210,13 +212,20 @@ mastermidibus::api_get_midi_event (event * in)
             else
             {
                 /*
-                 * We don't need to do this.  The perform input loop
-                 * sets the timestamp.  Let's hope that loop can keep up!
-                 *
-                 * midipulse ts = midipulse(Pt_Time_To_Pulses(pme.timestamp));
-                 * in->set_timestamp(ts);
+                 * The perform input loop converts the timestamp to a tick.
+                 * Here, it is the input delay in microseconds, as for the
+                 * other backends; PortMidi stamps input in milliseconds.
+                 * See midibase::get_midi_event().
                  */
 
+                long delay = 0;
+                if (not_nullptr(midi->time_proc))
+                {
+                    PmTimestamp now = midi->time_proc(midi->time_info);
+                    if (now > pme.timestamp)
+                        delay = long(now - pme.timestamp) * 1000;
+                }
+                in->set_timestamp(delay + rc().input_latency(i));
                 in->set_status_keep_channel(Pm_MessageStatus(pme.message));
                 in->set_data
                 (
@@ -250,6 +259,47 @@ mastermidibus::api_get_midi_event (event * in)
     return true;                        /* Why no "sysex = false"?  */
 }
 
+/**
+ *  Flushes the output busses, which write the events they hold for the
+ *  output cycle.  See midibus::api_play_at().
+ */
+
+void
+mastermidibus::api_flush ()
+{
+    m_outbus_array.flush();
+}
+
+/**
+ *  The output streams are opened with the "-o lookahead=ms" option as their
+ *  latency, so the events of the patterns can be stamped with their time.
+ *
+ * \return
+ *      Returns true if the latency is not 0.
+ */
+
+bool
+mastermidibus::api_schedule_start ()
+{
+    return usr().option_lookahead_ms() > 0;
+}
+
+/**
+ *  PortMidi delays every event by the latency, so the patterns are not
+ *  played ahead; an event that was due earlier in the output cycle is still
+ *  in time.  Nothing is queued past the latency, so there is also nothing to
+ *  purge when a pattern is muted.
+ *
+ * \return
+ *      Returns 0.
+ */
+
+int
+mastermidibus::api_schedule_lead_ms ()
+{
+    return 0;
+}
+
 /**
  *  Not yet implemented.
  */
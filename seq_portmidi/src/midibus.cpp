@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-05-27
+ * \updates       2023-03-23
  * \license       GNU GPLv2 or above
  *
  *  This file provides a Windows-only implementation of the midibus class.
@@ -39,10 +39,20 @@
  *          -   init_out_sub()
  *          -   init_in_sub()
  *          -   deinit_in()
+ *
+ *  With the "-o lookahead=ms" option, the output streams are opened with
+ *  that latency, and the events of the patterns are stamped with the time
+ *  they are due, from the PortTime clock that PortMidi then uses.  PortMidi
+ *  sends each at its timestamp plus the latency, so that the timing depends
+ *  on the PortMidi timer, not on when the output thread wakes up.  All
+ *  output is then delayed by the latency.
  */
 
+#include <algorithm>                    /* std::stable_sort()               */
+
 #include "event.hpp"                    /* seq64::event and macros          */
 #include "midibus_pm.hpp"               /* seq64::midibus for PortMIDI      */
+#include "porttime.h"                   /* Pt_Time()                        */
 #include "settings.hpp"                 /* seq64::rc_settings               */
 
 /*
@@ -69,7 +79,9 @@ midibus::midibus
         rc().application_name(), "PortMidi", clientname, index,
         bus_id, port_id, port_id                /* PM uses 'queue' still */
     ),
-    m_pms           (nullptr)
+    m_pms           (nullptr),
+    m_latency       (0),
+    m_batch         ()
 {
     // Empty body
 }
@@ -134,7 +146,9 @@ midibus::api_poll_for_midi ()
 }
 
 /**
- *  Initializes the MIDI output port, for PortMidi.
+ *  Initializes the MIDI output port, for PortMidi.  The latency is the
+ *  "-o lookahead=ms" option; if it is not 0, PortMidi starts the PortTime
+ *  clock, and uses it for the timestamps of the events.
  *
  * \return
  *      Returns true if the output port was successfully opened.
@@ -143,9 +157,10 @@ midibus::api_poll_for_midi ()
 bool
 midibus::api_init_out ()
 {
+    m_latency = usr().option_lookahead_ms();
     PmError err = Pm_OpenOutput
     (
-        &m_pms, queue_number(), NULL, 100, NULL, NULL, 0
+        &m_pms, queue_number(), NULL, 100, NULL, NULL, m_latency
     );
     bool result = err == pmNoError;
     if (! result)
@@ -209,9 +224,96 @@ midibus::api_play (event * e24, midibyte channel)
     PmEvent event;
     event.timestamp = 0;
     event.message = Pm_Message(buffer[0], buffer[1], buffer[2]);
+    write_batch();
     /* PmError err = */ Pm_Write(m_pms, &event, 1);
 }
 
+/**
+ *  Like api_play(), but the event is stamped with the time it is due, on
+ *  the PortTime clock, and held until the buss is flushed at the end of the
+ *  output cycle.  Without a latency, the timestamp would be ignored, and
+ *  the event is played now.
+ *
+ * \param e24
+ *      The MIDI event to play.
+ *
+ * \param channel
+ *      The channel on which to play the event.
+ *
+ * \param delayus
+ *      The time from now at which the event is due, in microseconds.  It
+ *      is negative for an event that was due earlier in the output cycle.
+ *      PortMidi sends the event at that time plus the latency.
+ */
+
+void
+midibus::api_play_at
+(
+    event * e24, midibyte channel, long delayus, int /* tag */
+)
+{
+    if (m_latency == 0)
+    {
+        api_play(e24, channel);
+        return;
+    }
+
+    midibyte buffer[4];
+    buffer[0] = e24->get_status();
+    buffer[0] += (channel & 0x0F);
+    e24->get_data(buffer[1], buffer[2]);
+
+    long ms = delayus >= 0 ? (delayus + 500) / 1000 : (delayus - 500) / 1000 ;
+    PmEvent event;
+    event.timestamp = PmTimestamp(Pt_Time() + ms);
+    event.message = Pm_Message(buffer[0], buffer[1], buffer[2]);
+    m_batch.push_back(event);
+}
+
+/**
+ *  Writes the events held by api_play_at().  Called by midibase::flush(),
+ *  once per output cycle.
+ */
+
+void
+midibus::api_flush ()
+{
+    write_batch();
+}
+
+/**
+ *  Orders the events of a batch by their timestamps.  The events of each
+ *  pattern are in order already, but the patterns are played one after the
+ *  other, and the Windows stream interface of PortMidi does not go back in
+ *  time.
+ */
+
+static bool
+earlier (const PmEvent & a, const PmEvent & b)
+{
+    return a.timestamp < b.timestamp;
+}
+
+/**
+ *  Writes the held events with one call to Pm_Write(), in the order of
+ *  their timestamps.  Also called before an event is written directly, so
+ *  that the events go out in order.
+ */
+
+void
+midibus::write_batch ()
+{
+    if (! m_batch.empty())
+    {
+        if (not_nullptr(m_pms))
+        {
+            std::stable_sort(m_batch.begin(), m_batch.end(), earlier);
+            (void) Pm_Write(m_pms, m_batch.data(), int32_t(m_batch.size()));
+        }
+        m_batch.clear();
+    }
+}
+
 /**
  *  Continue from the given tick.  This function implements only the
  *  PortMidi-specific code.
@@ -229,6 +331,7 @@ midibus::api_continue_from (midipulse /* tick */, midipulse beats)
 {
     PmEvent event;
     event.timestamp = 0;
+    write_batch();
     event.message = Pm_Message(EVENT_MIDI_CONTINUE, 0, 0);
     Pm_Write(m_pms, &event, 1);
     event.message = Pm_Message
@@ -251,6 +354,7 @@ midibus::api_start ()
         PmEvent event;
         event.timestamp = 0;
         event.message = Pm_Message(EVENT_MIDI_START, 0, 0);
+        write_batch();
         Pm_Write(m_pms, &event, 1);
     }
 }
@@ -268,6 +372,7 @@ midibus::api_stop ()
         PmEvent event;
         event.timestamp = 0;
         event.message = Pm_Message(EVENT_MIDI_STOP, 0, 0);
+        write_batch();
         Pm_Write(m_pms, &event, 1);
     }
 }
@@ -293,6 +398,7 @@ midibus::api_clock (midipulse /* tick */)
         PmEvent event;
         event.timestamp = 0;                /* WHY NOT use 'tick' here? */
         event.message = Pm_Message(EVENT_MIDI_CLOCK, 0, 0);
+        write_batch();
         Pm_Write(m_pms, &event, 1);
     }
 }
@@ -28,13 +28,16 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2019-04-08
+ * \updates       2023-03-15
  * \license       GNU GPLv2 or above
  *
  *  This class represents the central piano-roll user-interface area of the
  *  performance/song editor.
  */
 
+#include <vector>                       /* std::vector<>                    */
+
+#include <QPixmap>
 #include <QWidget>
 
 #include "globals.h"
@@ -125,6 +128,13 @@ private:
     void half_split_trigger (int seq, midipulse tick);
     void delete_trigger (int seq, midipulse tick);
     void follow_progress ();
+    QRect visible_rect () const;
+    std::vector<long> grid_key (const QRect & r) const;
+    std::vector<long> triggers_key (const QRect & r);
+    void update_layers (const QRect & r);
+    void draw_grid (QPainter & painter);
+    void draw_triggers (QPainter & painter, const QRect & r);
+    void draw_overlay (QPainter & painter);
 
 private:
 
@@ -146,6 +156,39 @@ private:
     bool m_grow_direction;
     bool m_adding_pressed;
 
+    /**
+     *  The visible part of the grid, drawn only when the values in
+     *  m_grid_key change.
+     */
+
+    QPixmap m_grid_pixmap;
+
+    /**
+     *  A copy of m_grid_pixmap with the triggers drawn over it.  This is
+     *  what paintEvent() copies to the screen.
+     */
+
+    QPixmap m_triggers_pixmap;
+
+    /**
+     *  The values the grid was last drawn with.  See grid_key().
+     */
+
+    std::vector<long> m_grid_key;
+
+    /**
+     *  The values the triggers were last drawn with.  See triggers_key().
+     */
+
+    std::vector<long> m_triggers_key;
+
+    /**
+     *  Set when this roll was marked dirty, so that the triggers are drawn
+     *  again even if no pattern generation has changed.
+     */
+
+    bool m_triggers_stale;
+
 };          // class qperfroll
 
 }           // namespace seq64
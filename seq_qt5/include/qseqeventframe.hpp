@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-08-13
- * \updates       2018-08-18
+ * \updates       2023-03-18
  * \license       GNU GPLv2 or above
  *
  */
@@ -116,6 +116,7 @@ private:
     void set_dirty (bool flag = true);
 
     bool initialize_table ();
+    void load_visible_rows ();
 
     std::string get_lengths ();
 
@@ -128,6 +129,7 @@ private slots:
 
     void handle_table_click (int row, int column);
     void handle_table_click_ex (int row, int column, int prevrow, int prevcol);
+    void handle_table_scroll ();
     void handle_delete ();
     void handle_insert ();
     void handle_modify ();
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2019-04-29
+ * \updates       2023-03-15
  * \license       GNU GPLv2 or above
  *
  *  We are currently moving toward making this class a base class.
@@ -37,9 +37,12 @@
  *  progress bar during playback.  See the qseqbase::m_progress_follow member.
  */
 
+#include <vector>                       /* std::vector<>                    */
+
 #include <QWidget>
 #include <QPainter>
 #include <QPen>
+#include <QPixmap>
 #include <QTimer>
 #include <QMouseEvent>
 
@@ -151,6 +154,13 @@ protected:      // overrides for painting, mouse/keyboard events, & size hints
 
 private:
 
+    QRect visible_rect () const;
+    std::vector<int> grid_key (const QRect & r) const;
+    void update_layers (const QRect & r);
+    void draw_grid (QPainter & painter);
+    void draw_notes (QPainter & painter);
+    void draw_progress (QPainter & painter);
+    void draw_selection (QPainter & painter);
     void snap_y (int & y);
     void set_adding (bool a_adding);
     void start_paste();
@@ -261,6 +271,44 @@ private:
     int m_key_y;               // dimensions of height
     int m_keyarea_y;
 
+    /**
+     *  The cached drawing of the grid of the visible part of the roll.
+     */
+
+    QPixmap m_grid_pixmap;
+
+    /**
+     *  The cached drawing of the grid with the notes drawn on it.
+     */
+
+    QPixmap m_notes_pixmap;
+
+    /**
+     *  The values m_grid_pixmap was drawn with.  See grid_key().
+     */
+
+    std::vector<int> m_grid_key;
+
+    /**
+     *  The generation of the sequence that m_notes_pixmap shows.
+     */
+
+    unsigned m_notes_generation;
+
+    /**
+     *  The generation of the background sequence plus one, or 0 if none is
+     *  shown, that m_notes_pixmap shows.
+     */
+
+    unsigned m_background_generation;
+
+    /**
+     *  Set when the notes must be redrawn even if the generations are
+     *  unchanged, such as for a change of selection.
+     */
+
+    bool m_notes_stale;
+
 signals:
 
 public slots:
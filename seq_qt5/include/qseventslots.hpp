@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2018-08-13
- * \updates       2018-08-17
+ * \updates       2023-03-18
  * \license       GNU GPLv2 or above
  *
  *  This class supports the left side of the Qt 5 version of the Event Editor
@@ -188,6 +188,22 @@ private:
 
     int m_pager_index;
 
+    /**
+     *  The table row last filled by load_table(), and the event shown in it.
+     *  The table is filled only as its rows are scrolled into view, and
+     *  starting from the nearest of this row and the top row saves walking
+     *  the container from the beginning for each page.  Reset whenever
+     *  events are added or removed, since the iterator may then be stale.
+     */
+
+    int m_table_row;
+
+    /**
+     *  The event shown in m_table_row.
+     */
+
+    editable_events::const_iterator m_table_iterator;
+
 public:
 
     qseventslots
@@ -334,7 +350,8 @@ private:
     }
 
     bool load_events ();
-    bool load_table ();
+    bool load_table (int first, int last);
+    void reset_table_anchor ();
     void set_current_event
     (
         const editable_events::iterator ei,
@@ -28,12 +28,13 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-10-21
+ * \updates       2023-03-16
  * \license       GNU GPLv2 or above
  *
  */
 
 #include <QFrame>
+#include <QPixmap>
 
 #include "globals.h"
 #include "gui_palette_qt5.hpp"
@@ -72,6 +73,25 @@ class qsliveframe : public QFrame, gui_palette_qt5
 
     Q_OBJECT
 
+private:
+
+    /**
+     *  The notes of a pattern, drawn once into a pixmap, along with the
+     *  values they were drawn with.  See update_thumbnail().
+     */
+
+    struct thumbnail
+    {
+        QPixmap t_pixmap;           /**< The notes, on a clear background.  */
+        unsigned t_generation;      /**< See sequence::generation().        */
+        int t_length;               /**< The length of the pattern.         */
+        int t_width;                /**< The width of the note area.        */
+        int t_height;               /**< The height of the note area.       */
+        int t_slot_height;          /**< Used in placing tempo events.      */
+        QRgb t_color;               /**< The color of the notes.            */
+        bool t_has_notes;           /**< Anything to draw at all?           */
+    };
+
 public:
 
     qsliveframe
@@ -121,6 +141,14 @@ private:
     void calculate_base_sizes (int seq, int & basex, int & basey);
     void drawSequence (int seq);
     void drawAllSequences ();
+    QRect slot_rect (int seq);
+    int preview_width () const;
+    int slot_state (int seq);
+    midipulse progress_x (int seq);
+    const thumbnail & update_thumbnail
+    (
+        int seq, int w, int h, const Color & pencolor
+    );
     void updateInternalBankName ();
     bool valid_sequence (int seqnum);
     int seq_id_from_xy (int click_x, int click_y);
@@ -224,6 +252,22 @@ private:
     bool m_adding_new;                  // new seq here, wait for double click
     midipulse m_last_tick_x[c_max_sequence];
     bool m_last_playing[c_max_sequence];
+
+    /**
+     *  The slot_state() value of each slot when it was last drawn.
+     *  Together with m_last_tick_x, the position of the progress marker
+     *  when the slot was last drawn, it lets conditional_update() repaint
+     *  only the slots that have changed.
+     */
+
+    int m_last_state[c_max_sequence];
+
+    /**
+     *  The cached note previews of the slots.
+     */
+
+    thumbnail m_thumbnails[c_max_sequence];
+
     bool m_can_paste;
 
     /**
@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-11-04
+ * \updates       2023-03-08
  * \license       GNU GPLv2 or above
  *
  *  The main window is known as the "Patterns window" or "Patterns
@@ -82,6 +82,7 @@ namespace seq64
     class qseditoptions;
     class qsabout;
     class qsbuildinfo;
+    class qsperfstats;
 
 /**
  * The main window of Kepler34.
@@ -220,6 +221,7 @@ private:
     qseditoptions * m_dialog_prefs;
     qsabout * mDialogAbout;
     qsbuildinfo * mDialogBuildInfo;
+    qsperfstats * mDialogPerfStats;
 
     /**
      *  Provides a workaround for a race condition when a MIDI file-name is
@@ -312,6 +314,7 @@ private slots:
     void show_open_list_dialog ();
     void showqsabout ();
     void showqsbuildinfo ();
+    void showqsperfstats ();
     void tabWidgetClicked (int newindex);
     void refresh ();                    /* redraw certain GUI elements      */
     void load_editor (int seqid);
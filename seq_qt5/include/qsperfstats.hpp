@@ -0,0 +1,88 @@
+#ifndef SEQ64_QSPERFSTATS_HPP
+#define SEQ64_QSPERFSTATS_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          qsperfstats.hpp
+ *
+ *  The diagnostics panel shows the latency and jitter statistics while the
+ *  application runs.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-08
+ * \updates       2023-03-08
+ * \license       GNU GPLv2 or above
+ *
+ */
+
+#include <QDialog>
+
+class QTimer;
+
+namespace Ui
+{
+   class qsperfstats;
+}
+
+namespace seq64
+{
+
+class qsperfstats : public QDialog
+{
+    Q_OBJECT
+
+public:
+
+    explicit qsperfstats (QWidget * parent = 0);
+    virtual ~qsperfstats ();
+
+protected:
+
+    virtual void showEvent (QShowEvent *);
+    virtual void hideEvent (QHideEvent *);
+
+private slots:
+
+    void update_stats ();
+    void reset_stats ();
+
+private:
+
+    Ui::qsperfstats * ui;
+
+    /**
+     *  Refreshes the report while the panel is shown.
+     */
+
+    QTimer * m_timer;
+
+};             // class qsperfstats
+
+}              // namespace seq64
+
+#endif         // SEQ64_QSPERFSTATS_HPP
+
+/*
+ * qsperfstats.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -62,6 +62,7 @@ FORMS += forms/qlfoframe.ui \
  forms/qsliveframe.ui \
  forms/qsmainwnd.ui \
  forms/qsbuildinfo.ui \
+ forms/qsperfstats.ui \
  forms/qseqeventframe.ui
 
 RESOURCES += src/qseq64.qrc
@@ -104,6 +105,7 @@ HEADERS += \
  include/qstriggereditor.hpp \
  include/qt5_helpers.hpp \
  include/qsbuildinfo.hpp \
+ include/qsperfstats.hpp \
  include/qseqeventframe.hpp
 
 SOURCES += \
@@ -142,6 +144,7 @@ SOURCES += \
  src/qstriggereditor.cpp \
  src/qt5_helpers.cpp \
  src/qsbuildinfo.cpp \
+ src/qsperfstats.cpp \
  src/qseqeventframe.cpp
 
 # The output of the uic command goes to the seq_qt5/forms directory in
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2019-05-05
+ * \updates       2023-03-15
  * \license       GNU GPLv2 or above
  *
  *  This class represents the central piano-roll user-interface area of the
@@ -91,7 +91,12 @@ qperfroll::qperfroll
     mLastTick           (0),
     mBoxSelect          (false),
     m_grow_direction    (false),
-    m_adding_pressed    (false)
+    m_adding_pressed    (false),
+    m_grid_pixmap       (),
+    m_triggers_pixmap   (),
+    m_grid_key          (),
+    m_triggers_key      (),
+    m_triggers_stale    (true)
 {
     setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     setFocusPolicy(Qt::StrongFocus);
@@ -118,12 +123,16 @@ qperfroll::~qperfroll ()
 }
 
 /**
- *
+ *  Called by the redraw timer.  needs_update() clears the dirty flag, so
+ *  it is noted first, for update_layers().
  */
 
 void
 qperfroll::conditional_update ()
 {
+    if (is_dirty())
+        m_triggers_stale = true;
+
     if (needs_update())
     {
         if (perf().follow_progress())
@@ -146,13 +155,157 @@ qperfroll::follow_progress ()
 }
 
 /**
- *
+ *  Draws the song editor.  As in qseqroll, the grid and the triggers are
+ *  drawn into pixmaps covering the visible part of the roll, and are
+ *  redrawn only when what they show has changed (see update_layers()).
+ *  During playback, only the cached pixmap is copied, and the selection
+ *  box, the border, and the progress bar are drawn over it.
  */
 
 void
 qperfroll::paintEvent (QPaintEvent *)
 {
+    QRect r = visible_rect();
+    update_layers(r);
+
     QPainter painter(this);
+    painter.drawPixmap(r.topLeft(), m_triggers_pixmap);
+    draw_overlay(painter);
+}
+
+/**
+ *  Gets the part of the roll that is visible in the scroll area.
+ *
+ * \return
+ *      Returns the visible rectangle, in the coordinates of the roll.
+ */
+
+QRect
+qperfroll::visible_rect () const
+{
+    QRect result = rect();
+    QWidget * viewport = parentWidget();
+    if (not_nullptr(viewport))
+    {
+        QRect vr(mapFromParent(QPoint(0, 0)), viewport->size());
+        result = result.intersected(vr);
+    }
+    return result;
+}
+
+/**
+ *  Gathers every value that the drawing of the grid depends on.
+ *
+ * \param r
+ *      The visible rectangle.
+ */
+
+std::vector<long>
+qperfroll::grid_key (const QRect & r) const
+{
+    std::vector<long> result;
+    result.reserve(10);
+    result.push_back(r.x());
+    result.push_back(r.y());
+    result.push_back(r.width());
+    result.push_back(r.height());
+    result.push_back(width());
+    result.push_back(height());
+    result.push_back(scale_zoom());
+    result.push_back(long(scroll_offset_ticks()));
+    result.push_back(long(measure_length()));
+    result.push_back(long(beat_length()));
+    return result;
+}
+
+/**
+ *  Gathers, for each visible row, the values that the drawing of its
+ *  triggers depends on.  The generations change with every edit of the
+ *  events or the triggers of the pattern; the selection of triggers does
+ *  not change them, but is done in this roll, which marks itself dirty.
+ *
+ * \param r
+ *      The visible rectangle.
+ */
+
+std::vector<long>
+qperfroll::triggers_key (const QRect & r)
+{
+    std::vector<long> result;
+    int y_s = r.top() / c_names_y;
+    int y_f = r.bottom() / c_names_y;
+    for (int seqid = y_s; seqid <= y_f && seqid < c_max_sequence; ++seqid)
+    {
+        if (perf().is_active(seqid))
+        {
+            sequence * seq = perf().get_sequence(seqid);
+            result.push_back(seqid);
+            result.push_back(long(seq->generation()));
+            result.push_back(long(seq->trigger_generation()));
+            result.push_back(long(seq->get_length()));
+            result.push_back(perf().get_sequence_color(seqid));
+            result.push_back(seq->get_transposable() ? 1 : 0);
+        }
+    }
+    return result;
+}
+
+/**
+ *  Redraws the cached layers that are stale.  The grid is redrawn when the
+ *  zoom, scroll position, size, or time signature changes.  The triggers
+ *  are redrawn over a copy of the grid when the grid was redrawn, when a
+ *  visible pattern has changed, or when this roll was marked dirty.
+ *
+ * \param r
+ *      The visible rectangle.
+ */
+
+void
+qperfroll::update_layers (const QRect & r)
+{
+    if (is_dirty())
+        m_triggers_stale = true;
+
+    int dpr = devicePixelRatio();
+    std::vector<long> gkey = grid_key(r);
+    if (gkey != m_grid_key || m_grid_pixmap.isNull())
+    {
+        m_grid_pixmap = QPixmap(r.size() * dpr);
+        m_grid_pixmap.setDevicePixelRatio(dpr);
+        m_grid_pixmap.fill(palette().color(backgroundRole()));
+
+        QPainter painter(&m_grid_pixmap);
+        painter.translate(-r.topLeft());
+        draw_grid(painter);
+        m_grid_key = gkey;
+        m_triggers_stale = true;
+    }
+
+    std::vector<long> tkey = triggers_key(r);
+    if (tkey != m_triggers_key)
+        m_triggers_stale = true;
+
+    if (m_triggers_stale)
+    {
+        m_triggers_pixmap = m_grid_pixmap.copy();
+        m_triggers_pixmap.setDevicePixelRatio(dpr);
+
+        QPainter painter(&m_triggers_pixmap);
+        painter.translate(-r.topLeft());
+        draw_triggers(painter, r);
+        m_triggers_key = tkey;
+        m_triggers_stale = false;
+    }
+}
+
+/**
+ *  Draws the horizontal lines between the patterns, and the vertical lines
+ *  for the measures and the beats.
+ */
+
+void
+qperfroll::draw_grid (QPainter & painter)
+{
     QBrush brush(Qt::NoBrush);
     QPen pen(Qt::black);
     pen.setStyle(Qt::SolidLine);
@@ -208,9 +361,24 @@ qperfroll::paintEvent (QPaintEvent *)
         }
 #endif
     }
+}
+
+/**
+ *  Draws the triggers of the visible rows, with the notes of each pattern
+ *  in miniature.
+ *
+ * \param r
+ *      The visible rectangle.
+ */
 
-    int y_s = 0;                                        /* for background   */
-    int y_f = height() / c_names_y;
+void
+qperfroll::draw_triggers (QPainter & painter, const QRect & r)
+{
+    QBrush brush(Qt::NoBrush);
+    QPen pen(Qt::black);
+    painter.setFont(m_font);
+    int y_s = r.top() / c_names_y;                      /* visible rows     */
+    int y_f = r.bottom() / c_names_y;
     bool selected;
     midipulse tick_on;                                  /* for seq block    */
     midipulse tick_off;
@@ -378,9 +546,17 @@ qperfroll::paintEvent (QPaintEvent *)
             }
         }
     }
+}
 
-    /* draw selections */
+/**
+ *  Draws the selection box, the border, and the progress bar.
+ */
 
+void
+qperfroll::draw_overlay (QPainter & painter)
+{
+    QBrush brush(Qt::NoBrush);
+    QPen pen(Qt::black);
     int x, y, w, h;
     if (mBoxSelect)
     {
@@ -26,11 +26,14 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-08-13
- * \updates       2018-09-13
+ * \updates       2023-03-18
  * \license       GNU GPLv2 or above
  *
  */
 
+#include <QHeaderView>
+#include <QScrollBar>
+
 #include "perform.hpp"                  /* seq64::perform                   */
 #include "qseqeventframe.hpp"           /* seq64::qseqeventframe            */
 #include "qseventslots.hpp"             /* seq64::qseventslots              */
@@ -56,6 +59,13 @@
 
 #define SEQ64_EVENT_ROW_HEIGHT          18
 
+/**
+ *  The number of rows filled when the table is not yet shown, and the rows
+ *  in view cannot be known.  Enough for a tall window.
+ */
+
+#define SEQ64_EVENT_TABLE_PAGE          80
+
 /*
  *  Do not document the name space.
  */
@@ -181,6 +191,24 @@ qseqeventframe::qseqeventframe (perform & p, int seqid, QWidget * parent)
     );
 #endif
 
+    /*
+     * The rows are filled as they come into view, when the table is scrolled
+     * or resized (which changes the range of the scroll-bar), or rows are
+     * added or removed.
+     */
+
+    connect
+    (
+        ui->eventTableWidget->verticalScrollBar(), SIGNAL(valueChanged(int)),
+        this, SLOT(handle_table_scroll())
+    );
+    connect
+    (
+        ui->eventTableWidget->verticalScrollBar(),
+        SIGNAL(rangeChanged(int, int)),
+        this, SLOT(handle_table_scroll())
+    );
+
     /*
      * Delete button.  Will set to enabled/disabled once fully initialized.
      */
@@ -246,15 +274,15 @@ qseqeventframe::~qseqeventframe()
 }
 
 /**
- *
+ *  Sets the height of all rows, present and future, via the default section
+ *  size of the vertical header.  Setting each row's height is linear in the
+ *  number of events, and done again for each added row.
  */
 
 void
 qseqeventframe::set_row_heights (int height)
 {
-    const int rows = ui->eventTableWidget->rowCount();
-    for (int r = 0; r < rows; ++r)
-        ui->eventTableWidget->setRowHeight(r, height);  /* set_row_height() */
+    ui->eventTableWidget->verticalHeader()->setDefaultSectionSize(height);
 }
 
 /**
@@ -285,7 +313,9 @@ qseqeventframe::set_column_widths (int total_width)
 }
 
 /**
- *
+ *  Sizes the table to the event count, and fills the rows that are in view.
+ *  The other rows stay empty until scrolled into view; see
+ *  load_visible_rows().
  */
 
 bool
@@ -299,14 +329,8 @@ qseqeventframe::initialize_table ()
         {
             ui->eventTableWidget->clearContents();
             ui->eventTableWidget->setRowCount(rows);
-            for (int r = 0; r < rows; ++r)
-            {
-                ui->eventTableWidget->setRowHeight(r, SEQ64_EVENT_ROW_HEIGHT);
-            }
-            if (m_eventslots->load_table())
-            {
-                m_eventslots->select_event(0);      /* first row */
-            }
+            load_visible_rows();
+            m_eventslots->select_event(0);          /* first row            */
             ui->button_del->setEnabled(true);
             ui->button_modify->setEnabled(true);
         }
@@ -319,6 +343,42 @@ qseqeventframe::initialize_table ()
     return result;
 }
 
+/**
+ *  Fills the rows of the table that are in view and have not been filled
+ *  yet.  A row is filled once its items exist; see cell().  Before the
+ *  table is shown, its viewport may have no height, and a page of
+ *  SEQ64_EVENT_TABLE_PAGE rows is filled instead.
+ */
+
+void
+qseqeventframe::load_visible_rows ()
+{
+    QTableWidget * table = ui->eventTableWidget;
+    int rows = table->rowCount();
+    if (not_nullptr(m_eventslots) && rows > 0)
+    {
+        int first = table->rowAt(0);
+        int last = table->rowAt(table->viewport()->height() - 1);
+        if (first < 0)
+            first = 0;
+
+        if (last < 0)
+        {
+            last = first + SEQ64_EVENT_TABLE_PAGE;
+            if (last >= rows)
+                last = rows - 1;
+        }
+        while (first <= last && not_nullptr(table->item(first, 0)))
+            ++first;                                /* already filled       */
+
+        while (last >= first && not_nullptr(table->item(last, 0)))
+            --last;
+
+        if (first <= last)
+            (void) m_eventslots->load_table(first, last + 1);
+    }
+}
+
 /**
  *  Sets ui->label_seq_name to the title.
  *
@@ -568,6 +628,16 @@ qseqeventframe::handle_table_click_ex
     set_current_row(row);
 }
 
+/**
+ *  Fills the rows that the scroll or resize brought into view.
+ */
+
+void
+qseqeventframe::handle_table_scroll ()
+{
+    load_visible_rows();
+}
+
 /**
  *
  */
@@ -657,7 +727,6 @@ qseqeventframe::handle_insert ()
             std::string chan = m_eventslots->current_event().channel_string();
             int cr = m_eventslots->current_row();
             ui->eventTableWidget->insertRow(cr);
-            set_row_height(cr, SEQ64_EVENT_ROW_HEIGHT);
             set_event_line(cr, ts, name, chan, data0, data1);
             ui->button_del->setEnabled(true);
             ui->button_modify->setEnabled(true);
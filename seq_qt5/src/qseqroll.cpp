@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2019-05-10
+ * \updates       2023-03-15
  * \license       GNU GPLv2 or above
  *
  *  Please see the additional notes for the Gtkmm-2.4 version of this panel,
@@ -96,7 +96,13 @@ qseqroll::qseqroll
     note_y                  (0),
     note_height             (0),
     m_key_y                 (usr().key_height()),
-    m_keyarea_y             (m_key_y * c_num_keys + 1)
+    m_keyarea_y             (m_key_y * c_num_keys + 1),
+    m_grid_pixmap           (),
+    m_notes_pixmap          (),
+    m_grid_key              (),
+    m_notes_generation      (0),
+    m_background_generation (0),
+    m_notes_stale           (true)
 {
     set_snap(seq.get_snap_tick());
     setFocusPolicy(Qt::StrongFocus);
@@ -174,12 +180,17 @@ qseqroll::set_background_sequence (bool state, int seq)
 
 /**
  *  In an effort to reduce CPU usage when simply idling, this function calls
- *  update() only if necessary.  See qseqbase::needs_update().
+ *  update() only if necessary.  See qseqbase::needs_update().  Since that
+ *  function clears the dirty flag, the flag is noted first, for
+ *  update_layers().
  */
 
 void
 qseqroll::conditional_update ()
 {
+    if (is_dirty())
+        m_notes_stale = true;
+
     if (needs_update())
     {
         if (progress_follow())
@@ -190,13 +201,145 @@ qseqroll::conditional_update ()
 }
 
 /**
- *  Draws the piano roll.
+ *  Draws the piano roll.  The roll is drawn in layers.  The grid (the key
+ *  lines, the scale shading, and the time lines) and the notes are drawn
+ *  into pixmaps covering the visible part of the roll, which are redrawn
+ *  only when what they show has changed (see update_layers()).  During
+ *  playback, which repaints the roll at the redraw rate, only the cached
+ *  notes pixmap is copied, and the progress bar and the selection box are
+ *  drawn over it.
  */
 
 void
 qseqroll::paintEvent (QPaintEvent *)
 {
+    QRect r = visible_rect();
+    update_layers(r);
+
     QPainter painter(this);
+    painter.drawPixmap(r.topLeft(), m_notes_pixmap);
+    draw_progress(painter);
+    draw_selection(painter);
+}
+
+/**
+ *  Gets the part of the roll that is visible in the scroll area.  The
+ *  roll itself can be many thousands of pixels wide, far too much to cache.
+ *
+ * \return
+ *      Returns the visible rectangle, in the coordinates of the roll.
+ */
+
+QRect
+qseqroll::visible_rect () const
+{
+    QRect result = rect();
+    QWidget * viewport = parentWidget();
+    if (not_nullptr(viewport))
+    {
+        QRect vr(mapFromParent(QPoint(0, 0)), viewport->size());
+        result = result.intersected(vr);
+    }
+    return result;
+}
+
+/**
+ *  Gathers every value that the drawing of the grid depends on.  If any of
+ *  them differs from the values the cached grid was drawn with, the grid
+ *  must be redrawn.
+ *
+ * \param r
+ *      The visible rectangle.
+ */
+
+std::vector<int>
+qseqroll::grid_key (const QRect & r) const
+{
+    std::vector<int> result;
+    result.reserve(16);
+    result.push_back(r.x());
+    result.push_back(r.y());
+    result.push_back(r.width());
+    result.push_back(r.height());
+    result.push_back(width());
+    result.push_back(zoom());
+    result.push_back(snap());
+    result.push_back(m_scale);
+    result.push_back(m_key);
+    result.push_back(int(m_edit_mode));
+    result.push_back(m_key_y);
+    result.push_back(scroll_offset_ticks());
+    result.push_back(scroll_offset_key());
+    result.push_back(seq().get_beats_per_bar());
+    result.push_back(seq().get_beat_width());
+    result.push_back(perf().get_ppqn());
+    return result;
+}
+
+/**
+ *  Redraws the cached layers that are stale.  The grid is redrawn when the
+ *  zoom, scroll position, size, scale, key, or time signature changes.  The
+ *  notes are redrawn over a copy of the grid when the grid was redrawn,
+ *  when the events of the sequence (or of the background sequence) have
+ *  changed, or when this roll was marked dirty, which it is by every edit
+ *  and change of selection made in it.
+ *
+ * \param r
+ *      The visible rectangle.
+ */
+
+void
+qseqroll::update_layers (const QRect & r)
+{
+    if (is_dirty())
+        m_notes_stale = true;
+
+    int dpr = devicePixelRatio();
+    std::vector<int> key = grid_key(r);
+    if (key != m_grid_key || m_grid_pixmap.isNull())
+    {
+        m_grid_pixmap = QPixmap(r.size() * dpr);
+        m_grid_pixmap.setDevicePixelRatio(dpr);
+        m_grid_pixmap.fill(Qt::white);
+
+        QPainter painter(&m_grid_pixmap);
+        painter.translate(-r.topLeft());
+        draw_grid(painter);
+        m_grid_key = key;
+        m_notes_stale = true;
+    }
+
+    sequence * bg = nullptr;
+    if (m_drawing_background_seq && perf().is_active(m_background_sequence))
+        bg = perf().get_sequence(m_background_sequence);
+
+    unsigned gen = seq().generation();
+    unsigned bggen = not_nullptr(bg) ? bg->generation() + 1 : 0 ;
+    if (gen != m_notes_generation || bggen != m_background_generation)
+        m_notes_stale = true;
+
+    if (m_notes_stale)
+    {
+        m_notes_pixmap = m_grid_pixmap.copy();
+        m_notes_pixmap.setDevicePixelRatio(dpr);
+
+        QPainter painter(&m_notes_pixmap);
+        painter.translate(-r.topLeft());
+        draw_notes(painter);
+        m_notes_generation = gen;
+        m_background_generation = bggen;
+        m_notes_stale = false;
+    }
+}
+
+/**
+ *  Draws the border, the horizontal key lines with the scale shading, and
+ *  the vertical time lines.
+ */
+
+void
+qseqroll::draw_grid (QPainter & painter)
+{
     QBrush brush(Qt::white);                // QBrush brush(Qt::NoBrush);
     mFont.setPointSize(6);
 
@@ -330,23 +473,20 @@ qseqroll::paintEvent (QPaintEvent *)
         painter.drawLine(x_offset, 0, x_offset, m_keyarea_y);
     }
     pen.setWidth(1);
+}
 
-    /*
-     * draw_progress_on_window():
-     *
-     *  Draw a progress line on the window.  This is done by first blanking out
-     *  the line with the background, which contains white space and grey lines,
-     *  using the the draw_drawable function.  Remember that we wrap the
-     *  draw_drawable() function so it's parameters are xsrc, ysrc, xdest, ydest,
-     *  width, and height.
-     *
-     *  Note that the progress-bar position is based on the
-     *  sequence::get_last_tick() value, the current zoom, and the current
-     *  scroll-offset x value.
-     */
+/**
+ *  Draws the progress bar over the cached layers, so that nothing needs to
+ *  be blanked out when it moves.  Note that the progress-bar position is
+ *  based on the sequence::get_last_tick() value, the current zoom, and the
+ *  current scroll-offset x value.
+ */
 
+void
+qseqroll::draw_progress (QPainter & painter)
+{
+    QPen pen(Qt::red);                          // draw the playhead
     int prog_x = old_progress_x();
-    pen.setColor(Qt::red);                      // draw the playhead
     pen.setStyle(Qt::SolidLine);
 
     /*
@@ -360,21 +500,28 @@ qseqroll::paintEvent (QPaintEvent *)
         pen.setWidth(1);
 
     painter.setPen(pen);
-    painter.drawLine(prog_x, 0, prog_x, wh * 8);    // why * 8?
+    painter.drawLine(prog_x, 0, prog_x, height() * 8);    // why * 8?
     old_progress_x(seq().get_last_tick() / zoom() + c_keyboard_padding_x);
+}
 
-    /*
-     * End of draw_progress_on_window()
-     */
+/**
+ *  Draws the notes of the sequence, and those of the background sequence,
+ *  if any.
+ */
 
-    midipulse tick_s;                               // draw notes
+void
+qseqroll::draw_notes (QPainter & painter)
+{
+    QBrush brush(Qt::white);
+    QPen pen(Qt::black);
+    midipulse tick_s;
     midipulse tick_f;
     int note;
     bool selected;
     int velocity;
     draw_type_t dt;
     int start_tick = 0;
-    int end_tick = ww * zoom();
+    int end_tick = width() * zoom();
     sequence * s = nullptr;
     for (int method = 0; method < 2; ++method)
     {
@@ -567,9 +714,19 @@ qseqroll::paintEvent (QPaintEvent *)
             }
         }
     }
+}
 
-    int x, y, w, h;                     /* draw selections              */
-    brush.setStyle(Qt::NoBrush);        /* painter reset                */
+/**
+ *  Draws the selection box, or the outline of the notes being moved,
+ *  pasted, or grown.
+ */
+
+void
+qseqroll::draw_selection (QPainter & painter)
+{
+    QBrush brush(Qt::NoBrush);
+    QPen pen(Qt::black);
+    int x, y, w, h;
     painter.setBrush(brush);
     if (select_action())                /* select/move/paste/grow       */
         pen.setStyle(Qt::SolidLine);
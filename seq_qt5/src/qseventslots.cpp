@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2018-08-13
- * \updates       2019-05-25
+ * \updates       2023-03-18
  * \license       GNU GPLv2 or above
  *
  *  Also note that, currently, the editable_events container does not support
@@ -89,7 +89,9 @@ qseventslots::qseventslots
     m_top_iterator          (),
     m_bottom_iterator       (),
     m_current_iterator      (),
-    m_pager_index           (0)
+    m_pager_index           (0),
+    m_table_row             (0),
+    m_table_iterator        ()
 {
     /*
      * Let the caller determined when this will happen?
@@ -134,15 +136,6 @@ qseventslots::load_events ()
                 if (increment_bottom() == SEQ64_NULL_EVENT_INDEX)
                     break;
             }
-
-            for
-            (
-                editable_events::iterator ei = m_event_container.begin();
-                ei != m_event_container.end(); ++ei
-            )
-            {
-                ei->second.analyze();       /* creates the event strings    */
-            }
         }
         else
             result = false;
@@ -153,32 +146,80 @@ qseventslots::load_events ()
         m_current_iterator = m_bottom_iterator =
             m_top_iterator = m_event_container.end();
     }
+    reset_table_anchor();
     return result;
 }
 
 /**
+ *  Fills a range of rows of the table.  The strings of an editable event are
+ *  built when first asked for (see editable_event::check_analysis()), so
+ *  only the events that are shown are ever formatted, and opening the editor
+ *  on a large pattern costs one walk of the container, not a string
+ *  conversion and a table row per event.
  *
+ * \param first
+ *      The first row to fill.
+ *
+ * \param last
+ *      One past the last row to fill.  Clamped to the event count.
+ *
+ * \return
+ *      Returns true if there are events in the container.
  */
 
 bool
-qseventslots::load_table ()
+qseventslots::load_table (int first, int last)
 {
     bool result = m_event_container.count() > 0;
-    if (m_event_count > 0)
+    if (result && m_event_count > 0)
     {
-        int row = 0;
-        for
-        (
-            editable_events::const_iterator ei = m_event_container.begin();
-            ei != m_event_container.end(); ++ei, ++row
-        )
+        if (last > m_event_count)
+            last = m_event_count;
+
+        if (first < 0)
+            first = 0;
+
+        if (first < last)
         {
-            set_table_event(ei, row);
+            editable_events::const_iterator ei = m_table_iterator;
+            int row = m_table_row;
+            if (first < row / 2)                /* closer to the beginning  */
+            {
+                ei = m_event_container.begin();
+                row = 0;
+            }
+            while (row < first && ei != m_event_container.end())
+            {
+                ++ei;
+                ++row;
+            }
+            while (row > first)
+            {
+                --ei;
+                --row;
+            }
+            m_table_row = row;
+            m_table_iterator = ei;
+            for ( ; row < last && ei != m_event_container.end(); ++ei, ++row)
+                set_table_event(ei, row);
         }
     }
     return result;
 }
 
+/**
+ *  Restarts the walks of load_table() from the first event.  Needed after
+ *  any insertion or deletion, which moves rows and can free the anchor
+ *  event.
+ */
+
+void
+qseventslots::reset_table_anchor ()
+{
+    m_table_row = 0;
+    m_table_iterator = m_event_container.begin();
+}
+
 /**
  *  Set the current event, which is the event that is highlighted.  Note in
  *  the snprintf() calls that the first digit is part of the data byte, so
@@ -345,6 +386,7 @@ qseventslots::insert_event (const editable_event & edev)
     bool result = m_event_container.add(edev);
     if (result)
     {
+        reset_table_anchor();
         m_event_count = m_event_container.count();
         if (m_event_count == 1)
         {
@@ -571,6 +613,7 @@ qseventslots::delete_current_event ()
          */
 
         m_event_container.remove(oldcurrent);       /* wrapper for erase()  */
+        reset_table_anchor();
 
         int newcount = m_event_container.count();
         if (newcount == 0)
@@ -24,14 +24,16 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2020-02-21
+ * \updates       2023-03-16
  * \license       GNU GPLv2 or above
  *
  *  This class is the Qt counterpart to the mainwid class.
  */
 
+#include <algorithm>                    /* std::max()                       */
 #include <sstream>                      /* std::ostringstream class         */
 
+#include <QPaintEvent>
 #include <QPainter>
 #include <QMenu>
 #include <QTimer>
@@ -72,6 +74,13 @@ static const int sc_preview_h_factor = 8;   // 5;
 static const int sc_base_x_offset = 12;     // 7;
 static const int sc_base_y_offset = 24;     // 15;
 
+/**
+ *  The point size of the slot font, which also sets the size of the preview
+ *  box.
+ */
+
+static const int sc_slot_font_size = 6;
+
 /*
  * Do not document a namespace, it breaks Doxygen.
  */
@@ -130,6 +139,8 @@ qsliveframe::qsliveframe (perform & p, qsmainwnd * window, QWidget * parent)
     m_adding_new        (false),
     m_last_tick_x       (),             // array
     m_last_playing      (),             // array
+    m_last_state        (),             // array
+    m_thumbnails        (),             // array
     m_can_paste         (false),
     m_has_focus         (false),
     m_is_external       (is_nullptr(parent))
@@ -192,9 +203,13 @@ qsliveframe::set_playlist_name (const std::string & plname)
 }
 
 /**
- *  In an effort to reduce CPU usage when simply idling, this function calls
- *  update() only if necessary.  See qseqbase::needs_update(). All
- *  sequences are potentially checked.
+ *  In an effort to reduce CPU usage when simply idling, and during playback,
+ *  this function asks for the repainting of only the slots that need it:
+ *  those whose sequence is dirty (see perform::is_dirty_main()), those whose
+ *  state (playing, queued, one-shot, color) has changed, and those whose
+ *  progress marker has moved since the slot was last drawn.  Until the
+ *  slots have been drawn once, their size is not known, and the whole frame
+ *  is updated.
  *
  *  Also handles any pending editor call-ups.  Before anything, get the pending
  *  sequence number. It gets cleared if a seq-edit check succeeds.
@@ -204,18 +219,256 @@ void
 qsliveframe::conditional_update ()
 {
     sequence_key_check();
-    if (perf().needs_update())
+    if (m_slot_w > 0 && m_slot_h > 0)
+    {
+        int send = m_screenset_offset + m_screenset_slots;
+        for (int seq = m_screenset_offset; seq < send; ++seq)
+        {
+            bool dirty = perf().is_dirty_main(seq);
+            if
+            (
+                dirty || slot_state(seq) != m_last_state[seq] ||
+                progress_x(seq) != m_last_tick_x[seq]
+            )
+            {
+                update(slot_rect(seq));
+            }
+        }
+    }
+    else if (perf().needs_update())
         update();
 }
 
 /**
- *  This override simply calls drawAllSequences().
+ *  Draws the slots that intersect the area to be repainted.
+ *
+ * \param event
+ *      Provides the area to be repainted.
  */
 
 void
-qsliveframe::paintEvent (QPaintEvent *)
+qsliveframe::paintEvent (QPaintEvent * event)
 {
-    drawAllSequences();
+    const QRect & area = event->rect();
+    if (area.contains(rect()))
+    {
+        drawAllSequences();
+    }
+    else
+    {
+        int send = m_screenset_offset + m_screenset_slots;
+        for (int seq = m_screenset_offset; seq < send; ++seq)
+        {
+            if (area.intersects(slot_rect(seq)))
+                drawSequence(seq);
+        }
+    }
+}
+
+/**
+ *  Gets the area drawn for a pattern slot, including the width of the
+ *  thickest border pen.
+ *
+ * \param seq
+ *      The number of the pattern slot.
+ */
+
+QRect
+qsliveframe::slot_rect (int seq)
+{
+    int base_x, base_y;
+    calculate_base_sizes(seq, base_x, base_y);
+    return QRect(base_x - 2, base_y - 2, m_slot_w + 5, m_slot_h + 5);
+}
+
+/**
+ *  Gets the width of the area in which the notes of a pattern are drawn.
+ *  It matches what drawSequence() computes.
+ */
+
+int
+qsliveframe::preview_width () const
+{
+    return m_slot_w - sc_slot_font_size * sc_preview_w_factor - 6;
+}
+
+/**
+ *  Packs what decides the colors of a pattern slot into one value, so that
+ *  conditional_update() can tell when the slot has to be redrawn.
+ *
+ * \param seq
+ *      The number of the pattern slot.
+ *
+ * \return
+ *      Returns 0 for an empty slot.
+ */
+
+int
+qsliveframe::slot_state (int seq)
+{
+    int result = 0;
+    sequence * s = perf().get_sequence(seq);
+    if (not_nullptr(s))
+    {
+        result = 0x01;
+        if (s->get_playing())
+            result |= 0x02;
+
+        if (s->get_queued())
+            result |= 0x04;
+
+        if (s->off_from_snap())
+            result |= 0x08;
+
+        if (s->one_shot())
+            result |= 0x10;
+
+        result |= (s->color() + 1) << 8;
+    }
+    return result;
+}
+
+/**
+ *  Gets the position of the progress marker in the preview of a pattern.
+ *
+ * \param seq
+ *      The number of the pattern slot.
+ *
+ * \return
+ *      Returns the x offset of the marker in the preview, or -1 if there is
+ *      no marker drawn.
+ */
+
+midipulse
+qsliveframe::progress_x (int seq)
+{
+    midipulse result = -1;
+    sequence * s = perf().get_sequence(seq);
+    if (not_nullptr(s) && m_thumbnails[seq].t_has_notes)
+    {
+        midipulse length = s->get_length();
+        if (length > 0)
+        {
+            midipulse a_tick = perf().get_tick();
+            a_tick += (length - s->get_trigger_offset());
+            a_tick %= length;
+            result = a_tick * preview_width() / length;
+        }
+    }
+    return result;
+}
+
+/**
+ *  Draws the notes of a pattern into the thumbnail of its slot, if the
+ *  pattern has changed since the thumbnail was drawn, or if it would be
+ *  drawn in a different size or color.  Getting the range of the notes, and
+ *  walking them, is the expensive part of drawing a slot, and now happens
+ *  only when the pattern is edited.
+ *
+ * \param seq
+ *      The number of the pattern.
+ *
+ * \param w
+ *      The width of the area for the notes.
+ *
+ * \param h
+ *      The height of the area for the notes.
+ *
+ * \param pencolor
+ *      The color of the notes.
+ *
+ * \return
+ *      Returns the thumbnail, whose t_has_notes member is false if the
+ *      pattern has no notes to draw.
+ */
+
+const qsliveframe::thumbnail &
+qsliveframe::update_thumbnail (int seq, int w, int h, const Color & pencolor)
+{
+    thumbnail & tn = m_thumbnails[seq];
+    sequence * s = perf().get_sequence(seq);
+    int length = s->get_length();
+    Color eventcolor = pencolor;
+    if (! s->get_transposable())
+        eventcolor = red();
+
+    bool current = ! tn.t_pixmap.isNull() &&
+        tn.t_generation == s->generation() && tn.t_length == length &&
+        tn.t_width == w && tn.t_height == h &&
+        tn.t_slot_height == m_slot_h && tn.t_color == eventcolor.rgba();
+
+    if (current)
+        return tn;
+
+    int lowest;
+    int highest;
+    tn.t_generation = s->generation();
+    tn.t_length = length;
+    tn.t_width = w;
+    tn.t_height = h;
+    tn.t_slot_height = m_slot_h;
+    tn.t_color = eventcolor.rgba();
+    tn.t_has_notes = s->get_minmax_note_events(lowest, highest) && length > 0;
+    tn.t_pixmap = QPixmap(w + 2, std::max(h, m_slot_h) + 2);
+    tn.t_pixmap.fill(Qt::transparent);
+    if (tn.t_has_notes)
+    {
+        QPainter painter(&tn.t_pixmap);
+        QPen pen(eventcolor);
+        int height = highest - lowest + 2;
+        midipulse tick_s, tick_f;
+        int note;
+        bool selected;
+        int velocity;
+        draw_type_t dt;
+        Color drawcolor = eventcolor;
+        s->reset_draw_marker();                 /* reset iterator       */
+        while
+        (
+            (
+                dt = s->get_next_note_event
+                (
+                    tick_s, tick_f, note, selected, velocity
+                )
+            ) != DRAW_FIN
+        )
+        {
+            int tick_s_x = (tick_s * w) / length;
+            int tick_f_x = (tick_f * w) / length;
+            int note_y;
+            if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
+                tick_f_x = tick_s_x + 1;
+
+            if (tick_f_x <= tick_s_x)
+                tick_f_x = tick_s_x + 1;
+
+            if (dt == DRAW_TEMPO)
+            {
+                /*
+                 * Do not scale by the note range here.
+                 */
+
+                pen.setWidth(2);
+                drawcolor = tempo_paint();
+                note_y = m_slot_h -                 // BAD? m_slot_w -
+                     m_slot_h * (note + 1) / SEQ64_MAX_DATA_VALUE;
+            }
+            else
+            {
+                pen.setWidth(1);                    /* 2 too thick  */
+                note_y = h - (h * (note+1 - lowest)) / height;
+            }
+            pen.setColor(drawcolor);                /* note line    */
+            painter.setPen(pen);
+            painter.drawLine(tick_s_x, note_y, tick_f_x, note_y);
+            if (dt == DRAW_TEMPO)
+            {
+                pen.setWidth(1);                    /* 2 too thick  */
+                drawcolor = eventcolor;
+            }
+        }
+    }
+    return tn;
 }
 
 /**
@@ -276,7 +529,7 @@ qsliveframe::drawSequence (int seq)
     QPainter painter(this);
     QPen pen(Qt::black);
     QBrush brush(Qt::black);
-    m_font.setPointSize(6);
+    m_font.setPointSize(sc_slot_font_size);
     m_font.setBold(true);
     m_font.setLetterSpacing(QFont::AbsoluteSpacing, 1);
     painter.setPen(pen);
@@ -556,86 +809,18 @@ qsliveframe::drawSequence (int seq)
             rectangle_x-2, rectangle_y-1, preview_w, preview_h
         );
 
-        int lowest;
-        int highest;
-        bool have_notes = s->get_minmax_note_events(lowest, highest);
-        if (have_notes)
-        {
-            int height = highest - lowest + 2;
-            int length = s->get_length();
-            midipulse tick_s, tick_f;
-            int note;
-            bool selected;
-            int velocity;
-            draw_type_t dt;
-            Color drawcolor = pencolor;         // fg_color();
-            Color eventcolor = pencolor;        // fg_color();
-            if (! s->get_transposable())
-            {
-                eventcolor = red();
-                drawcolor = red();
-            }
-            preview_h -= 6;                     /* padding for box      */
-            preview_w -= 6;
-            rectangle_x += 2;
-            rectangle_y += 2;
-            s->reset_draw_marker();             /* reset iterator       */
-            while
-            (
-                (
-                    dt = s->get_next_note_event
-                    (
-                        tick_s, tick_f, note, selected, velocity
-                    )
-                ) != DRAW_FIN
-            )
-            {
-                int tick_s_x = (tick_s * preview_w) / length;
-                int tick_f_x = (tick_f * preview_w) / length;
-                int note_y;
-                if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
-                    tick_f_x = tick_s_x + 1;
-
-                if (tick_f_x <= tick_s_x)
-                    tick_f_x = tick_s_x + 1;
-
-                if (dt == DRAW_TEMPO)
-                {
-                    /*
-                     * Do not scale by the note range here.
-                     */
-
-                    pen.setWidth(2);
-                    drawcolor = tempo_paint();
-                    note_y = m_slot_h -                 // BAD? m_slot_w -
-                         m_slot_h * (note + 1) / SEQ64_MAX_DATA_VALUE;
-                }
-                else
-                {
-                    pen.setWidth(1);                    /* 2 too thick  */
-                    note_y = preview_h -
-                         (preview_h * (note+1 - lowest)) / height;
-                }
-
-                int sx = rectangle_x + tick_s_x;        /* start x      */
-                int fx = rectangle_x + tick_f_x;        /* finish x     */
-                int sy = rectangle_y + note_y;          /* start y      */
-                int fy = sy;                            /* finish y     */
-                pen.setColor(drawcolor);                /* note line    */
-                painter.setPen(pen);
-                painter.drawLine(sx, sy, fx, fy);
-                if (dt == DRAW_TEMPO)
-                {
-                    pen.setWidth(1);                    /* 2 too thick  */
-                    drawcolor = eventcolor;
-                }
-            }
+        preview_h -= 6;                         /* padding for box      */
+        preview_w -= 6;
+        rectangle_x += 2;
+        rectangle_y += 2;
 
-            int a_tick = perf().get_tick();             /* for playhead */
-            a_tick += (length - s->get_trigger_offset());
-            a_tick %= length;
+        const thumbnail & tn =
+            update_thumbnail(seq, preview_w, preview_h, pencolor);
 
-            midipulse tick_x = a_tick * preview_w / length;
+        midipulse tick_x = progress_x(seq);
+        if (tn.t_has_notes)
+        {
+            painter.drawPixmap(rectangle_x, rectangle_y, tn.t_pixmap);
             if (s->get_playing())
                 pen.setColor(Qt::red);
             else
@@ -654,6 +839,7 @@ qsliveframe::drawSequence (int seq)
                 rectangle_x + tick_x - 1, rectangle_y + preview_h + 1
             );
         }
+        m_last_tick_x[seq] = tick_x;
     }
     else
     {
@@ -702,6 +888,7 @@ qsliveframe::drawSequence (int seq)
 
     m_alpha *= 0.7 - perf().bpm() / 300.0;
     m_last_metro = metro;
+    m_last_state[seq] = slot_state(seq);
 }
 
 /**
@@ -716,14 +903,12 @@ qsliveframe::drawAllSequences ()
     {
         int seq = i + (m_bank_id * m_screenset_slots);
         drawSequence(seq);
-        m_last_tick_x[seq] = 0;
     }
 #else
     int send = m_screenset_offset + m_screenset_slots;
     for (int s = m_screenset_offset; s < send; ++s)
     {
         drawSequence(s);
-        m_last_tick_x[s] = 0;
     }
 #endif
 }
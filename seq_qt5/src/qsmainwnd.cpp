@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2020-07-05
+ * \updates       2023-03-08
  * \license       GNU GPLv2 or above
  *
  *  The main window is known as the "Patterns window" or "Patterns
@@ -54,6 +54,7 @@
 #include "qsmacros.hpp"                 /* QS_TEXT_CHAR() macro             */
 #include "qsabout.hpp"
 #include "qsbuildinfo.hpp"
+#include "qsperfstats.hpp"
 #include "qseditoptions.hpp"
 #include "qseqeditex.hpp"
 #include "qseqeditframe.hpp"            /* Kepler34 version                 */
@@ -166,6 +167,7 @@ qsmainwnd::qsmainwnd
     m_dialog_prefs          (nullptr),
     mDialogAbout            (nullptr),
     mDialogBuildInfo        (nullptr),
+    mDialogPerfStats        (nullptr),
     m_is_title_dirty        (false),
     m_ppqn                  (ppqn),     /* can specify 0 for file ppqn  */
     m_tick_time_as_bbt      (true),
@@ -243,6 +245,7 @@ qsmainwnd::qsmainwnd
     m_beat_ind = new qsmaintime(perf(), this, 4, 4);
     mDialogAbout = new qsabout(this);
     mDialogBuildInfo = new qsbuildinfo(this);
+    mDialogPerfStats = new qsperfstats(this);
     make_perf_frame_in_tab();           /* create m_song_frame64 pointer    */
     m_live_frame = new qsliveframe(perf(), this, ui->LiveTab);
     m_playlist_frame = new qplaylistframe(perf(), this, ui->PlaylistTab);
@@ -301,6 +304,11 @@ qsmainwnd::qsmainwnd
         ui->actionBuildInfo, SIGNAL(triggered(bool)),
         this, SLOT(showqsbuildinfo())
     );
+    connect
+    (
+        ui->actionStatistics, SIGNAL(triggered(bool)),
+        this, SLOT(showqsperfstats())
+    );
 
     /*
      * Edit Menu.  First connect the preferences dialog to the main window's
@@ -1364,6 +1372,18 @@ qsmainwnd::showqsbuildinfo ()
         mDialogBuildInfo->show();
 }
 
+/**
+ *  Shows the diagnostics panel.  It is not modal, so that it can be watched
+ *  while playing.
+ */
+
+void
+qsmainwnd::showqsperfstats ()
+{
+    if (not_nullptr(mDialogPerfStats))
+        mDialogPerfStats->show();
+}
+
 /**
  *  Loads the older Kepler34 pattern editor (qseqeditframe) for the selected
  *  sequence into the "Edit" tab.
@@ -0,0 +1,142 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          qsperfstats.cpp
+ *
+ *  The diagnostics panel shows the latency and jitter statistics while the
+ *  application runs.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-08
+ * \updates       2023-03-08
+ * \license       GNU GPLv2 or above
+ *
+ *  The report is the same text that "seq64cli -o stats=filename" writes.
+ *  It is refreshed twice a second, but only while the panel is visible.
+ */
+
+#include <QTimer>
+
+#include "perf_stats.hpp"               /* seq64::statistics()              */
+#include "qsperfstats.hpp"
+
+/*
+ *  Qt's uic application allows a different output file-name, but not sure
+ *  if qmake can change the file-name.
+ */
+
+#ifdef SEQ64_QMAKE_RULES
+#include "forms/ui_qsperfstats.h"
+#else
+#include "forms/qsperfstats.ui.h"
+#endif
+
+namespace seq64
+{
+
+/**
+ *  The refresh interval of the report, in milliseconds.
+ */
+
+static const int c_stats_refresh_ms = 500;
+
+/**
+ *  Creates the panel and its refresh timer, which is started only when the
+ *  panel is shown.
+ */
+
+qsperfstats::qsperfstats (QWidget * parent)
+ :
+    QDialog     (parent),
+    ui          (new Ui::qsperfstats),
+    m_timer     (nullptr)
+{
+    ui->setupUi(this);
+    connect
+    (
+        ui->resetButton, SIGNAL(clicked(bool)), this, SLOT(reset_stats())
+    );
+    m_timer = new QTimer(this);
+    m_timer->setInterval(c_stats_refresh_ms);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(update_stats()));
+}
+
+/**
+ *  The timer is deleted by Qt, as a child of this dialog.
+ */
+
+qsperfstats::~qsperfstats ()
+{
+    delete ui;
+}
+
+/**
+ *  Shows the current report at once, and starts the refresh.
+ */
+
+void
+qsperfstats::showEvent (QShowEvent *)
+{
+    update_stats();
+    m_timer->start();
+}
+
+/**
+ *  Stops the refresh, so that a closed panel costs nothing.
+ */
+
+void
+qsperfstats::hideEvent (QHideEvent *)
+{
+    m_timer->stop();
+}
+
+/**
+ *  Replaces the text with the current report.
+ */
+
+void
+qsperfstats::update_stats ()
+{
+    ui->statsTextEdit->setPlainText
+    (
+        QString::fromStdString(statistics().report())
+    );
+}
+
+/**
+ *  Clears the statistics, to start a new measurement.
+ */
+
+void
+qsperfstats::reset_stats ()
+{
+    statistics().reset();
+    update_stats();
+}
+
+}               // namespace seq64
+
+/*
+ * qsperfstats.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -9,7 +9,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2016-12-04
- * \updates       2020-06-13
+ * \updates       2023-03-11
  * \license       See the rtexmidi.lic file.  Too big for a header file.
  *
  *    We need to have a way to get all of the ALSA information of
@@ -106,6 +106,7 @@ private:
     void get_poll_descriptors ();
     void remove_poll_descriptors ();
     bool check_port_type (snd_seq_port_info_t * pinfo) const;
+    long input_delay (const snd_seq_event_t * ev);
 
 };          // class midi_alsa_info
 
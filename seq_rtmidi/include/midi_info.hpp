@@ -9,7 +9,7 @@
  * \library       sequencer64 application
  * \author        Gary P. Scavone; refactoring by Chris Ahlstrom
  * \date          2016-12-05
- * \updates       2017-03-21
+ * \updates       2023-03-12
  * \license       See the rtexmidi.lic file.  Too big for a header file.
  *
  *      We need to have a way to get all of the API information from each
@@ -50,6 +50,7 @@ namespace seq64
     class event;
     class mastermidibus;
     class midibus;
+    class thru_router;
 
 /**
  *  A class for holding port information.
@@ -188,6 +189,8 @@ public:
             return SEQ64_BAD_QUEUE_ID;
     }
 
+    int get_port_index (int client, int port) const;
+
     /**
      *  Provides the bus name and port name in canonical JACK format:
      *  "busname:portname".  This function is basically the same as
@@ -288,8 +291,22 @@ private:
 
     midibpm m_bpm;
 
+    /**
+     *  If not null, the thru router of the mastermidibus, for the APIs that
+     *  forward MIDI thru in their own input callback.  Not owned.
+     */
+
+    thru_router * m_thru_router;
+
 protected:
 
+    /**
+     *  The input buss of the event most recently read by
+     *  api_get_midi_event(), or -1 if unknown.
+     */
+
+    int m_input_bus;
+
     /**
      *  Error string for the midi_info interface.
      */
@@ -513,6 +530,33 @@ public:
         return m_global_queue;
     }
 
+    /**
+     * \getter m_input_bus
+     */
+
+    int input_bus () const
+    {
+        return m_input_bus;
+    }
+
+    /**
+     * \getter m_thru_router
+     */
+
+    thru_router * router () const
+    {
+        return m_thru_router;
+    }
+
+    /**
+     * \setter m_thru_router
+     */
+
+    void router (thru_router * tr)
+    {
+        m_thru_router = tr;
+    }
+
     /**
      *  A basic error reporting function for midi_info classes.
      */
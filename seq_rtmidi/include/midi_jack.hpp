@@ -9,7 +9,7 @@
  * \library       sequencer64 application
  * \author        Gary P. Scavone; severe refactoring by Chris Ahlstrom
  * \date          2016-11-14
- * \updates       2018-09-14
+ * \updates       2023-03-20
  * \license       See the rtexmidi.lic file.  Too big for a header file.
  *
  *    In this refactoring, we've stripped out most of the original RtMidi
@@ -73,6 +73,14 @@ protected:
 
     midi_jack_data m_jack_data;
 
+    /**
+     *  Indicates that this port is in the port list of m_jack_info, and
+     *  must be removed from it before the port is closed or destroyed.
+     *  Cleared by the midi_jack_info destructor.
+     */
+
+    bool m_registered;
+
 private:
 
     midi_jack ();       // EXPERIMENTAL
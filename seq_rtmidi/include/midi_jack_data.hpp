@@ -9,7 +9,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2017-01-02
- * \updates       2017-09-14
+ * \updates       2023-03-12
  * \license       See the rtexmidi.lic file.  Too big for a header file.
  *
  *  GitHub issue #165: enabled a build and run with no JACK support.
@@ -71,18 +71,19 @@ struct midi_jack_data
     jack_ringbuffer_t * m_jack_buffmessage;
 
     /**
-     *  The last time-stamp obtained.  Use for calculating the delta time, I
-     *  would imagine.
+     *  Holds special data peculiar to the client and its MIDI input
+     *  processing.
      */
 
-    jack_time_t m_jack_lasttime;
+    rtmidi_in_data * m_jack_rtmidiin;
 
     /**
-     *  Holds special data peculiar to the client and its MIDI input
-     *  processing.
+     *  The frame offset of the last MIDI thru event written to this output
+     *  port in the current period.  JACK requires the events of a port
+     *  buffer to be in time order.  Reset by the output process callback.
      */
 
-    rtmidi_in_data * m_jack_rtmidiin;
+    jack_nframes_t m_jack_thru_frame;
 
     /**
      * \ctor midi_jack_data
@@ -93,8 +94,8 @@ struct midi_jack_data
         m_jack_port         (nullptr),
         m_jack_buffsize     (nullptr),
         m_jack_buffmessage  (nullptr),
-        m_jack_lasttime     (0),
-        m_jack_rtmidiin     (nullptr)
+        m_jack_rtmidiin     (nullptr),
+        m_jack_thru_frame   (0)
     {
         // Empty body
     }
@@ -9,20 +9,32 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2017-01-01
- * \updates       2018-09-14
+ * \updates       2023-03-28
  * \license       See the rtexmidi.lic file.  Too big for a header file.
  *
  *    We need to have a way to get all of the JACK information of
  *    the midi_jack module.  This module provides that information.
  *
  *  GitHub issue #165: enabled a build and run with no JACK support.
+ *
+ *  The list of ports iterated by the JACK process callback is published
+ *  read-copy-update style.  The callback loads the current list with one
+ *  atomic read, and never locks.  Adding or removing a port builds a new
+ *  list, publishes it, and waits for a process cycle to complete before
+ *  freeing the old list, so that a port can be removed (and then destroyed)
+ *  while the client is running.  If no cycle completes in time, the old
+ *  list is retired instead, and freed only when it is surely unused.
  */
 
 #include "seq64-config.h"
 
 #ifdef SEQ64_JACK_SUPPORT
 
+#include <atomic>                       /* std::atomic<>                */
+#include <vector>                       /* std::vector<>                */
+
 #include "midi_info.hpp"                /* seq64::midi_port_info etc.   */
+#include "mutex.hpp"                    /* seq64::mutex                 */
 #include "mastermidibus_rm.hpp"
 #include "midibus.hpp"                  /* seq64::midibus               */
 
@@ -47,15 +59,54 @@ class midi_jack_info : public midi_info
     friend class midi_jack;
     friend int jack_process_io (jack_nframes_t nframes, void * arg);
 
+public:
+
+    /**
+     *  A list of the ports.  Once published in m_jack_ports, a list is
+     *  never modified.
+     */
+
+    typedef std::vector<midi_jack *> jack_ports;
+
 private:
 
     /**
      *  Holds the port data.  Not for use with the multi-client option.
      *  This list is iterated in the input and output portions of the JACK
-     *  process callback.
+     *  process callback.  Replaced, never modified, by add() and remove().
      */
 
-    std::vector<midi_jack *> m_jack_ports;
+    std::atomic<const jack_ports *> m_jack_ports;
+
+    /**
+     *  Counts the completed runs of the process callback.  When it has
+     *  moved past its value at the time a new list was published, the
+     *  callback is done with the old list.
+     */
+
+    std::atomic<unsigned long> m_process_cycles;
+
+    /**
+     *  Indicates that the client is activated, so that the process callback
+     *  may be running, and a replaced list must outlive a process cycle.
+     */
+
+    std::atomic<bool> m_jack_active;
+
+    /**
+     *  Holds the replaced lists that the process callback might still be
+     *  reading, because no cycle completed within the grace period of
+     *  publish().  They are freed after a later cycle completes, or when
+     *  the client is closed.  Guarded by m_ports_mutex.
+     */
+
+    std::vector<const jack_ports *> m_retired_ports;
+
+    /**
+     *  Serializes add() and remove().  Never taken by the process callback.
+     */
+
+    mutex m_ports_mutex;
 
     /**
      *  Holds the JACK sequencer client pointer so that it can be used
@@ -129,15 +180,10 @@ private:
 
 private:
 
-    /**
-     *  Adds a pointer to a JACK port.
-     */
-
-    bool add (midi_jack & mj)
-    {
-        m_jack_ports.push_back(&mj);
-        return true;
-    }
+    bool add (midi_jack & mj);
+    bool remove (midi_jack & mj);
+    void publish (const jack_ports * ports);
+    void free_retired_ports ();
 
 };          // midi_jack_info
 
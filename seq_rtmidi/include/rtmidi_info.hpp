@@ -9,7 +9,7 @@
  * \library       sequencer64 application
  * \author        Refactoring by Chris Ahlstrom
  * \date          2016-12-08
- * \updates       2017-03-21
+ * \updates       2023-03-12
  * \license       See the rtexmidi.lic file.  Too big for a header file.
  * \license       GNU GPLv2 or above
  *
@@ -223,6 +223,16 @@ public:
         return get_api_info()->global_queue();
     }
 
+    int input_bus () const
+    {
+        return get_api_info()->input_bus();
+    }
+
+    void router (thru_router * tr)
+    {
+        get_api_info()->router(tr);
+    }
+
     int ppqn () const
     {
         return get_api_info()->ppqn();
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-05-31
+ * \updates       2023-03-12
  * \license       GNU GPLv2 or above
  *
  *  This file provides a Windows-only implementation of the mastermidibus
@@ -208,6 +208,20 @@ mastermidibus::api_init (int ppqn, midibpm bpm)
     set_beats_per_minute(bpm);                          // c_beats_per_minute
     set_ppqn(ppqn);
 
+    /*
+     * JACK forwards MIDI thru in its process callback, straight from the
+     * input port buffers to the output port buffers of the same period.
+     * ALSA forwards it as soon as perform::poll_cycle() reads the event.
+     */
+
+    if (rc().with_jack_midi())
+    {
+        m_midi_master.router(&m_thru_router);
+        m_thru_router.dispatch(thru_router::dispatch_callback);
+    }
+    else
+        m_thru_router.dispatch(thru_router::dispatch_input);
+
     /*
      * Deferred until later in startup.  See the comment here in the
      * seq_alsamidi version of this module.
@@ -281,7 +295,8 @@ mastermidibus::api_poll_for_midi ()
 }
 
 /**
- *  Grab a MIDI event.  For the ALSA implementation, this call
+ *  Grab a MIDI event, and note the input buss it came from, for the thru
+ *  router.
  *
  * \threadsafe
  */
@@ -289,10 +304,17 @@ mastermidibus::api_poll_for_midi ()
 bool
 mastermidibus::api_get_midi_event (event * inev)
 {
+    bool result = false;
+    int bus = -1;
     if (m_use_jack_polling)
-        return m_inbus_array.get_midi_event(inev);
+        result = m_inbus_array.get_midi_event(inev, &bus);
     else
-        return m_midi_master.api_get_midi_event(inev);
+    {
+        result = m_midi_master.api_get_midi_event(inev);
+        bus = m_midi_master.input_bus();
+    }
+    input_bus(bus);
+    return result;
 }
 
 }           // namespace seq64
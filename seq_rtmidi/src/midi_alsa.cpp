@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2016-12-18
- * \updates       2017-06-02
+ * \updates       2023-03-08
  * \license       GNU GPLv2 or above
  *
  *  This file provides a Linux-only implementation of ALSA MIDI support.
@@ -91,6 +91,7 @@
 #include "midibus_rm.hpp"               /* seq64::midibus for rtmidi        */
 #include "midi_alsa.hpp"                /* seq64::midi_alsa for ALSA        */
 #include "midi_info.hpp"                /* seq64::midi_info                 */
+#include "perf_stats.hpp"               /* seq64::statistics()              */
 #include "settings.hpp"                 /* seq64::rc()                      */
 
 /*
@@ -537,7 +538,8 @@ midi_alsa::api_deinit_in ()
  *  This play() function takes a native event, encodes it to an ALSA MIDI
  *  sequencer event, sets the broadcasting to the subscribers, sets the
  *  direct-passing mode to send the event without queueing, and puts it in the
- *  queue.
+ *  queue.  The fill level of the ALSA output buffer, or the loss of the
+ *  event, is tallied in the statistics of this buss.
  *
  * \threadsafe
  *
@@ -572,7 +574,21 @@ midi_alsa::api_play (event * e24, midibyte channel)
 
     snd_seq_ev_set_subs(&ev);
     snd_seq_ev_set_direct(&ev);                     /* it is immediate      */
-    snd_seq_event_output(m_seq, &ev);               /* pump into the queue  */
+    int remaining = snd_seq_event_output(m_seq, &ev);   /* pump into queue  */
+    int bus = parent_bus().get_bus_index();
+    if (remaining < 0)
+    {
+        statistics().xrun(bus);
+    }
+    else
+    {
+        size_t buffsize = snd_seq_get_output_buffer_size(m_seq);
+        if (buffsize > 0)
+        {
+            size_t used = size_t(remaining) * sizeof ev;
+            statistics().buffer_fill(bus, int(used * 100 / buffsize));
+        }
+    }
 }
 
 /**
@@ -6,7 +6,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2016-11-14
- * \updates       2020-06-13
+ * \updates       2023-03-12
  * \license       See the rtexmidi.lic file.  Too big.
  *
  *  API information found at:
@@ -641,13 +641,23 @@ midi_alsa_info::api_get_midi_event (event * inev)
     }
 
     /*
-     *  Note that ev->time.tick is always 0!  (Same in Seq32).
+     *  Note that ev->time.tick is 0 while the queue is stopped!  (Same in
+     *  Seq32).  See input_delay().
      */
 
     long bytes = snd_midi_event_decode(midi_ev, buffer, sizeof buffer, ev);
     if (bytes > 0)
     {
-        result = inev->set_midi_event(ev->time.tick, buffer, bytes);
+        int bus = input_ports().get_port_index
+        (
+            ev->source.client, ev->source.port
+        );
+        if (bus < 0 && seq64::rc().manual_alsa_ports())
+            bus = 0;                            /* the lone virtual input   */
+
+        long delay = input_delay(ev) + seq64::rc().input_latency(bus);
+        m_input_bus = bus;                      /* for the thru router      */
+        result = inev->set_midi_event(delay, buffer, bytes);
         if (result)
         {
             bool sysex = inev->is_sysex();
@@ -682,6 +692,46 @@ midi_alsa_info::api_get_midi_event (event * inev)
     }
 }
 
+/**
+ *  Calculates the input delay of an event, for api_get_midi_event().  The
+ *  input ports are subscribed with tick time-stamps from the global queue,
+ *  so the age of an event is the current tick of the queue less the tick of
+ *  the event.  While the queue is stopped, both are frozen, and the age is
+ *  0.  The caller adds the latency configured for the input buss.
+ *
+ * \param ev
+ *      The ALSA event just read.
+ *
+ * \return
+ *      Returns the age of the event in microseconds.
+ */
+
+long
+midi_alsa_info::input_delay (const snd_seq_event_t * ev)
+{
+    long result = 0;
+    bool ticked = (ev->flags & SND_SEQ_TIME_STAMP_MASK) ==
+        SND_SEQ_TIME_STAMP_TICK;
+
+    if (ticked && ev->queue == global_queue())
+    {
+        snd_seq_queue_status_t * status;
+        snd_seq_queue_status_alloca(&status);
+        if (snd_seq_get_queue_status(m_alsa_seq, global_queue(), status) == 0)
+        {
+            snd_seq_tick_time_t now =
+                snd_seq_queue_status_get_tick_time(status);
+
+            if (now > ev->time.tick)
+            {
+                midipulse age = midipulse(now - ev->time.tick);
+                result = long(ticks_to_delta_time_us(age, bpm(), ppqn()));
+            }
+        }
+    }
+    return result;
+}
+
 }           // namespace seq64
 
 /*
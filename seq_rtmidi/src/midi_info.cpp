@@ -6,7 +6,7 @@
  * \library       sequencer64 application
  * \author        Gary P. Scavone; severe refactoring by Chris Ahlstrom
  * \date          2016-12-06
- * \updates       2017-09-12
+ * \updates       2023-03-12
  * \license       See the rtexmidi.lic file.  Too big.
  *
  *  This class is meant to collect a whole bunch of system MIDI information
@@ -130,6 +130,35 @@ midi_port_info::add (const midibus * m)
     );
 }
 
+/**
+ *  Looks up a port by its client and port numbers.
+ *
+ * \param client
+ *      The client (buss) number of the port.
+ *
+ * \param port
+ *      The port number of the port.
+ *
+ * \return
+ *      Returns the index of the port, or -1 if it is not in the list.
+ */
+
+int
+midi_port_info::get_port_index (int client, int port) const
+{
+    int result = -1;
+    for (int i = 0; i < get_port_count(); ++i)
+    {
+        const port_info_t & pi = m_port_container[i];
+        if (pi.m_client_number == client && pi.m_port_number == port)
+        {
+            result = i;
+            break;
+        }
+    }
+    return result;
+}
+
 /*
  * class midi_info
  */
@@ -153,6 +182,8 @@ midi_info::midi_info
     m_app_name          (appname),
     m_ppqn              (ppqn),
     m_bpm               (bpm),
+    m_thru_router       (nullptr),
+    m_input_bus         (-1),
     m_error_string      ()
 {
     //
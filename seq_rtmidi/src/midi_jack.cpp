@@ -6,7 +6,7 @@
  * \library       sequencer64 application
  * \author        Gary P. Scavone; severe refactoring by Chris Ahlstrom
  * \date          2016-11-14
- * \updates       2020-05-24
+ * \updates       2023-03-20
  * \license       See the rtexmidi.lic file.  Too big for a header file.
  *
  *  Written primarily by Alexander Svetalkin, with updates for delta time by
@@ -157,6 +157,7 @@
 #include "jack_assistant.hpp"           /* seq64::jack_status_pair_t        */
 #include "midibus_rm.hpp"               /* seq64::midibus for rtmidi        */
 #include "midi_jack.hpp"                /* seq64::midi_jack                 */
+#include "perf_stats.hpp"               /* seq64::statistics()              */
 #include "settings.hpp"                 /* seq64::rc() accessor function    */
 
 /**
@@ -251,7 +252,9 @@ jack_process_rtmidi_input (jack_nframes_t nframes, void * arg)
     {
         rtmidi_in_data * rtindata = jackdata->m_jack_rtmidiin;
         jack_midi_event_t jmevent;
-        jack_time_t jtime;
+        jack_nframes_t cycleframe =
+            jack_last_frame_time(jackdata->m_jack_client);
+
         int evcount = jack_midi_get_event_count(buff);
         for (int j = 0; j < evcount; ++j)
         {
@@ -263,20 +266,17 @@ jack_process_rtmidi_input (jack_nframes_t nframes, void * arg)
                 for (int i = 0; i < eventsize; ++i)
                     message.push(jmevent.buffer[i]);
 
-                jack_time_t delta_jtime;
-                jtime = jack_get_time();            /* compute delta time   */
-                if (rtindata->first_message())
-                {
-                    rtindata->first_message(false);
-                    delta_jtime = jack_time_t(0);
-                }
-                else
-                {
-                    jtime -= jackdata->m_jack_lasttime;
-                    delta_jtime = jack_time_t(jtime * 0.000001);
-                }
-                message.timestamp(delta_jtime);
-                jackdata->m_jack_lasttime = jtime;
+                /*
+                 * The time-stamp is the JACK time, in microseconds, of the
+                 * frame at which the event arrived.  See
+                 * midi_in_jack::api_get_midi_event().
+                 */
+
+                jack_time_t jtime = jack_frames_to_time
+                (
+                    jackdata->m_jack_client, cycleframe + jmevent.time
+                );
+                message.timestamp(double(jtime));
                 if (! rtindata->continue_sysex())
                 {
                     if (rtindata->using_callback())
@@ -370,6 +370,7 @@ jack_process_rtmidi_output (jack_nframes_t nframes, void * arg)
 
     void * buf = jack_port_get_buffer(jackdata->m_jack_port, nframes);
     jack_midi_clear_buffer(buf);                    /* no nullptr test      */
+    jackdata->m_jack_thru_frame = 0;                /* see forward_thru()   */
 
 #ifdef SEQ64_SHOW_API_CALLS_TMI
     printf
@@ -453,20 +454,29 @@ midi_jack::midi_jack
     midi_api            (parentbus, masterinfo),
     m_remote_port_name  (),
     m_jack_info         (dynamic_cast<midi_jack_info &>(masterinfo)),
-    m_jack_data         ()
+    m_jack_data         (),
+    m_registered        (false)
 {
     client_handle(reinterpret_cast<jack_client_t *>(masterinfo.midi_handle()));
-    (void) m_jack_info.add(*this);
+    m_registered = m_jack_info.add(*this);
 }
 
 /**
  *  This could be a rote empty destructor if we offload this destruction to the
  *  midi_jack_data structure.  However, other than the initialization, that
  *  structure is currently "dumb".
+ *
+ *  The port is first taken out of the list that the JACK process callback
+ *  walks, so that a port can be destroyed while the client runs.
  */
 
 midi_jack::~midi_jack ()
 {
+    if (m_registered)
+    {
+        (void) m_jack_info.remove(*this);
+        m_registered = false;
+    }
     if (not_nullptr(m_jack_data.m_jack_buffsize))
         jack_ringbuffer_free(m_jack_data.m_jack_buffsize);
 
@@ -772,7 +782,9 @@ midi_jack::api_play (event * e24, midibyte channel)
 
 /**
  *  Sends a JACK MIDI output message.  It writes the full message size and
- *  the message itself to the JACK ring buffer.
+ *  the message itself to the JACK ring buffer.  The fill level of the
+ *  ring buffer, or the loss of the message if it does not fit, is tallied in
+ *  the statistics of this buss.
  *
  * \param message
  *      Provides the MIDI message object, which contains the bytes to send.
@@ -802,6 +814,18 @@ midi_jack::send_message (const midi_message & message)
         );
         apiprint("send_message", "jack");
         result = (count1 > 0) && (count2 > 0);
+
+        int bus = parent_bus().get_bus_index();
+        if (count1 < nbytes || count2 < int(sizeof nbytes))
+        {
+            statistics().xrun(bus);
+        }
+        else
+        {
+            jack_ringbuffer_t * rb = m_jack_data.m_jack_buffmessage;
+            size_t used = rb->size - jack_ringbuffer_write_space(rb);
+            statistics().buffer_fill(bus, int(used * 100 / rb->size));
+        }
     }
     return result;
 }
@@ -1294,6 +1318,11 @@ midi_jack::register_port (bool input, const std::string & portname)
 void
 midi_jack::close_port ()
 {
+    if (m_registered)
+    {
+        (void) m_jack_info.remove(*this);       /* callback lets go of it   */
+        m_registered = false;
+    }
     if (not_nullptr(client_handle()) && not_nullptr(port_handle()))
     {
         jack_port_unregister(client_handle(), port_handle());
@@ -1405,6 +1434,10 @@ midi_in_jack::api_poll_for_midi ()
  *      One result (we think) is odd artifacts in the seqroll when recording
  *      and passing through.
  *
+ *  The event's time-stamp is set to its input delay, the microseconds
+ *  elapsed since the JACK frame at which it arrived, as stamped by
+ *  jack_process_rtmidi_input().  See midibase::get_midi_event().
+ *
  * \param inev
  *      Provides the destination for the MIDI event.
  *
@@ -1423,7 +1456,10 @@ midi_in_jack::api_get_midi_event (event * inev)
     if (result)
     {
         midi_message mm = rtindata->queue().pop_front();
-        result = inev->set_midi_event(mm.timestamp(), mm.data(), mm.count());
+        jack_time_t arrival = jack_time_t(mm.timestamp());
+        jack_time_t now = jack_get_time();
+        midipulse delay = now > arrival ? midipulse(now - arrival) : 0 ;
+        result = inev->set_midi_event(delay, mm.data(), mm.count());
         if (result)
         {
             /*
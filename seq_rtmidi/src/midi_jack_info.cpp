@@ -6,7 +6,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2017-01-01
- * \updates       2019-01-05
+ * \updates       2023-03-28
  * \license       See the rtexmidi.lic file.  Too big.
  *
  *  This class is meant to collect a whole bunch of JACK information
@@ -44,7 +44,9 @@
 #include "midi_jack.hpp"                /* seq64::midi_jack_info            */
 #include "midi_jack_info.hpp"           /* seq64::midi_jack_info            */
 #include "midibus_common.hpp"           /* from the libseq64 sub-project    */
+#include "perf_stats.hpp"               /* seq64::statistics()              */
 #include "settings.hpp"                 /* seq64::rc() configuration object */
+#include "thru_router.hpp"              /* seq64::thru_router               */
 
 /*
  * Do not document the namespace; it breaks Doxygen.
@@ -60,12 +62,107 @@ namespace seq64
 extern int jack_process_rtmidi_input (jack_nframes_t nframes, void * arg);
 extern int jack_process_rtmidi_output (jack_nframes_t nframes, void * arg);
 
+/**
+ *  Forwards the MIDI thru events of an input port straight to the output
+ *  ports, in the same period, as routed by the thru router of the
+ *  mastermidibus.  The events keep their frame offsets, except that they
+ *  cannot precede an event already written to the output port buffer.
+ *  Neither locks nor allocates.
+ *
+ * \param nframes
+ *      The number of frames in the period.
+ *
+ * \param router
+ *      The thru router.
+ *
+ * \param ports
+ *      All of the ports, whose output ports have already been processed for
+ *      this period.
+ *
+ * \param inport
+ *      The input port whose events are to be forwarded.
+ */
+
+static void
+forward_thru
+(
+    jack_nframes_t nframes,
+    const thru_router & router,
+    const midi_jack_info::jack_ports & ports,
+    midi_jack * inport
+)
+{
+    midi_jack_data * injack = &inport->jack_data();
+    void * inbuff = jack_port_get_buffer(injack->m_jack_port, nframes);
+    if (is_nullptr(inbuff))
+        return;
+
+    int inbus = inport->parent_bus().get_bus_index();
+    int evcount = jack_midi_get_event_count(inbuff);
+    for (int j = 0; j < evcount; ++j)
+    {
+        jack_midi_event_t jmevent;
+        if (jack_midi_event_get(&jmevent, inbuff, j) != 0)
+            continue;
+
+        bussbyte outbus;
+        midibyte outchannel;
+        bool ok = jmevent.size > 0 && jmevent.size <= 3 && router.route
+        (
+            inbus, jmevent.buffer[0], outbus, outchannel
+        );
+        if (! ok)
+            continue;
+
+        midi_jack_info::jack_ports::const_iterator mi;
+        for (mi = ports.begin(); mi != ports.end(); ++mi)
+        {
+            midi_jack * mj = *mi;
+            if (mj->parent_bus().is_input_port())
+                continue;
+
+            if (mj->parent_bus().get_bus_index() == int(outbus))
+            {
+                midi_jack_data * outjack = &mj->jack_data();
+                void * outbuff = jack_port_get_buffer
+                (
+                    outjack->m_jack_port, nframes
+                );
+                if (not_nullptr(outbuff))
+                {
+                    jack_midi_data_t msg[3];
+                    msg[0] = (jmevent.buffer[0] & EVENT_CLEAR_CHAN_MASK) |
+                        outchannel;
+
+                    for (size_t b = 1; b < jmevent.size; ++b)
+                        msg[b] = jmevent.buffer[b];
+
+                    jack_nframes_t frame = jmevent.time;
+                    if (frame < outjack->m_jack_thru_frame)
+                        frame = outjack->m_jack_thru_frame;
+
+                    int rc = jack_midi_event_write
+                    (
+                        outbuff, frame, msg, jmevent.size
+                    );
+                    if (rc == 0)
+                        outjack->m_jack_thru_frame = frame;
+                }
+                break;
+            }
+        }
+    }
+}
+
 /**
  *  Provides a JACK callback function that uses the callbacks defined in the
  *  midi_jack module.  This function calls both the input callback and
  *  the output callback, depending on the port type.  This may lead to
  *  delays, depending on the size of the JACK MIDI buffer.
  *
+ *  The output ports are processed first, so that MIDI thru can be added to
+ *  their buffers as each input port is processed.
+ *
  * \param nframes
  *      The frame number from the JACK API.
  *
@@ -86,28 +183,60 @@ jack_process_io (jack_nframes_t nframes, void * arg)
         {
             /*
              * Here we want to go through the I/O ports and route the data
-             * appropriately.
+             * appropriately.  The list is read once, and stays valid until
+             * this cycle is counted; see midi_jack_info::publish().
              */
 
-            std::vector<midi_jack *>::iterator mi;
-            for
-            (
-                mi = self->m_jack_ports.begin();
-                mi != self->m_jack_ports.end(); ++mi
-            )
+            const midi_jack_info::jack_ports * ports =
+                self->m_jack_ports.load();
+            if (not_nullptr(ports))
             {
-                midi_jack * mj = *mi;
-                midi_jack_data * mjp = &mj->jack_data();
-                if (mj->parent_bus().is_input_port())
-                    (void) jack_process_rtmidi_input(nframes, mjp);
-                else
-                    (void) jack_process_rtmidi_output(nframes, mjp);
+                midi_jack_info::jack_ports::const_iterator mi;
+                for (mi = ports->begin(); mi != ports->end(); ++mi)
+                {
+                    midi_jack * mj = *mi;
+                    midi_jack_data * mjp = &mj->jack_data();
+                    if (! mj->parent_bus().is_input_port())
+                        (void) jack_process_rtmidi_output(nframes, mjp);
+                }
+
+                const thru_router * router = self->router();
+                bool forwarding = not_nullptr(router) &&
+                    router->dispatch() == thru_router::dispatch_callback;
+
+                for (mi = ports->begin(); mi != ports->end(); ++mi)
+                {
+                    midi_jack * mj = *mi;
+                    midi_jack_data * mjp = &mj->jack_data();
+                    if (mj->parent_bus().is_input_port())
+                    {
+                        (void) jack_process_rtmidi_input(nframes, mjp);
+                        if (forwarding)
+                            forward_thru(nframes, *router, *ports, mj);
+                    }
+                }
             }
+            ++self->m_process_cycles;           /* done with this list      */
         }
     }
     return 0;
 }
 
+/**
+ *  Provides a JACK callback function that counts the xruns reported by the
+ *  JACK server, for the statistics.
+ *
+ * \return
+ *      Always returns 0.
+ */
+
+static int
+jack_xrun_callback (void * /* arg */)
+{
+    statistics().server_xrun();
+    return 0;
+}
+
 /**
  *  Principal constructor.
  *
@@ -128,7 +257,11 @@ midi_jack_info::midi_jack_info
     midibpm bpm
 ) :
     midi_info               (appname, ppqn, bpm),
-    m_jack_ports            (),
+    m_jack_ports            (nullptr),              /* no ports yet         */
+    m_process_cycles        (0),
+    m_jack_active           (false),
+    m_retired_ports         (),
+    m_ports_mutex           (),
     m_jack_client           (nullptr),              /* inited for connect() */
     m_jack_client_2         (nullptr)
 {
@@ -145,11 +278,149 @@ midi_jack_info::midi_jack_info
  *  Destructor.  Deactivates (disconnects and closes) any ports maintained by
  *  the JACK client, then closes the JACK client, shuts down the input
  *  thread, and then cleans up any API resources in use.
+ *
+ *  The ports still in the list are destroyed after this object (they belong
+ *  to the busses of the mastermidibus), so they are told not to remove
+ *  themselves from it.
  */
 
 midi_jack_info::~midi_jack_info ()
 {
     disconnect();
+
+    const jack_ports * ports = m_jack_ports.exchange(nullptr);
+    if (not_nullptr(ports))
+    {
+        jack_ports::const_iterator pi;
+        for (pi = ports->begin(); pi != ports->end(); ++pi)
+            (*pi)->m_registered = false;
+
+        delete ports;
+    }
+    free_retired_ports();                           /* no more callbacks    */
+}
+
+/**
+ *  Adds a pointer to a JACK port, by publishing a copy of the list with
+ *  the port appended.
+ *
+ * \param mj
+ *      The port to add.
+ *
+ * \return
+ *      Always returns true.
+ */
+
+bool
+midi_jack_info::add (midi_jack & mj)
+{
+    automutex locker(m_ports_mutex);
+    const jack_ports * old = m_jack_ports.load();
+    jack_ports * ports = is_nullptr(old) ?
+        new jack_ports() : new jack_ports(*old) ;
+
+    ports->push_back(&mj);
+    publish(ports);
+    return true;
+}
+
+/**
+ *  Removes a pointer to a JACK port, by publishing a copy of the list
+ *  without the port.  When this function returns, the process callback no
+ *  longer uses the port, which can be closed and destroyed.
+ *
+ * \param mj
+ *      The port to remove.
+ *
+ * \return
+ *      Returns true if the port was in the list.
+ */
+
+bool
+midi_jack_info::remove (midi_jack & mj)
+{
+    automutex locker(m_ports_mutex);
+    bool result = false;
+    const jack_ports * old = m_jack_ports.load();
+    if (not_nullptr(old))
+    {
+        jack_ports * ports = new jack_ports();
+        ports->reserve(old->size());
+        jack_ports::const_iterator pi;
+        for (pi = old->begin(); pi != old->end(); ++pi)
+        {
+            if (*pi == &mj)
+                result = true;
+            else
+                ports->push_back(*pi);
+        }
+        if (result)
+            publish(ports);
+        else
+            delete ports;
+    }
+    return result;
+}
+
+/**
+ *  Replaces the list of ports seen by the process callback, and frees the
+ *  old list once the callback cannot be using it.  If the client is active,
+ *  that is when a process cycle has completed after the swap; the process
+ *  callback runs on a single thread, and loads the list once per cycle.
+ *
+ *  If no cycle completes within a second, the callback may be stalled in
+ *  the middle of one, still reading the old list.  Freeing the list then
+ *  would risk a use-after-free, so it is retired instead.  A cycle that
+ *  completes after a later swap proves that all earlier lists are unused,
+ *  and frees the retired ones too.  Called with m_ports_mutex held.
+ *
+ * \param ports
+ *      The new list.  This object takes ownership of it.
+ */
+
+void
+midi_jack_info::publish (const jack_ports * ports)
+{
+    static const int s_grace_poll_us = 500;
+    static const int s_grace_limit_us = 1000000;
+    const jack_ports * old = m_jack_ports.exchange(ports);
+    bool unused = true;
+    if (m_jack_active.load())
+    {
+        unsigned long cycle = m_process_cycles.load();
+        int waited = 0;
+        while (m_process_cycles.load() == cycle && waited < s_grace_limit_us)
+        {
+            (void) microsleep(s_grace_poll_us);
+            waited += s_grace_poll_us;
+        }
+        unused = m_process_cycles.load() != cycle;
+    }
+    if (unused)
+    {
+        delete old;
+        free_retired_ports();
+    }
+    else if (not_nullptr(old))
+    {
+        m_retired_ports.push_back(old);
+        warnprint("JACK process cycle stalled, port list retired");
+    }
+}
+
+/**
+ *  Frees the lists retired by publish().  Called only when the process
+ *  callback cannot be reading them.
+ */
+
+void
+midi_jack_info::free_retired_ports ()
+{
+    std::vector<const jack_ports *>::iterator ri;
+    for (ri = m_retired_ports.begin(); ri != m_retired_ports.end(); ++ri)
+        delete *ri;
+
+    m_retired_ports.clear();
 }
 
 /**
@@ -179,6 +450,8 @@ midi_jack_info::connect ()
             m_jack_client = result;
             if (rc == 0)
             {
+                (void) jack_set_xrun_callback(result, jack_xrun_callback, this);
+
                 /**
                  * We need to add a call to jack_on_shutdown() to set up a
                  * shutdown callback.  We also need to wait on the activation
@@ -215,6 +488,7 @@ midi_jack_info::disconnect ()
     if (not_nullptr(m_jack_client))
     {
         jack_deactivate(m_jack_client);
+        m_jack_active = false;                  /* no more process cycles   */
         jack_client_close(m_jack_client);
         m_jack_client = nullptr;
         apiprint("jack_deactivate", "info");
@@ -437,6 +711,8 @@ midi_jack_info::api_connect ()
         int rc = jack_activate(client_handle());
         apiprint("jack_activate", "info");
         result = rc == 0;
+        if (result)
+            m_jack_active = true;
     }
     if (result)
     {
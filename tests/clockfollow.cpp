@@ -0,0 +1,236 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          clockfollow.cpp
+ *
+ *  This module defines a test harness for the clock_follower.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-13
+ * \updates       2023-03-13
+ * \license       GNU GPLv2 or above
+ *
+ *  The harness simulates an external MIDI clock, with a tempo that ramps
+ *  linearly from one value to another, and with each clock arriving up to a
+ *  given jitter early or late.  An output cycle is simulated every
+ *  millisecond, as perform::output_func() would run it.  At each cycle, the
+ *  position computed by the clock_follower, and the position computed the
+ *  old way (the count of clocks received, times the increment), are
+ *  compared with the ideal position, the one of the un-jittered clock.
+ *  The jitter is generated with a fixed pseudo-random seed, so that the
+ *  results are repeatable.
+ *
+ *  Usage:
+ *
+\verbatim
+        clockfollow [ --bpm b ] [ --to b ] [ --jitter us ] [ --bandwidth hz ]
+            [ --ppqn p ] [ --seconds s ]
+\endverbatim
+ *
+ *  The program prints the RMS and maximum error, in ticks, of both methods,
+ *  and the tempo estimated at the end.  It returns 1 if the follower tracks
+ *  worse than the old method, or if its error ever exceeds two clocks.
+ */
+
+#include <cmath>                        /* std::sqrt(), std::fabs()         */
+#include <cstdio>                       /* std::printf(), std::fprintf()    */
+#include <cstdlib>                      /* std::atof(), std::atoi()         */
+#include <cstring>                      /* std::strcmp()                    */
+#include <vector>                       /* std::vector<>                    */
+
+#include "calculations.hpp"             /* seq64::clock_ticks_from_ppqn()   */
+#include "clock_follower.hpp"           /* seq64::clock_follower            */
+
+/**
+ *  A small linear congruential generator, so that the jitter does not
+ *  depend on the C library.
+ */
+
+static unsigned long s_seed = 12345;
+
+/**
+ *  Gets a pseudo-random value in the range [-1, 1].
+ */
+
+static double
+random_unit ()
+{
+    s_seed = (s_seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+    return double((s_seed >> 8) % 20001UL) / 10000.0 - 1.0;
+}
+
+/**
+ *  Accumulates an error measurement.
+ */
+
+struct tracking
+{
+    double sumsq;
+    double worst;
+    long count;
+};
+
+static void
+add_error (tracking & t, double error)
+{
+    t.sumsq += error * error;
+    if (std::fabs(error) > t.worst)
+        t.worst = std::fabs(error);
+
+    ++t.count;
+}
+
+static double
+rms (const tracking & t)
+{
+    return t.count > 0 ? std::sqrt(t.sumsq / t.count) : 0.0 ;
+}
+
+/**
+ *  Runs the simulation.
+ */
+
+int
+main (int argc, char * argv [])
+{
+    double bpm0 = 120.0;
+    double bpm1 = 0.0;
+    double jitter = 2000.0;                         /* microseconds         */
+    double bandwidth = SEQ64_CLOCK_FOLLOWER_BANDWIDTH;
+    int ppqn = 192;
+    double seconds = 60.0;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool more = i + 1 < argc;
+        if (more && std::strcmp(argv[i], "--bpm") == 0)
+            bpm0 = std::atof(argv[++i]);
+        else if (more && std::strcmp(argv[i], "--to") == 0)
+            bpm1 = std::atof(argv[++i]);
+        else if (more && std::strcmp(argv[i], "--jitter") == 0)
+            jitter = std::atof(argv[++i]);
+        else if (more && std::strcmp(argv[i], "--bandwidth") == 0)
+            bandwidth = std::atof(argv[++i]);
+        else if (more && std::strcmp(argv[i], "--ppqn") == 0)
+            ppqn = std::atoi(argv[++i]);
+        else if (more && std::strcmp(argv[i], "--seconds") == 0)
+            seconds = std::atof(argv[++i]);
+        else
+        {
+            std::fprintf
+            (
+                stderr,
+                "Usage: %s [--bpm b] [--to b] [--jitter us] "
+                "[--bandwidth hz] [--ppqn p] [--seconds s]\n", argv[0]
+            );
+            return 2;
+        }
+    }
+    if (bpm1 <= 0.0)
+        bpm1 = bpm0;
+
+    int increment = seq64::clock_ticks_from_ppqn(ppqn);
+    double end = seconds * 1.0e9;
+    double start = 1.0e9;                   /* keep arrival times positive  */
+    seq64::clock_follower follower(bandwidth);
+    follower.start(increment);
+
+    /*
+     *  The ideal clock times are generated first, along with their jittered
+     *  arrival times, which never go backward.
+     */
+
+    std::vector<double> ideal;
+    std::vector<double> arrival;
+    for (double t = start; t < start + end + 1.0e9; /* see body */)
+    {
+        double bpm = bpm0 + (bpm1 - bpm0) * (t - start) / end;
+        double a = t + random_unit() * jitter * 1000.0;
+        if (! arrival.empty() && a < arrival.back())
+            a = arrival.back();
+
+        ideal.push_back(t);
+        arrival.push_back(a);
+        t += 60.0e9 / (bpm * 24.0);
+    }
+
+    tracking newway = { 0.0, 0.0, 0 };
+    tracking oldway = { 0.0, 0.0, 0 };
+    seq64::midipulse followed = 0;
+    std::size_t received = 0;                   /* clocks delivered         */
+    std::size_t j = 0;                          /* ideal clock before now   */
+    for (double now = start; now < start + end; now += 1.0e6)
+    {
+        while (received < arrival.size() && arrival[received] <= now)
+            follower.pulse((long long)(arrival[received++]));
+
+        followed += follower.advance((long long)(now));
+        while (j + 1 < ideal.size() && ideal[j + 1] <= now)
+            ++j;
+
+        /*
+         *  The position after clock j is (j + 1) times the increment, as in
+         *  perform.  Skip the first beat, while the loop has no period.
+         */
+
+        double fraction = (now - ideal[j]) / (ideal[j + 1] - ideal[j]);
+        double idealticks = (double(j + 1) + fraction) * increment;
+        if (j >= 24)
+        {
+            add_error(newway, double(followed) - idealticks);
+            add_error(oldway, double(received * increment) - idealticks);
+        }
+    }
+
+    double newrms = rms(newway);
+    double oldrms = rms(oldway);
+    std::printf
+    (
+        "bpm %.2f -> %.2f, jitter %.0f us, bandwidth %.2f Hz, ppqn %d, "
+        "%.0f s\n", bpm0, bpm1, jitter, bandwidth, ppqn, seconds
+    );
+    std::printf
+    (
+        "  clock_follower: rms %8.3f ticks, max %8.3f ticks\n",
+        newrms, newway.worst
+    );
+    std::printf
+    (
+        "  pulse count:    rms %8.3f ticks, max %8.3f ticks\n",
+        oldrms, oldway.worst
+    );
+    std::printf
+    (
+        "  estimated tempo at end: %.3f bpm (actual %.3f bpm)\n",
+        follower.bpm(), bpm1
+    );
+
+    bool ok = newrms <= oldrms && newway.worst <= 2.0 * increment;
+    if (! ok)
+        std::printf("  FAILED\n");
+
+    return ok ? 0 : 1 ;
+}
+
+/*
+ * clockfollow.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,1135 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          seq64bench.cpp
+ *
+ *  This module defines a benchmark program for the hot paths of libseq64.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-07
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  The program is built only in the null-MIDI configuration
+ *  (./configure --disable-rtmidi --enable-nullmidi), so that it runs on any
+ *  machine, with no sound server, and measures only Sequencer64 itself.
+ *  Each case is a loop over one operation; the result is the number of
+ *  operations, the total time, and the derived time per operation and
+ *  operations per second.  All data is generated with a fixed pseudo-random
+ *  seed, so that results from different releases can be compared.
+ *
+ *  Usage:
+ *
+\verbatim
+        seq64bench [ --csv | --json ] [ --quick ] [ --output file ] [ filter ]
+\endverbatim
+ *
+ *  The default output is a plain table.  The --csv and --json options
+ *  produce machine-readable output for tracking regressions.  Since
+ *  libseq64 prints some progress messages, use --output to get a clean
+ *  file.  The --quick option cuts the repetitions by ten, for a smoke test.
+ *  A filter selects the cases whose names contain it.
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <cstdio>                       /* std::fprintf(), std::remove()    */
+#include <cstring>                      /* std::strcmp()                    */
+#include <string>                       /* std::string                      */
+#include <thread>                       /* std::this_thread::yield()        */
+#include <vector>                       /* std::vector<>                    */
+
+#include "event_list.hpp"               /* seq64::event_list                */
+#include "gui_assistant.hpp"            /* seq64::gui_assistant             */
+#include "keys_perform.hpp"             /* seq64::keys_perform              */
+#include "mastermidibus.hpp"            /* seq64::mastermidibus (null)      */
+#include "midifile.hpp"                 /* seq64::midifile                  */
+#include "offline_render.hpp"           /* seq64::offline_render            */
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "play_pool.hpp"                /* seq64::play_pool                 */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "settings.hpp"                 /* seq64::rc(), seq64::usr()        */
+#include "song_snapshot.hpp"            /* seq64::song_snapshot             */
+#include "triggers.hpp"                 /* seq64::triggers                  */
+
+/**
+ *  The PPQN used throughout.
+ */
+
+static const int s_ppqn = 192;
+
+/**
+ *  The length of one 4/4 measure, in ticks.
+ */
+
+static const seq64::midipulse s_measure = 4 * s_ppqn;
+
+/**
+ *  The result of one benchmark case.
+ */
+
+struct result
+{
+    std::string name;
+    long ops;
+    double ns;
+};
+
+/**
+ *  The results, in the order the cases were run.
+ */
+
+static std::vector<result> s_results;
+
+/**
+ *  The repetition divisor, 10 for --quick, otherwise 1.
+ */
+
+static int s_divisor = 1;
+
+/**
+ *  The case filter; empty to run all cases.
+ */
+
+static std::string s_filter;
+
+/**
+ *  A small linear congruential generator, so that the generated data does
+ *  not depend on the C library.
+ */
+
+static unsigned long s_seed = 12345;
+
+static int
+random_int (int range)
+{
+    s_seed = (s_seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+    return int((s_seed >> 8) % (unsigned long)(range));
+}
+
+/**
+ *  Scales a repetition count by the --quick divisor.
+ */
+
+static int
+reps (int count)
+{
+    int result = count / s_divisor;
+    return result > 0 ? result : 1 ;
+}
+
+/**
+ *  Checks the case filter.
+ */
+
+static bool
+wanted (const std::string & name)
+{
+    return s_filter.empty() || name.find(s_filter) != std::string::npos;
+}
+
+/**
+ *  Gets the current steady-clock time in nanoseconds.
+ */
+
+static double
+now_ns ()
+{
+    return double
+    (
+        std::chrono::duration_cast<std::chrono::nanoseconds>
+        (
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count()
+    );
+}
+
+/**
+ *  Records a result.
+ */
+
+static void
+add_result (const std::string & name, long ops, double ns)
+{
+    result r;
+    r.name = name;
+    r.ops = ops;
+    r.ns = ns;
+    s_results.push_back(r);
+}
+
+/**
+ *  Fills a pattern with random notes, at the given density.  The events are
+ *  appended, then sorted and linked once, since adding them one by one
+ *  would sort the list after every note.
+ *
+ * \param s
+ *      The pattern, which is cleared first.
+ *
+ * \param measures
+ *      The length of the pattern.
+ *
+ * \param density
+ *      The number of notes per measure.
+ */
+
+static void
+fill_sequence (seq64::sequence & s, int measures, int density)
+{
+    s.set_length(measures * s_measure);
+    int notes = measures * density;
+    seq64::midipulse spacing = s_measure / density;
+    if (spacing < 2)
+        spacing = 2;
+
+    for (int n = 0; n < notes; ++n)
+    {
+        seq64::midipulse tick = n * s_measure / density;
+        int note = 36 + random_int(60);
+        seq64::event on;
+        on.set_timestamp(tick);
+        on.set_status(seq64::EVENT_NOTE_ON);
+        on.set_data(note, 100);
+        (void) s.append_event(on);
+
+        seq64::event off;
+        off.set_timestamp(tick + spacing - 1);
+        off.set_status(seq64::EVENT_NOTE_OFF);
+        off.set_data(note, 0);
+        (void) s.append_event(off);
+    }
+    s.sort_events();
+    s.verify_and_link();
+}
+
+/**
+ *  Creates a pattern in the given slot.
+ */
+
+static seq64::sequence *
+make_sequence (seq64::perform & p, int seqno, int measures, int density)
+{
+    seq64::sequence * result = nullptr;
+    if (p.new_sequence(seqno))
+    {
+        result = p.get_sequence(seqno);
+        fill_sequence(*result, measures, density);
+    }
+    return result;
+}
+
+/**
+ *  Measures sequence::play() in Live mode.  The pattern is played for many
+ *  loops, one tick per call, which is the worst case for the output thread.
+ *  An operation is one call.
+ */
+
+static void
+bench_sequence_play (seq64::perform & p)
+{
+    static const int densities[] = { 4, 16, 64, 256 };
+    for (int d = 0; d < int(sizeof densities / sizeof densities[0]); ++d)
+    {
+        std::string name = "sequence_play/" + std::to_string(densities[d]);
+        if (! wanted(name))
+            continue;
+
+        (void) p.clear_all();
+        seq64::sequence * s = make_sequence(p, 0, 4, densities[d]);
+        if (is_nullptr(s))
+            continue;
+
+        s->set_playing(true);
+
+        long ticks = long(reps(50)) * long(s->get_length());
+        double t0 = now_ns();
+        for (long tick = 0; tick < ticks; ++tick)
+            s->play(seq64::midipulse(tick), false);
+
+        add_result(name, ticks, now_ns() - t0);
+        s->set_playing(false);
+    }
+}
+
+/**
+ *  Measures adding events to an event_list, a full sort, and the note
+ *  linking of a pattern of about the same size.  An operation is one event.
+ *  The std::list implementation sorts the list on every add, so the insert
+ *  case is quadratic, and is skipped for the largest size.
+ */
+
+static void
+bench_event_list (seq64::perform & p)
+{
+    static const int sizes[] = { 1024, 4096, 16384 };
+    for (int z = 0; z < int(sizeof sizes / sizeof sizes[0]); ++z)
+    {
+        int count = sizes[z];
+        std::string suffix = "/" + std::to_string(count);
+        seq64::midipulse length = seq64::midipulse(count) * 16;
+        std::vector<seq64::event> events;
+        for (int n = 0; n < count / 2; ++n)
+        {
+            seq64::midipulse tick = random_int(int(length - 32));
+            int note = random_int(128);
+            seq64::event on;
+            on.set_timestamp(tick);
+            on.set_status(seq64::EVENT_NOTE_ON);
+            on.set_data(note, 100);
+            events.push_back(on);
+
+            seq64::event off;
+            off.set_timestamp(tick + 1 + random_int(31));
+            off.set_status(seq64::EVENT_NOTE_OFF);
+            off.set_data(note, 0);
+            events.push_back(off);
+        }
+
+        seq64::event_list el;
+        if (count <= 4096 && wanted("event_list_insert" + suffix))
+        {
+            double t0 = now_ns();
+            for (int n = 0; n < int(events.size()); ++n)
+                (void) el.add(events[n]);
+
+            add_result("event_list_insert" + suffix, count, now_ns() - t0);
+        }
+        else
+        {
+            for (int n = 0; n < int(events.size()); ++n)
+                (void) el.append(events[n]);
+        }
+        if (wanted("event_list_sort" + suffix))
+        {
+            int loops = reps(20);
+            double ns = 0.0;
+            for (int i = 0; i < loops; ++i)
+            {
+                seq64::event_list copy;
+                for (int n = 0; n < int(events.size()); ++n)
+                    (void) copy.append(events[n]);
+
+                double t0 = now_ns();
+                copy.sort();
+                ns += now_ns() - t0;
+            }
+            add_result("event_list_sort" + suffix, long(loops) * count, ns);
+        }
+        if (wanted("event_list_link" + suffix))
+        {
+            (void) p.clear_all();
+            seq64::sequence * s = make_sequence(p, 0, count / 512, 256);
+            if (not_nullptr(s))
+            {
+                int loops = reps(20);
+                long events = s->event_count();
+                double t0 = now_ns();
+                for (int i = 0; i < loops; ++i)
+                {
+                    (void) s->events().begin(); /* else nothing to verify */
+                    s->verify_and_link();
+                }
+
+                add_result
+                (
+                    "event_list_link" + suffix, long(loops) * events,
+                    now_ns() - t0
+                );
+            }
+        }
+    }
+}
+
+/**
+ *  Measures triggers::play(), the Song-mode decision made for every pattern
+ *  on every output cycle, on a pattern with many short triggers.  An
+ *  operation is one call, covering 8 ticks.
+ */
+
+static void
+bench_triggers_play (seq64::perform & p)
+{
+    static const int counts[] = { 16, 256, 2048 };
+    for (int c = 0; c < int(sizeof counts / sizeof counts[0]); ++c)
+    {
+        std::string name = "triggers_play/" + std::to_string(counts[c]);
+        if (! wanted(name))
+            continue;
+
+        (void) p.clear_all();
+        seq64::sequence * s = make_sequence(p, 0, 1, 4);
+        if (is_nullptr(s))
+            continue;
+
+        seq64::triggers t(*s);
+        seq64::midipulse len = s->get_length();
+        for (int n = 0; n < counts[c]; ++n)
+            t.add(n * 2 * len, len, 0, 0, false);
+
+        seq64::midipulse end = counts[c] * 2 * len;
+        int loops = reps(4);
+        long calls = 0;
+        double t0 = now_ns();
+        for (int i = 0; i < loops; ++i)
+        {
+            seq64::midipulse last = 0;
+            for (seq64::midipulse tick = 8; tick < end; tick += 8)
+            {
+                seq64::midipulse starttick = last;
+                seq64::midipulse endtick = tick;
+                int transpose = 0;
+                (void) t.play(starttick, endtick, transpose);
+                last = tick;
+                ++calls;
+            }
+        }
+        add_result(name, calls, now_ns() - t0);
+    }
+}
+
+/**
+ *  Creates a song of 64 patterns, each played in a staggered sequence of
+ *  triggers.
+ *
+ * \return
+ *      Returns the number of events created.
+ */
+
+static long
+make_song (seq64::perform & p, int patterns, int density)
+{
+    long result = 0;
+    (void) p.clear_all();
+    for (int seqno = 0; seqno < patterns; ++seqno)
+    {
+        seq64::sequence * s = make_sequence(p, seqno, 4, density);
+        if (not_nullptr(s))
+        {
+            seq64::midipulse len = s->get_length();
+            for (int n = 0; n < 8; ++n)
+                s->add_trigger((seqno % 4 + n * 5) * len, 2 * len);
+
+            result += s->event_count();
+        }
+    }
+    return result;
+}
+
+/**
+ *  Appends a MIDI variable-length quantity to a byte buffer.
+ */
+
+static void
+put_varinum (std::vector<unsigned char> & b, unsigned long value)
+{
+    unsigned char bytes[4];
+    int count = 0;
+    do
+    {
+        bytes[count++] = (unsigned char)(value & 0x7F);
+        value >>= 7;
+    } while (value > 0 && count < 4);
+    while (count > 1)
+        b.push_back(bytes[--count] | 0x80);
+
+    b.push_back(bytes[0]);
+}
+
+/**
+ *  Writes an SMF 0 file of notes spread over the 16 channels, after a tempo
+ *  event.
+ *
+ * \return
+ *      Returns the number of events written, or 0 if the file could not be
+ *      written.
+ */
+
+static long
+make_smf0 (const std::string & filename, int notes)
+{
+    long result = 0;
+    std::vector<unsigned char> t;
+    const unsigned char tempo[] = { 0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20 };
+    t.insert(t.end(), tempo, tempo + sizeof tempo);
+    ++result;
+    for (int n = 0; n < notes; ++n)
+    {
+        unsigned char chan = (unsigned char)(random_int(16));
+        unsigned char note = (unsigned char)(36 + random_int(60));
+        put_varinum(t, n == 0 ? 0 : 1);
+        t.push_back(0x90 | chan);
+        t.push_back(note);
+        t.push_back(100);
+        put_varinum(t, 11);
+        t.push_back(0x80 | chan);
+        t.push_back(note);
+        t.push_back(0);
+        result += 2;
+    }
+    const unsigned char eot[] = { 0x00, 0xFF, 0x2F, 0x00 };
+    t.insert(t.end(), eot, eot + sizeof eot);
+
+    unsigned long tl = (unsigned long)(t.size());
+    const unsigned char header[] =
+    {
+        'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1,
+        (unsigned char)(s_ppqn >> 8), (unsigned char)(s_ppqn & 0xFF),
+        'M', 'T', 'r', 'k',
+        (unsigned char)(tl >> 24), (unsigned char)((tl >> 16) & 0xFF),
+        (unsigned char)((tl >> 8) & 0xFF), (unsigned char)(tl & 0xFF)
+    };
+    std::FILE * f = std::fopen(filename.c_str(), "wb");
+    if (not_nullptr(f))
+    {
+        bool ok = std::fwrite(header, sizeof header, 1, f) == 1 &&
+            std::fwrite(&t[0], t.size(), 1, f) == 1;
+
+        if (std::fclose(f) != 0 || ! ok)
+            result = 0;
+    }
+    else
+        result = 0;
+
+    return result;
+}
+
+/**
+ *  Measures writing and parsing a large generated MIDI file.  An operation
+ *  is one event.  An SMF 0 file, which is split into one pattern per
+ *  channel when parsed, is also measured.
+ */
+
+static void
+bench_midifile (seq64::perform & p)
+{
+    if (! wanted("midifile_write") && ! wanted("midifile_parse_smf0"))
+        return;
+
+    std::string filename = "seq64bench.midi";
+    long events = make_song(p, 64, 64);
+    int loops = reps(10);
+    double ns = 0.0;
+    bool ok = true;
+    for (int i = 0; ok && i < loops; ++i)
+    {
+        seq64::midifile f(filename, s_ppqn);
+        double t0 = now_ns();
+        ok = f.write(p);
+        ns += now_ns() - t0;
+    }
+    if (ok && wanted("midifile_write"))
+        add_result("midifile_write", long(loops) * events, ns);
+
+    ns = 0.0;
+    for (int i = 0; ok && i < loops; ++i)
+    {
+        (void) p.clear_all();
+        seq64::midifile f(filename, s_ppqn);
+        double t0 = now_ns();
+        ok = f.parse(p, 0);
+        ns += now_ns() - t0;
+    }
+    if (ok && wanted("midifile_parse"))
+        add_result("midifile_parse", long(loops) * events, ns);
+
+    if (ok && wanted("midifile_parse_smf0"))
+    {
+        events = make_smf0(filename, 32768);
+        ok = events > 0;
+        ns = 0.0;
+        for (int i = 0; ok && i < loops; ++i)
+        {
+            (void) p.clear_all();
+            seq64::midifile f(filename, s_ppqn);
+            double t0 = now_ns();
+            ok = f.parse(p, 0);
+            ns += now_ns() - t0;
+        }
+        if (ok)
+            add_result("midifile_parse_smf0", long(loops) * events, ns);
+    }
+
+    if (! ok)
+        std::fprintf(stderr, "midifile cases failed\n");
+
+    (void) std::remove(filename.c_str());
+}
+
+/**
+ *  Measures taking a song_snapshot of the song that bench_midifile() writes.
+ *  This is the only part of a save that locks the patterns; the rest is
+ *  done on the autosave thread.  An operation is one snapshot.
+ */
+
+static void
+bench_song_snapshot (seq64::perform & p)
+{
+    if (! wanted("song_snapshot"))
+        return;
+
+    long events = make_song(p, 64, 64);
+    std::string name = "song_snapshot/" + std::to_string(events);
+    int loops = reps(1000);
+    double t0 = now_ns();
+    for (int i = 0; i < loops; ++i)
+    {
+        seq64::song_snapshot snap(p);
+        if (snap.tracks().empty())
+            break;
+    }
+    add_result(name, loops, now_ns() - t0);
+}
+
+/**
+ *  Measures the dispatch of incoming MIDI events to the MIDI controls.
+ *  The events are injected into the null input port all at once, and the
+ *  time for the input thread to consume them, via perform::poll_cycle(), is
+ *  measured.  The events are a mix of Note Ons and Control Changes, none of
+ *  which is recorded, so each goes through perform::midi_control_event().
+ *  An operation is one event.
+ */
+
+static void
+bench_midi_control (seq64::perform & p)
+{
+    if (! wanted("midi_control_dispatch"))
+        return;
+
+    seq64::mastermidibus & mmb = p.master_bus();
+    seq64::midibus * inbus = mmb.input_port(0);
+    if (is_nullptr(inbus))
+        return;
+
+    (void) p.clear_all();
+    mmb.set_input(0, true);
+
+    std::vector<seq64::event> events;
+    for (int n = 0; n < 4096; ++n)
+    {
+        seq64::event ev;
+        ev.set_status
+        (
+            n % 2 == 0 ? seq64::EVENT_NOTE_ON : seq64::EVENT_CONTROL_CHANGE
+        );
+        ev.set_data(random_int(128), 64);
+        events.push_back(ev);
+    }
+
+    int loops = reps(50);
+    double ns = 0.0;
+    for (int i = 0; i < loops; ++i)
+    {
+        double t0 = now_ns();
+        for (int n = 0; n < int(events.size()); ++n)
+            inbus->inject(events[n]);
+
+        while (inbus->pending_count() > 0)
+            std::this_thread::yield();
+
+        ns += now_ns() - t0;
+    }
+    mmb.set_input(0, false);
+    add_result
+    (
+        "midi_control_dispatch", long(loops) * long(events.size()), ns
+    );
+}
+
+/**
+ *  Measures the edit operations of the pattern editor on all the notes of
+ *  a dense pattern, of about 4K and 100K events.  An operation is one event
+ *  of the pattern.
+ */
+
+static void
+bench_edit (seq64::perform & p)
+{
+    static const int measures[] = { 8, 200 };
+    for (int z = 0; z < int(sizeof measures / sizeof measures[0]); ++z)
+    {
+        (void) p.clear_all();
+        seq64::sequence * s = make_sequence(p, 0, measures[z], 256);
+        if (is_nullptr(s))
+            return;
+
+        long events = s->event_count();
+        std::string suffix = "/" + std::to_string(events);
+        seq64::midipulse length = s->get_length();
+        int loops = z == 0 ? reps(20) : reps(2) ;
+        if (wanted("quantize" + suffix))
+        {
+            double ns = 0.0;
+            for (int i = 0; i < loops; ++i)
+            {
+                s->select_all_notes();
+                double t0 = now_ns();
+                s->quantize_events
+                (
+                    seq64::EVENT_NOTE_ON, 0, s_ppqn / 4, 2, true
+                );
+                ns += now_ns() - t0;
+            }
+            add_result("quantize" + suffix, long(loops) * events, ns);
+        }
+        if (wanted("transpose" + suffix))
+        {
+            s->select_all_notes();
+            double t0 = now_ns();
+            for (int i = 0; i < loops; ++i)
+                s->transpose_notes(i % 2 == 0 ? 1 : -1, 0);
+
+            add_result
+            (
+                "transpose" + suffix, long(loops) * events, now_ns() - t0
+            );
+        }
+        if (wanted("stretch" + suffix))
+        {
+            s->select_all_notes();
+            double t0 = now_ns();
+            for (int i = 0; i < loops; ++i)
+                s->stretch_selected(i % 2 == 0 ? -s_ppqn : s_ppqn);
+
+            add_result
+            (
+                "stretch" + suffix, long(loops) * events, now_ns() - t0
+            );
+        }
+        if (wanted("data_lfo" + suffix))
+        {
+            s->select_all_notes();
+            double t0 = now_ns();
+            for (int i = 0; i < loops; ++i)
+            {
+                s->change_event_data_lfo
+                (
+                    64.0, 32.0, 1.0, 0.01 * i, seq64::WAVE_SINE,
+                    seq64::EVENT_NOTE_ON, 0
+                );
+            }
+            add_result
+            (
+                "data_lfo" + suffix, long(loops) * events, now_ns() - t0
+            );
+        }
+        if (wanted("data_range" + suffix))
+        {
+            s->select_all_notes();
+            double t0 = now_ns();
+            for (int i = 0; i < loops; ++i)
+            {
+                (void) s->change_event_data_range
+                (
+                    0, length, seq64::EVENT_NOTE_ON, 0, 10 + i % 2, 120
+                );
+            }
+            add_result
+            (
+                "data_range" + suffix, long(loops) * events, now_ns() - t0
+            );
+        }
+        if (wanted("select_notes" + suffix))
+        {
+            double ns = 0.0;
+            for (int i = 0; i < loops; ++i)
+            {
+                s->unselect();
+                double t0 = now_ns();
+                (void) s->select_note_events
+                (
+                    0, 127, length, 0, seq64::sequence::e_select
+                );
+                ns += now_ns() - t0;
+            }
+            add_result("select_notes" + suffix, long(loops) * events, ns);
+        }
+    }
+}
+
+/**
+ *  Measures the queries the pattern editors make on mouse moves, on a dense
+ *  pattern of about 4K and 100K events: the note under the mouse, and
+ *  whether a box of one beat by one octave holds a selected note.  An
+ *  operation is one query.  The last case measures the first query after
+ *  an edit, which rebuilds the index; its operation is one event.
+ */
+
+static void
+bench_hit_test (seq64::perform & p)
+{
+    static const int measures[] = { 8, 200 };
+    for (int z = 0; z < int(sizeof measures / sizeof measures[0]); ++z)
+    {
+        (void) p.clear_all();
+        seq64::sequence * s = make_sequence(p, 0, measures[z], 256);
+        if (is_nullptr(s))
+            return;
+
+        long events = s->event_count();
+        std::string suffix = "/" + std::to_string(events);
+        int length = int(s->get_length());
+        int queries = reps(z == 0 ? 20000 : 2000);
+        if (wanted("hit_note" + suffix))
+        {
+            seq64::midipulse start, finish;
+            int note;
+            double t0 = now_ns();
+            for (int i = 0; i < queries; ++i)
+            {
+                (void) s->intersect_notes
+                (
+                    random_int(length), 36 + i % 60, start, finish, note
+                );
+            }
+            add_result("hit_note" + suffix, queries, now_ns() - t0);
+        }
+        if (wanted("select_box" + suffix))
+        {
+            s->unselect();
+            double t0 = now_ns();
+            for (int i = 0; i < queries; ++i)
+            {
+                seq64::midipulse tick = random_int(length);
+                int note = 36 + random_int(48);
+                (void) s->select_note_events
+                (
+                    tick, note + 12, tick + s_ppqn, note,
+                    seq64::sequence::e_is_selected
+                );
+            }
+            add_result("select_box" + suffix, queries, now_ns() - t0);
+        }
+        if (wanted("hit_after_edit" + suffix))
+        {
+            seq64::midipulse start, finish;
+            int note;
+            int loops = reps(z == 0 ? 200 : 20);
+            double ns = 0.0;
+            for (int i = 0; i < loops; ++i)
+            {
+                s->modify();
+                double t0 = now_ns();
+                (void) s->intersect_notes(0, 36, start, finish, note);
+                ns += now_ns() - t0;
+            }
+            add_result("hit_after_edit" + suffix, long(loops) * events, ns);
+        }
+    }
+}
+
+/**
+ *  Measures copying a pattern of about 100K events to a clipboard pattern
+ *  and pasting it back, as the main window does, and pushing the pattern
+ *  onto its undo stack, as each edit does.  An operation is one copy and
+ *  paste, or one push.
+ */
+
+static void
+bench_pattern_copy (seq64::perform & p)
+{
+    (void) p.clear_all();
+    seq64::sequence * s = make_sequence(p, 0, 200, 256);
+    seq64::sequence * t = make_sequence(p, 1, 1, 1);
+    if (is_nullptr(s) || is_nullptr(t))
+        return;
+
+    std::string suffix = "/" + std::to_string(s->event_count());
+    int loops = reps(10);
+    if (wanted("pattern_copy" + suffix))
+    {
+        seq64::sequence clipboard;
+        double t0 = now_ns();
+        for (int i = 0; i < loops; ++i)
+        {
+            clipboard.partial_assign(*s);
+            t->partial_assign(clipboard);
+        }
+        add_result("pattern_copy" + suffix, loops, now_ns() - t0);
+    }
+    if (wanted("push_undo" + suffix))
+    {
+        double t0 = now_ns();
+        for (int i = 0; i < loops; ++i)
+            s->push_undo();
+
+        add_result("push_undo" + suffix, loops, now_ns() - t0);
+    }
+}
+
+/**
+ *  Measures rendering a song in Song mode with the offline_render class,
+ *  once through the play-queue of each pattern, and once through the
+ *  compiled song_timeline.  An operation is one event played.
+ */
+
+static void
+bench_song_render (seq64::perform & p)
+{
+    bool oldtimeline = seq64::usr().option_song_timeline();
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        std::string name = mode == 0 ?
+            "song_render/patterns" : "song_render/timeline" ;
+
+        if (! wanted(name))
+            continue;
+
+        (void) make_song(p, 64, 16);
+        seq64::usr().option_song_timeline(mode == 1);
+
+        seq64::offline_render renderer(p);
+        int loops = reps(2);
+        long events = 0;
+        double ns = 0.0;
+        for (int i = 0; i < loops; ++i)
+        {
+            if (! renderer.render())
+                break;
+
+            events += renderer.capture().count();
+            ns += renderer.elapsed_us() * 1000.0;
+        }
+        add_result(name, events, ns);
+    }
+    seq64::usr().option_song_timeline(oldtimeline);
+}
+
+/**
+ *  Measures the output cycle with many busy patterns in Live mode, first
+ *  with the serial loop of perform::play() (which is private, so it is
+ *  repeated here), then with a play_pool of 1, 2,
+ *  4, ... threads, up to the number of cores.  Each cycle advances 2 ticks,
+ *  about 5 ms at 120 BPM.  An operation is one cycle.
+ */
+
+static void
+bench_parallel_play (seq64::perform & p)
+{
+    static const int patterns = 512;
+    int cores = int(std::thread::hardware_concurrency());
+    if (cores < 2)
+        cores = 2;
+
+    std::vector<int> counts(1, 0);              /* 0 means the serial loop  */
+    for (int threads = 1; threads <= cores; threads *= 2)
+        counts.push_back(threads);
+
+    bool made = false;
+    for (int i = 0; i < int(counts.size()); ++i)
+    {
+        int threads = counts[i];
+        std::string name = threads == 0 ?
+            "parallel_play/serial" :
+            "parallel_play/" + std::to_string(threads) ;
+
+        if (wanted(name))
+        {
+            if (! made)
+            {
+                (void) p.clear_all();
+                for (int seqno = 0; seqno < patterns; ++seqno)
+                {
+                    seq64::sequence * s = make_sequence(p, seqno, 4, 64);
+                    if (not_nullptr(s))
+                    {
+                        s->set_midi_bus(char(seqno % 16));
+                        s->set_playing(true);
+                    }
+                }
+                made = true;
+            }
+            for (int seqno = 0; seqno < patterns; ++seqno)
+            {
+                seq64::sequence * s = p.get_sequence(seqno);
+                if (not_nullptr(s))
+                    s->set_last_tick(0);
+            }
+
+
+            seq64::play_pool * pool = threads > 0 ?
+                new seq64::play_pool(p, threads) : nullptr ;
+
+            long cycles = reps(2000);
+            double t0 = now_ns();
+            for (long c = 1; c <= cycles; ++c)
+            {
+                seq64::midipulse tick = seq64::midipulse(2 * c);
+                if (not_nullptr(pool))
+                {
+                    pool->play(tick, false, false);
+                }
+                else
+                {
+                    for (int seqno = 0; seqno < patterns; ++seqno)
+                    {
+                        seq64::sequence * s = p.get_sequence(seqno);
+                        if (not_nullptr(s))
+                            s->play_queue(tick, false, false);
+                    }
+                }
+                p.master_bus().flush();
+            }
+            add_result(name, cycles, now_ns() - t0);
+            delete pool;
+        }
+    }
+    (void) p.clear_all();
+}
+
+/**
+ *  Writes the results in the selected format.
+ */
+
+static void
+report (std::FILE * out, const std::string & format)
+{
+    if (format == "json")
+    {
+        std::fprintf
+        (
+            out, "{\n  \"program\": \"seq64bench\",\n  \"version\": \"%s\",\n"
+            "  \"results\": [\n", SEQ64_VERSION
+        );
+    }
+    else if (format == "csv")
+        std::fprintf(out, "name,ops,ns,ns_per_op,ops_per_sec\n");
+    else
+    {
+        std::fprintf
+        (
+            out, "%-28s %12s %14s %12s %14s\n",
+            "case", "ops", "ns", "ns/op", "ops/s"
+        );
+    }
+    for (int i = 0; i < int(s_results.size()); ++i)
+    {
+        const result & r = s_results[i];
+        double nsperop = r.ops > 0 ? r.ns / double(r.ops) : 0.0 ;
+        double opspersec = r.ns > 0.0 ? double(r.ops) * 1.0e9 / r.ns : 0.0 ;
+        if (format == "json")
+        {
+            std::fprintf
+            (
+                out, "    { \"name\": \"%s\", \"ops\": %ld, \"ns\": %.0f, "
+                "\"ns_per_op\": %.3f, \"ops_per_sec\": %.1f }%s\n",
+                r.name.c_str(), r.ops, r.ns, nsperop, opspersec,
+                i + 1 < int(s_results.size()) ? "," : ""
+            );
+        }
+        else if (format == "csv")
+        {
+            std::fprintf
+            (
+                out, "%s,%ld,%.0f,%.3f,%.1f\n",
+                r.name.c_str(), r.ops, r.ns, nsperop, opspersec
+            );
+        }
+        else
+        {
+            std::fprintf
+            (
+                out, "%-28s %12ld %14.0f %12.3f %14.1f\n",
+                r.name.c_str(), r.ops, r.ns, nsperop, opspersec
+            );
+        }
+    }
+    if (format == "json")
+        std::fprintf(out, "  ]\n}\n");
+}
+
+/**
+ *  The benchmark entry point.  The performance is launched on the null
+ *  MIDI backend, with no capture, so that the ports add as little as
+ *  possible to the measurements.
+ */
+
+int
+main (int argc, char * argv [])
+{
+    std::string format = "text";
+    std::string outname;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--csv") == 0)
+            format = "csv";
+        else if (std::strcmp(argv[i], "--json") == 0)
+            format = "json";
+        else if (std::strcmp(argv[i], "--quick") == 0)
+            s_divisor = 10;
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outname = argv[++i];
+        else if (argv[i][0] == '-')
+        {
+            std::fprintf
+            (
+                stderr,
+                "Usage: %s [--csv | --json] [--quick] [--output file] "
+                "[filter]\n", argv[0]
+            );
+            return EXIT_FAILURE;
+        }
+        else
+            s_filter = argv[i];
+    }
+
+    std::FILE * out = stdout;
+    if (! outname.empty())
+    {
+        out = std::fopen(outname.c_str(), "w");
+        if (is_nullptr(out))
+        {
+            std::fprintf(stderr, "Cannot open %s\n", outname.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    seq64::rc().set_defaults();
+    seq64::usr().set_defaults();
+    seq64::mastermidibus::configure(SEQ64_DEFAULT_BUSS_MAX, 1, 0);
+
+    seq64::keys_perform keys;
+    seq64::gui_assistant gui(keys);
+    seq64::perform p(gui);
+    p.launch(s_ppqn);
+    bench_sequence_play(p);
+    bench_event_list(p);
+    bench_triggers_play(p);
+    bench_midifile(p);
+    bench_song_snapshot(p);
+    bench_midi_control(p);
+    bench_edit(p);
+    bench_hit_test(p);
+    bench_pattern_copy(p);
+    bench_song_render(p);
+    bench_parallel_play(p);
+    (void) p.clear_all();
+    p.finish();
+    report(out, format);
+    if (out != stdout)
+        std::fclose(out);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * seq64bench.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
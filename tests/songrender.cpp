@@ -0,0 +1,248 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          songrender.cpp
+ *
+ *  This module defines a test that the compiled song_timeline plays a song
+ *  exactly as the patterns themselves do.
+ *
+ * \library       sequencer64 application
+ * \author        Chris Ahlstrom
+ * \date          2023-03-28
+ * \updates       2023-03-28
+ * \license       GNU GPLv2 or above
+ *
+ *  Each MIDI file is loaded and rendered twice in Song mode by the
+ *  offline_render class:  once through sequence::play(), and once through
+ *  the compiled song_timeline ("-o song-timeline").  The two captures must
+ *  hold the same events, on the same busses, at the same ticks.  Events of
+ *  the same tick may come out in a different order, since the timeline
+ *  plays them buss by buss; each tick is sorted before the comparison.
+ *
+ *  Usage:
+ *
+\verbatim
+        songrender file.midi ...
+\endverbatim
+ *
+ *  The program reports the first difference found in each file, and
+ *  returns 1 if any file renders differently, or cannot be loaded.
+ */
+
+#include <algorithm>                    /* std::sort()                      */
+#include <cstdio>                       /* std::printf()                    */
+#include <cstdlib>                      /* EXIT_SUCCESS, EXIT_FAILURE       */
+#include <string>                       /* std::string                      */
+#include <vector>                       /* std::vector<>                    */
+
+#include "gui_assistant.hpp"            /* seq64::gui_assistant             */
+#include "keys_perform.hpp"             /* seq64::keys_perform              */
+#include "mastermidibus.hpp"            /* seq64::mastermidibus             */
+#include "midifile.hpp"                 /* seq64::open_midi_file()          */
+#include "offline_render.hpp"           /* seq64::offline_render            */
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "settings.hpp"                 /* seq64::rc(), seq64::usr()        */
+
+/**
+ *  One captured event, reduced to what goes out on the buss.
+ */
+
+struct played
+{
+    long tick;
+    int bus;
+    int status;
+    int d0;
+    int d1;
+
+    bool operator < (const played & rhs) const
+    {
+        if (tick != rhs.tick)
+            return tick < rhs.tick;
+
+        if (bus != rhs.bus)
+            return bus < rhs.bus;
+
+        if (status != rhs.status)
+            return status < rhs.status;
+
+        if (d0 != rhs.d0)
+            return d0 < rhs.d0;
+
+        return d1 < rhs.d1;
+    }
+
+    bool operator != (const played & rhs) const
+    {
+        return *this < rhs || rhs < *this;
+    }
+};
+
+typedef std::vector<played> Played;
+
+/**
+ *  Renders the loaded song, through the timeline or not.
+ *
+ * \param p
+ *      The performance, holding the song.
+ *
+ * \param timeline
+ *      If true, the compiled song_timeline plays the song.
+ *
+ * \param [out] result
+ *      The events captured, sorted within each tick.
+ *
+ * \return
+ *      Returns true if the render succeeded.
+ */
+
+static bool
+render (seq64::perform & p, bool timeline, Played & result)
+{
+    seq64::usr().option_song_timeline(timeline);
+    seq64::offline_render renderer(p);
+    bool ok = renderer.render();
+    result.clear();
+    if (ok)
+    {
+        const seq64::midi_capture::Records & records =
+            renderer.capture().records();
+
+        seq64::midi_capture::Records::const_iterator r;
+        for (r = records.begin(); r != records.end(); ++r)
+        {
+            seq64::midibyte d0, d1;
+            r->get_event().get_data(d0, d1);
+
+            played pl;
+            pl.tick = long(r->tick());
+            pl.bus = int(r->bus());
+            pl.status = int(r->get_event().get_status());
+            pl.d0 = int(d0);
+            pl.d1 = int(d1);
+            result.push_back(pl);
+        }
+        std::sort(result.begin(), result.end());
+    }
+    return ok;
+}
+
+/**
+ *  Loads a MIDI file and compares its two renders.
+ *
+ * \return
+ *      Returns true if the renders are the same.
+ */
+
+static bool
+check_file (seq64::perform & p, const std::string & filename)
+{
+    int ppqn = 0;
+    std::string errmsg;
+    if (! seq64::open_midi_file(p, filename, ppqn, errmsg))
+    {
+        std::printf("FAIL %s: %s\n", filename.c_str(), errmsg.c_str());
+        return false;
+    }
+    if (p.get_max_trigger() <= 0)
+    {
+        std::printf("skip %s: no triggers\n", filename.c_str());
+        return true;
+    }
+
+    Played patterns, compiled;
+    bool ok = render(p, false, patterns) && render(p, true, compiled);
+    if (! ok)
+    {
+        std::printf("FAIL %s: render failed\n", filename.c_str());
+        return false;
+    }
+
+    std::size_t count = std::min(patterns.size(), compiled.size());
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const played & a = patterns[i];
+        const played & b = compiled[i];
+        if (a != b)
+        {
+            std::printf
+            (
+                "FAIL %s: event %lu, patterns tick %ld buss %d %02X %d %d, "
+                "timeline tick %ld buss %d %02X %d %d\n",
+                filename.c_str(), (unsigned long) i,
+                a.tick, a.bus, a.status, a.d0, a.d1,
+                b.tick, b.bus, b.status, b.d0, b.d1
+            );
+            return false;
+        }
+    }
+    if (patterns.size() != compiled.size())
+    {
+        std::printf
+        (
+            "FAIL %s: %lu events from the patterns, %lu from the timeline\n",
+            filename.c_str(), (unsigned long) patterns.size(),
+            (unsigned long) compiled.size()
+        );
+        return false;
+    }
+    std::printf("ok   %s: %lu events\n", filename.c_str(),
+        (unsigned long) patterns.size());
+    return true;
+}
+
+/**
+ *  The main routine.
+ */
+
+int
+main (int argc, char * argv [])
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s file.midi ...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    seq64::rc().set_defaults();
+    seq64::usr().set_defaults();
+    seq64::mastermidibus::configure(SEQ64_DEFAULT_BUSS_MAX, 1, 0);
+
+    seq64::keys_perform keys;
+    seq64::gui_assistant gui(keys);
+    seq64::perform p(gui);
+    p.launch(SEQ64_DEFAULT_PPQN);
+
+    bool result = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (! check_file(p, argv[i]))
+            result = false;
+    }
+    (void) p.clear_all();
+    p.finish();
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * songrender.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+